@@ -79,6 +79,18 @@ async def startup_event():
         print("Error: C++ Optimizer Engine failed to initialize. API might not function correctly.")
 
 
+# Event handler for application shutdown.
+@app.on_event("shutdown")
+async def shutdown_event():
+    """
+    Stops the resident C++ engine process.
+    """
+    # Close the persistent engine connection, if one was opened.
+    if optimizer_service.ENGINE is not None:
+        # Ask the engine to exit.
+        optimizer_service.ENGINE.close()
+
+
 # Include the graph API router with a prefix.
 app.include_router(graph_router.router, prefix="/api/v1", tags=["Graph Operations"])
 
@@ -1,6 +1,6 @@
 # Graph API routes
-from fastapi import APIRouter, HTTPException, Depends
-from typing import List, Dict, Any
+from fastapi import APIRouter, HTTPException, Depends, Response
+from typing import List, Dict, Any, Optional
 
 from backend.models import schema # Use fully qualified import
 from backend.services import optimizer as optimizer_service # Use fully qualified import
@@ -20,12 +20,31 @@ async def check_engine_initialized():
 
 # API endpoint to get the current graph data.
 @router.get("/graph", response_model=schema.GraphResponse, dependencies=[Depends(check_engine_initialized)])
-async def get_graph_data():
+async def get_graph_data(since: Optional[int] = None, bbox: Optional[str] = None):
     """
     Retrieves the current graph structure (nodes and edges) from the C++ engine.
+    `since` (the version of an earlier response) returns only what changed after it; the response
+    says whether it is such a delta or a full replacement. `bbox` ("min_x,min_y,max_x,max_y")
+    limits the result to nodes inside the box and edges between them.
     """
+    # Parsed viewport.
+    box = None
+    # If a viewport was requested.
+    if bbox is not None:
+        # Try to parse four numbers.
+        try:
+            # Corner coordinates.
+            box = tuple(float(c) for c in bbox.split(","))
+        # Handle malformed numbers.
+        except ValueError:
+            # Force the length check below to fail.
+            box = ()
+        # Exactly four corners.
+        if len(box) != 4:
+            # Raise 400 Bad Request.
+            raise HTTPException(status_code=400, detail="bbox must be 'min_x,min_y,max_x,max_y'.")
     # Call service to get graph data.
-    graph_data_dict = optimizer_service.get_graph_data_service()
+    graph_data_dict = optimizer_service.get_graph_data_service(since, box)
     # If graph data is not retrieved successfully.
     if graph_data_dict is None:
         # Raise 404 Not Found error.
@@ -41,9 +60,10 @@ async def get_graph_data():
         # Iterate through raw edge data.
         for e_raw in edges_raw:
             # Create Edge object, mapping "from" to "from_node".
-            edges.append(schema.Edge(from_node=e_raw["from"], to_node=e_raw["to"], weight=e_raw["weight"]))
+            edges.append(schema.Edge(from_node=e_raw["from"], to_node=e_raw["to"], weight=e_raw["weight"], parallel=e_raw.get("parallel", 0)))
         # Return graph data in response model.
-        return schema.GraphResponse(nodes=nodes, edges=edges, message="Graph data retrieved successfully.")
+        return schema.GraphResponse(nodes=nodes, edges=edges, version=graph_data_dict.get("version"), full=graph_data_dict.get("full", True),
+                                    message="Graph data retrieved successfully.")
     # Handle exceptions during parsing.
     except Exception as e:
         # Raise 500 Internal Server Error if parsing fails.
@@ -84,14 +104,19 @@ async def add_edge(request: schema.AddEdgeRequest):
 @router.post("/shortest_path", response_model=schema.ShortestPathResponse, dependencies=[Depends(check_engine_initialized)])
 async def shortest_path(request: schema.ShortestPathRequest):
     """
-    Calculates the shortest path between two nodes using Dijkstra or A*.
+    Calculates the shortest path between two nodes using (bidirectional) Dijkstra, A* (Euclidean or landmark bounds) or a (customizable) contraction hierarchy.
+    "td_dijkstra" follows the edges' travel-time functions from departure_time and also reports the arrival.
     """
     # Check if the requested algorithm is valid.
-    if request.algorithm not in ["dijkstra", "astar"]:
+    if request.algorithm not in ["dijkstra", "astar", "alt", "bidijkstra", "biastar", "ch", "cch", "crp", "td_dijkstra"]:
         # Raise 400 Bad Request for invalid algorithm.
-        raise HTTPException(status_code=400, detail="Invalid algorithm. Choose 'dijkstra' or 'astar'.")
+        raise HTTPException(status_code=400, detail="Invalid algorithm. Choose 'dijkstra', 'astar', 'alt', 'bidijkstra', 'biastar', 'ch', 'cch', 'crp' or 'td_dijkstra'.")
+    # The departure time goes with time-dependent queries only.
+    if (request.algorithm == "td_dijkstra") != (request.departure_time is not None):
+        # Raise 400 Bad Request.
+        raise HTTPException(status_code=400, detail="departure_time is required by 'td_dijkstra' and only accepted there.")
     # Call service to find the shortest path.
-    result = optimizer_service.shortest_path_service(request.start_node, request.end_node, request.algorithm)
+    result = optimizer_service.shortest_path_service(request.start_node, request.end_node, request.algorithm, request.departure_time)
     # If the path list is empty and there's a message (likely error or no path).
     if not result["path"] and "message" in result and "found" not in result["message"].lower() : # Check if it's not a "No path found" message
         # If the message suggests an error rather than just "no path".
@@ -99,7 +124,87 @@ async def shortest_path(request: schema.ShortestPathRequest):
             # Raise 500 Internal Server Error.
              raise HTTPException(status_code=500, detail=result["message"])
     # Return the shortest path response.
-    return schema.ShortestPathResponse(path=result["path"], weight=result["weight"], message=result.get("message", "Path calculation processed."))
+    return schema.ShortestPathResponse(path=result["path"], weight=result["weight"], arrival=result.get("arrival"), message=result.get("message", "Path calculation processed."))
+
+
+# API endpoint to answer many shortest path queries at once.
+@router.post("/shortest_path_batch", response_model=schema.ShortestPathBatchResponse, dependencies=[Depends(check_engine_initialized)])
+async def shortest_path_batch(request: schema.ShortestPathBatchRequest):
+    """
+    Answers many (source, target, algorithm) queries in one engine call, in parallel on all cores.
+    Results come back in request order, each tagged with the index of its query.
+    """
+    # Valid algorithm names.
+    algorithms = ["dijkstra", "astar", "alt", "bidijkstra", "biastar", "ch", "cch", "crp"]
+    # Check the default and every per-query algorithm.
+    if request.algorithm not in algorithms or any(q.algorithm is not None and q.algorithm not in algorithms for q in request.queries):
+        # Raise 400 Bad Request for invalid algorithm.
+        raise HTTPException(status_code=400, detail="Invalid algorithm. Choose 'dijkstra', 'astar', 'alt', 'bidijkstra', 'biastar', 'ch', 'cch' or 'crp'.")
+    # Nothing to compute.
+    if not request.queries:
+        # Return an empty result list.
+        return schema.ShortestPathBatchResponse(results=[], message="No queries.")
+    # Call service to answer the batch.
+    result = optimizer_service.shortest_path_batch_service([(q.source, q.target, q.algorithm) for q in request.queries], request.algorithm, request.include_paths)
+    # If the engine failed.
+    if result["results"] is None:
+        # Raise 500 Internal Server Error with the engine message.
+        raise HTTPException(status_code=500, detail=result["message"])
+    # Return the results.
+    return schema.ShortestPathBatchResponse(results=result["results"], message=result["message"])
+
+
+# API endpoint to rank alternative routes.
+@router.post("/k_shortest_paths", response_model=schema.KShortestPathsResponse, dependencies=[Depends(check_engine_initialized)])
+async def k_shortest_paths(request: schema.KShortestPathsRequest):
+    """
+    Returns up to k loopless routes from the start node to the end node, shortest first.
+    """
+    # At least one path must be asked for.
+    if request.k < 1:
+        # Raise 400 Bad Request for an invalid count.
+        raise HTTPException(status_code=400, detail="k must be at least 1.")
+    # Call service to rank the paths.
+    result = optimizer_service.k_shortest_paths_service(request.start_node, request.end_node, request.k)
+    # If the engine failed.
+    if result["paths"] is None:
+        # Raise 500 Internal Server Error with the engine message.
+        raise HTTPException(status_code=500, detail=result["message"])
+    # Return the ranked paths.
+    return schema.KShortestPathsResponse(paths=result["paths"], message=result["message"])
+
+
+# API endpoint to compute a source x target distance matrix.
+@router.post("/distance_matrix", response_model=schema.DistanceMatrixResponse, dependencies=[Depends(check_engine_initialized)])
+async def distance_matrix(request: schema.DistanceMatrixRequest):
+    """
+    Computes the shortest distances from every source to every target in one engine call.
+    With format "binary" the engine's raw matrix is returned as application/octet-stream.
+    """
+    # Check if the requested method is valid.
+    if request.method not in ["auto", "dijkstra", "ch", "cch"]:
+        # Raise 400 Bad Request for invalid method.
+        raise HTTPException(status_code=400, detail="Invalid method. Choose 'auto', 'dijkstra', 'ch' or 'cch'.")
+    # Check if the requested format is valid.
+    if request.format not in ["json", "binary"]:
+        # Raise 400 Bad Request for invalid format.
+        raise HTTPException(status_code=400, detail="Invalid format. Choose 'json' or 'binary'.")
+    # An empty list has nothing to compute.
+    if not request.sources or not request.targets:
+        # Raise 400 Bad Request for empty lists.
+        raise HTTPException(status_code=400, detail="Sources and targets must not be empty.")
+    # Call service to compute the matrix.
+    result = optimizer_service.distance_matrix_service(request.sources, request.targets, request.method)
+    # If the engine failed (e.g. unknown node).
+    if result["payload"] is None:
+        # Raise 400 Bad Request with the engine message.
+        raise HTTPException(status_code=400, detail=result["message"])
+    # Raw matrix for binary clients.
+    if request.format == "binary":
+        # Return the engine bytes unchanged.
+        return Response(content=result["payload"], media_type="application/octet-stream")
+    # Return the decoded matrix.
+    return schema.DistanceMatrixResponse(sources=request.sources, targets=request.targets, distances=result["distances"], message=result["message"])
 
 
 # API endpoint to update the weight of an edge.
@@ -117,6 +222,242 @@ async def update_weight(request: schema.UpdateWeightRequest):
     # Return success message.
     return schema.MessageResponse(message=result["message"])
 
+# API endpoint to remove (close) an edge.
+@router.post("/remove_edge", response_model=schema.MessageResponse, dependencies=[Depends(check_engine_initialized)])
+async def remove_edge(request: schema.RemoveEdgeRequest):
+    """
+    Removes an existing edge, e.g., due to a road closure; zones split if it was their last connection.
+    """
+    # Call service to remove the edge.
+    result = optimizer_service.remove_edge_service(request.from_node, request.to_node)
+    # If the result contains details.
+    if result.get("details"):
+        # Raise 400 Bad Request if removal fails (e.g., edge not found).
+        raise HTTPException(status_code=400, detail=result["details"])
+    # Return success message.
+    return schema.MessageResponse(message=result["message"])
+
+# API endpoint to keep a source's shortest path tree resident.
+@router.post("/maintained_sources", response_model=schema.MessageResponse, dependencies=[Depends(check_engine_initialized)])
+async def maintain_source(request: schema.MaintainSourceRequest):
+    """
+    Registers a source; the engine keeps its shortest path tree and repairs it incrementally on every weight update.
+    """
+    # Call service to register the source.
+    result = optimizer_service.maintain_source_service(request.source)
+    # If the result contains details (e.g. unknown node).
+    if result.get("details"):
+        # Raise 400 Bad Request with details.
+        raise HTTPException(status_code=400, detail=result["details"])
+    # Return success message.
+    return schema.MessageResponse(message=result["message"])
+
+# API endpoint to stop maintaining a source.
+@router.delete("/maintained_sources/{source}", response_model=schema.MessageResponse, dependencies=[Depends(check_engine_initialized)])
+async def drop_source(source: int):
+    """
+    Drops the maintained shortest path tree of a source.
+    """
+    # Call service to drop the source.
+    result = optimizer_service.maintain_source_service(source, maintain=False)
+    # If the result contains details (source not maintained).
+    if result.get("details"):
+        # Raise 404 Not Found with details.
+        raise HTTPException(status_code=404, detail=result["details"])
+    # Return success message.
+    return schema.MessageResponse(message=result["message"])
+
+# API endpoint to read a maintained shortest path tree.
+@router.get("/maintained_sources/{source}/tree", response_model=schema.SourceTreeResponse, dependencies=[Depends(check_engine_initialized)])
+async def source_tree(source: int):
+    """
+    Returns every node reachable from a maintained source with its distance and tree parent.
+    """
+    # Call service to read the tree.
+    result = optimizer_service.source_tree_service(source)
+    # If the source is not maintained.
+    if result["tree"] is None:
+        # Raise 404 Not Found with the engine message.
+        raise HTTPException(status_code=404, detail=result["message"])
+    # Return the tree.
+    return schema.SourceTreeResponse(**result["tree"], message=result["message"])
+
+# API endpoint to read one path of a maintained shortest path tree.
+@router.get("/maintained_sources/{source}/path/{target}", response_model=schema.ShortestPathResponse, dependencies=[Depends(check_engine_initialized)])
+async def source_tree_path(source: int, target: int):
+    """
+    Returns the shortest path from a maintained source to a target, read off the resident tree.
+    """
+    # Call service to read the path.
+    result = optimizer_service.source_tree_service(source, target)
+    # If the source is not maintained.
+    if result["tree"] is None:
+        # Raise 404 Not Found with the engine message.
+        raise HTTPException(status_code=404, detail=result["message"])
+    # Unreachable targets have no weight.
+    weight = result["tree"]["weight"]
+    # Return the path.
+    return schema.ShortestPathResponse(path=result["tree"]["path"], weight=float("inf") if weight is None else weight,
+                                       message="Path found successfully." if weight is not None else f"No path found from {source} to {target}.")
+
+# API endpoint to read the shortest path cache counters.
+@router.get("/path_cache/stats", response_model=schema.PathCacheStatsResponse, dependencies=[Depends(check_engine_initialized)])
+async def path_cache_stats():
+    """
+    Returns the hit, miss, eviction and invalidation counters of the engine's shortest path cache.
+    """
+    # Call service to read the counters.
+    result = optimizer_service.path_cache_service("stats")
+    # If the engine failed.
+    if result["stats"] is None:
+        # Raise 500 Internal Server Error with the engine message.
+        raise HTTPException(status_code=500, detail=result["message"])
+    # Return the counters.
+    return schema.PathCacheStatsResponse(**result["stats"])
+
+# API endpoint to drop every cached shortest path.
+@router.post("/path_cache/clear", response_model=schema.PathCacheStatsResponse, dependencies=[Depends(check_engine_initialized)])
+async def path_cache_clear():
+    """
+    Empties the engine's shortest path cache and returns the counters afterwards.
+    """
+    # Call service to clear the cache.
+    result = optimizer_service.path_cache_service("clear")
+    # If the engine failed.
+    if result["stats"] is None:
+        # Raise 500 Internal Server Error with the engine message.
+        raise HTTPException(status_code=500, detail=result["message"])
+    # Return the counters.
+    return schema.PathCacheStatsResponse(**result["stats"])
+
+# API endpoint to find the nodes or edges closest to a point.
+@router.get("/nearest", response_model=schema.NearestResponse, dependencies=[Depends(check_engine_initialized)])
+async def nearest(x: float, y: float, k: int = 1, kind: str = "nodes"):
+    """
+    Returns up to k nodes (kind "nodes") or edge segments (kind "edges") closest to (x, y), closest first.
+    """
+    # Only nodes and edges are indexed.
+    if kind not in ("nodes", "edges"):
+        # Raise 400 Bad Request for unknown kinds.
+        raise HTTPException(status_code=400, detail="kind must be 'nodes' or 'edges'.")
+    # Call service for the lookup.
+    result = optimizer_service.nearest_service(x, y, k, kind)
+    # If the engine failed.
+    if result["matches"] is None:
+        # Raise 400 Bad Request with the engine message.
+        raise HTTPException(status_code=400, detail=result["message"])
+    # Edge matches use the API's field names for their ends.
+    if kind == "edges":
+        # Return the segments.
+        return schema.NearestResponse(edges=[schema.NearestEdge(from_node=m["from"], to_node=m["to"], x=m["x"], y=m["y"], fraction=m["fraction"], distance=m["distance"]) for m in result["matches"]])
+    # Return the nodes.
+    return schema.NearestResponse(nodes=[schema.NearestNode(**m) for m in result["matches"]])
+
+# API endpoint to route between two coordinates.
+@router.post("/route_coords", response_model=schema.RouteCoordsResponse, dependencies=[Depends(check_engine_initialized)])
+async def route_coords(request: schema.RouteCoordsRequest):
+    """
+    Snaps both points onto their closest edges and finds the shortest path between them, counting
+    the parts of those edges from and to the points.
+    """
+    # Call service to route.
+    result = optimizer_service.route_coords_service(request.source_x, request.source_y, request.target_x, request.target_y)
+    # No snapped endpoints means the engine failed (e.g. a graph without edges).
+    if result.get("source") is None:
+        # Raise 400 Bad Request with the engine message.
+        raise HTTPException(status_code=400, detail=result["message"])
+    # Snapped endpoints under the API's field names.
+    snaps = {side: schema.NearestEdge(from_node=m["from"], to_node=m["to"], x=m["x"], y=m["y"], fraction=m["fraction"], distance=m["distance"])
+             for side, m in (("source", result["source"]), ("target", result["target"]))}
+    # Return the route.
+    return schema.RouteCoordsResponse(path=result["path"], weight=result["weight"], source=snaps["source"], target=snaps["target"], message=result["message"])
+
+# API endpoint to read the engine's search counters and command latencies.
+@router.get("/stats", response_model=schema.EngineStatsResponse, dependencies=[Depends(check_engine_initialized)])
+async def engine_stats():
+    """
+    Returns the engine's search counters (nodes settled, edges relaxed, queue operations, cache hits)
+    and the latency percentiles of every command it has run.
+    """
+    # Call service to read the statistics.
+    result = optimizer_service.engine_stats_service()
+    # If the engine failed.
+    if result["stats"] is None:
+        # Raise 500 Internal Server Error with the engine message.
+        raise HTTPException(status_code=500, detail=result["message"])
+    # Return the statistics.
+    return schema.EngineStatsResponse(**result["stats"])
+
+# API endpoint to start the engine's counters and latency histograms from zero.
+@router.post("/stats/reset", response_model=schema.EngineStatsResponse, dependencies=[Depends(check_engine_initialized)])
+async def engine_stats_reset():
+    """
+    Resets the engine's search counters and command latencies and returns the statistics afterwards.
+    """
+    # Call service to reset and read the statistics.
+    result = optimizer_service.engine_stats_service(reset=True)
+    # If the engine failed.
+    if result["stats"] is None:
+        # Raise 500 Internal Server Error with the engine message.
+        raise HTTPException(status_code=500, detail=result["message"])
+    # Return the statistics.
+    return schema.EngineStatsResponse(**result["stats"])
+
+# API endpoint to set time buckets of an edge's travel-time profile.
+@router.put("/edge_profile", response_model=schema.MessageResponse, dependencies=[Depends(check_engine_initialized)])
+async def set_edge_profile(request: schema.EdgeProfileRequest):
+    """
+    Sets the travel time of some time buckets of an edge; buckets never set keep the edge's weight (or travel-time function).
+    Time-dependent routing uses the buckets from then on.
+    """
+    # Nothing to set.
+    if not request.buckets:
+        # Return a message without calling the engine.
+        return schema.MessageResponse(message="No buckets.")
+    # Call service to set the buckets.
+    result = optimizer_service.set_edge_profile_service(request.from_node, request.to_node, request.buckets)
+    # If the result contains details.
+    if result.get("details"):
+        # Raise 400 Bad Request with details.
+        raise HTTPException(status_code=400, detail=result["details"])
+    # Return success message.
+    return schema.MessageResponse(message=result["message"])
+
+# API endpoint to aggregate an edge's profile over a window of the day.
+@router.get("/edge_profile/{from_node}/{to_node}", response_model=schema.EdgeProfileStatsResponse, dependencies=[Depends(check_engine_initialized)])
+async def edge_profile_stats(from_node: int, to_node: int, start: Optional[str] = None, end: Optional[str] = None):
+    """
+    Returns the min, max and mean travel time of an edge over [start, end) ("HH:MM"), or over the whole day.
+    """
+    # A window needs both ends.
+    if (start is None) != (end is None):
+        # Raise 400 Bad Request.
+        raise HTTPException(status_code=400, detail="Give both start and end, or neither.")
+    # Call service to aggregate the profile.
+    result = optimizer_service.edge_profile_stats_service(from_node, to_node, start, end)
+    # If the engine failed (e.g. the edge has no profile).
+    if result["stats"] is None:
+        # Raise 404 Not Found with the engine message.
+        raise HTTPException(status_code=404, detail=result["message"])
+    # Return the aggregate.
+    return schema.EdgeProfileStatsResponse(**result["stats"])
+
+# API endpoint to compute the arrival-time function over a departure window.
+@router.get("/td_profile/{source}/{target}", response_model=schema.TimeDependentProfileResponse, dependencies=[Depends(check_engine_initialized)])
+async def td_profile(source: int, target: int, start: str, end: str):
+    """
+    Returns the arrival time at target as a piecewise-linear function of the departure from source
+    over [start, end] ("HH:MM" or minutes), together with the fastest and slowest travel time.
+    """
+    # Call service to run the profile search.
+    result = optimizer_service.td_profile_service(source, target, start, end)
+    # If the engine failed or the target is unreachable.
+    if result["profile"] is None:
+        # Raise 404 Not Found for unreachable targets, 400 Bad Request otherwise.
+        raise HTTPException(status_code=404 if "No path found" in result["message"] else 400, detail=result["message"])
+    # Return the profile.
+    return schema.TimeDependentProfileResponse(**result["profile"])
+
 # API endpoint for Union-Find: find the representative of a node's set.
 @router.post("/zones/find_set", response_model=schema.FindSetResponse, dependencies=[Depends(check_engine_initialized)])
 async def find_set(request: schema.FindSetRequest):
@@ -147,4 +488,53 @@ async def unite_sets(request: schema.UniteSetsRequest):
         # Raise 400 Bad Request with details.
         raise HTTPException(status_code=400, detail=result["details"])
     # Return success message.
-    return schema.MessageResponse(message=result["message"])
\ No newline at end of file
+    return schema.MessageResponse(message=result["message"])
+
+# API endpoint for Union-Find: unite many pairs of zones at once.
+@router.post("/zones/unite_batch", response_model=schema.MessageResponse, dependencies=[Depends(check_engine_initialized)])
+async def unite_batch(request: schema.UniteBatchRequest):
+    """
+    Unites the zones of every pair in one engine call; large batches pick their spanning forest links in parallel.
+    """
+    # Nothing to unite.
+    if not request.pairs:
+        # Return a message without calling the engine.
+        return schema.MessageResponse(message="No pairs.")
+    # Call service to unite the pairs.
+    result = optimizer_service.unite_batch_service(request.pairs)
+    # If the result contains details (implies an error).
+    if result.get("details"):
+        # Raise 400 Bad Request with details.
+        raise HTTPException(status_code=400, detail=result["details"])
+    # Return success message.
+    return schema.MessageResponse(message=result["message"])
+
+# API endpoint for zones: check whether two nodes are in the same zone.
+@router.post("/zones/connected", response_model=schema.ConnectedResponse, dependencies=[Depends(check_engine_initialized)])
+async def zones_connected(request: schema.UniteSetsRequest):
+    """
+    Tells whether two nodes are in the same zone, following edge additions and removals.
+    """
+    # Call service for the check.
+    result = optimizer_service.connected_service(request.node_id1, request.node_id2)
+    # If the engine failed (e.g. unknown node).
+    if result["connected"] is None:
+        # Raise 400 Bad Request with the engine message.
+        raise HTTPException(status_code=400, detail=result["message"])
+    # Return the answer.
+    return schema.ConnectedResponse(node_id1=request.node_id1, node_id2=request.node_id2, connected=result["connected"], message=result["message"])
+
+# API endpoint for Union-Find: recompute the zones from the graph's connectivity.
+@router.post("/zones/recompute", response_model=schema.ZonesResponse, dependencies=[Depends(check_engine_initialized)])
+async def recompute_zones():
+    """
+    Replaces the zones with the connected components of the graph, computed in parallel.
+    """
+    # Call service to recompute the zones.
+    result = optimizer_service.components_service()
+    # If the engine failed.
+    if result["components"] is None:
+        # Raise 500 Internal Server Error with the engine message.
+        raise HTTPException(status_code=500, detail=result["message"])
+    # Return the zones.
+    return schema.ZonesResponse(components=result["components"], zones=result["zones"], message=result["message"])
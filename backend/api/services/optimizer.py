@@ -1,19 +1,119 @@
 import subprocess
+import threading
 import json
 import os
+import re
+import struct
 from typing import List, Tuple, Optional, Dict, Any
 
 # Path to the C++ engine executable, configurable via environment or config file.
 CPP_ENGINE_EXECUTABLE = "cpp_engine/build/dynamic_route_optimizer"
 # Path to the default graph data.
 DEFAULT_GRAPH_DATA_PATH = "data/sample_graph.json"
+# Cached contraction hierarchy of the default graph, so the engine does not re-contract on every start.
+DEFAULT_CH_CACHE_PATH = os.path.splitext(DEFAULT_GRAPH_DATA_PATH)[0] + ".ch"
+
+# Long-lived connection to a resident `dynamic_route_optimizer serve` process.
+class EngineConnection:
+    """
+    Keeps one engine process alive and exchanges framed requests with it over stdin/stdout.
+    Each request is a single command line; each response is a header line "<status> <length>"
+    followed by exactly <length> bytes of command output.
+    """
+
+    # Creates an unstarted connection for the given executable.
+    def __init__(self, executable: str):
+        # Path to the engine executable.
+        self.executable = executable
+        # Handle of the resident engine process.
+        self.process: Optional[subprocess.Popen] = None
+        # Serializes requests; the protocol is strictly request/response.
+        self.lock = threading.Lock()
+
+    # Returns True while the engine process is alive.
+    def is_running(self) -> bool:
+        # The process exists and has not exited.
+        return self.process is not None and self.process.poll() is None
+
+    # Starts the engine process if it is not running.
+    def start(self):
+        # Nothing to do if the process is alive.
+        if self.is_running():
+            return
+        # Spawn the engine in serve mode with binary pipes.
+        self.process = subprocess.Popen([self.executable, "serve"], stdin=subprocess.PIPE,
+                                        stdout=subprocess.PIPE, stderr=subprocess.DEVNULL)
+
+    # Sends one command and returns (status, raw payload bytes).
+    def request(self, command_args: List[str]) -> Tuple[int, bytes]:
+        # Hold the lock for the whole round trip.
+        with self.lock:
+            # A fresh process would not hold the graph, so never respawn implicitly.
+            if not self.is_running():
+                # Report the failure.
+                raise RuntimeError("C++ engine process is not running.")
+            # Write the request line.
+            self.process.stdin.write((" ".join(command_args) + "\n").encode("utf-8"))
+            # Push it to the engine.
+            self.process.stdin.flush()
+            # Read the response header.
+            header = self.process.stdout.readline()
+            # An empty header means the engine exited.
+            if not header:
+                # Forget the dead process so the next call respawns it.
+                self.process = None
+                # Report the failure.
+                raise RuntimeError("C++ engine process exited unexpectedly.")
+            # Parse status and payload length.
+            status, length = (int(part) for part in header.split())
+            # Read exactly the payload.
+            payload = self.process.stdout.read(length)
+            # Return the response.
+            return status, payload
+
+    # Stops the engine process.
+    def close(self):
+        # Hold the lock so no request is in flight.
+        with self.lock:
+            # Nothing to do without a process.
+            if self.process is None:
+                return
+            # Ask the engine to exit cleanly.
+            try:
+                # Send the exit request.
+                self.process.stdin.write(b"exit\n")
+                # Flush and close stdin.
+                self.process.stdin.close()
+                # Wait briefly for shutdown.
+                self.process.wait(timeout=5)
+            # Kill the process if it does not exit.
+            except Exception:
+                # Force termination.
+                self.process.kill()
+            # Forget the process.
+            self.process = None
+
+
+# Shared engine connection, created on first use.
+ENGINE: Optional[EngineConnection] = None
+
+# Returns the shared engine connection, creating it if needed.
+def get_engine() -> EngineConnection:
+    # Global connection object.
+    global ENGINE
+    # Create the connection on first use (or after the executable path changed).
+    if ENGINE is None or ENGINE.executable != CPP_ENGINE_EXECUTABLE:
+        # Build a new connection.
+        ENGINE = EngineConnection(CPP_ENGINE_EXECUTABLE)
+    # Return the connection.
+    return ENGINE
+
 
 # Initializes the C++ engine, typically by loading a graph.
 def _initialize_engine():
     """
-    Ensures the C++ engine is loaded with a graph.
-    This might be called at startup or on first request.
-    For simplicity, we assume the C++ engine can take a graph file path.
+    Starts the resident C++ engine and loads the default graph into it.
+    The graph stays loaded for the lifetime of the engine process.
     """
     # Check if the default graph data file exists.
     if not os.path.exists(DEFAULT_GRAPH_DATA_PATH):
@@ -21,41 +121,57 @@ def _initialize_engine():
         print(f"Warning: Default graph data {DEFAULT_GRAPH_DATA_PATH} not found.")
         # Return False indicating failure.
         return False
-    
-    # Command to load the graph in the C++ engine.
-    cmd = [CPP_ENGINE_EXECUTABLE, "load_graph", DEFAULT_GRAPH_DATA_PATH]
-    # Try to execute the command.
+
+    # Try to load the graph into the resident engine.
     try:
-        # Run the command and capture output.
-        result = subprocess.run(cmd, capture_output=True, text=True, check=True, timeout=10)
+        # Spawn the resident engine if needed.
+        get_engine().start()
+        # Send the load command.
+        status, payload = get_engine().request(["load_graph", DEFAULT_GRAPH_DATA_PATH])
+        # Decode the engine output.
+        output = payload.decode("utf-8").strip()
         # Print stdout from C++ engine.
-        print(f"Engine load output: {result.stdout.strip()}")
-        # If "Error" is in stdout, something went wrong despite 0 exit code potentially.
-        if "Error" in result.stdout or "Could not load graph" in result.stdout :
+        print(f"Engine load output: {output}")
+        # Non-zero status means the graph could not be loaded.
+        if status != 0:
             # Print error message.
-            print(f"Error initializing C++ engine with graph: {result.stdout.strip()}")
+            print(f"Error initializing C++ engine with graph: {output}")
             # Return False indicating failure.
             return False
+        # Reuse the cached contraction hierarchy if it matches the graph.
+        _load_or_build_hierarchy()
         # Return True indicating success.
         return True
-    # Handle exceptions during subprocess execution.
-    except subprocess.CalledProcessError as e:
-        # Print error message with stderr.
-        print(f"Error calling C++ engine for load_graph: {e.stderr}")
-        # Return False indicating failure.
-        return False
-    # Handle timeout exception.
-    except subprocess.TimeoutExpired:
-        # Print timeout message.
-        print("Timeout calling C++ engine for load_graph.")
-        # Return False indicating failure.
-        return False
     # Handle file not found error.
     except FileNotFoundError:
         # Print executable not found message.
         print(f"Error: C++ executable '{CPP_ENGINE_EXECUTABLE}' not found. Ensure it is compiled and path is correct.")
         # Return False indicating failure.
         return False
+    # Handle a crashed or unreachable engine process.
+    except (OSError, RuntimeError, ValueError) as e:
+        # Print error message.
+        print(f"Error calling C++ engine for load_graph: {e}")
+        # Return False indicating failure.
+        return False
+
+
+def _load_or_build_hierarchy():
+    """
+    Loads the cached contraction hierarchy into the engine, or contracts the graph and refreshes
+    the cache when it is missing or stale. Failures are not fatal: "ch" queries then contract lazily.
+    """
+    # Try the cache first; the engine rejects hierarchies of other graphs or weights.
+    status, payload = get_engine().request(["load_ch", DEFAULT_CH_CACHE_PATH])
+    # Print the engine output.
+    print(f"Engine load_ch output: {payload.decode('utf-8').strip()}")
+    # Cache hit.
+    if status == 0:
+        return
+    # Contract now and write a fresh cache.
+    status, payload = get_engine().request(["save_ch", DEFAULT_CH_CACHE_PATH])
+    # Print the engine output.
+    print(f"Engine save_ch output: {payload.decode('utf-8').strip()}")
 
 
 # Counter for initialization attempts.
@@ -81,43 +197,58 @@ def ensure_engine_initialized():
     return ENGINE_INITIALIZED
 
 
-# Calls the C++ engine with a given command and arguments.
-def call_cpp_engine(command_args: List[str]) -> Tuple[Optional[str], Optional[str]]:
+# Sends a command to the resident C++ engine and returns its raw response.
+def call_cpp_engine_raw(command_args: List[str]) -> Tuple[Optional[bytes], Optional[str]]:
     """
-    Calls the C++ executable with the given list of command arguments.
-    Returns a tuple (stdout, stderr).
+    Sends one command over the persistent engine connection.
+    Returns a tuple (payload bytes, error message).
     """
+    # Global variables for initialization state.
+    global ENGINE_INITIALIZED, INIT_ATTEMPTS
+    # A dead engine process lost its graph, so it has to be initialized again.
+    if not get_engine().is_running():
+        # Reset initialization state.
+        ENGINE_INITIALIZED, INIT_ATTEMPTS = False, 0
     # If engine is not initialized, try to initialize it.
     if not ensure_engine_initialized():
         # If initialization fails, return error.
         return None, "C++ engine could not be initialized with graph data."
-
-    # Prepend the executable path to the command arguments.
-    cmd = [CPP_ENGINE_EXECUTABLE] + command_args
     # Try to execute the command.
     try:
-        # Run the command and capture output.
-        result = subprocess.run(cmd, capture_output=True, text=True, check=False, timeout=15) # check=False to get output even on error
-        # If C++ process returned an error code (non-zero).
-        if result.returncode != 0:
-            # Combine stdout and stderr for error message.
-            error_message = f"C++ engine error (code {result.returncode}): {result.stdout.strip()} {result.stderr.strip()}"
-            # Return None for stdout and the error message for stderr.
-            return None, error_message
-        # Return stdout and stderr (which should be empty on success).
-        return result.stdout.strip(), result.stderr.strip() if result.stderr else None
-    # Handle subprocess execution errors.
-    except subprocess.CalledProcessError as e:
-        # Return None for stdout and error details for stderr.
-        return None, f"CalledProcessError: {e.stderr or e.stdout or str(e)}"
-    # Handle timeout exception.
-    except subprocess.TimeoutExpired:
-        # Return None for stdout and timeout message for stderr.
-        return None, "Timeout calling C++ engine."
+        # Exchange one framed request/response.
+        status, payload = get_engine().request(command_args)
     # Handle file not found error (engine executable).
     except FileNotFoundError:
         # Return None for stdout and file not found message for stderr.
         return None, f"Error: C++ executable '{CPP_ENGINE_EXECUTABLE}' not found."
+    # Handle a crashed engine or broken pipe.
+    except (OSError, RuntimeError, ValueError) as e:
+        # Mark the engine uninitialized so the graph is reloaded on the next call.
+        ENGINE_INITIALIZED, INIT_ATTEMPTS = False, 0
+        # Return the error.
+        return None, f"C++ engine connection error: {e}"
+    # If C++ command returned an error code (non-zero).
+    if status != 0:
+        # Return None for stdout and the error message for stderr.
+        return None, f"C++ engine error (code {status}): {payload.decode('utf-8', 'replace').strip()}"
+    # Return the payload.
+    return payload, None
+
+
+# Calls the C++ engine with a given command and arguments.
+def call_cpp_engine(command_args: List[str]) -> Tuple[Optional[str], Optional[str]]:
+    """
+    Calls the resident C++ engine with the given list of command arguments.
+    Returns a tuple (stdout, stderr).
+    """
+    # Exchange the request.
+    payload, error = call_cpp_engine_raw(command_args)
+    # Propagate errors.
+    if error:
+        # Return None for stdout and the error message.
+        return None, error
+    # Return decoded output.
+    return payload.decode("utf-8").strip(), None
 
 # Service function to add a node.
 def add_node_service(node_id: int, x: Optional[float] = None, y: Optional[float] = None) -> Dict[str, Any]:
@@ -154,9 +285,12 @@ def add_edge_service(from_node: int, to_node: int, weight: float) -> Dict[str, A
     return {"message": stdout or "Edge added successfully (no output from engine)."}
 
 # Service function to find the shortest path.
-def shortest_path_service(start_node: int, end_node: int, algorithm: str) -> Dict[str, Any]:
+def shortest_path_service(start_node: int, end_node: int, algorithm: str, departure_time: Optional[str] = None) -> Dict[str, Any]:
     # Prepare command arguments for finding the shortest path.
     args = ["shortest_path", algorithm, str(start_node), str(end_node)]
+    # Time-dependent queries leave at a given time.
+    if departure_time is not None:
+        args.append(departure_time)
     # Call the C++ engine.
     stdout, stderr = call_cpp_engine(args)
     # If an error occurred or no stdout.
@@ -169,6 +303,8 @@ def shortest_path_service(start_node: int, end_node: int, algorithm: str) -> Dic
         path_nodes = []
         # Initialize path weight.
         path_weight = float('inf')
+        # Arrival time, reported by time-dependent queries only.
+        arrival = None
         # Split stdout into lines.
         lines = stdout.splitlines()
         # If "No path found" is in the output.
@@ -188,11 +324,15 @@ def shortest_path_service(start_node: int, end_node: int, algorithm: str) -> Dic
             elif line.startswith("Weight:"):
                 # Extract and convert weight to float.
                 path_weight = float(line.replace("Weight:", "").strip())
+            # Else if line starts with "Arrival:".
+            elif line.startswith("Arrival:"):
+                # Extract and convert the arrival time to float.
+                arrival = float(line.replace("Arrival:", "").strip())
         
         # If path nodes were extracted.
         if path_nodes:
             # Return the found path and weight.
-            return {"path": path_nodes, "weight": path_weight, "message": "Path found successfully."}
+            return {"path": path_nodes, "weight": path_weight, "arrival": arrival, "message": "Path found successfully."}
         else:
             # If parsing failed, return an error.
             return {"path": [], "weight": float('inf'), "message": f"Could not parse path from engine output: {stdout}"}
@@ -215,6 +355,324 @@ def update_weight_service(from_node: int, to_node: int, new_weight: float) -> Di
     # Return success message from stdout.
     return {"message": stdout or "Weight updated successfully (no output from engine)."}
 
+# Service function to remove (close) an edge.
+def remove_edge_service(from_node: int, to_node: int) -> Dict[str, Any]:
+    # Prepare command arguments for removing the edge.
+    args = ["remove_edge", str(from_node), str(to_node)]
+    # Call the C++ engine.
+    stdout, stderr = call_cpp_engine(args)
+    # If an error occurred (e.g. edge not found).
+    if stderr:
+        # Return error message.
+        return {"message": "Failed to remove edge", "details": stderr}
+    # Return success message from stdout.
+    return {"message": stdout or "Edge removed successfully (no output from engine)."}
+
+# Service function to compute a source x target distance matrix.
+def distance_matrix_service(sources: List[int], targets: List[int], method: str = "auto") -> Dict[str, Any]:
+    """
+    Computes all source->target distances in one engine call, using the binary matrix format
+    ("DRDM", uint32 rows, uint32 columns, row-major little-endian doubles).
+    Returns the raw payload and the decoded rows (None for unreachable targets).
+    """
+    # Prepare command arguments; ID lists are comma-separated.
+    args = ["distance_matrix", ",".join(map(str, sources)), ",".join(map(str, targets)), method, "binary"]
+    # Call the C++ engine.
+    payload, error = call_cpp_engine_raw(args)
+    # If an error occurred.
+    if error:
+        # Return error message.
+        return {"payload": None, "distances": [], "message": error}
+    # Check the header.
+    if len(payload) < 12 or payload[:4] != b"DRDM":
+        # Return error message.
+        return {"payload": None, "distances": [], "message": "Malformed distance matrix from engine."}
+    # Matrix dimensions.
+    rows, columns = struct.unpack_from("<II", payload, 4)
+    # Row-major cells.
+    cells = struct.unpack_from(f"<{rows * columns}d", payload, 12)
+    # Split into rows; INF becomes None.
+    distances = [[None if d == float("inf") else d for d in cells[r * columns:(r + 1) * columns]] for r in range(rows)]
+    # Return both forms.
+    return {"payload": payload, "distances": distances, "message": "Distance matrix computed successfully."}
+
+# Service function to answer many shortest path queries in one engine call.
+def shortest_path_batch_service(queries: List[Tuple[int, int, Optional[str]]], algorithm: str = "dijkstra", include_paths: bool = True) -> Dict[str, Any]:
+    """
+    Sends (source, target, algorithm or None) tuples as one shortest_path_batch command; the engine
+    answers them in parallel and returns the results in query order, each tagged with its index.
+    """
+    # Tuples as "source:target[:algorithm]", comma-separated.
+    encoded = ",".join(f"{s}:{t}:{a}" if a else f"{s}:{t}" for s, t, a in queries)
+    # Prepare command arguments.
+    args = ["shortest_path_batch", algorithm, encoded, "paths" if include_paths else "weights"]
+    # Call the C++ engine.
+    stdout, stderr = call_cpp_engine(args)
+    # If an error occurred (e.g. unknown algorithm).
+    if stderr or not stdout:
+        # Return error message.
+        return {"results": None, "message": stderr or "No output from engine."}
+    # Try to parse the JSON document.
+    try:
+        # Results in query order.
+        return {"results": json.loads(stdout)["results"], "message": "Batch computed successfully."}
+    # Handle malformed output.
+    except (json.JSONDecodeError, KeyError) as e:
+        # Return parsing error message.
+        return {"results": None, "message": f"Error decoding batch results from C++ engine: {str(e)}"}
+
+# Service function to rank up to k loopless routes between two nodes.
+def k_shortest_paths_service(start_node: int, end_node: int, k: int) -> Dict[str, Any]:
+    """
+    Runs the engine's k_shortest_paths command (Yen's algorithm) and returns the paths, shortest first.
+    """
+    # Prepare command arguments.
+    args = ["k_shortest_paths", str(start_node), str(end_node), str(k)]
+    # Call the C++ engine.
+    stdout, stderr = call_cpp_engine(args)
+    # If an error occurred (e.g. k below 1).
+    if stderr or not stdout:
+        # Return error message.
+        return {"paths": None, "message": stderr or "No output from engine."}
+    # Try to parse the JSON document.
+    try:
+        # Ranked paths.
+        paths = json.loads(stdout)["paths"]
+    # Handle malformed output.
+    except (json.JSONDecodeError, KeyError) as e:
+        # Return parsing error message.
+        return {"paths": None, "message": f"Error decoding ranked paths from C++ engine: {str(e)}"}
+    # No path at all means the end node is unreachable (or a node unknown).
+    if not paths:
+        # Return an empty list with an explanation.
+        return {"paths": [], "message": f"No path found from {start_node} to {end_node}."}
+    # Return the paths.
+    return {"paths": paths, "message": f"Found {len(paths)} path(s)."}
+
+# Service function to read (or reset) the engine's shortest path cache counters.
+def path_cache_service(action: str = "stats") -> Dict[str, Any]:
+    """
+    Runs "path_cache stats" or "path_cache clear"; both answer with the cache counters (capacity,
+    size, hits, misses, hit_rate, insertions, evictions, invalidations, flushes).
+    """
+    # Prepare command arguments.
+    args = ["path_cache", action]
+    # Call the C++ engine.
+    stdout, stderr = call_cpp_engine(args)
+    # If an error occurred or no stdout.
+    if stderr or not stdout:
+        # Return error message.
+        return {"stats": None, "message": stderr or "No output from engine."}
+    # Try to parse the JSON object.
+    try:
+        # Counters as a dictionary.
+        return {"stats": json.loads(stdout), "message": "Cache statistics retrieved successfully."}
+    # Handle malformed output.
+    except json.JSONDecodeError as e:
+        # Return parsing error message.
+        return {"stats": None, "message": f"Error decoding cache statistics from C++ engine: {str(e)}"}
+
+# Service function to read (or reset) the engine's search counters and command latencies.
+def engine_stats_service(reset: bool = False) -> Dict[str, Any]:
+    """
+    Runs "stats", or "stats reset" followed by "stats"; answers with the search counters and the
+    latency percentiles (microseconds) of every command the engine has run.
+    """
+    # Start counting from zero first if asked to.
+    if reset:
+        # Call the C++ engine.
+        _, stderr = call_cpp_engine(["stats", "reset"])
+        # If an error occurred.
+        if stderr:
+            # Return error message.
+            return {"stats": None, "message": stderr}
+    # Call the C++ engine.
+    stdout, stderr = call_cpp_engine(["stats"])
+    # If an error occurred or no stdout.
+    if stderr or not stdout:
+        # Return error message.
+        return {"stats": None, "message": stderr or "No output from engine."}
+    # Try to parse the JSON object.
+    try:
+        # Counters and histograms as a dictionary.
+        return {"stats": json.loads(stdout), "message": "Engine statistics retrieved successfully."}
+    # Handle malformed output.
+    except json.JSONDecodeError as e:
+        # Return parsing error message.
+        return {"stats": None, "message": f"Error decoding engine statistics from C++ engine: {str(e)}"}
+
+# Service function to find the nodes or edges closest to a point.
+def nearest_service(x: float, y: float, k: int = 1, kind: str = "nodes") -> Dict[str, Any]:
+    """
+    Runs "k_nearest"; answers with up to k nodes (id, x, y, distance) or edge segments (from, to,
+    closest point x/y, fraction along the segment, distance), closest first.
+    """
+    # Prepare command arguments.
+    args = ["k_nearest", str(x), str(y), str(k), kind]
+    # Call the C++ engine.
+    stdout, stderr = call_cpp_engine(args)
+    # If an error occurred (e.g. k below 1) or no stdout.
+    if stderr or not stdout:
+        # Return error message.
+        return {"matches": None, "message": stderr or "No output from engine."}
+    # Try to parse the JSON array.
+    try:
+        # Matches as a list of dictionaries.
+        return {"matches": json.loads(stdout), "message": "Nearest matches found successfully."}
+    # Handle malformed output.
+    except json.JSONDecodeError as e:
+        # Return parsing error message.
+        return {"matches": None, "message": f"Error decoding nearest matches from C++ engine: {str(e)}"}
+
+# Pattern of the snapped endpoint lines of "route_coords".
+SNAP_LINE = re.compile(r"^(Source|Target): (-?\d+) -> (-?\d+) at \(([^,]+), ([^)]+)\), fraction ([^,]+), distance (\S+)$")
+
+# Service function to route between two points snapped onto their closest edges.
+def route_coords_service(source_x: float, source_y: float, target_x: float, target_y: float) -> Dict[str, Any]:
+    # Prepare command arguments.
+    args = ["route_coords", str(source_x), str(source_y), str(target_x), str(target_y)]
+    # Call the C++ engine.
+    stdout, stderr = call_cpp_engine(args)
+    # If an error occurred (e.g. a graph without edges) or no stdout.
+    if stderr or not stdout:
+        # Return error message.
+        return {"path": [], "weight": float('inf'), "message": stderr or "No output from engine."}
+    # Result with the snapped endpoints filled in below.
+    result = {"path": [], "weight": float('inf'), "source": None, "target": None}
+    # Iterate through the lines.
+    for line in stdout.splitlines():
+        # Snapped endpoint.
+        match = SNAP_LINE.match(line)
+        if match:
+            # Segment, closest point, position along the segment and distance.
+            result[match.group(1).lower()] = {"from": int(match.group(2)), "to": int(match.group(3)), "x": float(match.group(4)), "y": float(match.group(5)),
+                                              "fraction": float(match.group(6)), "distance": float(match.group(7))}
+        # Else if line starts with "Path:".
+        elif line.startswith("Path:"):
+            # Node IDs passed, in order.
+            result["path"] = [int(p.strip()) for p in line.replace("Path:", "").split("->")]
+        # Else if line starts with "Weight:".
+        elif line.startswith("Weight:"):
+            # Extract and convert weight to float.
+            result["weight"] = float(line.replace("Weight:", "").strip())
+    # Unreachable target point.
+    if not result["path"]:
+        result["message"] = "No path found between the snapped points."
+    else:
+        result["message"] = "Path found successfully."
+    # Return the route.
+    return result
+
+# Service function to set time buckets of an edge's travel-time profile.
+def set_edge_profile_service(from_node: int, to_node: int, buckets: Dict[int, float]) -> Dict[str, Any]:
+    # Buckets as "bucket:time", comma-separated.
+    args = ["set_profile", str(from_node), str(to_node), ",".join(f"{b}:{t}" for b, t in sorted(buckets.items()))]
+    # Call the C++ engine.
+    stdout, stderr = call_cpp_engine(args)
+    # If an error occurred (e.g. edge not found, bucket out of range).
+    if stderr:
+        # Return error message.
+        return {"message": "Failed to set profile", "details": stderr}
+    # Return success message from stdout.
+    return {"message": stdout or "Profile set successfully (no output from engine)."}
+
+# Service function to aggregate an edge's profile over a window of the day.
+def edge_profile_stats_service(from_node: int, to_node: int, start: Optional[str] = None, end: Optional[str] = None) -> Dict[str, Any]:
+    """
+    Returns the min, max and mean travel time of the edge over [start, end) ("HH:MM"), or over the
+    whole day if no window is given.
+    """
+    # Prepare command arguments.
+    args = ["profile_query", str(from_node), str(to_node)]
+    # Optional window.
+    if start is not None and end is not None:
+        args += [start, end]
+    # Call the C++ engine.
+    stdout, stderr = call_cpp_engine(args)
+    # If an error occurred (e.g. no profile) or no stdout.
+    if stderr or not stdout:
+        # Return error message.
+        return {"stats": None, "message": stderr or "No output from engine."}
+    # Try to parse the JSON object.
+    try:
+        # Aggregate as a dictionary, with the edge under the API's field names.
+        data = json.loads(stdout)
+        data["from_node"], data["to_node"] = data.pop("from"), data.pop("to")
+        return {"stats": data, "message": "Profile statistics retrieved successfully."}
+    # Handle malformed output.
+    except (json.JSONDecodeError, KeyError) as e:
+        # Return parsing error message.
+        return {"stats": None, "message": f"Error decoding profile statistics from C++ engine: {str(e)}"}
+
+# Service function to compute the arrival-time function over a departure window.
+def td_profile_service(source: int, target: int, start: str, end: str) -> Dict[str, Any]:
+    """
+    Returns the arrival time at target as a piecewise-linear function of the departure from source
+    over [start, end] ("HH:MM" or minutes), following the edges' travel-time functions.
+    """
+    # Prepare command arguments.
+    args = ["td_profile", str(source), str(target), start, end]
+    # Call the C++ engine.
+    stdout, stderr = call_cpp_engine(args)
+    # If an error occurred (e.g. malformed window) or no stdout.
+    if stderr or not stdout:
+        # Return error message.
+        return {"profile": None, "message": stderr or "No output from engine."}
+    # Unreachable target.
+    if "No path found" in stdout:
+        # Return no path found message.
+        return {"profile": None, "message": f"No path found from {source} to {target}."}
+    # Try to parse the JSON object.
+    try:
+        # Profile as a dictionary, with the window under the API's field names.
+        data = json.loads(stdout)
+        data["start"], data["end"] = data.pop("from"), data.pop("to")
+        return {"profile": data, "message": "Profile computed successfully."}
+    # Handle malformed output.
+    except (json.JSONDecodeError, KeyError) as e:
+        # Return parsing error message.
+        return {"profile": None, "message": f"Error decoding profile from C++ engine: {str(e)}"}
+
+# Service function to start or stop maintaining a source's shortest path tree.
+def maintain_source_service(source: int, maintain: bool = True) -> Dict[str, Any]:
+    """
+    Registers a source whose shortest path tree the engine keeps resident and repairs on every
+    weight update ("maintain_source"), or drops it ("drop_source").
+    """
+    # Prepare command arguments.
+    args = ["maintain_source" if maintain else "drop_source", str(source)]
+    # Call the C++ engine.
+    stdout, stderr = call_cpp_engine(args)
+    # If an error occurred (e.g. unknown node, source not maintained).
+    if stderr:
+        # Return error message.
+        return {"message": "Failed to update maintained sources", "details": stderr}
+    # Return success message from stdout.
+    return {"message": stdout or "Maintained sources updated (no output from engine)."}
+
+# Service function to read a maintained shortest path tree.
+def source_tree_service(source: int, target: Optional[int] = None) -> Dict[str, Any]:
+    """
+    Returns the whole maintained tree of a source (every reachable node with its distance and
+    parent), or only the distance and tree path to one target.
+    """
+    # Prepare command arguments.
+    args = ["source_tree", str(source)] + ([str(target)] if target is not None else [])
+    # Call the C++ engine.
+    stdout, stderr = call_cpp_engine(args)
+    # If an error occurred (e.g. source not maintained).
+    if stderr or not stdout:
+        # Return error message.
+        return {"tree": None, "message": stderr or "No output from engine."}
+    # Try to parse the JSON document.
+    try:
+        # Tree or path as a dictionary.
+        return {"tree": json.loads(stdout), "message": "Tree retrieved successfully."}
+    # Handle malformed output.
+    except json.JSONDecodeError as e:
+        # Return parsing error message.
+        return {"tree": None, "message": f"Error decoding tree from C++ engine: {str(e)}"}
+
 # Service function for Union-Find 'find' operation.
 def find_set_service(node_id: int) -> Dict[str, Any]:
     # Prepare command arguments for find_set.
@@ -255,10 +713,73 @@ def unite_sets_service(node_id1: int, node_id2: int) -> Dict[str, Any]:
     # Return success message from stdout.
     return {"message": stdout or "Sets united successfully (no output from engine)."}
 
+# Service function to unite many pairs of zones in one engine call.
+def unite_batch_service(pairs: List[Tuple[int, int]]) -> Dict[str, Any]:
+    """
+    Unites the zones of every (a, b) pair in one engine call.
+    """
+    # Pairs as "a:b", comma-separated.
+    args = ["unite_batch", ",".join(f"{a}:{b}" for a, b in pairs)]
+    # Call the C++ engine.
+    stdout, stderr = call_cpp_engine(args)
+    # If an error occurred (e.g. unknown node).
+    if stderr:
+        # Return error message.
+        return {"message": "Failed to unite sets", "details": stderr}
+    # Return success message from stdout.
+    return {"message": stdout or "Sets united successfully (no output from engine)."}
+
+# Service function to check whether two nodes share a zone.
+def connected_service(node_id1: int, node_id2: int) -> Dict[str, Any]:
+    # Call the C++ engine.
+    stdout, stderr = call_cpp_engine(["connected", str(node_id1), str(node_id2)])
+    # If an error occurred (e.g. unknown node) or no stdout.
+    if stderr or not stdout:
+        # Return error message.
+        return {"connected": None, "message": stderr or "No output from engine."}
+    # Example output: "Nodes 1 and 2 are connected." / "Nodes 1 and 2 are not connected."
+    return {"connected": stdout.endswith(" are connected."), "message": stdout}
+
+# Service function to recompute the zones as the graph's connected components.
+def components_service() -> Dict[str, Any]:
+    """
+    Replaces the zones with the connected components of the graph (edge directions ignored) and
+    returns the zone of every node; a zone is named after its smallest node ID.
+    """
+    # Call the C++ engine.
+    stdout, stderr = call_cpp_engine(["components_of_graph", "labels"])
+    # If an error occurred or no stdout.
+    if stderr or not stdout:
+        # Return error message.
+        return {"components": None, "zones": {}, "message": stderr or "No output from engine."}
+    # Try to parse the JSON document.
+    try:
+        # Parallel arrays of nodes and zones.
+        data = json.loads(stdout)
+        # Zone of every node.
+        return {"components": data["components"], "zones": dict(zip(data["nodes"], data["zones"])), "message": f"Zones recomputed in {data['milliseconds']:.1f} ms."}
+    # Handle malformed output.
+    except (json.JSONDecodeError, KeyError) as e:
+        # Return parsing error message.
+        return {"components": None, "zones": {}, "message": f"Error decoding components from C++ engine: {str(e)}"}
+
 # Service function to get the current graph data as JSON.
-def get_graph_data_service() -> Optional[Dict[str, Any]]:
+def get_graph_data_service(since: Optional[int] = None, bbox: Optional[Tuple[float, float, float, float]] = None) -> Optional[Dict[str, Any]]:
+    """
+    Dumps the graph from the engine. With `since` (the "version" of an earlier dump) only nodes and
+    edges changed after it are returned ("full" is False); with `bbox` (min_x, min_y, max_x, max_y)
+    only nodes inside the box and edges between them.
+    """
     # Command to dump graph data as JSON from C++ engine.
     args = ["dump_graph_json"]
+    # Viewport filter.
+    if bbox is not None:
+        # Corners as one comma-separated argument.
+        args += ["bbox", ",".join(repr(float(c)) for c in bbox)]
+    # Delta since an earlier version.
+    if since is not None:
+        # Version from the previous response.
+        args += ["since", str(since)]
     # Call C++ engine.
     stdout, stderr = call_cpp_engine(args)
     # If an error occurred or no stdout.
@@ -1,5 +1,5 @@
 from pydantic import BaseModel
-from typing import List, Optional, Union, Tuple
+from typing import Dict, List, Optional, Union, Tuple
 
 # Represents a node for API requests and responses.
 class Node(BaseModel):
@@ -18,6 +18,9 @@ class Edge(BaseModel):
     to_node: int
     # Weight of the edge.
     weight: float
+    # Position among the edges with the same source and destination (0 for the first); with
+    # from_node and to_node it identifies the edge across graph deltas.
+    parallel: int = 0
 
 # Represents the full graph structure for API communication.
 class GraphData(BaseModel):
@@ -50,18 +53,109 @@ class ShortestPathRequest(BaseModel):
     start_node: int
     # ID of the ending node.
     end_node: int
-    # Algorithm to use ("dijkstra" or "astar").
+    # Algorithm to use ("dijkstra", "astar", "alt", "bidijkstra", "biastar", "ch", "cch", "crp" or "td_dijkstra").
     algorithm: str = "dijkstra"
+    # Departure time ("HH:MM" or minutes), required by "td_dijkstra".
+    departure_time: Optional[str] = None
 
 # Response model for the shortest path calculation.
 class ShortestPathResponse(BaseModel):
     # List of node IDs forming the path.
     path: List[int]
-    # Total weight of the path.
+    # Total weight of the path (the travel time for "td_dijkstra").
     weight: float
+    # Arrival time in minutes ("td_dijkstra" only).
+    arrival: Optional[float] = None
     # Message indicating success or failure.
     message: Optional[str] = None
 
+# One query of a batch.
+class BatchQuery(BaseModel):
+    # ID of the starting node.
+    source: int
+    # ID of the ending node.
+    target: int
+    # Algorithm for this query; the batch default if omitted.
+    algorithm: Optional[str] = None
+
+# Request model for many shortest path queries answered in one engine call.
+class ShortestPathBatchRequest(BaseModel):
+    # Queries to answer.
+    queries: List[BatchQuery]
+    # Default algorithm ("dijkstra", "astar", "alt", "bidijkstra", "biastar", "ch", "cch" or "crp").
+    algorithm: str = "dijkstra"
+    # Whether to return the node lists or only the weights.
+    include_paths: bool = True
+
+# Result of one batch query.
+class BatchResult(BaseModel):
+    # Index of the query in the request.
+    id: int
+    # ID of the starting node.
+    source: int
+    # ID of the ending node.
+    target: int
+    # Algorithm that answered it.
+    algorithm: str
+    # Path weight; None if the target is unreachable or a node unknown.
+    weight: Optional[float] = None
+    # Node IDs of the path (empty if unreachable or not requested).
+    path: List[int] = []
+
+# Response model for a batch of shortest path queries.
+class ShortestPathBatchResponse(BaseModel):
+    # Results in request order.
+    results: List[BatchResult]
+    # Optional message.
+    message: Optional[str] = None
+
+# Request model for ranked alternative routes.
+class KShortestPathsRequest(BaseModel):
+    # ID of the starting node.
+    start_node: int
+    # ID of the ending node.
+    end_node: int
+    # Number of loopless paths to return (at least 1).
+    k: int = 3
+
+# One ranked route.
+class RankedPath(BaseModel):
+    # Rank, 1 for the shortest path.
+    rank: int
+    # Total weight of the path.
+    weight: float
+    # Node IDs of the path.
+    path: List[int]
+
+# Response model for ranked alternative routes.
+class KShortestPathsResponse(BaseModel):
+    # Up to k paths, shortest first; empty if the end node is unreachable.
+    paths: List[RankedPath]
+    # Optional message.
+    message: Optional[str] = None
+
+# Request model for a source x target distance matrix.
+class DistanceMatrixRequest(BaseModel):
+    # Source node IDs (rows).
+    sources: List[int]
+    # Target node IDs (columns).
+    targets: List[int]
+    # Search method ("auto", "dijkstra", "ch" or "cch"); auto uses an existing hierarchy if there is one.
+    method: str = "auto"
+    # Response format ("json", or "binary" for the engine's raw "DRDM" matrix).
+    format: str = "json"
+
+# Response model for a distance matrix.
+class DistanceMatrixResponse(BaseModel):
+    # Source node IDs (rows).
+    sources: List[int]
+    # Target node IDs (columns).
+    targets: List[int]
+    # Distances, row-major; None where a target is unreachable.
+    distances: List[List[Optional[float]]]
+    # Optional message.
+    message: Optional[str] = None
+
 # Request model for updating an edge's weight.
 class UpdateWeightRequest(BaseModel):
     # Source node ID of the edge.
@@ -71,6 +165,13 @@ class UpdateWeightRequest(BaseModel):
     # New weight for the edge.
     new_weight: float
 
+# Request model for removing (closing) an edge.
+class RemoveEdgeRequest(BaseModel):
+    # Source node ID of the edge.
+    from_node: int
+    # Destination node ID of the edge.
+    to_node: int
+
 # Request model for Union-Find 'find' operation.
 class FindSetRequest(BaseModel):
     # ID of the node whose set representative is to be found.
@@ -85,6 +186,167 @@ class FindSetResponse(BaseModel):
     # Optional message.
     message: Optional[str] = None
 
+# Request model for registering a maintained source.
+class MaintainSourceRequest(BaseModel):
+    # ID of the source whose shortest path tree is kept resident.
+    source: int
+
+# One node of a maintained shortest path tree.
+class SourceTreeNode(BaseModel):
+    # Node ID.
+    id: int
+    # Distance from the source.
+    distance: float
+    # Parent in the tree; None for the source.
+    parent: Optional[int] = None
+
+# Response model for a whole maintained shortest path tree.
+class SourceTreeResponse(BaseModel):
+    # ID of the source.
+    source: int
+    # Number of nodes reachable from the source.
+    reached: int
+    # Every reachable node.
+    nodes: List[SourceTreeNode]
+    # Optional message.
+    message: Optional[str] = None
+
+# Response model for the shortest path cache counters.
+class PathCacheStatsResponse(BaseModel):
+    # Maximum number of cached answers.
+    capacity: int
+    # Answers cached right now.
+    size: int
+    # Queries answered from the cache.
+    hits: int
+    # Queries that had to be computed.
+    misses: int
+    # Fraction of queries answered from the cache.
+    hit_rate: float
+    # Answers stored.
+    insertions: int
+    # Answers dropped to make room.
+    evictions: int
+    # Answers dropped because an edge change affected them.
+    invalidations: int
+    # Answers dropped by a clear, a resize or a graph reload.
+    flushes: int
+
+# A node close to a query point.
+class NearestNode(BaseModel):
+    # Node ID.
+    id: int
+    # Coordinates of the node.
+    x: float
+    y: float
+    # Euclidean distance to the query point.
+    distance: float
+
+# The closest point of an edge segment to a query point.
+class NearestEdge(BaseModel):
+    # Ends of the segment; edges in both directions share it.
+    from_node: int
+    to_node: int
+    # Closest point on the segment.
+    x: float
+    y: float
+    # Position of that point from from_node (0) to to_node (1).
+    fraction: float
+    # Euclidean distance to the query point.
+    distance: float
+
+# Response model for nearest node or edge lookups, closest first.
+class NearestResponse(BaseModel):
+    # Matching nodes (kind "nodes").
+    nodes: Optional[List[NearestNode]] = None
+    # Matching edge segments (kind "edges").
+    edges: Optional[List[NearestEdge]] = None
+
+# Request model for a route between two coordinates.
+class RouteCoordsRequest(BaseModel):
+    # Start point.
+    source_x: float
+    source_y: float
+    # End point.
+    target_x: float
+    target_y: float
+
+# Response model for a route between two coordinates snapped onto their closest edges.
+class RouteCoordsResponse(BaseModel):
+    # Node IDs passed between the two snapped points.
+    path: List[int]
+    # Total weight, including the parts of the edges the points lie on.
+    weight: float
+    # Where the start and end points were snapped to.
+    source: Optional[NearestEdge] = None
+    target: Optional[NearestEdge] = None
+    # Message indicating success or failure.
+    message: Optional[str] = None
+
+# Latency of one engine command, in microseconds.
+class CommandLatency(BaseModel):
+    # Successful runs recorded.
+    count: int
+    # Mean, smallest and largest latency.
+    mean_us: float
+    min_us: float
+    max_us: float
+    # Percentiles (within 1%).
+    p50_us: float
+    p90_us: float
+    p99_us: float
+    p999_us: float
+
+# Response model for the engine's search counters and command latencies.
+class EngineStatsResponse(BaseModel):
+    # Whether the engine was built with counters (ROUTE_ENGINE_STATS); counters stay zero otherwise.
+    counters_enabled: bool
+    # Search counters (nodes_settled, edges_relaxed, heap_pushes, heap_pops, stale_pops, cache_hits, cache_misses).
+    counters: Dict[str, int]
+    # Latency of every command run since the last reset, by command name.
+    commands: Dict[str, CommandLatency]
+
+# Request model for setting time buckets of an edge's travel-time profile.
+class EdgeProfileRequest(BaseModel):
+    # Source node ID of the edge.
+    from_node: int
+    # Destination node ID of the edge.
+    to_node: int
+    # Travel time of every bucket to set, by bucket index (buckets of 15 minutes from midnight by default).
+    buckets: Dict[int, float]
+
+# Response model for a profile aggregate over a window of the day.
+class EdgeProfileStatsResponse(BaseModel):
+    # Source node ID of the edge.
+    from_node: int
+    # Destination node ID of the edge.
+    to_node: int
+    # First and last bucket of the window (the window wraps past midnight if last < first).
+    first_bucket: int
+    last_bucket: int
+    # Number of buckets aggregated.
+    buckets: int
+    # Length of a bucket in minutes.
+    bucket_minutes: float
+    # Smallest, largest and mean travel time over the window.
+    min: float
+    max: float
+    mean: float
+
+# Response model for a time-dependent profile query.
+class TimeDependentProfileResponse(BaseModel):
+    # Source and target node IDs.
+    source: int
+    target: int
+    # Departure window in minutes.
+    start: float
+    end: float
+    # Arrival time as a function of the departure: [departure, arrival] breakpoints, linear in between.
+    breakpoints: List[Tuple[float, float]]
+    # Fastest and slowest travel time over the window.
+    min_travel_time: float
+    max_travel_time: float
+
 # Request model for Union-Find 'unite' operation.
 class UniteSetsRequest(BaseModel):
     # ID of the first node.
@@ -92,6 +354,31 @@ class UniteSetsRequest(BaseModel):
     # ID of the second node.
     node_id2: int
 
+# Request model for uniting many pairs of zones at once.
+class UniteBatchRequest(BaseModel):
+    # (node_id1, node_id2) pairs whose zones are united.
+    pairs: List[Tuple[int, int]]
+
+# Response model for recomputed zones.
+class ZonesResponse(BaseModel):
+    # Number of zones (connected components).
+    components: int
+    # Zone of every node, named after the smallest node ID in it.
+    zones: Dict[int, int]
+    # Optional message.
+    message: Optional[str] = None
+
+# Response model for a zone connectivity check.
+class ConnectedResponse(BaseModel):
+    # ID of the first node.
+    node_id1: int
+    # ID of the second node.
+    node_id2: int
+    # Whether both nodes are in the same zone.
+    connected: bool
+    # Optional message.
+    message: Optional[str] = None
+
 # Generic message response for operations like add, update, unite.
 class MessageResponse(BaseModel):
     # Message detailing the result of the operation.
@@ -99,11 +386,15 @@ class MessageResponse(BaseModel):
     # Optional details or status.
     details: Optional[str] = None
 
-# Response model for getting the entire graph.
+# Response model for getting the graph (or the part of it that changed).
 class GraphResponse(BaseModel):
-    # List of nodes in the current graph.
+    # List of nodes in the current graph (only changed ones if full is False).
     nodes: List[Node]
-    # List of edges in the current graph.
+    # List of edges in the current graph (only changed ones if full is False).
     edges: List[Edge]
+    # Graph version of this response; pass it as `since` to receive only later changes.
+    version: Optional[int] = None
+    # True if the response replaces everything, False if it is a delta on top of `since`.
+    full: bool = True
     # Optional message.
     message: Optional[str] = None
\ No newline at end of file
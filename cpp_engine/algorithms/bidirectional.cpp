@@ -0,0 +1,95 @@
+#include "../include/algorithms.h"
+#include "../include/graph.h"
+#include "../include/search_kernel.h"
+#include <vector>
+
+// Joins the forward tree path source..meeting and the backward tree path meeting..target.
+static std::vector<int> joinPath(const CsrGraph& graph, const QueryWorkspace& forward, const QueryWorkspace& backward, int meeting) {
+    // Source side, already in source..meeting order.
+    std::vector<int> path = forward.extractPath(graph, meeting);
+    // Backward parents point towards the target.
+    for (int curr = backward.parent(meeting); curr != -1; curr = backward.parent(curr)) {
+        // Append the next node on the way to the target.
+        path.push_back(graph.externalId(curr));
+    }
+    // Complete path.
+    return path;
+}
+
+// Second workspace for the backward half of bidirectional searches.
+QueryWorkspace& Algorithms::threadReverseWorkspace() {
+    // One lazily grown workspace per thread.
+    thread_local QueryWorkspace workspace;
+    // Return this thread's backward workspace.
+    return workspace;
+}
+
+// Computes the shortest path by meeting-in-the-middle Dijkstra searches from both endpoints.
+std::vector<int> Algorithms::bidirectionalDijkstra(const CsrGraph& graph, QueryWorkspace& forward, QueryWorkspace& backward, int startNode, int endNode, double& pathWeight, QueueKind queue) {
+    // Translate the endpoints to internal indices.
+    int source = graph.internalId(startNode);
+    // Internal index of the target.
+    int target = graph.internalId(endNode);
+    // Meeting node of the two searches.
+    int meeting = -1;
+    // Unknown endpoints cannot be connected; otherwise search with zero potentials.
+    if (source < 0 || target < 0 ||
+        (meeting = SearchKernel::runBidirectionalWith(queue, graph, forward, backward, source, target, SearchKernel::ZeroPotential(), SearchKernel::ZeroPotential())) < 0) {
+        // Set path weight to infinity if no path found.
+        pathWeight = INF;
+        // Return empty path.
+        return {};
+    }
+    // Path weight is the sum of both halves.
+    pathWeight = forward.distance(meeting) + backward.distance(meeting);
+    // Reconstruct the path from both trees.
+    return joinPath(graph, forward, backward, meeting);
+}
+
+// Computes the shortest path using this thread's workspaces.
+std::vector<int> Algorithms::bidirectionalDijkstra(const CsrGraph& graph, int startNode, int endNode, double& pathWeight) {
+    // Run the kernel with the thread-local workspaces.
+    return bidirectionalDijkstra(graph, threadWorkspace(), threadReverseWorkspace(), startNode, endNode, pathWeight);
+}
+
+// Computes the shortest path on a mutable Graph by freezing it first.
+std::vector<int> Algorithms::bidirectionalDijkstra(const Graph& graph, int startNode, int endNode, double& pathWeight) {
+    // Run the CSR kernel on a frozen copy.
+    return bidirectionalDijkstra(graph.freeze(), startNode, endNode, pathWeight);
+}
+
+// Computes the shortest path by bidirectional A* with average Euclidean potentials.
+std::vector<int> Algorithms::bidirectionalAStar(const CsrGraph& graph, QueryWorkspace& forward, QueryWorkspace& backward, int startNode, int endNode, double& pathWeight, QueueKind queue) {
+    // Translate the endpoints to internal indices.
+    int source = graph.internalId(startNode);
+    // Internal index of the target.
+    int target = graph.internalId(endNode);
+    // Meeting node of the two searches.
+    int meeting = -1;
+    // Unknown endpoints cannot be connected; otherwise search with the paired average potentials.
+    if (source < 0 || target < 0 ||
+        (meeting = SearchKernel::runBidirectionalWith(queue, graph, forward, backward, source, target,
+                                                      SearchKernel::AveragePotential(graph, target, source),
+                                                      SearchKernel::AveragePotential(graph, source, target))) < 0) {
+        // Set path weight to infinity.
+        pathWeight = INF;
+        // Return an empty path indicating failure.
+        return {};
+    }
+    // Path weight is the sum of both halves.
+    pathWeight = forward.distance(meeting) + backward.distance(meeting);
+    // Reconstruct the path from both trees.
+    return joinPath(graph, forward, backward, meeting);
+}
+
+// Computes the shortest path using this thread's workspaces.
+std::vector<int> Algorithms::bidirectionalAStar(const CsrGraph& graph, int startNode, int endNode, double& pathWeight) {
+    // Run the kernel with the thread-local workspaces.
+    return bidirectionalAStar(graph, threadWorkspace(), threadReverseWorkspace(), startNode, endNode, pathWeight);
+}
+
+// Computes the shortest path on a mutable Graph by freezing it first.
+std::vector<int> Algorithms::bidirectionalAStar(const Graph& graph, int startNode, int endNode, double& pathWeight) {
+    // Run the CSR kernel on a frozen copy.
+    return bidirectionalAStar(graph.freeze(), startNode, endNode, pathWeight);
+}
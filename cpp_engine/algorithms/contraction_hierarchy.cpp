@@ -0,0 +1,759 @@
+#include "../include/contraction_hierarchy.h"
+#include "../include/algorithms.h"
+#include "../include/stats.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <utility>
+
+namespace {
+    // Witness searches give up after settling this many nodes (a missed witness only costs a shortcut).
+    const int WITNESS_SETTLE_LIMIT = 500;
+    // Cheaper limit for the simulated contractions that only estimate priorities.
+    const int SIMULATION_SETTLE_LIMIT = 50;
+    // File signature of a saved hierarchy.
+    const char FILE_MAGIC[8] = {'D', 'R', 'O', 'C', 'H', 0, 0, 1};
+
+    // Arc of the remaining graph during contraction.
+    struct Neighbor {
+        // Other endpoint.
+        int node;
+        // Length.
+        double weight;
+        // Index into the hierarchy's arcs.
+        int arc;
+    };
+
+    // Shortcut found while contracting a node.
+    struct Shortcut {
+        // Source of the shortcut.
+        int tail;
+        // Target of the shortcut.
+        int head;
+        // Length through the contracted node.
+        double weight;
+        // Arc tail->node.
+        int firstChild;
+        // Arc node->head.
+        int secondChild;
+    };
+
+    // Folds a byte range into a 64-bit FNV-1a hash.
+    unsigned long long fnv1a(const void* data, size_t size, unsigned long long hash = 1469598103934665603ULL) {
+        // Bytes to hash.
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        // Mix in every byte.
+        for (size_t i = 0; i < size; ++i) hash = (hash ^ bytes[i]) * 1099511628211ULL;
+        // Return the hash.
+        return hash;
+    }
+
+    // Folds a whole array (std::vector or CsrArray) into a hash.
+    template <class Array>
+    unsigned long long fnv1aArray(const Array& values, unsigned long long hash) {
+        // Hash the raw element bytes.
+        return fnv1a(values.data(), values.size() * sizeof(values[0]), hash);
+    }
+
+    // Deterministic tie breaker between nodes of equal priority.
+    uint32_t scramble(int node) {
+        // Multiplicative hash spreads neighboring indices apart.
+        return static_cast<uint32_t>(node) * 2654435761u;
+    }
+
+    // Remaining graph plus the per-node state of the contraction.
+    class Contractor {
+    public:
+        // Outgoing arcs of every node to remaining nodes.
+        std::vector<std::vector<Neighbor>> out;
+        // Incoming arcs of every node from remaining nodes.
+        std::vector<std::vector<Neighbor>> in;
+        // Current priority of every remaining node.
+        std::vector<int> priority;
+        // Number of contracted neighbors of every node.
+        std::vector<int> deletedNeighbors;
+        // Upper bound on the depth of every node's search space in the hierarchy so far.
+        std::vector<int> level;
+        // Nodes contracted in the current round; witnesses through them must be strictly shorter.
+        std::vector<char> blocked;
+        // Whether a node has been contracted.
+        std::vector<char> contracted;
+        // Arcs of the hierarchy under construction.
+        std::vector<ContractionHierarchy::Arc>& arcs;
+
+        // Loads the graph's edges, keeping the shortest of parallel edges and dropping self loops.
+        Contractor(const CsrGraph& graph, std::vector<ContractionHierarchy::Arc>& arcsOut) : arcs(arcsOut) {
+            // Number of nodes.
+            int n = graph.numNodes();
+            // Size the per-node state.
+            out.resize(n);
+            in.resize(n);
+            priority.assign(n, 0);
+            deletedNeighbors.assign(n, 0);
+            level.assign(n, 0);
+            blocked.assign(n, 0);
+            contracted.assign(n, 0);
+            // Copy every edge.
+            for (int u = 0; u < n; ++u) {
+                // Scan u's edges.
+                for (int e = graph.beginEdge(u); e < graph.endEdge(u); ++e) {
+                    // Self loops never lie on a shortest path.
+                    if (graph.edgeHead(e) != u) addArc(u, graph.edgeHead(e), graph.edgeWeight(e), -1, -1);
+                }
+            }
+        }
+
+        // Adds tail->head unless an arc at least as short exists; a longer one is replaced.
+        void addArc(int tail, int head, double weight, int firstChild, int secondChild) {
+            // Look for an existing arc between the two nodes.
+            for (Neighbor& neighbor : out[tail]) {
+                // Not this one.
+                if (neighbor.node != head) continue;
+                // The existing arc is at least as short.
+                if (neighbor.weight <= weight) return;
+                // Replace it by a new arc.
+                neighbor.weight = weight;
+                // Record the arc.
+                neighbor.arc = static_cast<int>(arcs.size());
+                // Update the mirrored entry.
+                for (Neighbor& mirror : in[head]) {
+                    // The entry pointing back at tail.
+                    if (mirror.node == tail) { mirror.weight = weight; mirror.arc = neighbor.arc; break; }
+                }
+                // Store the replacement.
+                arcs.push_back({tail, head, weight, firstChild, secondChild});
+                // Done.
+                return;
+            }
+            // New arc.
+            int arc = static_cast<int>(arcs.size());
+            // Store it.
+            arcs.push_back({tail, head, weight, firstChild, secondChild});
+            // Link it from both endpoints.
+            out[tail].push_back({head, weight, arc});
+            in[head].push_back({tail, weight, arc});
+        }
+
+        // Collects the shortcuts contracting v would need, using the worker's scratch workspace.
+        void findShortcuts(int v, QueryWorkspace& scratch, std::vector<Shortcut>& shortcuts, int settleLimit = WITNESS_SETTLE_LIMIT) const {
+            // Start empty.
+            shortcuts.clear();
+            // One witness search per incoming arc.
+            for (const Neighbor& incoming : in[v]) {
+                // Source of the candidate shortcuts.
+                int u = incoming.node;
+                // Longest path through v the witness search must beat.
+                double limit = -INF;
+                // Find it among the outgoing arcs.
+                for (const Neighbor& outgoing : out[v]) {
+                    // Skip the way back to u.
+                    if (outgoing.node != u) limit = std::max(limit, incoming.weight + outgoing.weight);
+                }
+                // No pair through v starts at u.
+                if (limit == -INF) continue;
+                // Bounded Dijkstra from u that avoids v.
+                witnessSearch(u, v, limit, settleLimit, scratch);
+                // Every target the search could not reach cheaply enough needs a shortcut.
+                for (const Neighbor& outgoing : out[v]) {
+                    // Skip the way back to u.
+                    if (outgoing.node == u) continue;
+                    // Length through v.
+                    double through = incoming.weight + outgoing.weight;
+                    // Length of the best witness.
+                    double witness = scratch.distance(outgoing.node);
+                    // A shorter witness makes the shortcut redundant; one of equal length only if it avoids
+                    // the rest of the round, which may itself be relying on v for the same distance.
+                    if (witness > through || (witness == through && scratch.parent(outgoing.node) != 0)) {
+                        // Keep the path through v.
+                        shortcuts.push_back({u, outgoing.node, through, incoming.arc, outgoing.arc});
+                    }
+                }
+            }
+        }
+
+        // Recomputes the priority of v from its edge difference, contracted neighbors and level.
+        void updatePriority(int v, QueryWorkspace& scratch, std::vector<Shortcut>& shortcuts) {
+            // Simulate the contraction with cheaper witness searches.
+            findShortcuts(v, scratch, shortcuts, SIMULATION_SETTLE_LIMIT);
+            // Edge difference: shortcuts added minus arcs removed.
+            int edgeDifference = static_cast<int>(shortcuts.size()) - static_cast<int>(in[v].size() + out[v].size());
+            // Weighted towards sparsity; contracted neighbors and level spread contractions evenly over the graph.
+            priority[v] = 2 * edgeDifference + deletedNeighbors[v] + level[v];
+        }
+
+        // Whether v comes before u in contraction order.
+        bool before(int v, int u) const {
+            // Lower priority first.
+            if (priority[v] != priority[u]) return priority[v] < priority[u];
+            // Then the scrambled index.
+            if (scramble(v) != scramble(u)) return scramble(v) < scramble(u);
+            // Then the index itself.
+            return v < u;
+        }
+
+        // Whether v precedes all of its remaining neighbors.
+        bool isLocalMinimum(int v) const {
+            // Check the outgoing side.
+            for (const Neighbor& neighbor : out[v]) if (!before(v, neighbor.node)) return false;
+            // Check the incoming side.
+            for (const Neighbor& neighbor : in[v]) if (!before(v, neighbor.node)) return false;
+            // v goes first.
+            return true;
+        }
+
+        // Removes v from the remaining graph.
+        void remove(int v) {
+            // Mark it.
+            contracted[v] = 1;
+            // Unlink it from the incoming side of its out-neighbors.
+            for (const Neighbor& neighbor : out[v]) {
+                // Mirrored list.
+                std::vector<Neighbor>& list = in[neighbor.node];
+                // Drop the entries pointing at v.
+                list.erase(std::remove_if(list.begin(), list.end(), [v](const Neighbor& x) { return x.node == v; }), list.end());
+                // Count the contracted neighbor.
+                ++deletedNeighbors[neighbor.node];
+                // The neighbor now sits above v.
+                level[neighbor.node] = std::max(level[neighbor.node], level[v] + 1);
+            }
+            // Unlink it from the outgoing side of its in-neighbors.
+            for (const Neighbor& neighbor : in[v]) {
+                // Mirrored list.
+                std::vector<Neighbor>& list = out[neighbor.node];
+                // Drop the entries pointing at v.
+                list.erase(std::remove_if(list.begin(), list.end(), [v](const Neighbor& x) { return x.node == v; }), list.end());
+                // Count the contracted neighbor.
+                ++deletedNeighbors[neighbor.node];
+                // The neighbor now sits above v.
+                level[neighbor.node] = std::max(level[neighbor.node], level[v] + 1);
+            }
+        }
+
+    private:
+        // Bounded Dijkstra from source over the remaining nodes other than skip. The parent slot of
+        // every label holds whether its path crosses another node of the current round; among
+        // paths of equal length, paths that avoid the round are preferred.
+        void witnessSearch(int source, int skip, double limit, int settleLimit, QueryWorkspace& scratch) const {
+            // Start a new search.
+            scratch.reset(static_cast<int>(out.size()));
+            // Heap of the workspace.
+            IndexedDaryHeap<4>& queue = scratch.daryQueue;
+            // Start a new search on the heap.
+            queue.reset(static_cast<int>(out.size()));
+            // Distance from the source to itself is 0.
+            scratch.setLabel(source, 0, 0);
+            // Seed the heap.
+            queue.push(source, 0);
+            // Settle nodes until the limit.
+            for (int settled = 0; !queue.empty() && settled < settleLimit; ++settled) {
+                // Closest unsettled node.
+                std::pair<double, int> top = queue.pop();
+                // Nothing beyond the limit can be a witness.
+                if (top.first > limit) break;
+                // Whether the path to the node crosses the round.
+                int crosses = scratch.parent(top.second);
+                // Relax its arcs.
+                for (const Neighbor& neighbor : out[top.second]) {
+                    // Witnesses must avoid the contracted node itself.
+                    if (neighbor.node == skip) continue;
+                    // Candidate distance.
+                    double candidate = top.first + neighbor.weight;
+                    // Whether the candidate path crosses the round (its end point is checked by the caller).
+                    int candidateCrosses = crosses | blocked[top.second];
+                    // Current label of the neighbor.
+                    double current = scratch.distance(neighbor.node);
+                    // Improve the label, or keep its length and stop crossing the round.
+                    if (candidate < current || (candidate == current && candidateCrosses < scratch.parent(neighbor.node))) {
+                        // Record it.
+                        scratch.setLabel(neighbor.node, candidate, candidateCrosses);
+                        // Queue the node.
+                        queue.push(neighbor.node, candidate);
+                    }
+                }
+            }
+        }
+    };
+}
+
+// Contracts a graph; witness searches run on the given pool.
+ContractionHierarchy ContractionHierarchy::build(const CsrGraph& graph, ThreadPool& pool) {
+    // Hierarchy under construction.
+    ContractionHierarchy ch;
+    // Number of nodes.
+    const int n = graph.numNodes();
+    // Remember the graph.
+    ch.fingerprint = fingerprintOf(graph);
+    // No rank assigned yet.
+    ch.rank.assign(n, -1);
+    // Remaining graph.
+    Contractor contractor(graph, ch.arcs);
+    // Final upward arcs (out-arcs at contraction time) per node.
+    std::vector<std::vector<Neighbor>> upward(n);
+    // Final downward arcs (in-arcs at contraction time) per node.
+    std::vector<std::vector<Neighbor>> downward(n);
+    // Per-worker witness search scratch.
+    std::vector<QueryWorkspace> scratch(pool.size(), QueryWorkspace(n));
+    // Per-worker shortcut buffers for priority simulation.
+    std::vector<std::vector<Shortcut>> buffers(pool.size());
+    // Nodes not contracted yet.
+    std::vector<int> remaining(n);
+    // Initially all of them.
+    for (int v = 0; v < n; ++v) remaining[v] = v;
+    // Initial priorities.
+    pool.parallelFor(remaining.size(), [&](size_t i, unsigned worker) {
+        // Simulate contracting the node.
+        contractor.updatePriority(remaining[i], scratch[worker], buffers[worker]);
+    });
+    // Next rank to hand out.
+    int nextRank = 0;
+    // Whether a node is in the current round.
+    std::vector<char> selected(n, 0);
+    // Shortcuts of every node of the round.
+    std::vector<std::vector<Shortcut>> roundShortcuts;
+    // Nodes whose priority must be recomputed after the round.
+    std::vector<int> touched;
+    // Marks for touched.
+    std::vector<char> isTouched(n, 0);
+    // Contract round by round.
+    while (!remaining.empty()) {
+        // Pick the local minima in parallel.
+        pool.parallelFor(remaining.size(), [&](size_t i, unsigned) {
+            // Mark the node if it precedes all its neighbors.
+            selected[remaining[i]] = contractor.isLocalMinimum(remaining[i]);
+        });
+        // Nodes of this round.
+        std::vector<int> round;
+        // Split the remaining nodes.
+        std::vector<int> rest;
+        // Partition (the global minimum is always selected, so every round makes progress).
+        for (int v : remaining) (selected[v] ? round : rest).push_back(v);
+        // Witness paths must avoid every node of the round.
+        for (int v : round) contractor.blocked[v] = 1;
+        // One shortcut list per node.
+        roundShortcuts.resize(round.size());
+        // Find the shortcuts in parallel; the remaining graph is read-only meanwhile. A shortcut is only
+        // dropped for a strictly shorter witness or an equally long one that avoids the round, so no
+        // two nodes of the round can drop a shortest path by relying on each other.
+        pool.parallelFor(round.size(), [&](size_t i, unsigned worker) {
+            // Witness searches for this node.
+            contractor.findShortcuts(round[i], scratch[worker], roundShortcuts[i]);
+        });
+        // Apply the round sequentially.
+        for (size_t i = 0; i < round.size(); ++i) {
+            // Node being contracted.
+            int v = round[i];
+            // Assign its rank.
+            ch.rank[v] = nextRank++;
+            // Its arcs to remaining nodes all lead upwards in the final order.
+            upward[v] = contractor.out[v];
+            // Same for its incoming arcs.
+            downward[v] = contractor.in[v];
+            // Neighbors need new priorities.
+            for (const std::vector<Neighbor>* list : {&contractor.out[v], &contractor.in[v]}) {
+                // Collect each neighbor once.
+                for (const Neighbor& neighbor : *list) {
+                    // Skip neighbors already collected.
+                    if (!isTouched[neighbor.node]) { isTouched[neighbor.node] = 1; touched.push_back(neighbor.node); }
+                }
+            }
+            // Take v out of the remaining graph.
+            contractor.remove(v);
+            // Insert its shortcuts.
+            for (const Shortcut& shortcut : roundShortcuts[i]) {
+                // Keeps the shorter of an existing arc and the shortcut.
+                contractor.addArc(shortcut.tail, shortcut.head, shortcut.weight, shortcut.firstChild, shortcut.secondChild);
+            }
+            // Free the node's lists.
+            std::vector<Neighbor>().swap(contractor.out[v]);
+            std::vector<Neighbor>().swap(contractor.in[v]);
+        }
+        // The round is over.
+        for (int v : round) { contractor.blocked[v] = 0; selected[v] = 0; }
+        // Update the touched neighbors in parallel.
+        pool.parallelFor(touched.size(), [&](size_t i, unsigned worker) {
+            // Simulate contracting the neighbor again.
+            contractor.updatePriority(touched[i], scratch[worker], buffers[worker]);
+        });
+        // Clear the marks.
+        for (int v : touched) isTouched[v] = 0;
+        // Reuse the list.
+        touched.clear();
+        // Continue with the rest.
+        remaining.swap(rest);
+    }
+    // Keep only arcs of the final search graphs; replaced arcs between remaining nodes drop out.
+    std::vector<int> newIndex(ch.arcs.size(), -1);
+    // Compacted arcs.
+    std::vector<Arc> kept;
+    // Upward and downward arcs, node by node.
+    for (int v = 0; v < n; ++v) {
+        // Both directions.
+        for (const std::vector<Neighbor>* list : {&upward[v], &downward[v]}) {
+            // Assign new indices.
+            for (const Neighbor& neighbor : *list) {
+                // Each arc appears once as upward or downward arc.
+                if (newIndex[neighbor.arc] < 0) { newIndex[neighbor.arc] = static_cast<int>(kept.size()); kept.push_back(ch.arcs[neighbor.arc]); }
+            }
+        }
+    }
+    // Children of shortcuts are arcs at the contracted middle node, so all of them were kept.
+    for (Arc& arc : kept) {
+        // Translate the children.
+        if (arc.firstChild >= 0) { arc.firstChild = newIndex[arc.firstChild]; arc.secondChild = newIndex[arc.secondChild]; }
+    }
+    // Replace the arc array.
+    ch.arcs.swap(kept);
+    // Index the arcs for queries.
+    ch.buildSearchGraphs();
+    // Done.
+    return ch;
+}
+
+// Rebuilds the upward/downward search graphs from rank and arcs.
+void ContractionHierarchy::buildSearchGraphs() {
+    // Number of nodes.
+    const int n = numNodes();
+    // Counts per node, shifted by one for the prefix sums.
+    firstUp.assign(n + 1, 0);
+    firstDown.assign(n + 1, 0);
+    // Count the arcs of each node.
+    for (const Arc& arc : arcs) {
+        // Upward arcs belong to their tail, downward arcs to their head.
+        if (rank[arc.tail] < rank[arc.head]) ++firstUp[arc.tail + 1];
+        else ++firstDown[arc.head + 1];
+    }
+    // Prefix sums turn counts into offsets.
+    for (int v = 0; v < n; ++v) { firstUp[v + 1] += firstUp[v]; firstDown[v + 1] += firstDown[v]; }
+    // Size the search graphs.
+    up.resize(firstUp[n]);
+    down.resize(firstDown[n]);
+    // Next free slot per node.
+    std::vector<int> nextUp(firstUp.begin(), firstUp.end() - 1), nextDown(firstDown.begin(), firstDown.end() - 1);
+    // Scatter the arcs.
+    for (int a = 0; a < static_cast<int>(arcs.size()); ++a) {
+        // Arc being placed.
+        const Arc& arc = arcs[a];
+        // Upward arc: the forward search follows it from the tail.
+        if (rank[arc.tail] < rank[arc.head]) up[nextUp[arc.tail]++] = {arc.head, arc.weight, a};
+        // Downward arc: the backward search follows it from the head.
+        else down[nextDown[arc.head]++] = {arc.tail, arc.weight, a};
+    }
+}
+
+// Hash of the node IDs, topology and weights of a graph.
+unsigned long long ContractionHierarchy::fingerprintOf(const CsrGraph& graph) {
+    // Node IDs.
+    unsigned long long hash = fnv1aArray(graph.ids, 1469598103934665603ULL);
+    // Edge offsets.
+    hash = fnv1aArray(graph.firstOut, hash);
+    // Edge targets.
+    hash = fnv1aArray(graph.head, hash);
+    // Edge weights.
+    return fnv1aArray(graph.weight, hash);
+}
+
+// Number of arcs that are shortcuts.
+int ContractionHierarchy::numShortcuts() const {
+    // Count arcs with children.
+    return static_cast<int>(std::count_if(arcs.begin(), arcs.end(), [](const Arc& arc) { return arc.firstChild >= 0; }));
+}
+
+// Runs the upward searches from source and target and returns the peak of the shortest path.
+int ContractionHierarchy::query(QueryWorkspace& forward, QueryWorkspace& backward, int source, int target) const {
+    // Heaps of both sides.
+    IndexedDaryHeap<4>& forwardQueue = forward.daryQueue;
+    IndexedDaryHeap<4>& backwardQueue = backward.daryQueue;
+    // Start a new query on both sides.
+    forward.reset(numNodes());
+    backward.reset(numNodes());
+    forwardQueue.reset(numNodes());
+    backwardQueue.reset(numNodes());
+    // Seed the forward search.
+    forward.setLabel(source, 0, -1);
+    forwardQueue.push(source, 0);
+    // Seed the backward search.
+    backward.setLabel(target, 0, -1);
+    backwardQueue.push(target, 0);
+    // Length of the best path found so far.
+    double best = INF;
+    // Peak of that path.
+    int meeting = -1;
+    // Last settled distance of each side.
+    double forwardKey = 0, backwardKey = 0;
+    // Each side stops on its own once it cannot improve the best path.
+    bool forwardDone = false, backwardDone = false;
+    // Counts of this query, published when it returns.
+    ROUTE_STATS(Stats::Local counters; counters[Stats::HeapPushes] += 2;)
+    // Search until both sides are done.
+    while (!(forwardDone && backwardDone)) {
+        // Advance the side that is behind (or the only one left).
+        bool isForward = backwardDone || (!forwardDone && forwardKey <= backwardKey);
+        // This side's state.
+        QueryWorkspace& self = isForward ? forward : backward;
+        const QueryWorkspace& other = isForward ? backward : forward;
+        IndexedDaryHeap<4>& queue = isForward ? forwardQueue : backwardQueue;
+        // A side without queued nodes is done.
+        if (queue.empty()) { (isForward ? forwardDone : backwardDone) = true; continue; }
+        // Closest unsettled node of this side.
+        std::pair<double, int> top = queue.pop();
+        ROUTE_STATS(++counters[Stats::HeapPops];)
+        // Node of the entry.
+        int u = top.second;
+        // Advance the side's bound.
+        (isForward ? forwardKey : backwardKey) = top.first;
+        // Nothing this side settles from now on can lead to a shorter path.
+        if (top.first >= best) { (isForward ? forwardDone : backwardDone) = true; continue; }
+        // Both searches reached u: candidate peak.
+        if (other.reached(u) && top.first + other.distance(u) < best) { best = top.first + other.distance(u); meeting = u; }
+        // Arcs the search follows from u.
+        const std::vector<SearchArc>& arcsOut = isForward ? up : down;
+        // Arcs in the opposite direction, used for stall-on-demand.
+        const std::vector<SearchArc>& arcsIn = isForward ? down : up;
+        // Offsets of both.
+        const std::vector<int>& firstOut = isForward ? firstUp : firstDown;
+        const std::vector<int>& firstIn = isForward ? firstDown : firstUp;
+        // Stall u if a higher node already offers a shorter way to it; its label is not a shortest distance.
+        bool stalled = false;
+        // Check the higher neighbors on the opposite side.
+        for (int i = firstIn[u]; i < firstIn[u + 1] && !stalled; ++i) stalled = self.distance(arcsIn[i].node) + arcsIn[i].weight < top.first;
+        // Stalled nodes do not relax their arcs.
+        if (stalled) continue;
+        // Count the node and its arcs.
+        ROUTE_STATS(++counters[Stats::NodesSettled]; counters[Stats::EdgesRelaxed] += firstOut[u + 1] - firstOut[u];)
+        // Relax the arcs towards higher ranks.
+        for (int i = firstOut[u]; i < firstOut[u + 1]; ++i) {
+            // Arc being relaxed.
+            const SearchArc& arc = arcsOut[i];
+            // Candidate distance through u.
+            double candidate = top.first + arc.weight;
+            // If a shorter path to the node is found through u.
+            if (candidate < self.distance(arc.node)) {
+                // Record the distance with the arc as parent.
+                self.setLabel(arc.node, candidate, arc.arc);
+                // Queue the node.
+                queue.push(arc.node, candidate);
+                ROUTE_STATS(++counters[Stats::HeapPushes];)
+            }
+        }
+    }
+    // Peak of the shortest path, if any.
+    return meeting;
+}
+
+// Runs one complete upward search and lists the nodes it settles without stalling.
+void ContractionHierarchy::upwardSearch(QueryWorkspace& workspace, int source, bool backward, std::vector<int>& settled) const {
+    // Heap of the workspace.
+    IndexedDaryHeap<4>& queue = workspace.daryQueue;
+    // Start a new search.
+    workspace.reset(numNodes());
+    queue.reset(numNodes());
+    // Seed it.
+    workspace.setLabel(source, 0, -1);
+    queue.push(source, 0);
+    // Arcs the search follows, and the opposite ones for stall-on-demand.
+    const std::vector<SearchArc>& arcsOut = backward ? down : up;
+    const std::vector<SearchArc>& arcsIn = backward ? up : down;
+    // Offsets of both.
+    const std::vector<int>& firstOut = backward ? firstDown : firstUp;
+    const std::vector<int>& firstIn = backward ? firstUp : firstDown;
+    // No settled nodes yet.
+    settled.clear();
+    // Settle everything reachable upwards.
+    while (!queue.empty()) {
+        // Closest unsettled node.
+        std::pair<double, int> top = queue.pop();
+        // Node of the entry.
+        int u = top.second;
+        // Stall u if a higher node already offers a shorter way to it.
+        bool stalled = false;
+        // Check the higher neighbors on the opposite side.
+        for (int i = firstIn[u]; i < firstIn[u + 1] && !stalled; ++i) stalled = workspace.distance(arcsIn[i].node) + arcsIn[i].weight < top.first;
+        // Stalled labels are not shortest distances; they are neither reported nor relaxed.
+        if (stalled) continue;
+        // Report u.
+        settled.push_back(u);
+        // Relax the arcs towards higher ranks.
+        for (int i = firstOut[u]; i < firstOut[u + 1]; ++i) {
+            // Arc being relaxed.
+            const SearchArc& arc = arcsOut[i];
+            // Candidate distance through u.
+            double candidate = top.first + arc.weight;
+            // If a shorter path to the node is found through u.
+            if (candidate < workspace.distance(arc.node)) {
+                // Record the distance with the arc as parent.
+                workspace.setLabel(arc.node, candidate, arc.arc);
+                // Queue the node.
+                queue.push(arc.node, candidate);
+            }
+        }
+    }
+}
+
+// Appends the internal nodes of an arc after its tail, expanding shortcuts.
+void ContractionHierarchy::unpackArc(int arc, std::vector<int>& nodes) const {
+    // Arcs still to expand, last one on top.
+    std::vector<int> stack{arc};
+    // Expand depth first, left half before right half.
+    while (!stack.empty()) {
+        // Next arc in path order.
+        const Arc& current = arcs[stack.back()];
+        // Consume it.
+        stack.pop_back();
+        // Original edge: emit its head.
+        if (current.firstChild < 0) { nodes.push_back(current.head); continue; }
+        // Shortcut: expand the second half after the first.
+        stack.push_back(current.secondChild);
+        // The first half is expanded next.
+        stack.push_back(current.firstChild);
+    }
+}
+
+// Writes the hierarchy to a binary file.
+bool ContractionHierarchy::save(const std::string& filepath, std::string& error) const {
+    // Serialized image: header, ranks, arcs, then a checksum of everything before it.
+    std::string image(FILE_MAGIC, sizeof(FILE_MAGIC));
+    // Appends raw bytes to the image.
+    auto append = [&image](const void* data, size_t size) { image.append(static_cast<const char*>(data), size); };
+    // Node and arc counts.
+    uint64_t counts[2] = {static_cast<uint64_t>(numNodes()), static_cast<uint64_t>(arcs.size())};
+    // Header fields.
+    append(&fingerprint, sizeof(fingerprint));
+    append(counts, sizeof(counts));
+    // Ranks.
+    for (int r : rank) { int32_t value = r; append(&value, sizeof(value)); }
+    // Arcs, field by field so padding never reaches the file.
+    for (const Arc& arc : arcs) {
+        // Integer fields.
+        int32_t ends[4] = {arc.tail, arc.head, arc.firstChild, arc.secondChild};
+        append(ends, sizeof(ends));
+        // Weight.
+        append(&arc.weight, sizeof(arc.weight));
+    }
+    // Trailing checksum.
+    unsigned long long checksum = fnv1a(image.data(), image.size());
+    append(&checksum, sizeof(checksum));
+    // Write the file.
+    std::ofstream file(filepath, std::ios::binary | std::ios::trunc);
+    // Report unopenable paths.
+    if (!file) { error = "Could not open " + filepath + " for writing."; return false; }
+    // Write the image.
+    file.write(image.data(), static_cast<std::streamsize>(image.size()));
+    // Report write failures.
+    if (!file) { error = "Could not write " + filepath + "."; return false; }
+    // Success.
+    return true;
+}
+
+// Reads a hierarchy written by save.
+bool ContractionHierarchy::load(const std::string& filepath, std::string& error) {
+    // Open the file.
+    std::ifstream file(filepath, std::ios::binary);
+    // Report missing files.
+    if (!file) { error = "Could not open " + filepath + "."; return false; }
+    // Read the whole image.
+    std::string image((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    // Fixed part: magic, fingerprint, counts, checksum.
+    const size_t fixed = sizeof(FILE_MAGIC) + sizeof(uint64_t) * 4;
+    // Check the signature.
+    if (image.size() < fixed || std::memcmp(image.data(), FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) {
+        // Not a hierarchy file.
+        error = filepath + " is not a contraction hierarchy file.";
+        return false;
+    }
+    // Verify the checksum before trusting any field.
+    unsigned long long stored;
+    std::memcpy(&stored, image.data() + image.size() - sizeof(stored), sizeof(stored));
+    // Compare with the recomputed one.
+    if (fnv1a(image.data(), image.size() - sizeof(stored)) != stored) { error = filepath + " is corrupted (checksum mismatch)."; return false; }
+    // Read position.
+    size_t pos = sizeof(FILE_MAGIC);
+    // Copies raw bytes out of the image.
+    auto read = [&image, &pos](void* data, size_t size) { std::memcpy(data, image.data() + pos, size); pos += size; };
+    // Header fields.
+    unsigned long long storedFingerprint;
+    uint64_t counts[2];
+    read(&storedFingerprint, sizeof(storedFingerprint));
+    read(counts, sizeof(counts));
+    // The payload size must match the counts.
+    if (image.size() != fixed + counts[0] * sizeof(int32_t) + counts[1] * (4 * sizeof(int32_t) + sizeof(double))) {
+        // Truncated or padded file.
+        error = filepath + " has an invalid size.";
+        return false;
+    }
+    // Ranks.
+    std::vector<int> ranks(counts[0]);
+    for (int& r : ranks) { int32_t value; read(&value, sizeof(value)); r = value; }
+    // Arcs.
+    std::vector<Arc> loaded(counts[1]);
+    for (Arc& arc : loaded) {
+        // Integer fields.
+        int32_t ends[4];
+        read(ends, sizeof(ends));
+        // Unpack them.
+        arc = {ends[0], ends[1], 0.0, ends[2], ends[3]};
+        // Weight.
+        read(&arc.weight, sizeof(arc.weight));
+    }
+    // Node count as a signed bound.
+    const long long n = static_cast<long long>(counts[0]), m = static_cast<long long>(counts[1]);
+    // Reject ranks outside the node range.
+    for (int r : ranks) if (r < 0 || r >= n) { error = filepath + " has an invalid rank."; return false; }
+    // Reject arcs pointing outside the node or arc ranges.
+    for (const Arc& arc : loaded) {
+        // Endpoints must be nodes; children must both be arcs or both be absent.
+        if (arc.tail < 0 || arc.tail >= n || arc.head < 0 || arc.head >= n || arc.firstChild >= m || arc.secondChild >= m ||
+            (arc.firstChild < 0) != (arc.secondChild < 0)) {
+            // Inconsistent arc.
+            error = filepath + " has an invalid arc.";
+            return false;
+        }
+    }
+    // Adopt the contents.
+    fingerprint = storedFingerprint;
+    rank.swap(ranks);
+    arcs.swap(loaded);
+    // Rebuild the query indices.
+    buildSearchGraphs();
+    // Success.
+    return true;
+}
+
+// Computes the shortest path with a contraction hierarchy and unpacks it into original edges.
+std::vector<int> Algorithms::contractionHierarchyQuery(const CsrGraph& graph, const ContractionHierarchy& ch, QueryWorkspace& forward, QueryWorkspace& backward,
+                                                       int startNode, int endNode, double& pathWeight) {
+    // Translate the endpoints to internal indices.
+    int source = graph.internalId(startNode);
+    // Internal index of the target.
+    int target = graph.internalId(endNode);
+    // Peak of the path.
+    int meeting = -1;
+    // Unknown endpoints cannot be connected; otherwise run the upward searches.
+    if (source < 0 || target < 0 || (meeting = ch.query(forward, backward, source, target)) < 0) {
+        // Set path weight to infinity if no path found.
+        pathWeight = INF;
+        // Return empty path.
+        return {};
+    }
+    // Path weight is the sum of both halves.
+    pathWeight = forward.distance(meeting) + backward.distance(meeting);
+    // Arcs source..meeting, collected backwards.
+    std::vector<int> upwardArcs;
+    // Forward parents are arcs ending at the labelled node.
+    for (int curr = meeting; forward.parent(curr) != -1; curr = ch.arcs[forward.parent(curr)].tail) upwardArcs.push_back(forward.parent(curr));
+    // Internal nodes of the path.
+    std::vector<int> nodes{source};
+    // Expand the source half in path order.
+    for (auto it = upwardArcs.rbegin(); it != upwardArcs.rend(); ++it) ch.unpackArc(*it, nodes);
+    // Backward parents are arcs leaving the labelled node, already in path order.
+    for (int curr = meeting; backward.parent(curr) != -1; curr = ch.arcs[backward.parent(curr)].head) ch.unpackArc(backward.parent(curr), nodes);
+    // Translate to external IDs.
+    std::vector<int> path;
+    // Reserve the result.
+    path.reserve(nodes.size());
+    // Translate every node.
+    for (int u : nodes) path.push_back(graph.externalId(u));
+    // Return the path.
+    return path;
+}
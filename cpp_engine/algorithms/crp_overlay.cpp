@@ -0,0 +1,369 @@
+#include "../include/crp_overlay.h"
+#include "../include/algorithms.h"
+#include "../include/stats.h"
+#include <algorithm>
+
+namespace {
+    // Calls visit(head, weight) for every clique arc of a boundary node u within its cell of a level.
+    template <class Visit>
+    void forEachCliqueArc(const CrpOverlay::Level& level, int u, const Visit& visit) {
+        // Cell of u and its boundary nodes.
+        const int cell = level.cellOf[u];
+        const int begin = level.firstBoundary[cell];
+        const int size = level.firstBoundary[cell + 1] - begin;
+        // Row of u in the cell's matrix.
+        const double* row = level.weights.data() + level.firstWeight[cell] + static_cast<size_t>(level.boundaryIndex[u] - begin) * size;
+        // Every boundary node of the cell.
+        for (int j = 0; j < size; ++j) visit(level.boundary[begin + j], row[j]);
+    }
+}
+
+// Partitions a graph's topology and finds the boundary nodes of every level.
+CrpOverlay CrpOverlay::build(const CsrGraph& graph, const std::vector<int>& cellSizes, ThreadPool& pool) {
+    // Result.
+    CrpOverlay overlay;
+    // Number of nodes.
+    const int n = graph.numNodes();
+    overlay.nodeCount = n;
+    // Nested cells.
+    MultilevelPartition partition = MultilevelPartition::inertialFlow(graph, cellSizes, pool);
+    overlay.cellSizes = partition.cellSizes;
+    overlay.levels.resize(partition.numLevels());
+    // Every level on its own.
+    for (int l = 0; l < partition.numLevels(); ++l) {
+        Level& level = overlay.levels[l];
+        level.cellOf = std::move(partition.cellOf[l]);
+        const int cells = partition.numCells[l];
+        // Ends of every edge between two cells.
+        std::vector<char> isBoundary(n, 0);
+        for (int u = 0; u < n; ++u) {
+            for (int e = graph.beginEdge(u); e < graph.endEdge(u); ++e) {
+                if (level.cellOf[graph.edgeHead(e)] != level.cellOf[u]) isBoundary[u] = isBoundary[graph.edgeHead(e)] = 1;
+            }
+        }
+        // Boundary nodes per cell (shifted by one for the prefix sum).
+        level.firstBoundary.assign(cells + 1, 0);
+        for (int v = 0; v < n; ++v) if (isBoundary[v]) ++level.firstBoundary[level.cellOf[v] + 1];
+        for (int c = 0; c < cells; ++c) level.firstBoundary[c + 1] += level.firstBoundary[c];
+        // Place them in ascending order.
+        level.boundary.resize(level.firstBoundary[cells]);
+        level.boundaryIndex.assign(n, -1);
+        std::vector<int> fill(level.firstBoundary.begin(), level.firstBoundary.end() - 1);
+        for (int v = 0; v < n; ++v) {
+            if (!isBoundary[v]) continue;
+            level.boundaryIndex[v] = fill[level.cellOf[v]]++;
+            level.boundary[level.boundaryIndex[v]] = v;
+        }
+        // One square matrix per cell, back to back.
+        level.firstWeight.assign(cells + 1, 0);
+        for (int c = 0; c < cells; ++c) {
+            const size_t size = level.firstBoundary[c + 1] - level.firstBoundary[c];
+            level.firstWeight[c + 1] = level.firstWeight[c] + size * size;
+        }
+        level.weights.assign(level.firstWeight[cells], INF);
+        // Subcells of every cell; the partition numbers them consecutively per cell.
+        if (l > 0) {
+            const Level& below = overlay.levels[l - 1];
+            level.firstSubcell.assign(cells + 1, 0);
+            // Count the subcells of every cell (each one once, via its first node).
+            std::vector<char> counted(below.numCells(), 0);
+            for (int v = 0; v < n; ++v) {
+                if (counted[below.cellOf[v]]) continue;
+                counted[below.cellOf[v]] = 1;
+                ++level.firstSubcell[level.cellOf[v] + 1];
+            }
+            for (int c = 0; c < cells; ++c) level.firstSubcell[c + 1] += level.firstSubcell[c];
+        }
+    }
+    // Return the overlay (not customized yet).
+    return overlay;
+}
+
+// Dijkstra from source restricted to one cell of a level.
+void CrpOverlay::cellSearch(const CsrGraph& graph, QueryWorkspace& workspace, int level, int cell, int source, int target) const {
+    // Start a new search on the labels and the queue.
+    workspace.reset(graph.numNodes());
+    IndexedDaryHeap<4>& queue = workspace.daryQueue;
+    queue.reset(graph.numNodes());
+    workspace.setLabel(source, 0, -1);
+    queue.push(source, 0);
+    // Cells of the level and, above level 0, the level below.
+    const Level& current = levels[level];
+    const Level* below = level > 0 ? &levels[level - 1] : nullptr;
+    // Boundary nodes of the cell still unsettled, if those are what the search is for.
+    int remaining = target < 0 ? current.firstBoundary[cell + 1] - current.firstBoundary[cell] : -1;
+    // Settle nodes in order of distance.
+    while (!queue.empty()) {
+        // Closest unsettled node.
+        std::pair<double, int> top = queue.pop();
+        const int u = top.second;
+        if (u == target || (current.boundaryIndex[u] >= 0 && --remaining == 0)) return;
+        // Improves v through u.
+        auto relax = [&](int v, double weight) {
+            double candidate = top.first + weight;
+            if (candidate < workspace.distance(v)) { workspace.setLabel(v, candidate, u); queue.push(v, candidate); }
+        };
+        // Level 0: the original edges inside the cell.
+        if (!below) {
+            for (int e = graph.beginEdge(u); e < graph.endEdge(u); ++e) if (current.cellOf[graph.edgeHead(e)] == cell) relax(graph.edgeHead(e), graph.edgeWeight(e));
+            continue;
+        }
+        // Otherwise the clique of u's subcell, unless u was reached over it (cliques are closed under
+        // shortest paths, so nothing improves), and the original edges into other subcells of the cell.
+        const int parent = workspace.parent(u);
+        if (parent < 0 || below->cellOf[parent] != below->cellOf[u]) forEachCliqueArc(*below, u, relax);
+        for (int e = graph.beginEdge(u); e < graph.endEdge(u); ++e) {
+            const int v = graph.edgeHead(e);
+            if (below->cellOf[v] != below->cellOf[u] && current.cellOf[v] == cell) relax(v, graph.edgeWeight(e));
+        }
+    }
+}
+
+// Computes the clique matrix of one cell.
+void CrpOverlay::customizeCell(const CsrGraph& graph, int level, int cell, QueryWorkspace& workspace, std::vector<double>& scratch) {
+    // The cell's boundary nodes and matrix.
+    Level& current = levels[level];
+    const int begin = current.firstBoundary[cell];
+    const int rows = current.firstBoundary[cell + 1] - begin;
+    double* matrix = current.weights.data() + current.firstWeight[cell];
+    // Level 0: one Dijkstra over the original edges from every boundary node.
+    if (level == 0) {
+        for (int i = 0; i < rows; ++i) {
+            cellSearch(graph, workspace, 0, cell, current.boundary[begin + i], -1);
+            for (int j = 0; j < rows; ++j) matrix[static_cast<size_t>(i) * rows + j] = workspace.distance(current.boundary[begin + j]);
+        }
+        return;
+    }
+    // Higher levels: the nodes are the boundary nodes of the subcells, a contiguous range of the level below.
+    const Level& below = levels[level - 1];
+    const int firstSubcell = current.firstSubcell[cell], lastSubcell = current.firstSubcell[cell + 1];
+    const int first = below.firstBoundary[firstSubcell];
+    const int columns = below.firstBoundary[lastSubcell] - first;
+    // Subcell of every column.
+    std::vector<int> subcellOf(columns);
+    for (int d = firstSubcell; d < lastSubcell; ++d) {
+        for (int column = below.firstBoundary[d] - first; column < below.firstBoundary[d + 1] - first; ++column) subcellOf[column] = d;
+    }
+    // Original edges between subcells per column (CSR), and the columns of the cell's own boundary nodes.
+    std::vector<int> firstArc(columns + 1, 0), arcHead;
+    std::vector<double> arcWeight;
+    std::vector<char> isTarget(columns, 0);
+    // Whether the label of a column came over a clique arc of its subcell.
+    std::vector<char> viaClique(columns);
+    for (int column = 0; column < columns; ++column) {
+        const int u = below.boundary[first + column];
+        for (int e = graph.beginEdge(u); e < graph.endEdge(u); ++e) {
+            const int v = graph.edgeHead(e);
+            if (below.cellOf[v] == below.cellOf[u] || current.cellOf[v] != cell) continue;
+            arcHead.push_back(below.boundaryIndex[v] - first);
+            arcWeight.push_back(graph.edgeWeight(e));
+        }
+        firstArc[column + 1] = static_cast<int>(arcHead.size());
+        isTarget[column] = current.boundaryIndex[u] >= 0;
+    }
+    // Distance of every column from the current row's boundary node.
+    scratch.resize(columns);
+    double* distance = scratch.data();
+    IndexedDaryHeap<4>& queue = workspace.daryQueue;
+    // One Dijkstra per boundary node of the cell, stopped once all of them are settled.
+    for (int i = 0; i < rows; ++i) {
+        std::fill(distance, distance + columns, INF);
+        queue.reset(columns);
+        const int source = below.boundaryIndex[current.boundary[begin + i]] - first;
+        distance[source] = 0;
+        viaClique[source] = 0;
+        queue.push(source, 0);
+        for (int settled = 0; settled < rows && !queue.empty();) {
+            // Closest unsettled column.
+            std::pair<double, int> top = queue.pop();
+            const double du = top.first;
+            const int u = top.second;
+            settled += isTarget[u];
+            // Its clique row and the subcell's slice of the distances, both contiguous; skipped if u
+            // was reached over the same clique, which is closed under shortest paths.
+            if (!viaClique[u]) {
+                const int d = subcellOf[u];
+                const int offset = below.firstBoundary[d] - first;
+                const int size = below.firstBoundary[d + 1] - below.firstBoundary[d];
+                const double* row = below.weights.data() + below.firstWeight[d] + static_cast<size_t>(u - offset) * size;
+                double* slice = distance + offset;
+                char* cliqueLabel = viaClique.data() + offset;
+                for (int j = 0; j < size; ++j) {
+                    const double candidate = du + row[j];
+                    if (candidate < slice[j]) { slice[j] = candidate; cliqueLabel[j] = 1; queue.push(offset + j, candidate); }
+                }
+            }
+            // Original edges from u into other subcells.
+            for (int a = firstArc[u]; a < firstArc[u + 1]; ++a) {
+                const double candidate = du + arcWeight[a];
+                if (candidate < distance[arcHead[a]]) { distance[arcHead[a]] = candidate; viaClique[arcHead[a]] = 0; queue.push(arcHead[a], candidate); }
+            }
+        }
+        // Keep the distances to the cell's own boundary nodes.
+        for (int j = 0; j < rows; ++j) matrix[static_cast<size_t>(i) * rows + j] = distance[below.boundaryIndex[current.boundary[begin + j]] - first];
+    }
+}
+
+// Computes every clique matrix from the graph's current weights.
+void CrpOverlay::customize(const CsrGraph& graph, ThreadPool& pool) {
+    // Distance rows of the higher levels, one buffer per worker.
+    std::vector<std::vector<double>> scratch(pool.size());
+    // Bottom-up; the cells of a level are independent.
+    for (int l = 0; l < numLevels(); ++l) {
+        pool.parallelFor(levels[l].numCells(), [&](size_t c, unsigned worker) {
+            customizeCell(graph, l, static_cast<int>(c), Algorithms::threadWorkspace(), scratch[worker]);
+        });
+    }
+}
+
+// Recomputes only the cells containing the given changed edges.
+void CrpOverlay::customizeEdges(const CsrGraph& graph, const std::vector<std::pair<int, int>>& changed, ThreadPool& pool) {
+    // Distance rows of the higher levels, one buffer per worker.
+    std::vector<std::vector<double>> scratch(pool.size());
+    // Bottom-up, so every cell sees its recomputed subcells.
+    for (int l = 0; l < numLevels(); ++l) {
+        const std::vector<int>& cellOf = levels[l].cellOf;
+        // Cells with a changed edge inside (edges between cells of the level are read directly by the level above).
+        std::vector<char> dirty(levels[l].numCells(), 0);
+        std::vector<int> cells;
+        for (const auto& pair : changed) {
+            const int c = cellOf[pair.first];
+            if (cellOf[pair.second] != c || dirty[c]) continue;
+            dirty[c] = 1;
+            cells.push_back(c);
+        }
+        // Recompute them in parallel.
+        pool.parallelFor(cells.size(), [&](size_t i, unsigned worker) {
+            customizeCell(graph, l, cells[i], Algorithms::threadWorkspace(), scratch[worker]);
+        });
+    }
+}
+
+// Total number of clique matrix entries.
+size_t CrpOverlay::numEntries() const {
+    // Sum over the levels.
+    size_t entries = 0;
+    for (const Level& level : levels) entries += level.weights.size();
+    return entries;
+}
+
+// Highest level whose cell of v contains neither source nor target, or -1.
+int CrpOverlay::queryLevel(int v, int source, int target) const {
+    // From the top down.
+    for (int l = numLevels() - 1; l >= 0; --l) {
+        const std::vector<int>& cellOf = levels[l].cellOf;
+        if (cellOf[v] != cellOf[source] && cellOf[v] != cellOf[target]) return l;
+    }
+    // v shares a cell with source or target on every level.
+    return -1;
+}
+
+// Multilevel Dijkstra from source to target.
+bool CrpOverlay::query(const CsrGraph& graph, QueryWorkspace& workspace, int source, int target) const {
+    // Start a new search on the labels and the queue.
+    workspace.reset(graph.numNodes());
+    IndexedDaryHeap<4>& queue = workspace.daryQueue;
+    queue.reset(graph.numNodes());
+    workspace.setLabel(source, 0, -1);
+    queue.push(source, 0);
+    // Counts of this search, published when it returns.
+    ROUTE_STATS(Stats::Local counters; ++counters[Stats::HeapPushes];)
+    // Settle nodes in order of distance.
+    while (!queue.empty()) {
+        // Closest unsettled node.
+        std::pair<double, int> top = queue.pop();
+        ROUTE_STATS(++counters[Stats::HeapPops];)
+        const int u = top.second;
+        if (u == target) return true;
+        ROUTE_STATS(++counters[Stats::NodesSettled];)
+        // Improves v through u.
+        auto relax = [&](int v, double weight) {
+            ROUTE_STATS(++counters[Stats::EdgesRelaxed];)
+            double candidate = top.first + weight;
+            if (candidate < workspace.distance(v)) {
+                workspace.setLabel(v, candidate, u);
+                queue.push(v, candidate);
+                ROUTE_STATS(++counters[Stats::HeapPushes];)
+            }
+        };
+        // Level to settle u on.
+        const int l = queryLevel(u, source, target);
+        // Near source or target: the original edges.
+        if (l < 0) {
+            for (int e = graph.beginEdge(u); e < graph.endEdge(u); ++e) relax(graph.edgeHead(e), graph.edgeWeight(e));
+            continue;
+        }
+        // Otherwise u is a boundary node of its cell on that level: its clique (unless u was reached
+        // over it) and the edges leaving the cell.
+        const Level& level = levels[l];
+        const int parent = workspace.parent(u);
+        if (parent < 0 || level.cellOf[parent] != level.cellOf[u]) forEachCliqueArc(level, u, relax);
+        for (int e = graph.beginEdge(u); e < graph.endEdge(u); ++e) if (level.cellOf[graph.edgeHead(e)] != level.cellOf[u]) relax(graph.edgeHead(e), graph.edgeWeight(e));
+    }
+    // Target unreachable.
+    return false;
+}
+
+// Appends the internal nodes of the path behind an arc after its start node.
+void CrpOverlay::unpackArc(const CsrGraph& graph, QueryWorkspace& workspace, int level, int from, int to, std::vector<int>& nodes) const {
+    // Arcs still to expand, last one on top.
+    struct Arc {
+        int level, from, to;
+    };
+    std::vector<Arc> stack{{level, from, to}};
+    // Nodes of one restricted search, from its end back to its start.
+    std::vector<int> hops;
+    // Expand depth first in path order.
+    while (!stack.empty()) {
+        Arc arc = stack.back();
+        stack.pop_back();
+        // An original edge: emit its end.
+        if (arc.level < 0) { nodes.push_back(arc.to); continue; }
+        // A clique arc: its shortest path inside the cell, one level down.
+        cellSearch(graph, workspace, arc.level, levels[arc.level].cellOf[arc.from], arc.from, arc.to);
+        hops.clear();
+        for (int v = arc.to; v != -1; v = workspace.parent(v)) hops.push_back(v);
+        // Push its arcs last-first; one is a clique arc of the level below if it stays in a subcell.
+        const int below = arc.level - 1;
+        for (size_t k = 0; k + 1 < hops.size(); ++k) {
+            const int p = hops[k + 1], q = hops[k];
+            stack.push_back({below >= 0 && levels[below].cellOf[p] == levels[below].cellOf[q] ? below : -1, p, q});
+        }
+    }
+}
+
+// Computes the shortest path with a customized overlay and unpacks it into original edges.
+std::vector<int> Algorithms::crpQuery(const CsrGraph& graph, const CrpOverlay& crp, QueryWorkspace& workspace, int startNode, int endNode, double& pathWeight) {
+    // Translate the endpoints to internal indices.
+    int source = graph.internalId(startNode);
+    // Internal index of the target.
+    int target = graph.internalId(endNode);
+    // Unknown endpoints cannot be connected; otherwise run the multilevel search.
+    if (source < 0 || target < 0 || !crp.query(graph, workspace, source, target)) {
+        // Set path weight to infinity if no path found.
+        pathWeight = INF;
+        // Return empty path.
+        return {};
+    }
+    // Set the total weight of the found path.
+    pathWeight = workspace.distance(target);
+    // Nodes the search passed, from target back to source (the workspace is reused for unpacking).
+    std::vector<int> coarse;
+    for (int v = target; v != -1; v = workspace.parent(v)) coarse.push_back(v);
+    // Internal nodes of the path.
+    std::vector<int> nodes{source};
+    // Expand every hop in path order; it is a clique arc if it stays in a cell of the level its tail was settled on.
+    for (size_t k = coarse.size() - 1; k > 0; --k) {
+        const int from = coarse[k], to = coarse[k - 1];
+        const int level = crp.queryLevel(from, source, target);
+        crp.unpackArc(graph, workspace, level >= 0 && crp.levels[level].cellOf[to] == crp.levels[level].cellOf[from] ? level : -1, from, to, nodes);
+    }
+    // Translate to external IDs.
+    std::vector<int> path;
+    // Reserve the result.
+    path.reserve(nodes.size());
+    // Map every node.
+    for (int v : nodes) path.push_back(graph.externalId(v));
+    // Return the path.
+    return path;
+}
@@ -0,0 +1,566 @@
+#include "../include/customizable_ch.h"
+#include "../include/algorithms.h"
+#include "../include/stats.h"
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <utility>
+
+namespace {
+    // Undirected simple graph (no self loops, no parallel edges) in CSR form.
+    struct UndirectedGraph {
+        // Offset of each node's neighbors; size N+1.
+        std::vector<int> first;
+        // Neighbors, sorted within each node.
+        std::vector<int> neighbors;
+    };
+
+    // Forgets edge directions, weights, parallel edges and self loops.
+    UndirectedGraph undirectedTopology(const CsrGraph& graph) {
+        // Number of nodes.
+        const int n = graph.numNodes();
+        // Both orientations of every edge.
+        std::vector<std::pair<int, int>> pairs;
+        // Reserve them.
+        pairs.reserve(2 * static_cast<size_t>(graph.numEdges()));
+        // Collect the pairs.
+        for (int u = 0; u < n; ++u) {
+            // Scan u's edges.
+            for (int e = graph.beginEdge(u); e < graph.endEdge(u); ++e) {
+                // Skip self loops.
+                if (graph.edgeHead(e) == u) continue;
+                // Add both orientations.
+                pairs.push_back({u, graph.edgeHead(e)});
+                pairs.push_back({graph.edgeHead(e), u});
+            }
+        }
+        // Sort by node, then neighbor.
+        std::sort(pairs.begin(), pairs.end());
+        // Drop parallel edges.
+        pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+        // Result.
+        UndirectedGraph result;
+        // Offsets.
+        result.first.assign(n + 1, 0);
+        // Count neighbors (shifted by one for the prefix sum).
+        for (const auto& pair : pairs) ++result.first[pair.first + 1];
+        // Prefix sums turn counts into offsets.
+        for (int v = 0; v < n; ++v) result.first[v + 1] += result.first[v];
+        // Pairs are sorted, so neighbors can be copied in order.
+        result.neighbors.reserve(pairs.size());
+        // Copy them.
+        for (const auto& pair : pairs) result.neighbors.push_back(pair.second);
+        // Return the graph.
+        return result;
+    }
+
+    // Nested dissection order: recursively bisects the node set and ranks each separator above
+    // both halves. Bisection splits at the coordinate median along the longer axis of the cell,
+    // or at the middle of a BFS order when the cell has no spatial extent.
+    std::vector<int> nestedDissectionRanks(const CsrGraph& graph, const UndirectedGraph& topology) {
+        // Number of nodes.
+        const int n = graph.numNodes();
+        // Rank of every node.
+        std::vector<int> rank(n, -1);
+        // Ranks are handed out from the top: separators first.
+        int next = n - 1;
+        // Cell every node currently belongs to.
+        std::vector<int> cellOf(n, -1);
+        // Half of its cell every node was put in.
+        std::vector<uint8_t> side(n, 0);
+        // Cells still to dissect.
+        std::vector<std::vector<int>> pending;
+        // Start with all nodes.
+        pending.emplace_back(n);
+        // Fill the initial cell.
+        for (int v = 0; v < n; ++v) pending.back()[v] = v;
+        // Identifier of the cell being dissected.
+        int cellId = 0;
+        // BFS queue for cells without spatial extent.
+        std::vector<int> bfs;
+        // Dissect until no cell is left.
+        while (!pending.empty()) {
+            // Take a cell.
+            std::vector<int> cell = std::move(pending.back());
+            // Remove it from the stack.
+            pending.pop_back();
+            // Tiny cells are ranked directly.
+            if (cell.size() <= 2) {
+                // Any order works.
+                for (int v : cell) rank[v] = next--;
+                // Next cell.
+                continue;
+            }
+            // New cell identifier.
+            ++cellId;
+            // Mark the members.
+            for (int v : cell) cellOf[v] = cellId;
+            // Bounding box of the cell.
+            double minX = INF, maxX = -INF, minY = INF, maxY = -INF;
+            // Measure it.
+            for (int v : cell) {
+                // Track both axes.
+                minX = std::min(minX, graph.x(v)); maxX = std::max(maxX, graph.x(v));
+                minY = std::min(minY, graph.y(v)); maxY = std::max(maxY, graph.y(v));
+            }
+            // Middle position.
+            auto middle = cell.begin() + cell.size() / 2;
+            // Split geometrically if the cell has any extent.
+            if (maxX > minX || maxY > minY) {
+                // Longer axis.
+                bool alongX = maxX - minX >= maxY - minY;
+                // Partial sort by the coordinate (ties by index, for determinism).
+                std::nth_element(cell.begin(), middle, cell.end(), [&](int a, int b) {
+                    // Coordinates along the axis.
+                    double ca = alongX ? graph.x(a) : graph.y(a), cb = alongX ? graph.x(b) : graph.y(b);
+                    // Compare.
+                    return ca < cb || (ca == cb && a < b);
+                });
+            } else {
+                // Breadth-first order within the cell, restarting in every component.
+                bfs.clear();
+                // Visited marks reuse the side array.
+                for (int v : cell) side[v] = 0;
+                // Start from every unvisited member.
+                for (int start : cell) {
+                    // Already visited.
+                    if (side[start]) continue;
+                    // Visit it.
+                    side[start] = 1;
+                    bfs.push_back(start);
+                    // Expand the component.
+                    for (size_t head = bfs.size() - 1; head < bfs.size(); ++head) {
+                        // Scan the neighbors inside the cell.
+                        for (int i = topology.first[bfs[head]]; i < topology.first[bfs[head] + 1]; ++i) {
+                            // Neighbor.
+                            int w = topology.neighbors[i];
+                            // Visit unvisited members.
+                            if (cellOf[w] == cellId && !side[w]) { side[w] = 1; bfs.push_back(w); }
+                        }
+                    }
+                }
+                // Use the BFS order.
+                cell = bfs;
+                // Recompute the middle for the new vector.
+                middle = cell.begin() + cell.size() / 2;
+            }
+            // Assign the halves.
+            for (auto it = cell.begin(); it != cell.end(); ++it) side[*it] = it < middle ? 0 : 1;
+            // Boundary nodes of each half: members with a neighbor in the other half.
+            std::vector<int> boundary[2];
+            // Find them.
+            for (int v : cell) {
+                // Scan the neighbors.
+                for (int i = topology.first[v]; i < topology.first[v + 1]; ++i) {
+                    // Neighbor.
+                    int w = topology.neighbors[i];
+                    // Crossing edge.
+                    if (cellOf[w] == cellId && side[w] != side[v]) { boundary[side[v]].push_back(v); break; }
+                }
+            }
+            // The smaller boundary is the separator.
+            int separatorSide = boundary[0].size() <= boundary[1].size() ? 0 : 1;
+            // Rank the separator above everything left in the cell.
+            for (int v : boundary[separatorSide]) { rank[v] = next--; cellOf[v] = -1; }
+            // Both halves without the separator.
+            std::vector<int> halves[2];
+            // Split the rest.
+            for (int v : cell) if (cellOf[v] == cellId) halves[side[v]].push_back(v);
+            // Dissect them further.
+            for (std::vector<int>& half : halves) if (!half.empty()) pending.push_back(std::move(half));
+        }
+        // Return the ranks.
+        return rank;
+    }
+
+    // Cheapest edge from->to in the graph, or INF.
+    double cheapestEdge(const CsrGraph& graph, int from, int to) {
+        // Best weight so far.
+        double best = INF;
+        // Scan the outgoing edges of from.
+        for (int e = graph.beginEdge(from); e < graph.endEdge(from); ++e) if (graph.edgeHead(e) == to) best = std::min(best, graph.edgeWeight(e));
+        // Return it.
+        return best;
+    }
+}
+
+// Computes the nested dissection order and the chordal supergraph of a graph's topology.
+CustomizableCH CustomizableCH::build(const CsrGraph& graph, ThreadPool& pool) {
+    // Result.
+    CustomizableCH cch;
+    // Number of nodes.
+    const int n = graph.numNodes();
+    // Undirected topology.
+    UndirectedGraph topology = undirectedTopology(graph);
+    // Contraction order.
+    cch.rank = nestedDissectionRanks(graph, topology);
+    // Node at every rank.
+    std::vector<int> nodeAt(n);
+    // Invert the ranks.
+    for (int v = 0; v < n; ++v) nodeAt[cch.rank[v]] = v;
+    // Upper neighbors of every node, completed during contraction.
+    std::vector<std::vector<int>> upper(n);
+    // Original edges point from the lower to the upper endpoint.
+    for (int v = 0; v < n; ++v) {
+        // Scan the neighbors.
+        for (int i = topology.first[v]; i < topology.first[v + 1]; ++i) if (cch.rank[topology.neighbors[i]] > cch.rank[v]) upper[v].push_back(topology.neighbors[i]);
+    }
+    // Orders nodes by rank.
+    auto byRank = [&cch](int a, int b) { return cch.rank[a] < cch.rank[b]; };
+    // Elimination tree parents.
+    cch.parent.assign(n, -1);
+    // Contract in rank order: the upper neighbors of v become a clique, which is recorded at the
+    // lowest of them (the elimination tree parent) and passed on when that one is contracted.
+    for (int r = 0; r < n; ++r) {
+        // Node being contracted.
+        int v = nodeAt[r];
+        // Its upper neighbors.
+        std::vector<int>& up = upper[v];
+        // Sort them by rank.
+        std::sort(up.begin(), up.end(), byRank);
+        // Drop duplicates inherited from several children.
+        up.erase(std::unique(up.begin(), up.end()), up.end());
+        // Roots have no parent.
+        if (up.empty()) continue;
+        // Lowest upper neighbor.
+        cch.parent[v] = up.front();
+        // The other upper neighbors become its neighbors too.
+        upper[up.front()].insert(upper[up.front()].end(), up.begin() + 1, up.end());
+    }
+    // Offsets of the upward edges.
+    cch.firstUp.assign(n + 1, 0);
+    // Count them.
+    for (int v = 0; v < n; ++v) cch.firstUp[v + 1] = cch.firstUp[v] + static_cast<int>(upper[v].size());
+    // Number of edges.
+    const int m = cch.firstUp[n];
+    // Edge endpoints.
+    cch.upHead.resize(m);
+    cch.edgeTail.resize(m);
+    // Fill them.
+    for (int v = 0; v < n; ++v) {
+        // Copy the sorted upper neighbors.
+        std::copy(upper[v].begin(), upper[v].end(), cch.upHead.begin() + cch.firstUp[v]);
+        // Record the tail of each edge.
+        std::fill(cch.edgeTail.begin() + cch.firstUp[v], cch.edgeTail.begin() + cch.firstUp[v + 1], v);
+        // Free the list.
+        std::vector<int>().swap(upper[v]);
+    }
+    // Offsets of the downward edges.
+    cch.firstDown.assign(n + 1, 0);
+    // Count them.
+    for (int e = 0; e < m; ++e) ++cch.firstDown[cch.upHead[e] + 1];
+    // Prefix sums turn counts into offsets.
+    for (int v = 0; v < n; ++v) cch.firstDown[v + 1] += cch.firstDown[v];
+    // Downward edge arrays.
+    cch.downTail.resize(m);
+    cch.downEdge.resize(m);
+    // Next free slot per node.
+    std::vector<int> nextDown(cch.firstDown.begin(), cch.firstDown.end() - 1);
+    // Scatter in rank order of the tails, so every node's downward list ends up sorted by rank.
+    for (int r = 0; r < n; ++r) {
+        // Lower endpoint.
+        int v = nodeAt[r];
+        // Its upward edges.
+        for (int e = cch.firstUp[v]; e < cch.firstUp[v + 1]; ++e) {
+            // Slot at the upper endpoint.
+            int slot = nextDown[cch.upHead[e]]++;
+            // Record the lower endpoint.
+            cch.downTail[slot] = v;
+            // Record the edge.
+            cch.downEdge[slot] = e;
+        }
+    }
+    // Calls visit(low, high) for every lower triangle of edge e (by merging both downward lists).
+    auto forEachTriangle = [&cch](int e, const std::function<void(int, int)>& visit) {
+        // Endpoints.
+        int u = cch.edgeTail[e], w = cch.upHead[e];
+        // Merge positions.
+        int i = cch.firstDown[u], j = cch.firstDown[w];
+        // Merge the rank-sorted lists.
+        while (i < cch.firstDown[u + 1] && j < cch.firstDown[w + 1]) {
+            // Ranks of the current entries.
+            int ri = cch.rank[cch.downTail[i]], rj = cch.rank[cch.downTail[j]];
+            // Advance the smaller one.
+            if (ri < rj) ++i;
+            else if (rj < ri) ++j;
+            // Common lower neighbor.
+            else visit(cch.downEdge[i++], cch.downEdge[j++]);
+        }
+    };
+    // Count the triangles of every edge in parallel.
+    cch.firstTriangle.assign(m + 1, 0);
+    // One item per edge.
+    pool.parallelFor(m, [&](size_t e, unsigned) {
+        // Count into the shifted slot.
+        forEachTriangle(static_cast<int>(e), [&](int, int) { ++cch.firstTriangle[e + 1]; });
+    });
+    // Prefix sums turn counts into offsets.
+    for (int e = 0; e < m; ++e) cch.firstTriangle[e + 1] += cch.firstTriangle[e];
+    // Triangle arrays.
+    cch.triangleLow.resize(cch.firstTriangle[m]);
+    cch.triangleHigh.resize(cch.firstTriangle[m]);
+    // Fill them in parallel; every edge owns its range.
+    pool.parallelFor(m, [&](size_t e, unsigned) {
+        // Next slot of this edge.
+        int slot = cch.firstTriangle[e];
+        // Store each triangle.
+        forEachTriangle(static_cast<int>(e), [&](int low, int high) { cch.triangleLow[slot] = low; cch.triangleHigh[slot] = high; ++slot; });
+    });
+    // Elimination tree level of every node (0 for nodes without lower neighbors).
+    std::vector<int> level(n, 0);
+    // Highest level.
+    int maxLevel = 0;
+    // Levels follow from the lower neighbors, which come first in rank order.
+    for (int r = 0; r < n; ++r) {
+        // Node.
+        int v = nodeAt[r];
+        // One above its highest lower neighbor.
+        for (int i = cch.firstDown[v]; i < cch.firstDown[v + 1]; ++i) level[v] = std::max(level[v], level[cch.downTail[i]] + 1);
+        // Track the maximum.
+        maxLevel = std::max(maxLevel, level[v]);
+    }
+    // Group the nodes by level.
+    cch.levelStart.assign(maxLevel + 2, 0);
+    // Count each level.
+    for (int v = 0; v < n; ++v) ++cch.levelStart[level[v] + 1];
+    // Prefix sums turn counts into offsets.
+    for (int l = 0; l <= maxLevel; ++l) cch.levelStart[l + 1] += cch.levelStart[l];
+    // Level members.
+    cch.levelNodes.resize(n);
+    // Next free slot per level.
+    std::vector<int> nextLevel(cch.levelStart.begin(), cch.levelStart.end() - 1);
+    // Scatter the nodes.
+    for (int v = 0; v < n; ++v) cch.levelNodes[nextLevel[level[v]]++] = v;
+    // No metric yet.
+    cch.inputUp.assign(m, INF);
+    cch.inputDown.assign(m, INF);
+    cch.upWeight.assign(m, INF);
+    cch.downWeight.assign(m, INF);
+    // Done.
+    return cch;
+}
+
+// Recomputes the input weights of an edge from the graph's parallel edges.
+void CustomizableCH::loadInput(const CsrGraph& graph, int edge) {
+    // Lower to upper endpoint.
+    inputUp[edge] = cheapestEdge(graph, edgeTail[edge], upHead[edge]);
+    // Upper to lower endpoint.
+    inputDown[edge] = cheapestEdge(graph, upHead[edge], edgeTail[edge]);
+}
+
+// Recomputes both weights of an edge from its input and lower triangles.
+void CustomizableCH::recomputeEdge(int edge) {
+    // Start from the original edges.
+    double up = inputUp[edge], down = inputDown[edge];
+    // Every lower triangle offers a detour through a lower node x.
+    for (int t = firstTriangle[edge]; t < firstTriangle[edge + 1]; ++t) {
+        // Edges {x, u} and {x, w}.
+        int low = triangleLow[t], high = triangleHigh[t];
+        // u -> x -> w.
+        up = std::min(up, downWeight[low] + upWeight[high]);
+        // w -> x -> u.
+        down = std::min(down, downWeight[high] + upWeight[low]);
+    }
+    // Store the customized weights.
+    upWeight[edge] = up;
+    downWeight[edge] = down;
+}
+
+// Applies the graph's current weights to every edge.
+void CustomizableCH::customize(const CsrGraph& graph, ThreadPool& pool) {
+    // Load the input weights, one node's upward edges per item.
+    pool.parallelFor(numNodes(), [&](size_t v, unsigned) {
+        // Every upward edge of the node.
+        for (int e = firstUp[v]; e < firstUp[v + 1]; ++e) loadInput(graph, e);
+    });
+    // Level by level; the edges of a level only depend on lower levels.
+    for (size_t l = 0; l + 1 < levelStart.size(); ++l) {
+        // First node of the level.
+        const int begin = levelStart[l];
+        // Customize the level's nodes in parallel.
+        pool.parallelFor(levelStart[l + 1] - begin, [&](size_t i, unsigned) {
+            // Node of the item.
+            int v = levelNodes[begin + i];
+            // Its upward edges.
+            for (int e = firstUp[v]; e < firstUp[v + 1]; ++e) recomputeEdge(e);
+        });
+    }
+}
+
+// Re-customizes only what depends on the given changed edges.
+void CustomizableCH::customizeEdges(const CsrGraph& graph, const std::vector<std::pair<int, int>>& changed) {
+    // Size the queue marks once.
+    if (queued.size() != upHead.size()) queued.assign(upHead.size(), 0);
+    // Edges to recompute, lowest tail rank first (everything an edge depends on has a lower tail).
+    std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>, std::greater<std::pair<int, int>>> dirty;
+    // Queues an edge once.
+    auto enqueue = [&](int e) { if (!queued[e]) { queued[e] = 1; dirty.push({rank[edgeTail[e]], e}); } };
+    // Seed with the changed edges.
+    for (const auto& pair : changed) {
+        // Matching edge of the hierarchy.
+        int e = findEdge(pair.first, pair.second);
+        // Self loops have none.
+        if (e < 0) continue;
+        // Reload its input weights.
+        loadInput(graph, e);
+        // Recompute it.
+        enqueue(e);
+    }
+    // Propagate upwards.
+    while (!dirty.empty()) {
+        // Lowest pending edge.
+        int e = dirty.top().second;
+        // Remove it.
+        dirty.pop();
+        // Unmark it.
+        queued[e] = 0;
+        // Previous weights.
+        double up = upWeight[e], down = downWeight[e];
+        // Recompute.
+        recomputeEdge(e);
+        // Unchanged edges do not affect anything above them.
+        if (up == upWeight[e] && down == downWeight[e]) continue;
+        // Lower endpoint x and upper endpoint u of {x, u}.
+        int x = edgeTail[e], u = upHead[e];
+        // {x, u} is in a lower triangle of {u, w} for every other upper neighbor w of x.
+        for (int f = firstUp[x]; f < firstUp[x + 1]; ++f) if (upHead[f] != u) enqueue(findEdge(u, upHead[f]));
+    }
+}
+
+// Edge id between two nodes in either order, or -1 if they are not adjacent.
+int CustomizableCH::findEdge(int a, int b) const {
+    // Self loops are never edges.
+    if (a == b) return -1;
+    // Search from the lower endpoint.
+    if (rank[a] > rank[b]) std::swap(a, b);
+    // Upward edges of a are sorted by rank.
+    auto begin = upHead.begin() + firstUp[a], end = upHead.begin() + firstUp[a + 1];
+    // Binary search by rank.
+    auto it = std::lower_bound(begin, end, b, [this](int x, int y) { return rank[x] < rank[y]; });
+    // Return the edge if found.
+    return it != end && *it == b ? static_cast<int>(it - upHead.begin()) : -1;
+}
+
+// Walks the elimination tree from source, relaxing upward (or, if backward, downward) weights.
+void CustomizableCH::upwardSearch(QueryWorkspace& workspace, int source, bool backward, std::vector<int>* reached) const {
+    // Start a new search.
+    workspace.reset(numNodes());
+    // Seed it.
+    workspace.setLabel(source, 0, -1);
+    // Weights in the search direction.
+    const std::vector<double>& weights = backward ? downWeight : upWeight;
+    // Counts of this search (no queue: the elimination tree fixes the order), published when it returns.
+    ROUTE_STATS(Stats::Local counters;)
+    // Every ancestor of source in order; all upper neighbors of a node are among its ancestors.
+    for (int v = source; v != -1; v = parent[v]) {
+        // Distance label of v.
+        double d = workspace.distance(v);
+        // Unreached ancestors have nothing to relax.
+        if (d == INF) continue;
+        // Count the node and its edges.
+        ROUTE_STATS(++counters[Stats::NodesSettled]; counters[Stats::EdgesRelaxed] += firstUp[v + 1] - firstUp[v];)
+        // Report v.
+        if (reached) reached->push_back(v);
+        // Relax the upward edges.
+        for (int e = firstUp[v]; e < firstUp[v + 1]; ++e) {
+            // Candidate distance to (or from) the upper endpoint.
+            double candidate = d + weights[e];
+            // Keep the shorter one, with the edge as parent.
+            if (candidate < workspace.distance(upHead[e])) workspace.setLabel(upHead[e], candidate, e);
+        }
+    }
+}
+
+// Runs the elimination tree searches from source and target and returns the peak of the shortest path.
+int CustomizableCH::query(QueryWorkspace& forward, QueryWorkspace& backward, int source, int target) const {
+    // Forward: paths from source.
+    upwardSearch(forward, source, false);
+    // Backward: paths towards target.
+    upwardSearch(backward, target, true);
+    // Best peak among the common ancestors.
+    int meeting = -1;
+    // Length of the best path.
+    double best = INF;
+    // Only ancestors of both endpoints carry both labels.
+    for (int v = target; v != -1; v = parent[v]) {
+        // Path through v.
+        double length = forward.distance(v) + backward.distance(v);
+        // Keep the shortest.
+        if (length < best) { best = length; meeting = v; }
+    }
+    // Peak, if any path exists.
+    return meeting;
+}
+
+// Appends the internal nodes of an edge traversed upwards (or downwards) after its start node.
+void CustomizableCH::unpackEdge(int edge, bool upward, std::vector<int>& nodes) const {
+    // Edges still to expand with their direction, last one on top.
+    std::vector<std::pair<int, bool>> stack{{edge, upward}};
+    // Expand depth first in path order.
+    while (!stack.empty()) {
+        // Next edge.
+        int e = stack.back().first;
+        // Its direction.
+        bool up = stack.back().second;
+        // Consume it.
+        stack.pop_back();
+        // Customized weight in this direction.
+        double weight = up ? upWeight[e] : downWeight[e];
+        // An original edge carries exactly the customized weight.
+        bool original = weight == (up ? inputUp[e] : inputDown[e]);
+        // Triangle the weight came from.
+        int found = -1;
+        // Look for it unless the original edge explains the weight.
+        for (int t = firstTriangle[e]; !original && t < firstTriangle[e + 1] && found < 0; ++t) {
+            // Detour length in this direction (computed exactly as during customization).
+            double detour = up ? downWeight[triangleLow[t]] + upWeight[triangleHigh[t]] : downWeight[triangleHigh[t]] + upWeight[triangleLow[t]];
+            // Match.
+            if (detour == weight) found = t;
+        }
+        // Original edge (or, defensively, nothing matched): emit the end node.
+        if (found < 0) { nodes.push_back(up ? upHead[e] : edgeTail[e]); continue; }
+        // Upwards u->x->w: {x,u} downwards, then {x,w} upwards.
+        if (up) { stack.push_back({triangleHigh[found], true}); stack.push_back({triangleLow[found], false}); }
+        // Downwards w->x->u: {x,w} downwards, then {x,u} upwards.
+        else { stack.push_back({triangleLow[found], true}); stack.push_back({triangleHigh[found], false}); }
+    }
+}
+
+// Computes the shortest path with a customized CCH and unpacks it into original edges.
+std::vector<int> Algorithms::customizableCHQuery(const CsrGraph& graph, const CustomizableCH& cch, QueryWorkspace& forward, QueryWorkspace& backward,
+                                                 int startNode, int endNode, double& pathWeight) {
+    // Translate the endpoints to internal indices.
+    int source = graph.internalId(startNode);
+    // Internal index of the target.
+    int target = graph.internalId(endNode);
+    // Peak of the path.
+    int meeting = -1;
+    // Unknown endpoints cannot be connected; otherwise walk the elimination tree.
+    if (source < 0 || target < 0 || (meeting = cch.query(forward, backward, source, target)) < 0) {
+        // Set path weight to infinity if no path found.
+        pathWeight = INF;
+        // Return empty path.
+        return {};
+    }
+    // Path weight is the sum of both halves.
+    pathWeight = forward.distance(meeting) + backward.distance(meeting);
+    // Edges source..meeting, collected backwards.
+    std::vector<int> upwardEdges;
+    // Forward parents are edges whose lower endpoint precedes the labelled node.
+    for (int curr = meeting; forward.parent(curr) != -1; curr = cch.edgeTail[forward.parent(curr)]) upwardEdges.push_back(forward.parent(curr));
+    // Internal nodes of the path.
+    std::vector<int> nodes{source};
+    // Expand the source half in path order.
+    for (auto it = upwardEdges.rbegin(); it != upwardEdges.rend(); ++it) cch.unpackEdge(*it, true, nodes);
+    // Backward parents lead down towards target, already in path order.
+    for (int curr = meeting; backward.parent(curr) != -1; curr = cch.edgeTail[backward.parent(curr)]) cch.unpackEdge(backward.parent(curr), false, nodes);
+    // Translate to external IDs.
+    std::vector<int> path;
+    // Reserve the result.
+    path.reserve(nodes.size());
+    // Translate every node.
+    for (int u : nodes) path.push_back(graph.externalId(u));
+    // Return the path.
+    return path;
+}
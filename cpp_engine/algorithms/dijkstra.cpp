@@ -1,89 +1,99 @@
 #include "../include/algorithms.h"
 #include "../include/graph.h"
+#include "../include/search_kernel.h"
 #include <vector>
-#include <queue>
-#include <map>
 
-// Computes the shortest path from a start node to an end node using Dijkstra's algorithm.
-std::vector<int> Algorithms::dijkstra(const Graph& graph, int startNode, int endNode, double& pathWeight) {
-    // Map to store the minimum distance found so far from startNode to each other node.
-    std::map<int, double> dist;
-    // Map to store the predecessor of each node in the shortest path from startNode.
-    std::map<int, int> prev;
-    // Priority queue to efficiently select the node with the smallest distance. Stores pairs of (distance, nodeId).
-    std::priority_queue<std::pair<double, int>, std::vector<std::pair<double, int>>, std::greater<std::pair<double, int>>> pq;
-
-    // Initialize distances for all nodes.
-    for (int nodeId : graph.getAllNodeIds()) {
-        // Set distance to infinity.
-        dist[nodeId] = INF;
-        // Set predecessor to -1 (undefined).
-        prev[nodeId] = -1;
-    }
-
-    // Distance from startNode to itself is 0.
-    dist[startNode] = 0;
-    // Push the start node into the priority queue with distance 0.
-    pq.push({0, startNode});
-
-    // Main loop of Dijkstra's algorithm.
-    while (!pq.empty()) {
-        // Get the node with the smallest distance from the priority queue.
-        double d = pq.top().first;
-        // Current node being processed.
-        int u = pq.top().second;
-        // Remove the processed node from the priority queue.
-        pq.pop();
-
-        // If a shorter path to u has already been found, skip this iteration.
-        if (d > dist[u]) continue;
-        // If the destination node is reached, stop.
-        if (u == endNode) break;
-
-        // Iterate over all neighbors v of node u.
-        if (graph.nodeExists(u)) {
-            // For each edge (u,v)
-            for (const auto& edge : graph.getEdges(u)) {
-                // Neighbor node ID.
-                int v = edge.to;
-                // Weight of the edge (u,v).
-                double weight = edge.weight;
-                // If a shorter path to v is found through u.
-                if (dist[u] + weight < dist[v]) {
-                    // Update distance to v.
-                    dist[v] = dist[u] + weight;
-                    // Set u as the predecessor of v.
-                    prev[v] = u;
-                    // Push v into the priority queue with its new distance.
-                    pq.push({dist[v], v});
-                }
-            }
-        }
-    }
+// Workspace used by the overloads that do not take one explicitly.
+QueryWorkspace& Algorithms::threadWorkspace() {
+    // One lazily grown workspace per thread.
+    thread_local QueryWorkspace workspace;
+    // Return this thread's workspace.
+    return workspace;
+}
 
-    // Reconstruct the shortest path from endNode back to startNode.
-    std::vector<int> path;
-    // If endNode is unreachable or is the startNode itself without a path (should not happen if dist[endNode] < INF).
-    if (dist[endNode] == INF) {
+// Computes the shortest path from a start node to an end node using Dijkstra's algorithm.
+std::vector<int> Algorithms::dijkstra(const CsrGraph& graph, QueryWorkspace& workspace, int startNode, int endNode, double& pathWeight, QueueKind queue) {
+    // Translate the endpoints to internal indices.
+    int source = graph.internalId(startNode);
+    // Internal index of the target.
+    int target = graph.internalId(endNode);
+    // Unknown endpoints cannot be connected; otherwise search with the zero potential.
+    if (source < 0 || target < 0 || !SearchKernel::runWith(queue, graph, workspace, source, target, SearchKernel::ZeroPotential())) {
         // Set path weight to infinity if no path found.
         pathWeight = INF;
         // Return empty path.
-        return path; // No path found
+        return {};
     }
-    
     // Set the total weight of the found path.
-    pathWeight = dist[endNode];
-    // Start from the end node.
-    int curr = endNode;
-    // Traverse backwards using predecessors until startNode or no predecessor.
-    while (curr != -1) {
-        // Add current node to the path.
-        path.push_back(curr);
-        // Move to the predecessor of the current node.
-        curr = prev[curr];
+    pathWeight = workspace.distance(target);
+    // Reconstruct the path from the parent labels.
+    return workspace.extractPath(graph, target);
+}
+
+// Computes the shortest path between two sets of seeded nodes.
+std::vector<int> Algorithms::dijkstra(const CsrGraph& graph, QueryWorkspace& workspace, const std::vector<SearchSeed>& sources, const std::vector<SearchSeed>& targets, double& pathWeight) {
+    // Start a new query on the labels and the queue.
+    workspace.reset(graph.numNodes());
+    IndexedDaryHeap<4>& queue = workspace.daryQueue;
+    queue.reset(graph.numNodes());
+    // Counts of this search, published when it returns.
+    ROUTE_STATS(Stats::Local counters;)
+    // Seed every known source with its offset (the smaller one if a node is seeded twice).
+    for (const SearchSeed& seed : sources) {
+        int u = graph.internalId(seed.node);
+        if (u < 0 || seed.offset >= workspace.distance(u)) continue;
+        workspace.setLabel(u, seed.offset, -1);
+        queue.push(u, seed.offset);
+        ROUTE_STATS(++counters[Stats::HeapPushes];)
+    }
+    // Targets by internal index.
+    std::vector<std::pair<int, double>> ends;
+    for (const SearchSeed& seed : targets) {
+        int u = graph.internalId(seed.node);
+        if (u >= 0) ends.push_back({u, seed.offset});
+    }
+    // Best total so far and the target it ends at.
+    pathWeight = INF;
+    int best = -1;
+    // Settle nodes until nothing queued can beat the best total.
+    while (!queue.empty()) {
+        // Closest unsettled node.
+        std::pair<double, int> top = queue.pop();
+        ROUTE_STATS(++counters[Stats::HeapPops];)
+        // Offsets are non-negative, so no later target can improve.
+        if (top.first >= pathWeight) break;
+        // A target closes a path here.
+        int u = top.second;
+        for (const std::pair<int, double>& end : ends) {
+            if (end.first == u && top.first + end.second < pathWeight) { pathWeight = top.first + end.second; best = u; }
+        }
+        // Count the node and its edges.
+        ROUTE_STATS(++counters[Stats::NodesSettled]; counters[Stats::EdgesRelaxed] += graph.endEdge(u) - graph.beginEdge(u);)
+        // Relax u's edges.
+        for (int e = graph.beginEdge(u); e < graph.endEdge(u); ++e) {
+            // Candidate distance through u.
+            int v = graph.edgeHead(e);
+            double candidate = top.first + graph.edgeWeight(e);
+            // Improve v.
+            if (candidate < workspace.distance(v)) {
+                workspace.setLabel(v, candidate, u);
+                queue.push(v, candidate);
+                ROUTE_STATS(++counters[Stats::HeapPushes];)
+            }
+        }
     }
-    // Reverse the path to get it from startNode to endNode.
-    std::reverse(path.begin(), path.end());
-    // Return the reconstructed path.
-    return path;
-}
\ No newline at end of file
+    // Path from its seed to the best target, if any target was reached.
+    return best < 0 ? std::vector<int>() : workspace.extractPath(graph, best);
+}
+
+// Computes the shortest path using this thread's workspace.
+std::vector<int> Algorithms::dijkstra(const CsrGraph& graph, int startNode, int endNode, double& pathWeight) {
+    // Run the kernel with the thread-local workspace.
+    return dijkstra(graph, threadWorkspace(), startNode, endNode, pathWeight);
+}
+
+// Computes the shortest path on a mutable Graph by freezing it first.
+std::vector<int> Algorithms::dijkstra(const Graph& graph, int startNode, int endNode, double& pathWeight) {
+    // Run the CSR kernel on a frozen copy.
+    return dijkstra(graph.freeze(), startNode, endNode, pathWeight);
+}
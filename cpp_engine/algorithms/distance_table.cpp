@@ -0,0 +1,196 @@
+#include "../include/algorithms.h"
+#include <algorithm>
+#include <utility>
+
+namespace {
+    // Internal indices of a list of external IDs (-1 for unknown IDs).
+    std::vector<int> internalIds(const CsrGraph& graph, const std::vector<int>& ids) {
+        // One entry per ID.
+        std::vector<int> result(ids.size());
+        // Translate each one.
+        for (size_t i = 0; i < ids.size(); ++i) result[i] = graph.internalId(ids[i]);
+        // Return them.
+        return result;
+    }
+
+    // Distinct known nodes of a list, sorted; slot[i] is the position of list[i] among them (-1 if unknown).
+    std::vector<int> distinctNodes(const std::vector<int>& list, std::vector<int>& slot) {
+        // Known nodes only.
+        std::vector<int> distinct;
+        // Collect them.
+        for (int u : list) if (u >= 0) distinct.push_back(u);
+        // Sort them.
+        std::sort(distinct.begin(), distinct.end());
+        // Drop duplicates.
+        distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+        // Map every entry to its slot.
+        slot.resize(list.size());
+        // Binary search each one.
+        for (size_t i = 0; i < list.size(); ++i) slot[i] = list[i] < 0 ? -1 : static_cast<int>(std::lower_bound(distinct.begin(), distinct.end(), list[i]) - distinct.begin());
+        // Return the distinct nodes.
+        return distinct;
+    }
+
+    // Bucket-based many-to-many (Knopp et al.) over any hierarchy whose upward search spaces meet
+    // on every shortest path. search(workspace, node, backward, settled) runs one upward search and
+    // lists the nodes whose labels are exact.
+    template <typename Search>
+    std::vector<double> bucketTable(const CsrGraph& graph, const std::vector<int>& sourceIds, const std::vector<int>& targetIds, ThreadPool& pool, Search search) {
+        // Number of nodes.
+        const int n = graph.numNodes();
+        // Table dimensions.
+        const size_t rows = sourceIds.size(), columns = targetIds.size();
+        // Result, INF until a path is found.
+        std::vector<double> table(rows * columns, INF);
+        // Internal endpoints.
+        std::vector<int> sources = internalIds(graph, sourceIds), targets = internalIds(graph, targetIds);
+        // Slot of every column among the distinct targets.
+        std::vector<int> slot;
+        // Each distinct target is searched once.
+        std::vector<int> distinct = distinctNodes(targets, slot);
+        // Backward search space of every distinct target: (node, distance to the target).
+        std::vector<std::vector<std::pair<int, double>>> spaces(distinct.size());
+        // Backward searches in parallel.
+        pool.parallelFor(distinct.size(), [&](size_t i, unsigned) {
+            // This thread's scratch.
+            QueryWorkspace& workspace = Algorithms::threadWorkspace();
+            // Settled nodes.
+            std::vector<int> settled;
+            // Search towards the target.
+            search(workspace, distinct[i], true, settled);
+            // Record the search space.
+            spaces[i].reserve(settled.size());
+            for (int u : settled) spaces[i].push_back({u, workspace.distance(u)});
+        });
+        // Offsets of every node's bucket; size N+1.
+        std::vector<int> firstBucket(n + 1, 0);
+        // Count the bucket entries per node (shifted by one for the prefix sum).
+        for (const auto& space : spaces) for (const auto& entry : space) ++firstBucket[entry.first + 1];
+        // Prefix sums turn counts into offsets.
+        for (int u = 0; u < n; ++u) firstBucket[u + 1] += firstBucket[u];
+        // Target slot and distance of every bucket entry.
+        std::vector<int> bucketTarget(firstBucket[n]);
+        std::vector<double> bucketDistance(firstBucket[n]);
+        // Next free entry per node.
+        std::vector<int> next(firstBucket.begin(), firstBucket.end() - 1);
+        // Scatter the search spaces into the buckets.
+        for (size_t i = 0; i < spaces.size(); ++i) {
+            // Every node the target's search settled.
+            for (const auto& entry : spaces[i]) {
+                // Entry position.
+                int at = next[entry.first]++;
+                // Store it.
+                bucketTarget[at] = static_cast<int>(i);
+                bucketDistance[at] = entry.second;
+            }
+            // The search space is no longer needed.
+            std::vector<std::pair<int, double>>().swap(spaces[i]);
+        }
+        // Forward searches in parallel, each scanning the buckets of its search space.
+        pool.parallelFor(rows, [&](size_t row, unsigned) {
+            // Unknown sources reach nothing.
+            if (sources[row] < 0) return;
+            // This thread's scratch.
+            QueryWorkspace& workspace = Algorithms::threadWorkspace();
+            // Settled nodes.
+            std::vector<int> settled;
+            // Search from the source.
+            search(workspace, sources[row], false, settled);
+            // Best distance to every distinct target.
+            std::vector<double> best(distinct.size(), INF);
+            // Every settled node is a potential peak.
+            for (int u : settled) {
+                // Distance from the source.
+                double d = workspace.distance(u);
+                // Combine with every target that reached u.
+                for (int b = firstBucket[u]; b < firstBucket[u + 1]; ++b) best[bucketTarget[b]] = std::min(best[bucketTarget[b]], d + bucketDistance[b]);
+            }
+            // Fill the row.
+            for (size_t column = 0; column < columns; ++column) if (slot[column] >= 0) table[row * columns + column] = best[slot[column]];
+        });
+        // Return the table.
+        return table;
+    }
+}
+
+// One-to-many Dijkstra per source in parallel, each stopping once every target is settled.
+std::vector<double> Algorithms::distanceTable(const CsrGraph& graph, const std::vector<int>& sourceIds, const std::vector<int>& targetIds, ThreadPool& pool) {
+    // Number of nodes.
+    const int n = graph.numNodes();
+    // Table dimensions.
+    const size_t rows = sourceIds.size(), columns = targetIds.size();
+    // Result, INF until a path is found.
+    std::vector<double> table(rows * columns, INF);
+    // Internal endpoints.
+    std::vector<int> sources = internalIds(graph, sourceIds), targets = internalIds(graph, targetIds);
+    // Slot of every column among the distinct targets.
+    std::vector<int> slot;
+    // Targets every search has to settle.
+    std::vector<int> distinct = distinctNodes(targets, slot);
+    // Target flags, shared read-only by all searches.
+    std::vector<char> isTarget(n, 0);
+    // Set them.
+    for (int t : distinct) isTarget[t] = 1;
+    // One search per source.
+    pool.parallelFor(rows, [&](size_t row, unsigned) {
+        // Unknown sources reach nothing.
+        if (sources[row] < 0) return;
+        // This thread's scratch.
+        QueryWorkspace& workspace = threadWorkspace();
+        // Its heap.
+        IndexedDaryHeap<4>& queue = workspace.daryQueue;
+        // Start a new search.
+        workspace.reset(n);
+        queue.reset(n);
+        // Seed it.
+        workspace.setLabel(sources[row], 0, -1);
+        queue.push(sources[row], 0);
+        // Targets not settled yet.
+        size_t remaining = distinct.size();
+        // Settle nodes until every target is settled or nothing is left.
+        while (remaining > 0 && !queue.empty()) {
+            // Closest unsettled node.
+            std::pair<double, int> top = queue.pop();
+            // Count settled targets.
+            if (isTarget[top.second]) --remaining;
+            // Relax the outgoing edges.
+            for (int e = graph.beginEdge(top.second); e < graph.endEdge(top.second); ++e) {
+                // Candidate distance.
+                double candidate = top.first + graph.edgeWeight(e);
+                // Improve the label.
+                if (candidate < workspace.distance(graph.edgeHead(e))) {
+                    // Record it.
+                    workspace.setLabel(graph.edgeHead(e), candidate, top.second);
+                    // Queue the node.
+                    queue.push(graph.edgeHead(e), candidate);
+                }
+            }
+        }
+        // Settled targets carry their distance; unreached ones stay INF.
+        for (size_t column = 0; column < columns; ++column) if (targets[column] >= 0) table[row * columns + column] = workspace.distance(targets[column]);
+    });
+    // Return the table.
+    return table;
+}
+
+// Bucket-based many-to-many on a contraction hierarchy.
+std::vector<double> Algorithms::distanceTable(const CsrGraph& graph, const ContractionHierarchy& ch, const std::vector<int>& sourceIds,
+                                              const std::vector<int>& targetIds, ThreadPool& pool) {
+    // Upward searches with stall-on-demand.
+    return bucketTable(graph, sourceIds, targetIds, pool, [&ch](QueryWorkspace& workspace, int node, bool backward, std::vector<int>& settled) {
+        // Settle the search space.
+        ch.upwardSearch(workspace, node, backward, settled);
+    });
+}
+
+// Bucket-based many-to-many on a customized CCH.
+std::vector<double> Algorithms::distanceTable(const CsrGraph& graph, const CustomizableCH& cch, const std::vector<int>& sourceIds,
+                                              const std::vector<int>& targetIds, ThreadPool& pool) {
+    // Elimination tree walks.
+    return bucketTable(graph, sourceIds, targetIds, pool, [&cch](QueryWorkspace& workspace, int node, bool backward, std::vector<int>& settled) {
+        // Start from an empty list.
+        settled.clear();
+        // Walk the ancestors.
+        cch.upwardSearch(workspace, node, backward, &settled);
+    });
+}
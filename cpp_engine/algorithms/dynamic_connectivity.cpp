@@ -0,0 +1,591 @@
+#include "../include/dynamic_connectivity.h"
+#include "../include/union_find.h"
+#include <algorithm>
+#include <climits>
+
+namespace {
+    // Nodes handed to a worker at a time when the spanning forest is built.
+    const size_t CHUNK_SIZE = 1024;
+}
+
+// Builds the structure for a graph.
+DynamicConnectivity::DynamicConnectivity(const CsrGraph& graph, std::vector<int>& handles, ThreadPool& pool) {
+    // Number of nodes and edges.
+    const int n = graph.numNodes();
+    const int m = graph.numEdges();
+    // Slots follow the graph's internal indices.
+    ids.assign(graph.ids.begin(), graph.ids.end());
+    slotOf.reserve(n);
+    for (int u = 0; u < n; ++u) slotOf[ids[u]] = u;
+    // Every node starts alone.
+    components = n;
+    // Room for every occurrence and tree entry of level 0.
+    nodes.reserve(static_cast<size_t>(n) * 3);
+    // Occurrences of level 0.
+    Level& base = levelAt(0);
+    for (int u = 0; u < n; ++u) base.occurrence[u] = newNode(u, -1);
+    // Spanning forest: an edge joins it iff its unite is the one that merged two sets.
+    std::vector<char> inForest(m, 0);
+    ConcurrentDisjointSets forest(n);
+    pool.parallelFor((static_cast<size_t>(n) + CHUNK_SIZE - 1) / CHUNK_SIZE, [&](size_t chunk, unsigned) {
+        // Nodes of this chunk.
+        int end = static_cast<int>(std::min(static_cast<size_t>(n), (chunk + 1) * CHUNK_SIZE));
+        for (int u = static_cast<int>(chunk * CHUNK_SIZE); u < end; ++u) {
+            // Every outgoing edge other than self-loops.
+            for (int e = graph.beginEdge(u); e < graph.endEdge(u); ++e) if (graph.edgeHead(e) != u && forest.unite(u, graph.edgeHead(e))) inForest[e] = 1;
+        }
+    });
+    // One link per edge; tree links are counted per node for the tour walk, the rest are filed as non-tree links.
+    handles.assign(m, -1);
+    links.reserve(m);
+    std::vector<int> firstTree(n + 1, 0);
+    for (int u = 0; u < n; ++u) {
+        // Outgoing edges.
+        for (int e = graph.beginEdge(u); e < graph.endEdge(u); ++e) {
+            // Self-loops never matter.
+            int v = graph.edgeHead(e);
+            if (v == u) continue;
+            // New link.
+            handles[e] = static_cast<int>(links.size());
+            links.push_back(Link{u, v});
+            // Tree link: one component fewer.
+            if (inForest[e]) {
+                links.back().tree = true;
+                --components;
+                ++firstTree[u + 1];
+                ++firstTree[v + 1];
+            } else {
+                // Non-tree link of level 0.
+                addNonTree(handles[e]);
+            }
+        }
+    }
+    // Tree adjacency (neighbor, link) of every node.
+    for (int u = 0; u < n; ++u) firstTree[u + 1] += firstTree[u];
+    std::vector<std::pair<int, int>> treeAdjacency(firstTree[n]);
+    std::vector<int> next(firstTree.begin(), firstTree.end() - 1);
+    for (int h = 0; h < static_cast<int>(links.size()); ++h) {
+        // Both directions of every tree link.
+        if (!links[h].tree) continue;
+        treeAdjacency[next[links[h].u]++] = {links[h].v, h};
+        treeAdjacency[next[links[h].v]++] = {links[h].u, h};
+    }
+    // Euler tour of every tree: occurrence at the first visit, one entry down and one entry up per link.
+    std::vector<char> visited(n, 0);
+    std::vector<int> tour;
+    // DFS frames: node, next adjacency position, link it was entered by.
+    struct Frame { int node; int position; int via; };
+    std::vector<Frame> stack;
+    // Treap construction stack and post-order scratch.
+    std::vector<int> spine, order;
+    for (int r = 0; r < n; ++r) {
+        // Already in a tour.
+        if (visited[r]) continue;
+        // Walk the tree of r.
+        tour.assign(1, base.occurrence[r]);
+        visited[r] = 1;
+        stack.push_back({r, firstTree[r], -1});
+        while (!stack.empty()) {
+            // Current frame.
+            Frame& frame = stack.back();
+            // Unvisited tree neighbor: go down.
+            if (frame.position < firstTree[frame.node + 1]) {
+                // Neighbor and link.
+                std::pair<int, int> step = treeAdjacency[frame.position++];
+                // The parent side.
+                if (visited[step.first]) continue;
+                visited[step.first] = 1;
+                // Entry down, then the child's occurrence.
+                int down = newNode(-1, step.second);
+                nodes[down].ownTree = true;
+                tour.push_back(down);
+                tour.push_back(levelData[0].occurrence[step.first]);
+                links[step.second].arcs.assign(1, {down, -1});
+                // Descend (invalidates frame).
+                stack.push_back({step.first, firstTree[step.first], step.second});
+            } else {
+                // Done with the node: entry back up.
+                int via = frame.via;
+                stack.pop_back();
+                if (via >= 0) {
+                    int up = newNode(-1, via);
+                    tour.push_back(up);
+                    links[via].arcs[0].second = up;
+                }
+            }
+        }
+        // Cartesian tree of the tour by priority (a treap in O(length)).
+        spine.clear();
+        for (int x : tour) {
+            // Pop the entries with lower priority; they become x's left subtree.
+            int last = -1;
+            while (!spine.empty() && nodes[spine.back()].priority < nodes[x].priority) { last = spine.back(); spine.pop_back(); }
+            nodes[x].left = last;
+            if (last >= 0) nodes[last].parent = x;
+            // x is the right child of the remaining top.
+            if (!spine.empty()) { nodes[spine.back()].right = x; nodes[x].parent = spine.back(); }
+            spine.push_back(x);
+        }
+        // Aggregates bottom-up: children come after their parents in a preorder, so walk it backwards.
+        order.assign(1, spine.front());
+        for (size_t i = 0; i < order.size(); ++i) {
+            // Children of the next entry.
+            if (nodes[order[i]].left >= 0) order.push_back(nodes[order[i]].left);
+            if (nodes[order[i]].right >= 0) order.push_back(nodes[order[i]].right);
+        }
+        for (size_t i = order.size(); i-- > 0;) update(order[i]);
+    }
+}
+
+// Adds a node as its own component.
+void DynamicConnectivity::addNode(int id) {
+    // Creates it if unknown.
+    slot(id);
+}
+
+// Links a and b.
+int DynamicConnectivity::link(int a, int b) {
+    // Slots of both ends.
+    int u = slot(a), v = slot(b);
+    // Self-loops do not connect anything.
+    if (u == v) return -1;
+    // New link of level 0.
+    int handle = static_cast<int>(links.size());
+    links.push_back(Link{u, v});
+    // Different components: it joins the spanning forest.
+    if (!connectedAt(0, u, v)) {
+        links[handle].tree = true;
+        linkAt(0, handle);
+        --components;
+    } else {
+        // Otherwise it is a spare.
+        addNonTree(handle);
+    }
+    // Its handle.
+    return handle;
+}
+
+// Links many pairs at once.
+std::vector<int> DynamicConnectivity::linkBatch(const std::vector<std::pair<int, int>>& pairs, ThreadPool& pool) {
+    // Handles in pair order.
+    std::vector<int> handles(pairs.size(), -1);
+    // Small batches are cheaper one by one.
+    if (pairs.size() < CHUNK_SIZE) {
+        for (size_t i = 0; i < pairs.size(); ++i) handles[i] = link(pairs[i].first, pairs[i].second);
+        return handles;
+    }
+    // Slots of both ends (unknown IDs become singletons first, serially).
+    std::vector<std::pair<int, int>> slots(pairs.size());
+    for (size_t i = 0; i < pairs.size(); ++i) slots[i] = {slot(pairs[i].first), slot(pairs[i].second)};
+    // Tour of both ends in forest 0; climbing the treaps only reads them, so chunks run in parallel.
+    const size_t chunks = (pairs.size() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    std::vector<std::pair<int, int>> tours(pairs.size());
+    const std::vector<int>& occurrence = levelData[0].occurrence;
+    pool.parallelFor(chunks, [&](size_t chunk, unsigned) {
+        size_t end = std::min(pairs.size(), (chunk + 1) * CHUNK_SIZE);
+        for (size_t i = chunk * CHUNK_SIZE; i < end; ++i) tours[i] = {rootOf(occurrence[slots[i].first]), rootOf(occurrence[slots[i].second])};
+    });
+    // Dense index of every tour touched.
+    std::unordered_map<int, int> dense;
+    dense.reserve(2 * pairs.size());
+    for (auto& tour : tours) {
+        tour.first = dense.emplace(tour.first, static_cast<int>(dense.size())).first->second;
+        tour.second = dense.emplace(tour.second, static_cast<int>(dense.size())).first->second;
+    }
+    // Spanning forest over the tours: a pair joins it iff its unite is the one that merged two sets.
+    std::vector<char> inForest(pairs.size(), 0);
+    ConcurrentDisjointSets forest(static_cast<int>(dense.size()));
+    pool.parallelFor(chunks, [&](size_t chunk, unsigned) {
+        size_t end = std::min(pairs.size(), (chunk + 1) * CHUNK_SIZE);
+        for (size_t i = chunk * CHUNK_SIZE; i < end; ++i) if (forest.unite(tours[i].first, tours[i].second)) inForest[i] = 1;
+    });
+    // Create the links in pair order; forest links join two different trees, the rest are spares.
+    links.reserve(links.size() + pairs.size());
+    for (size_t i = 0; i < pairs.size(); ++i) {
+        // Self-loops do not connect anything.
+        int u = slots[i].first, v = slots[i].second;
+        if (u == v) continue;
+        // New link of level 0.
+        int handle = static_cast<int>(links.size());
+        links.push_back(Link{u, v});
+        handles[i] = handle;
+        if (inForest[i]) {
+            links[handle].tree = true;
+            linkAt(0, handle);
+            --components;
+        } else {
+            addNonTree(handle);
+        }
+    }
+    // Their handles.
+    return handles;
+}
+
+// Removes a link.
+void DynamicConnectivity::cut(int handle) {
+    // Self-loop handle or already removed.
+    if (handle < 0 || !links[handle].live) return;
+    links[handle].live = false;
+    // Spares just leave their lists.
+    if (!links[handle].tree) { removeNonTree(handle); return; }
+    // Tree link: cut it from every forest it is in.
+    int level = links[handle].level;
+    for (int i = 0; i <= level; ++i) cutAt(i, handle);
+    links[handle].arcs.clear();
+    // Without a replacement the component falls apart.
+    if (!replace(links[handle].u, links[handle].v, level)) ++components;
+}
+
+// Whether a and b are in the same component.
+bool DynamicConnectivity::connected(int a, int b) {
+    // Everything is connected to itself.
+    if (a == b) return true;
+    // Unknown IDs are isolated.
+    auto ia = slotOf.find(a), ib = slotOf.find(b);
+    if (ia == slotOf.end() || ib == slotOf.end()) return false;
+    // Same tree of F_0.
+    return connectedAt(0, ia->second, ib->second);
+}
+
+// Smallest node ID in the component of id.
+int DynamicConnectivity::representative(int id) {
+    // Unknown IDs are their own component.
+    auto it = slotOf.find(id);
+    if (it == slotOf.end()) return id;
+    // Aggregate of the tour root.
+    return nodes[rootOf(occurrenceAt(0, it->second))].minId;
+}
+
+// New treap entry.
+int DynamicConnectivity::newNode(int vertex, int edge) {
+    // Reuse a freed entry if possible.
+    int x;
+    if (!freeNodes.empty()) { x = freeNodes.back(); freeNodes.pop_back(); }
+    else { x = static_cast<int>(nodes.size()); nodes.emplace_back(); }
+    // Fresh singleton.
+    TourNode& node = nodes[x];
+    node = TourNode();
+    node.priority = static_cast<uint32_t>(random());
+    node.vertex = vertex;
+    node.edge = edge;
+    node.vertices = vertex >= 0 ? 1 : 0;
+    node.minId = vertex >= 0 ? ids[vertex] : INT_MAX;
+    return x;
+}
+
+// Returns an entry to the free list.
+void DynamicConnectivity::freeNode(int x) {
+    // Forget it.
+    nodes[x] = TourNode();
+    freeNodes.push_back(x);
+}
+
+// Recomputes the aggregates of x from its children.
+void DynamicConnectivity::update(int x) {
+    // Entry and children.
+    TourNode& node = nodes[x];
+    // Own contribution.
+    node.size = 1;
+    node.vertices = node.vertex >= 0 ? 1 : 0;
+    node.subTree = node.ownTree;
+    node.subNonTree = node.ownNonTree;
+    node.minId = node.vertex >= 0 ? ids[node.vertex] : INT_MAX;
+    // Children's.
+    for (int child : {node.left, node.right}) {
+        if (child < 0) continue;
+        const TourNode& c = nodes[child];
+        node.size += c.size;
+        node.vertices += c.vertices;
+        node.subTree = node.subTree || c.subTree;
+        node.subNonTree = node.subNonTree || c.subNonTree;
+        node.minId = std::min(node.minId, c.minId);
+    }
+}
+
+// Recomputes the aggregates from x up to its root.
+void DynamicConnectivity::refresh(int x) {
+    // Every ancestor.
+    for (; x >= 0; x = nodes[x].parent) update(x);
+}
+
+// Concatenates two treaps (roots or -1).
+int DynamicConnectivity::merge(int a, int b) {
+    // One side empty.
+    if (a < 0) return b;
+    if (b < 0) return a;
+    // Higher priority on top.
+    if (nodes[a].priority > nodes[b].priority) {
+        // a stays the root; b goes into its right subtree.
+        int right = merge(nodes[a].right, b);
+        nodes[a].right = right;
+        nodes[right].parent = a;
+        update(a);
+        nodes[a].parent = -1;
+        return a;
+    }
+    // b stays the root; a goes into its left subtree.
+    int left = merge(a, nodes[b].left);
+    nodes[b].left = left;
+    nodes[left].parent = b;
+    update(b);
+    nodes[b].parent = -1;
+    return b;
+}
+
+// Splits the treap rooted at t into its first count entries (a) and the rest (b).
+void DynamicConnectivity::split(int t, int count, int& a, int& b) {
+    // Empty.
+    if (t < 0) { a = b = -1; return; }
+    // Entries left of t.
+    int leftSize = nodes[t].left >= 0 ? nodes[nodes[t].left].size : 0;
+    if (count <= leftSize) {
+        // The cut is in the left subtree; t and its right subtree go to b.
+        int rest;
+        split(nodes[t].left, count, a, rest);
+        nodes[t].left = rest;
+        if (rest >= 0) nodes[rest].parent = t;
+        update(t);
+        b = t;
+    } else {
+        // The cut is in the right subtree; t and its left subtree go to a.
+        int rest;
+        split(nodes[t].right, count - leftSize - 1, rest, b);
+        nodes[t].right = rest;
+        if (rest >= 0) nodes[rest].parent = t;
+        update(t);
+        a = t;
+    }
+    // Both pieces are roots now.
+    if (a >= 0) nodes[a].parent = -1;
+    if (b >= 0) nodes[b].parent = -1;
+}
+
+// Root of the treap containing x.
+int DynamicConnectivity::rootOf(int x) const {
+    // Climb.
+    while (nodes[x].parent >= 0) x = nodes[x].parent;
+    return x;
+}
+
+// Position of x in its tour.
+int DynamicConnectivity::rankOf(int x) const {
+    // Entries left of x in its own subtree.
+    int rank = nodes[x].left >= 0 ? nodes[nodes[x].left].size : 0;
+    // Plus everything left of each ancestor x hangs right of.
+    for (int p = nodes[x].parent; p >= 0; x = p, p = nodes[p].parent) {
+        if (nodes[p].right == x) rank += 1 + (nodes[p].left >= 0 ? nodes[nodes[p].left].size : 0);
+    }
+    return rank;
+}
+
+// Level i, created (and grown to the current node count) on demand.
+DynamicConnectivity::Level& DynamicConnectivity::levelAt(int level) {
+    // New levels.
+    while (static_cast<int>(levelData.size()) <= level) levelData.emplace_back();
+    // Nodes added since the level was last used.
+    Level& data = levelData[level];
+    if (data.occurrence.size() < ids.size()) {
+        data.occurrence.resize(ids.size(), -1);
+        data.nonTree.resize(ids.size());
+    }
+    return data;
+}
+
+// Occurrence of slot v at level i.
+int DynamicConnectivity::occurrenceAt(int level, int v) {
+    // Existing one.
+    int x = levelAt(level).occurrence[v];
+    if (x >= 0) return x;
+    // New singleton tour.
+    x = newNode(v, -1);
+    levelData[level].occurrence[v] = x;
+    return x;
+}
+
+// Rotates x's tour so that x comes first.
+int DynamicConnectivity::reroot(int x) {
+    // Tour and position of x.
+    int root = rootOf(x);
+    int rank = rankOf(x);
+    // Already first.
+    if (rank == 0) return root;
+    // [before x][x ...] becomes [x ...][before x].
+    int before, after;
+    split(root, rank, before, after);
+    return merge(after, before);
+}
+
+// Whether slots u and v are connected in forest i.
+bool DynamicConnectivity::connectedAt(int level, int u, int v) {
+    // Trivially.
+    if (u == v) return true;
+    // Nodes without an occurrence at this level are alone in it.
+    Level& data = levelAt(level);
+    if (data.occurrence[u] < 0 || data.occurrence[v] < 0) return false;
+    // Same tour.
+    return rootOf(data.occurrence[u]) == rootOf(data.occurrence[v]);
+}
+
+// Adds tree link h to forest i.
+void DynamicConnectivity::linkAt(int level, int handle) {
+    // Endpoints' tours, rotated to start at them.
+    int u = links[handle].u, v = links[handle].v;
+    int tourU = reroot(occurrenceAt(level, u));
+    int tourV = reroot(occurrenceAt(level, v));
+    // Entries for both directions; the first one carries the link at its own level.
+    int down = newNode(-1, handle), up = newNode(-1, handle);
+    nodes[down].ownTree = links[handle].level == level;
+    update(down);
+    // [u ...] (u -> v) [v ...] (v -> u).
+    merge(merge(merge(tourU, down), tourV), up);
+    // Remember the entries.
+    if (static_cast<int>(links[handle].arcs.size()) <= level) links[handle].arcs.resize(level + 1, {-1, -1});
+    links[handle].arcs[level] = {down, up};
+}
+
+// Removes tree link h from forest i.
+void DynamicConnectivity::cutAt(int level, int handle) {
+    // Its two entries, in tour order.
+    int first = links[handle].arcs[level].first, second = links[handle].arcs[level].second;
+    int root = rootOf(first);
+    int p = rankOf(first), q = rankOf(second);
+    if (p > q) std::swap(p, q);
+    // [A] first [B] second [C]: B is one side, A + C the other.
+    int a, rest, x, b, y, c;
+    split(root, p, a, rest);
+    split(rest, 1, x, rest);
+    split(rest, q - p - 1, b, rest);
+    split(rest, 1, y, c);
+    merge(a, c);
+    // Drop the link's entries.
+    freeNode(x);
+    freeNode(y);
+    links[handle].arcs[level] = {-1, -1};
+}
+
+// Files a non-tree link under both endpoints at its level.
+void DynamicConnectivity::addNonTree(int handle) {
+    // Level and endpoints.
+    Link& link = links[handle];
+    Level& data = levelAt(link.level);
+    // Append to both lists.
+    link.positionU = static_cast<int>(data.nonTree[link.u].size());
+    data.nonTree[link.u].push_back(handle);
+    link.positionV = static_cast<int>(data.nonTree[link.v].size());
+    data.nonTree[link.v].push_back(handle);
+    // Flag both occurrences.
+    setNonTreeFlag(link.level, link.u);
+    setNonTreeFlag(link.level, link.v);
+}
+
+// Removes a non-tree link from both endpoints' lists.
+void DynamicConnectivity::removeNonTree(int handle) {
+    // Level and endpoints.
+    int level = links[handle].level;
+    for (int side = 0; side < 2; ++side) {
+        // Endpoint and position on this side.
+        int x = side == 0 ? links[handle].u : links[handle].v;
+        int position = side == 0 ? links[handle].positionU : links[handle].positionV;
+        std::vector<int>& list = levelAt(level).nonTree[x];
+        // Move the last link into the hole.
+        int moved = list.back();
+        list[position] = moved;
+        if (links[moved].u == x) links[moved].positionU = position; else links[moved].positionV = position;
+        list.pop_back();
+        // Clear the flag if that was the last one.
+        setNonTreeFlag(level, x);
+    }
+    // Not filed anywhere.
+    links[handle].positionU = links[handle].positionV = -1;
+}
+
+// Updates the non-tree flag of slot v's occurrence at level i.
+void DynamicConnectivity::setNonTreeFlag(int level, int v) {
+    // Occurrence and desired flag.
+    int x = occurrenceAt(level, v);
+    bool flag = !levelData[level].nonTree[v].empty();
+    // Propagate changes to the root.
+    if (nodes[x].ownNonTree != flag) {
+        nodes[x].ownNonTree = flag;
+        refresh(x);
+    }
+}
+
+// First flagged entry of a treap, or -1.
+int DynamicConnectivity::findFlagged(int root, bool tree) const {
+    // Flag of a subtree.
+    auto sub = [&](int x) { return x >= 0 && (tree ? nodes[x].subTree : nodes[x].subNonTree); };
+    // Nothing flagged.
+    if (!sub(root)) return -1;
+    // Descend towards the leftmost flagged entry.
+    int x = root;
+    while (true) {
+        // Flagged entries on the left come first.
+        if (sub(nodes[x].left)) { x = nodes[x].left; continue; }
+        // Then x itself.
+        if (tree ? nodes[x].ownTree : nodes[x].ownNonTree) return x;
+        // Otherwise it is on the right.
+        x = nodes[x].right;
+    }
+}
+
+// Looks for a replacement link between the trees of u and v, from maxLevel down to 0.
+bool DynamicConnectivity::replace(int u, int v, int maxLevel) {
+    // Highest level first.
+    for (int level = maxLevel; level >= 0; --level) {
+        // Both halves at this level; search the smaller one.
+        int rootU = rootOf(occurrenceAt(level, u)), rootV = rootOf(occurrenceAt(level, v));
+        int small = nodes[rootU].vertices <= nodes[rootV].vertices ? rootU : rootV;
+        // Its tree links of this level move up, so the half is one tree of the next level too.
+        for (int x; (x = findFlagged(small, true)) >= 0;) {
+            // Link of the entry.
+            int handle = nodes[x].edge;
+            // Unmark it here.
+            nodes[x].ownTree = false;
+            refresh(x);
+            // Raise it and add it to the next forest.
+            links[handle].level = level + 1;
+            linkAt(level + 1, handle);
+        }
+        // Try its non-tree links of this level one by one.
+        for (int x; (x = findFlagged(small, false)) >= 0;) {
+            // Node with non-tree links.
+            int w = nodes[x].vertex;
+            // Every one of them.
+            while (!levelData[level].nonTree[w].empty()) {
+                // Next link and its far end.
+                int handle = levelData[level].nonTree[w].back();
+                int other = links[handle].u == w ? links[handle].v : links[handle].u;
+                // Take it off this level.
+                removeNonTree(handle);
+                // Both ends in the small half: raise it (the half is connected one level up).
+                if (rootOf(occurrenceAt(level, other)) == small) {
+                    links[handle].level = level + 1;
+                    addNonTree(handle);
+                    continue;
+                }
+                // It reconnects the halves: it becomes a tree link of this level.
+                links[handle].tree = true;
+                for (int i = 0; i <= level; ++i) linkAt(i, handle);
+                return true;
+            }
+        }
+    }
+    // The component is split.
+    return false;
+}
+
+// Dense slot of an external ID.
+int DynamicConnectivity::slot(int id) {
+    // Known ID.
+    auto it = slotOf.find(id);
+    if (it != slotOf.end()) return it->second;
+    // New singleton component.
+    int s = static_cast<int>(ids.size());
+    ids.push_back(id);
+    slotOf[id] = s;
+    ++components;
+    // Its level-0 occurrence.
+    occurrenceAt(0, s);
+    return s;
+}
@@ -1,83 +1,214 @@
 #include "../include/algorithms.h"
 #include "../include/graph.h"
+#include <algorithm>
+#include <cstring>
 #include <vector>
 #include <map>
+#include <cstddef> // For size_t
 
-// Computes all-pairs shortest paths using Floyd-Warshall algorithm.
-std::map<int, std::map<int, double>> Algorithms::floydWarshall(const Graph& graph, std::map<int, std::map<int, int>>& predecessors) {
-    // Map to store shortest distances between pairs of nodes. dist[i][j] is distance from i to j.
-    std::map<int, std::map<int, double>> dist;
-    // Get all node IDs from the graph.
-    std::vector<int> nodeIds = graph.getAllNodeIds();
-    // Get the number of nodes.
-    int numNodes = nodeIds.size();
-    // Map node IDs to 0-based indices for easier array-like access if preferred, but direct map usage is fine.
-    std::map<int, int> nodeToIndex;
-    // Map 0-based indices back to node IDs.
-    std::vector<int> indexToNode(numNodes);
+namespace {
+    // Edge length of the square tiles; a tile of each operand (64x64 doubles = 32 KB) stays in L2.
+    constexpr int TILE = 64;
+
+#if defined(__GNUC__)
+    // Vector width of the min-plus kernel: AVX registers when the build targets them (see the
+    // ROUTE_ENGINE_NATIVE option), the SSE2/NEON baseline otherwise.
+#if defined(__AVX__)
+    constexpr int VECTOR_BYTES = 32;
+#else
+    constexpr int VECTOR_BYTES = 16;
+#endif
+    // SIMD lanes via GCC/Clang vector extensions.
+    template <typename T> struct Lanes;
+    // Floats; their int32 predecessors fill a vector of the same width.
+    template <> struct Lanes<float> {
+        typedef float Dist __attribute__((vector_size(VECTOR_BYTES)));
+        typedef int Pred __attribute__((vector_size(VECTOR_BYTES)));
+        static constexpr int count = VECTOR_BYTES / sizeof(float);
+    };
+    // Doubles; their int32 predecessors fill half a vector.
+    template <> struct Lanes<double> {
+        typedef double Dist __attribute__((vector_size(VECTOR_BYTES)));
+        typedef int Pred __attribute__((vector_size(VECTOR_BYTES / 2)));
+        static constexpr int count = VECTOR_BYTES / sizeof(double);
+    };
+#endif
 
-    // Populate mapping from node ID to index and vice versa.
-    for (int i = 0; i < numNodes; ++i) {
-        // Map node ID to its index.
-        nodeToIndex[nodeIds[i]] = i;
-        // Map index back to its node ID.
-        indexToNode[i] = nodeIds[i];
+    // Relaxes row[j] through node k for j in [0, width): row[j] = min(row[j], dik + rowK[j]), taking
+    // the predecessor from the row of k wherever the path through k is shorter. width is a
+    // multiple of the lane count.
+    template <typename T>
+    void relaxRow(T* row, int* predRow, const T* rowK, const int* predK, T dik, int width) {
+#if defined(__GNUC__)
+        // Vector types of this precision.
+        typedef typename Lanes<T>::Dist Dist;
+        typedef typename Lanes<T>::Pred Pred;
+        // One vector of lanes per step.
+        for (int j = 0; j < width; j += Lanes<T>::count) {
+            // Load the operands (memcpy keeps unaligned loads well-defined).
+            Dist d, k;
+            Pred p, pk;
+            std::memcpy(&d, row + j, sizeof(d));
+            std::memcpy(&k, rowK + j, sizeof(k));
+            std::memcpy(&p, predRow + j, sizeof(p));
+            std::memcpy(&pk, predK + j, sizeof(pk));
+            // Candidate lengths through k.
+            Dist candidate = k + dik;
+            // Lanes where the candidate is shorter.
+            auto better = candidate < d;
+            // Blend the distances.
+            d = better ? candidate : d;
+            // Narrow the mask to the predecessor lanes and blend them.
+            p = __builtin_convertvector(better, Pred) ? pk : p;
+            // Store the results.
+            std::memcpy(row + j, &d, sizeof(d));
+            std::memcpy(predRow + j, &p, sizeof(p));
+        }
+#else
+        // Portable scalar kernel.
+        for (int j = 0; j < width; ++j) {
+            // Candidate length through k.
+            T candidate = dik + rowK[j];
+            // Keep the shorter path.
+            if (candidate < row[j]) { row[j] = candidate; predRow[j] = predK[j]; }
+        }
+#endif
     }
 
-    // Initialize distances and predecessors.
-    for (int u_id : nodeIds) {
-        // For each node v_id.
-        for (int v_id : nodeIds) {
-            // If u_id is the same as v_id, distance is 0.
-            if (u_id == v_id) {
-                // Distance from a node to itself is 0.
-                dist[u_id][v_id] = 0;
-                // Predecessor of v_id in path from u_id is u_id itself.
-                predecessors[u_id][v_id] = u_id;
-            } else {
-                // Initialize distance to infinity.
-                dist[u_id][v_id] = INF;
-                // Initialize predecessor to -1 (no path yet).
-                predecessors[u_id][v_id] = -1;
+    // Relaxes tile (ti, tj) through the intermediate nodes of tile column tk.
+    template <typename T>
+    void relaxTile(DistanceMatrix<T>& matrix, int ti, int tj, int tk) {
+        // Number of nodes; tiles past the last row or intermediate node are cut short.
+        const int n = matrix.size();
+        // Row range of the tile.
+        const int iBegin = ti * TILE, iEnd = std::min(n, iBegin + TILE);
+        // Intermediate nodes.
+        const int kBegin = tk * TILE, kEnd = std::min(n, kBegin + TILE);
+        // First column (the padded columns are INF, so the full tile width is always valid).
+        const size_t j0 = static_cast<size_t>(tj) * TILE;
+        // One intermediate node at a time, in order, as in the plain algorithm.
+        for (int k = kBegin; k < kEnd; ++k) {
+            // Row of the intermediate node.
+            const T* rowK = matrix.dist.data() + static_cast<size_t>(k) * matrix.stride + j0;
+            // Its predecessors.
+            const int* predK = matrix.pred.data() + static_cast<size_t>(k) * matrix.stride + j0;
+            // Every row of the tile.
+            for (int i = iBegin; i < iEnd; ++i) {
+                // Start of row i.
+                size_t row = static_cast<size_t>(i) * matrix.stride;
+                // Distance from i to the intermediate node.
+                T dik = matrix.dist[row + k];
+                // Nothing to relax through an unreachable intermediate node.
+                if (dik == static_cast<T>(INF)) continue;
+                // Relax the tile's part of row i.
+                relaxRow(matrix.dist.data() + row + j0, matrix.pred.data() + row + j0, rowK, predK, dik, TILE);
             }
         }
     }
+}
 
+// Computes all-pairs shortest paths into a dense matrix with a tiled Floyd-Warshall.
+template <typename T>
+DistanceMatrix<T> Algorithms::floydWarshallMatrix(const CsrGraph& graph, ThreadPool& pool) {
+    // Get the number of nodes.
+    const int n = graph.numNodes();
+    // Result.
+    DistanceMatrix<T> matrix;
+    // Rows and columns in internal order.
+    matrix.ids.assign(graph.ids.begin(), graph.ids.end());
+    // Tiles per row and column.
+    const int tiles = (n + TILE - 1) / TILE;
+    // Pad every row to whole tiles.
+    matrix.stride = static_cast<size_t>(tiles) * TILE;
+    // No paths yet.
+    matrix.dist.assign(static_cast<size_t>(n) * matrix.stride, static_cast<T>(INF));
+    // No predecessors yet (-1 means no path).
+    matrix.pred.assign(static_cast<size_t>(n) * matrix.stride, -1);
+    // Initialize the diagonal.
+    for (int i = 0; i < n; ++i) {
+        // Distance from a node to itself is 0.
+        matrix.dist[static_cast<size_t>(i) * matrix.stride + i] = 0;
+        // Predecessor of i in the path from i is i itself.
+        matrix.pred[static_cast<size_t>(i) * matrix.stride + i] = i;
+    }
     // Initialize distances with direct edge weights.
-    for (int u_id : nodeIds) {
-        // Check if node u_id exists in graph (should always be true here).
-        if (graph.nodeExists(u_id)) {
-            // For each edge starting from u_id.
-            for (const auto& edge : graph.getEdges(u_id)) {
-                // The destination node of the edge.
-                int v_id = edge.to;
-                // The weight of the edge.
-                double weight = edge.weight;
+    for (int u = 0; u < n; ++u) {
+        // For each edge starting from u.
+        for (int e = graph.beginEdge(u); e < graph.endEdge(u); ++e) {
+            // Cell for the edge's endpoints.
+            size_t cell = static_cast<size_t>(u) * matrix.stride + graph.edgeHead(e);
+            // Weight in the matrix precision.
+            T weight = static_cast<T>(graph.edgeWeight(e));
+            // Keep the lightest of any parallel edges.
+            if (weight < matrix.dist[cell]) {
                 // Set the direct distance.
-                dist[u_id][v_id] = weight;
-                // Predecessor of v_id in path from u_id is u_id.
-                predecessors[u_id][v_id] = u_id;
+                matrix.dist[cell] = weight;
+                // Predecessor of the target in the path from u is u.
+                matrix.pred[cell] = u;
             }
         }
     }
+    // One round per tile of intermediate nodes.
+    for (int tk = 0; tk < tiles; ++tk) {
+        // Phase 1: the diagonal tile only depends on itself.
+        relaxTile(matrix, tk, tk, tk);
+        // Phase 2: the other tiles of row tk and column tk only depend on themselves and the diagonal tile.
+        pool.parallelFor(2 * static_cast<size_t>(tiles - 1), [&](size_t item, unsigned) {
+            // Position along the row or column, skipping the diagonal.
+            int other = static_cast<int>(item / 2);
+            // Shift past the diagonal.
+            if (other >= tk) ++other;
+            // Even items are row tiles, odd items column tiles.
+            if (item % 2 == 0) relaxTile(matrix, tk, other, tk);
+            else relaxTile(matrix, other, tk, tk);
+        });
+        // Phase 3: every remaining tile only reads its row tile and column tile from phase 2.
+        pool.parallelFor(static_cast<size_t>(tiles - 1) * (tiles - 1), [&](size_t item, unsigned) {
+            // Tile coordinates, skipping row and column tk.
+            int ti = static_cast<int>(item / (tiles - 1)), tj = static_cast<int>(item % (tiles - 1));
+            // Shift past the diagonal.
+            if (ti >= tk) ++ti;
+            if (tj >= tk) ++tj;
+            // Relax the tile.
+            relaxTile(matrix, ti, tj, tk);
+        });
+    }
+    // Return the matrix.
+    return matrix;
+}
 
-    // Main Floyd-Warshall algorithm loops.
-    for (int k_id : nodeIds) { // Intermediate node
-        // For each source node u_id.
-        for (int u_id : nodeIds) { // Source node
-            // For each destination node v_id.
-            for (int v_id : nodeIds) { // Destination node
-                // If path through k_id is shorter.
-                if (dist[u_id][k_id] != INF && dist[k_id][v_id] != INF &&
-                    dist[u_id][k_id] + dist[k_id][v_id] < dist[u_id][v_id]) {
-                    // Update shortest distance from u_id to v_id.
-                    dist[u_id][v_id] = dist[u_id][k_id] + dist[k_id][v_id];
-                    // Update predecessor of v_id to be the same as predecessor of v_id in path from k_id.
-                    predecessors[u_id][v_id] = predecessors[k_id][v_id];
-                }
-            }
+// Both precisions are compiled here.
+template DistanceMatrix<float> Algorithms::floydWarshallMatrix<float>(const CsrGraph& graph, ThreadPool& pool);
+template DistanceMatrix<double> Algorithms::floydWarshallMatrix<double>(const CsrGraph& graph, ThreadPool& pool);
+
+// Computes all-pairs shortest paths using Floyd-Warshall algorithm.
+std::map<int, std::map<int, double>> Algorithms::floydWarshall(const CsrGraph& graph, std::map<int, std::map<int, int>>& predecessors) {
+    // Run the tiled kernel in double precision.
+    DistanceMatrix<double> matrix = floydWarshallMatrix<double>(graph);
+    // Get the number of nodes.
+    const int n = matrix.size();
+    // Convert the dense result back to nested maps keyed by external IDs.
+    std::map<int, std::map<int, double>> result;
+    // For each source node.
+    for (int u = 0; u < n; ++u) {
+        // Result row for the source.
+        auto& resultRow = result[graph.externalId(u)];
+        // Predecessor row for the source.
+        auto& predRow = predecessors[graph.externalId(u)];
+        // For each destination node.
+        for (int v = 0; v < n; ++v) {
+            // Copy the distance.
+            resultRow[graph.externalId(v)] = matrix.distance(u, v);
+            // Copy the predecessor, translated to an external ID.
+            predRow[graph.externalId(v)] = matrix.predecessor(u, v) < 0 ? -1 : graph.externalId(matrix.predecessor(u, v));
         }
     }
     // Return the map of all-pairs shortest distances.
-    return dist;
-}
\ No newline at end of file
+    return result;
+}
+
+// Computes all-pairs shortest paths on a mutable Graph by freezing it first.
+std::map<int, std::map<int, double>> Algorithms::floydWarshall(const Graph& graph, std::map<int, std::map<int, int>>& predecessors) {
+    // Run the CSR kernel on a frozen copy.
+    return floydWarshall(graph.freeze(), predecessors);
+}
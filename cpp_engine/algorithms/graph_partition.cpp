@@ -0,0 +1,235 @@
+#include "../include/graph_partition.h"
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <numeric>
+#include <utility>
+
+namespace {
+    // Projection directions (cosine, sine): 0, 45, 90 and 135 degrees.
+    const double DIRECTIONS[4][2] = {{1.0, 0.0}, {0.70710678118654752, 0.70710678118654752}, {0.0, 1.0}, {-0.70710678118654752, 0.70710678118654752}};
+
+    // Undirected topology among the members of a cell, with paired arcs for a unit-capacity flow.
+    struct CellGraph {
+        // Offset of each member's arcs; size members+1.
+        std::vector<int> first;
+        // Head of every arc (position in the member list).
+        std::vector<int> head;
+        // Arc of the same edge in the opposite direction.
+        std::vector<int> twin;
+    };
+
+    // Bisection of a cell along one direction.
+    struct Cut {
+        // Edges cut (the value of the max flow).
+        int size = INT_MAX;
+        // Half of every member: 1 if reachable from the source in the residual graph.
+        std::vector<uint8_t> side;
+        // Members in half 1.
+        int reached = 0;
+    };
+
+    // Builds the topology among a cell's members; local maps every node to -1 on entry and on return.
+    CellGraph cellGraph(const CsrGraph& graph, const std::vector<int>& members, std::vector<int>& local) {
+        // Number of members.
+        const int m = static_cast<int>(members.size());
+        // Position of every member.
+        for (int i = 0; i < m; ++i) local[members[i]] = i;
+        // Result.
+        CellGraph cell;
+        // Arc counts (shifted by one for the prefix sum): every edge inside the cell gives an arc at both ends.
+        cell.first.assign(m + 1, 0);
+        for (int i = 0; i < m; ++i) {
+            for (int e = graph.beginEdge(members[i]); e < graph.endEdge(members[i]); ++e) {
+                // Other end; edges leaving the cell and self loops carry no flow.
+                int j = local[graph.edgeHead(e)];
+                if (j < 0 || j == i) continue;
+                ++cell.first[i + 1];
+                ++cell.first[j + 1];
+            }
+        }
+        // Prefix sums turn counts into offsets.
+        for (int i = 0; i < m; ++i) cell.first[i + 1] += cell.first[i];
+        cell.head.resize(cell.first[m]);
+        cell.twin.resize(cell.first[m]);
+        // Next free arc of every member.
+        std::vector<int> fill(cell.first.begin(), cell.first.end() - 1);
+        // Place both arcs of every edge.
+        for (int i = 0; i < m; ++i) {
+            for (int e = graph.beginEdge(members[i]); e < graph.endEdge(members[i]); ++e) {
+                int j = local[graph.edgeHead(e)];
+                if (j < 0 || j == i) continue;
+                int a = fill[i]++, b = fill[j]++;
+                cell.head[a] = j;
+                cell.head[b] = i;
+                cell.twin[a] = b;
+                cell.twin[b] = a;
+            }
+        }
+        // Leave the map clean for the next cell.
+        for (int v : members) local[v] = -1;
+        // Return the topology.
+        return cell;
+    }
+
+    // Minimum cut between the first and the last quarter of the members along a direction, found
+    // with Dinic's max flow (every edge has capacity 1 in both directions).
+    Cut directionCut(const CsrGraph& graph, const std::vector<int>& members, const CellGraph& cell, int direction) {
+        // Number of members.
+        const int m = static_cast<int>(members.size());
+        // Projection of every member onto the direction.
+        std::vector<double> key(m);
+        for (int i = 0; i < m; ++i) key[i] = graph.x(members[i]) * DIRECTIONS[direction][0] + graph.y(members[i]) * DIRECTIONS[direction][1];
+        // Members by projection (ties by position, for determinism); only the two quarters need sorting out.
+        std::vector<int> order(m);
+        std::iota(order.begin(), order.end(), 0);
+        auto before = [&](int a, int b) { return key[a] < key[b] || (key[a] == key[b] && a < b); };
+        const int quarter = std::max(1, m / 4);
+        std::nth_element(order.begin(), order.begin() + quarter, order.end(), before);
+        std::nth_element(order.begin() + quarter, order.end() - quarter, order.end(), before);
+        // Role of every member: 1 for the source quarter, 2 for the sink quarter.
+        std::vector<char> role(m, 0);
+        for (int i = 0; i < quarter; ++i) { role[order[i]] = 1; role[order[m - 1 - i]] = 2; }
+        // Flow on every arc (-1, 0 or 1; an arc's twin carries the opposite); residual capacity is 1 - flow.
+        std::vector<signed char> flow(cell.head.size(), 0);
+        // BFS level of every member (-1 if unreached or a dead end), the BFS queue, the next arc to
+        // try per member and the arcs of the current augmenting path.
+        std::vector<int> level(m), queue, next(m), path;
+        queue.reserve(m);
+        // Result.
+        Cut cut;
+        cut.size = 0;
+        // Phases until the sink is cut off.
+        while (true) {
+            // Levels from the source over arcs with residual capacity.
+            std::fill(level.begin(), level.end(), -1);
+            queue.clear();
+            for (int i = 0; i < m; ++i) if (role[i] == 1) { level[i] = 0; queue.push_back(i); }
+            bool sinkReached = false;
+            for (size_t h = 0; h < queue.size(); ++h) {
+                int u = queue[h];
+                // Paths end at the sink.
+                if (role[u] == 2) { sinkReached = true; continue; }
+                for (int a = cell.first[u]; a < cell.first[u + 1]; ++a) {
+                    int v = cell.head[a];
+                    if (flow[a] < 1 && level[v] < 0) { level[v] = level[u] + 1; queue.push_back(v); }
+                }
+            }
+            // The last levels mark the source half.
+            if (!sinkReached) break;
+            // Blocking flow: depth-first along increasing levels, never retrying an exhausted arc.
+            for (int i = 0; i < m; ++i) next[i] = cell.first[i];
+            for (int s = 0; s < m; ++s) {
+                if (role[s] != 1) continue;
+                int u = s;
+                path.clear();
+                while (true) {
+                    // Reached the sink: push one unit along the path and start over from s.
+                    if (role[u] == 2) {
+                        for (int a : path) { ++flow[a]; --flow[cell.twin[a]]; }
+                        ++cut.size;
+                        path.clear();
+                        u = s;
+                        continue;
+                    }
+                    // Advance over the next admissible arc.
+                    int& a = next[u];
+                    while (a < cell.first[u + 1] && (flow[a] >= 1 || level[cell.head[a]] != level[u] + 1)) ++a;
+                    if (a < cell.first[u + 1]) { path.push_back(a); u = cell.head[a]; continue; }
+                    // Dead end: never enter u again in this phase and retreat.
+                    level[u] = -1;
+                    if (path.empty()) break;
+                    u = cell.head[cell.twin[path.back()]];
+                    path.pop_back();
+                    ++next[u];
+                }
+            }
+        }
+        // Half 1 is everything the source still reaches.
+        cut.side.assign(m, 0);
+        for (int i = 0; i < m; ++i) if (level[i] >= 0) { cut.side[i] = 1; ++cut.reached; }
+        // Return the cut.
+        return cut;
+    }
+}
+
+// Partitions a graph top-down with inertial flow bisections.
+MultilevelPartition MultilevelPartition::inertialFlow(const CsrGraph& graph, const std::vector<int>& cellSizes, ThreadPool& pool) {
+    // Number of nodes.
+    const int n = graph.numNodes();
+    // Result, keeping only the levels that split the graph.
+    MultilevelPartition partition;
+    for (int size : cellSizes) if (size < n) partition.cellSizes.push_back(size);
+    const int levels = partition.numLevels();
+    partition.cellOf.assign(levels, std::vector<int>(n, -1));
+    partition.numCells.assign(levels, 0);
+    // Nothing to split.
+    if (levels == 0) return partition;
+    // Member position maps, one per worker, allocated on first use.
+    std::vector<std::vector<int>> local(pool.size());
+    // Cells of the current recursion round and the size of the cell each one was split from.
+    std::vector<std::vector<int>> round(1, std::vector<int>(n));
+    std::iota(round[0].begin(), round[0].end(), 0);
+    std::vector<int> parentSize(1, INT_MAX);
+    // One round per recursion depth.
+    while (!round.empty()) {
+        // A cell is a cell of every level whose size it is the first on its branch to fit.
+        for (size_t c = 0; c < round.size(); ++c) {
+            const int size = static_cast<int>(round[c].size());
+            for (int l = 0; l < levels; ++l) {
+                if (size > partition.cellSizes[l] || parentSize[c] <= partition.cellSizes[l]) continue;
+                const int id = partition.numCells[l]++;
+                for (int v : round[c]) partition.cellOf[l][v] = id;
+            }
+        }
+        // Cells still larger than the smallest level.
+        std::vector<size_t> split;
+        for (size_t c = 0; c < round.size(); ++c) if (static_cast<int>(round[c].size()) > partition.cellSizes[0]) split.push_back(c);
+        // Their topologies, in parallel.
+        std::vector<CellGraph> graphs(split.size());
+        pool.parallelFor(split.size(), [&](size_t i, unsigned worker) {
+            if (local[worker].empty()) local[worker].assign(n, -1);
+            graphs[i] = cellGraph(graph, round[split[i]], local[worker]);
+        });
+        // Every direction of every cell, in parallel.
+        std::vector<Cut> cuts(4 * split.size());
+        pool.parallelFor(cuts.size(), [&](size_t i, unsigned) { cuts[i] = directionCut(graph, round[split[i / 4]], graphs[i / 4], static_cast<int>(i % 4)); });
+        // Halves for the next round.
+        std::vector<std::vector<int>> nextRound;
+        std::vector<int> nextParentSize;
+        for (size_t i = 0; i < split.size(); ++i) {
+            std::vector<int>& members = round[split[i]];
+            const int m = static_cast<int>(members.size());
+            // Smallest cut, then the most balanced one.
+            const Cut* best = &cuts[4 * i];
+            for (int d = 1; d < 4; ++d) {
+                const Cut& cut = cuts[4 * i + d];
+                if (cut.size < best->size || (cut.size == best->size && std::abs(2 * cut.reached - m) < std::abs(2 * best->reached - m))) best = &cut;
+            }
+            // Split the members.
+            std::vector<int> halves[2];
+            for (int k = 0; k < m; ++k) halves[best->side[k]].push_back(members[k]);
+            for (std::vector<int>& half : halves) { nextRound.push_back(std::move(half)); nextParentSize.push_back(m); }
+        }
+        // Recurse.
+        round = std::move(nextRound);
+        parentSize = std::move(nextParentSize);
+    }
+    // Renumber the cells of every level so those inside one cell of the level above are consecutive.
+    for (int l = levels - 2; l >= 0; --l) {
+        // Cell of the level above containing every cell.
+        std::vector<int> parent(partition.numCells[l]);
+        for (int v = 0; v < n; ++v) parent[partition.cellOf[l][v]] = partition.cellOf[l + 1][v];
+        // Cells by parent, keeping the recursion order within one.
+        std::vector<int> order(partition.numCells[l]);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return parent[a] < parent[b]; });
+        // New id of every cell.
+        std::vector<int> renamed(order.size());
+        for (size_t k = 0; k < order.size(); ++k) renamed[order[k]] = static_cast<int>(k);
+        for (int v = 0; v < n; ++v) partition.cellOf[l][v] = renamed[partition.cellOf[l][v]];
+    }
+    // Return the partition.
+    return partition;
+}
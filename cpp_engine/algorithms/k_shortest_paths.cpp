@@ -0,0 +1,339 @@
+#include "../include/algorithms.h"
+#include "../include/stats.h"
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <set>
+#include <unordered_map>
+#include <utility>
+
+namespace {
+    // Node sequences of the accepted and candidate paths, stored back to back in one buffer.
+    // Released ids are recycled and the buffer is compacted once it is mostly garbage, so memory
+    // stays proportional to the paths still alive.
+    class PathPool {
+    public:
+        // One stored path.
+        struct Entry {
+            // Position of its nodes in the buffer and their number.
+            size_t offset;
+            int length;
+            // Total weight.
+            double weight;
+            // Position of the spur node it leaves its parent path at (0 for the first path).
+            int deviation;
+            // Hash of the node sequence.
+            uint64_t hash;
+        };
+
+        // FNV-1a hash of a node sequence.
+        static uint64_t hashOf(const std::vector<int>& nodes) {
+            uint64_t hash = 1469598103934665603ULL;
+            for (int v : nodes) { hash ^= static_cast<uint32_t>(v); hash *= 1099511628211ULL; }
+            return hash;
+        }
+
+        // Stores a path and returns its id.
+        int add(const std::vector<int>& nodes, double weight, int deviation, uint64_t hash) {
+            // Reclaim released space first, so the buffer never exceeds twice the live nodes by much.
+            if (buffer.size() > 4096 && buffer.size() > 2 * liveNodes) compact();
+            // Recycle an id if possible.
+            int id;
+            if (!freeIds.empty()) { id = freeIds.back(); freeIds.pop_back(); }
+            else { id = static_cast<int>(entries.size()); entries.emplace_back(); live.push_back(0); }
+            entries[id] = Entry{buffer.size(), static_cast<int>(nodes.size()), weight, deviation, hash};
+            live[id] = 1;
+            buffer.insert(buffer.end(), nodes.begin(), nodes.end());
+            liveNodes += nodes.size();
+            byHash.emplace(hash, id);
+            return id;
+        }
+
+        // Drops a path; its id may be handed out again.
+        void release(int id) {
+            live[id] = 0;
+            liveNodes -= entries[id].length;
+            auto range = byHash.equal_range(entries[id].hash);
+            for (auto it = range.first; it != range.second; ++it) if (it->second == id) { byHash.erase(it); break; }
+            freeIds.push_back(id);
+        }
+
+        // Id of a live path with exactly these nodes, or -1.
+        int find(const std::vector<int>& nodes, uint64_t hash) const {
+            auto range = byHash.equal_range(hash);
+            for (auto it = range.first; it != range.second; ++it) {
+                const Entry& entry = entries[it->second];
+                if (entry.length == static_cast<int>(nodes.size()) && std::equal(nodes.begin(), nodes.end(), buffer.begin() + entry.offset)) return it->second;
+            }
+            return -1;
+        }
+
+        // Metadata of a stored path.
+        const Entry& entry(int id) const { return entries[id]; }
+        // Nodes of a stored path; valid until the next add.
+        const int* nodes(int id) const { return buffer.data() + entries[id].offset; }
+
+    private:
+        // Nodes of all stored paths.
+        std::vector<int> buffer;
+        // Every id ever handed out, live or not.
+        std::vector<Entry> entries;
+        std::vector<char> live;
+        // Released ids.
+        std::vector<int> freeIds;
+        // Nodes of live paths in the buffer.
+        size_t liveNodes = 0;
+        // Live ids by hash, for duplicate detection.
+        std::unordered_multimap<uint64_t, int> byHash;
+
+        // Moves the live paths to the front of a fresh buffer.
+        void compact() {
+            std::vector<int> packed;
+            packed.reserve(2 * liveNodes);
+            for (size_t id = 0; id < entries.size(); ++id) {
+                if (!live[id]) continue;
+                const size_t offset = packed.size();
+                packed.insert(packed.end(), buffer.begin() + entries[id].offset, buffer.begin() + entries[id].offset + entries[id].length);
+                entries[id].offset = offset;
+            }
+            buffer.swap(packed);
+        }
+    };
+
+    // Weight of the cheapest edge u -> v.
+    double edgeCost(const CsrGraph& graph, int u, int v) {
+        double best = INF;
+        for (int e = graph.beginEdge(u); e < graph.endEdge(u); ++e) if (graph.edgeHead(e) == v) best = std::min(best, graph.edgeWeight(e));
+        return best;
+    }
+
+    // Weight of a node sequence over the cheapest edge of every hop.
+    double pathCost(const CsrGraph& graph, const std::vector<int>& nodes) {
+        double weight = 0;
+        for (size_t i = 1; i < nodes.size(); ++i) weight += edgeCost(graph, nodes[i - 1], nodes[i]);
+        return weight;
+    }
+
+    // Dijkstra from target over incoming edges: distance(v) is the distance from v to target and
+    // parent(v) the next node on a shortest path from v.
+    void reverseTree(const CsrGraph& graph, QueryWorkspace& tree, int target) {
+        // Start a new search on the labels and the queue.
+        tree.reset(graph.numNodes());
+        IndexedDaryHeap<4>& queue = tree.daryQueue;
+        queue.reset(graph.numNodes());
+        tree.setLabel(target, 0, -1);
+        queue.push(target, 0);
+        // Counts of this search, published when it returns.
+        ROUTE_STATS(Stats::Local counters; ++counters[Stats::HeapPushes];)
+        // Settle every node that reaches target.
+        while (!queue.empty()) {
+            std::pair<double, int> top = queue.pop();
+            const int u = top.second;
+            ROUTE_STATS(++counters[Stats::HeapPops]; ++counters[Stats::NodesSettled]; counters[Stats::EdgesRelaxed] += graph.endInEdge(u) - graph.beginInEdge(u);)
+            for (int e = graph.beginInEdge(u); e < graph.endInEdge(u); ++e) {
+                const int v = graph.inEdgeTail(e);
+                double candidate = top.first + graph.inEdgeWeight(e);
+                if (candidate < tree.distance(v)) {
+                    tree.setLabel(v, candidate, u);
+                    queue.push(v, candidate);
+                    ROUTE_STATS(++counters[Stats::HeapPushes];)
+                }
+            }
+        }
+    }
+
+    // Spur searches of one Yen run: nodes are blocked by stamping them with the current spur's
+    // epoch, and the reverse tree is both the A* potential and a ready-made path to target from
+    // every node whose tree path avoids the blocked nodes.
+    class SpurSearch {
+    public:
+        SpurSearch(const CsrGraph& graph, QueryWorkspace& search, const QueryWorkspace& tree, int target)
+            : graph(graph), search(search), tree(tree), target(target), blocked(graph.numNodes(), 0), known(graph.numNodes(), 0), clear(graph.numNodes(), 0) {}
+
+        // Starts a spur problem at spur with the given root nodes (the ones before spur) blocked.
+        void begin(int spurNode, const int* root, int rootLength) {
+            ++epoch;
+            spur = spurNode;
+            for (int i = 0; i < rootLength; ++i) blocked[root[i]] = epoch;
+        }
+
+        // Shortest path from spur to target (spur first) that avoids the blocked nodes and does not
+        // leave spur towards any node in heads. Returns false if there is none.
+        bool run(const std::vector<int>& heads, std::vector<int>& suffix) {
+            // Target unreachable even without restrictions.
+            if (tree.distance(spur) == INF) return false;
+            auto excludedHead = [&](int v) { return std::find(heads.begin(), heads.end(), v) != heads.end(); };
+            // The tree path itself, if it survives the restrictions.
+            const int next = tree.parent(spur);
+            if (next >= 0 && !excludedHead(next) && treeClear(next)) {
+                suffix.assign(1, spur);
+                appendTreePath(next, suffix);
+                return true;
+            }
+            // A* with the exact tree distances as potential.
+            search.reset(graph.numNodes());
+            IndexedDaryHeap<4>& queue = search.daryQueue;
+            queue.reset(graph.numNodes());
+            search.setLabel(spur, 0, -1);
+            queue.push(spur, tree.distance(spur));
+            // Counts of this search, published when it returns.
+            ROUTE_STATS(Stats::Local counters; ++counters[Stats::HeapPushes];)
+            while (!queue.empty()) {
+                const int u = queue.pop().second;
+                ROUTE_STATS(++counters[Stats::HeapPops];)
+                // The first node with an unobstructed tree path finishes the search: its key is the
+                // final distance, and every node still queued is at least as far. No earlier node of
+                // the path is on that tree path, or it would have finished the search itself.
+                if (u != spur && treeClear(u)) {
+                    suffix.clear();
+                    for (int v = u; v != -1; v = search.parent(v)) suffix.push_back(v);
+                    std::reverse(suffix.begin(), suffix.end());
+                    appendTreePath(tree.parent(u), suffix);
+                    return true;
+                }
+                ROUTE_STATS(++counters[Stats::NodesSettled]; counters[Stats::EdgesRelaxed] += graph.endEdge(u) - graph.beginEdge(u);)
+                const double g = search.distance(u);
+                for (int e = graph.beginEdge(u); e < graph.endEdge(u); ++e) {
+                    const int v = graph.edgeHead(e);
+                    // Blocked nodes, the spur node and the excluded first hops.
+                    if (v == spur || blocked[v] == epoch || (u == spur && excludedHead(v))) continue;
+                    // Nodes that cannot reach target.
+                    const double h = tree.distance(v);
+                    if (h == INF) continue;
+                    double candidate = g + graph.edgeWeight(e);
+                    if (candidate < search.distance(v)) {
+                        search.setLabel(v, candidate, u);
+                        queue.push(v, candidate + h);
+                        ROUTE_STATS(++counters[Stats::HeapPushes];)
+                    }
+                }
+            }
+            // Target is cut off.
+            return false;
+        }
+
+    private:
+        const CsrGraph& graph;
+        QueryWorkspace& search;
+        const QueryWorkspace& tree;
+        int target;
+        int spur = -1;
+        // Stamp of the spur problem that blocks each node.
+        std::vector<unsigned> blocked;
+        // Memo of treeClear: stamp of the spur problem it was computed for and the answer.
+        std::vector<unsigned> known;
+        std::vector<char> clear;
+        unsigned epoch = 0;
+        // Nodes visited by the current treeClear walk.
+        std::vector<int> walk;
+
+        // Whether the tree path from v to target avoids the blocked nodes and spur.
+        bool treeClear(int v) {
+            walk.clear();
+            char answer;
+            while (true) {
+                if (known[v] == epoch) { answer = clear[v]; break; }
+                if (v == spur || blocked[v] == epoch) { answer = 0; break; }
+                if (v == target) { answer = 1; break; }
+                walk.push_back(v);
+                v = tree.parent(v);
+            }
+            // Every node on the walk shares the answer.
+            for (int w : walk) { known[w] = epoch; clear[w] = answer; }
+            return answer != 0;
+        }
+
+        // Appends the tree path from v to target.
+        void appendTreePath(int v, std::vector<int>& nodes) const {
+            for (; v != -1; v = tree.parent(v)) nodes.push_back(v);
+        }
+    };
+}
+
+// Yen's k shortest loopless paths with Lawler's rule and tree-shortcut spur searches.
+std::vector<PathResult> Algorithms::kShortestPaths(const CsrGraph& graph, QueryWorkspace& forward, QueryWorkspace& backward, int startNode, int endNode, int k) {
+    // Result.
+    std::vector<PathResult> paths;
+    // Translate the endpoints to internal indices.
+    const int source = graph.internalId(startNode);
+    const int target = graph.internalId(endNode);
+    if (source < 0 || target < 0 || k < 1) return paths;
+    // Distances to target and next hops for every node; nothing to rank if source is cut off.
+    reverseTree(graph, backward, target);
+    if (backward.distance(source) == INF) return paths;
+    // Path store, spur searches and scratch.
+    PathPool pool;
+    SpurSearch spurSearch(graph, forward, backward, target);
+    std::vector<int> nodes, suffix, candidate, sharing, heads;
+    std::vector<double> prefix;
+    // The shortest path is the tree path from source.
+    for (int v = source; v != -1; v = backward.parent(v)) nodes.push_back(v);
+    std::vector<int> accepted{pool.add(nodes, pathCost(graph, nodes), 0, PathPool::hashOf(nodes))};
+    // Best candidates by (weight, id); no more than the paths still missing are ever kept.
+    std::set<std::pair<double, int>> candidates;
+    // One round per accepted path.
+    while (static_cast<int>(accepted.size()) < k) {
+        // Nodes of the last accepted path (copied, since adding candidates may move the buffer).
+        const int last = accepted.back();
+        const PathPool::Entry lastEntry = pool.entry(last);
+        nodes.assign(pool.nodes(last), pool.nodes(last) + lastEntry.length);
+        const int length = lastEntry.length;
+        // Weight of every prefix of it.
+        prefix.assign(length, 0);
+        for (int i = 1; i < length; ++i) prefix[i] = prefix[i - 1] + edgeCost(graph, nodes[i - 1], nodes[i]);
+        // Accepted paths with the same root so far; by Lawler's rule spurs before the last
+        // path's own deviation were explored when its parent was accepted.
+        sharing.clear();
+        for (int id : accepted) {
+            const PathPool::Entry& entry = pool.entry(id);
+            const int* other = pool.nodes(id);
+            if (entry.length <= lastEntry.deviation) continue;
+            if (std::equal(nodes.begin(), nodes.begin() + lastEntry.deviation + 1, other)) sharing.push_back(id);
+        }
+        // Every spur node from the deviation on.
+        for (int i = lastEntry.deviation; i + 1 < length; ++i) {
+            // Keep only the paths that still share the root with spur node i.
+            if (i > lastEntry.deviation) {
+                sharing.erase(std::remove_if(sharing.begin(), sharing.end(), [&](int id) { return pool.entry(id).length <= i || pool.nodes(id)[i] != nodes[i]; }), sharing.end());
+            }
+            // Their next nodes may not follow the spur node.
+            heads.clear();
+            for (int id : sharing) if (pool.entry(id).length > i + 1) heads.push_back(pool.nodes(id)[i + 1]);
+            // Block the root and search.
+            spurSearch.begin(nodes[i], nodes.data(), i);
+            if (!spurSearch.run(heads, suffix)) continue;
+            // Root and spur path; the spur path avoids the root, so it is loopless.
+            candidate.assign(nodes.begin(), nodes.begin() + i);
+            candidate.insert(candidate.end(), suffix.begin(), suffix.end());
+            const double weight = pathCost(graph, candidate);
+            // Skip it if enough better candidates exist already.
+            const size_t room = static_cast<size_t>(k) - accepted.size();
+            if (candidates.size() >= room && weight >= candidates.rbegin()->first) continue;
+            // Skip duplicates.
+            const uint64_t hash = PathPool::hashOf(candidate);
+            if (pool.find(candidate, hash) >= 0) continue;
+            // Store it, evicting the worst candidate beyond the room left.
+            candidates.emplace(weight, pool.add(candidate, weight, i, hash));
+            if (candidates.size() > room) {
+                auto worst = std::prev(candidates.end());
+                pool.release(worst->second);
+                candidates.erase(worst);
+            }
+        }
+        // No further loopless paths.
+        if (candidates.empty()) break;
+        // The best candidate is the next path.
+        accepted.push_back(candidates.begin()->second);
+        candidates.erase(candidates.begin());
+    }
+    // Translate the accepted paths to external IDs.
+    paths.resize(accepted.size());
+    for (size_t r = 0; r < accepted.size(); ++r) {
+        const PathPool::Entry& entry = pool.entry(accepted[r]);
+        paths[r].weight = entry.weight;
+        paths[r].path.reserve(entry.length);
+        for (int j = 0; j < entry.length; ++j) paths[r].path.push_back(graph.externalId(pool.nodes(accepted[r])[j]));
+    }
+    // Return the ranked paths.
+    return paths;
+}
@@ -0,0 +1,257 @@
+#include "../include/landmarks.h"
+#include <algorithm>
+#include <random>
+#include <utility>
+
+namespace {
+    // Full single-source search from source over outgoing edges (or incoming edges if backward).
+    // Labels are left in the workspace; settled nodes are appended to order if given.
+    void searchAll(const CsrGraph& graph, int source, bool backward, QueryWorkspace& workspace, std::vector<int>* order = nullptr) {
+        // Heap of the workspace.
+        IndexedDaryHeap<4>& queue = workspace.daryQueue;
+        // Start a new search.
+        workspace.reset(graph.numNodes());
+        queue.reset(graph.numNodes());
+        // Distance from the source to itself is 0.
+        workspace.setLabel(source, 0, -1);
+        // Seed the heap.
+        queue.push(source, 0);
+        // Settle every reachable node.
+        while (!queue.empty()) {
+            // Closest unsettled node.
+            std::pair<double, int> top = queue.pop();
+            // Record the settle order.
+            if (order) order->push_back(top.second);
+            // Edge range in the search direction.
+            int begin = backward ? graph.beginInEdge(top.second) : graph.beginEdge(top.second);
+            // End of the range.
+            int end = backward ? graph.endInEdge(top.second) : graph.endEdge(top.second);
+            // Relax the edges.
+            for (int e = begin; e < end; ++e) {
+                // Neighbor node index.
+                int v = backward ? graph.inEdgeTail(e) : graph.edgeHead(e);
+                // Candidate distance.
+                double candidate = top.first + (backward ? graph.inEdgeWeight(e) : graph.edgeWeight(e));
+                // Improve the label.
+                if (candidate < workspace.distance(v)) {
+                    // Record it.
+                    workspace.setLabel(v, candidate, top.second);
+                    // Queue the node.
+                    queue.push(v, candidate);
+                }
+            }
+        }
+    }
+
+    // Copies a workspace's distance labels into a dense column.
+    std::vector<double> distanceColumn(const QueryWorkspace& workspace, int numNodes) {
+        // One entry per node.
+        std::vector<double> column(numNodes);
+        // INF for unreached nodes.
+        for (int v = 0; v < numNodes; ++v) column[v] = workspace.distance(v);
+        // Return the column.
+        return column;
+    }
+
+    // Forward and backward distance columns of every source: one full search per source and
+    // direction, all in parallel on per-worker workspaces.
+    void searchColumns(const CsrGraph& graph, const std::vector<int>& sources, std::vector<QueryWorkspace>& workspaces, ThreadPool& pool,
+                       std::vector<std::vector<double>>& from, std::vector<std::vector<double>>& to) {
+        // One column per source and direction.
+        from.resize(sources.size());
+        to.resize(sources.size());
+        pool.parallelFor(2 * sources.size(), [&](size_t job, unsigned worker) {
+            // Source of the job.
+            size_t i = job / 2;
+            // Even jobs search forward, odd jobs backward.
+            bool backward = job % 2 == 1;
+            // Run the search.
+            searchAll(graph, sources[i], backward, workspaces[worker]);
+            // Store the column.
+            (backward ? to : from)[i] = distanceColumn(workspaces[worker], graph.numNodes());
+        });
+    }
+
+    // Interleaves per-landmark columns into the node-major tables.
+    void storeColumns(Landmarks& landmarks, const std::vector<std::vector<double>>& from, const std::vector<std::vector<double>>& to, int numNodes) {
+        // Number of landmarks.
+        const size_t k = from.size();
+        // Size the tables.
+        landmarks.fromLandmark.assign(static_cast<size_t>(numNodes) * k, INF);
+        landmarks.toLandmark.assign(static_cast<size_t>(numNodes) * k, INF);
+        // Node by node.
+        for (int v = 0; v < numNodes; ++v) {
+            // Landmark by landmark.
+            for (size_t i = 0; i < k; ++i) {
+                // Distance from the landmark.
+                landmarks.fromLandmark[v * k + i] = from[i][v];
+                // Distance to the landmark.
+                landmarks.toLandmark[v * k + i] = to[i][v];
+            }
+        }
+    }
+}
+
+// Parses a selection name ("farthest", "avoid"); returns false if unknown.
+bool parseLandmarkSelection(const std::string& name, LandmarkSelection& selection) {
+    // Match each supported name.
+    if (name == "farthest") selection = LandmarkSelection::Farthest;
+    else if (name == "avoid") selection = LandmarkSelection::Avoid;
+    // Unknown name.
+    else return false;
+    // Parsed successfully.
+    return true;
+}
+
+// Chooses count landmarks on the graph and computes their tables.
+Landmarks Landmarks::select(const CsrGraph& graph, int count, LandmarkSelection selection, ThreadPool& pool) {
+    // Result.
+    Landmarks landmarks;
+    // Number of nodes.
+    const int n = graph.numNodes();
+    // Never more landmarks than nodes.
+    count = std::min(count, n);
+    // Per-worker scratch; the first one also serves the avoid heuristic's tree searches.
+    std::vector<QueryWorkspace> workspaces(pool.size(), QueryWorkspace(n));
+    QueryWorkspace& workspace = workspaces[0];
+    // Columns of the landmarks chosen so far; every selection step needs the previous ones.
+    std::vector<std::vector<double>> from, to;
+    // Columns of the latest search, both directions computed in parallel.
+    std::vector<std::vector<double>> stepFrom, stepTo;
+    // Whether a node is already a landmark.
+    std::vector<char> isLandmark(n, 0);
+    // Distance (in the nearer direction) to the nearest landmark, for farthest selection.
+    std::vector<double> nearest(n, INF);
+    // Fixed seed, so the same graph always gets the same landmarks.
+    std::mt19937 rng(12345);
+    // Uniform choice of node.
+    std::uniform_int_distribution<int> pick(0, std::max(0, n - 1));
+    // Subtree sizes, flags and best children of the avoid heuristic.
+    std::vector<double> size;
+    std::vector<char> covered;
+    std::vector<int> bestChild, order;
+    // Choose one landmark per step.
+    for (int step = 0; step < count; ++step) {
+        // Internal index of the new landmark.
+        int chosen = -1;
+        // Farthest: the node farthest from all chosen landmarks.
+        if (selection == LandmarkSelection::Farthest) {
+            // The first landmark is the node farthest from a random start.
+            if (step == 0) {
+                // Random start.
+                int start = pick(rng);
+                // Distances from and to the start; keep the nearer direction.
+                searchColumns(graph, {start}, workspaces, pool, stepFrom, stepTo);
+                for (int v = 0; v < n; ++v) nearest[v] = std::min(stepFrom[0][v], stepTo[0][v]);
+            }
+            // Largest distance wins; disconnected nodes (INF) first, so every component gets covered.
+            for (int v = 0; v < n; ++v) if (!isLandmark[v] && (chosen < 0 || nearest[v] > nearest[chosen])) chosen = v;
+        } else {
+            // Avoid: shortest path tree from a random root.
+            int root = pick(rng);
+            // Settle order of the tree.
+            order.clear();
+            // Grow the tree.
+            searchAll(graph, root, false, workspace, &order);
+            // Per-node subtree state.
+            size.assign(n, 0);
+            covered.assign(n, 0);
+            bestChild.assign(n, -1);
+            // Weight of a node: how badly the current landmarks bound its distance from the root.
+            for (int v : order) {
+                // Best lower bound on d(root, v) from the chosen landmarks.
+                double bound = 0;
+                // Check each landmark's two triangle bounds.
+                for (size_t i = 0; i < from.size(); ++i) {
+                    // d(L, v) - d(L, root).
+                    double behind = from[i][v] - from[i][root];
+                    // d(root, L) - d(v, L).
+                    double beyond = to[i][root] - to[i][v];
+                    // Keep the best.
+                    if (behind > bound) bound = behind;
+                    if (beyond > bound) bound = beyond;
+                }
+                // Gap between the true distance and the bound (clamped against rounding).
+                size[v] = std::max(0.0, workspace.distance(v) - std::min(bound, workspace.distance(v)));
+                // Landmarks cover their subtree.
+                covered[v] = isLandmark[v];
+            }
+            // Accumulate subtree sizes and coverage bottom-up (children settle after parents).
+            for (auto it = order.rbegin(); it != order.rend(); ++it) {
+                // Parent in the tree.
+                int parent = workspace.parent(*it);
+                // The root has none.
+                if (parent < 0) continue;
+                // Add the subtree.
+                size[parent] += size[*it];
+                // Propagate coverage.
+                covered[parent] |= covered[*it];
+            }
+            // Subtrees containing a landmark do not count.
+            for (int v : order) if (covered[v]) size[v] = 0;
+            // Pick every node's largest child subtree.
+            for (int v : order) {
+                // Parent in the tree.
+                int parent = workspace.parent(v);
+                // Larger than the current best child.
+                if (parent >= 0 && size[v] > 0 && (bestChild[parent] < 0 || size[v] > size[bestChild[parent]])) bestChild[parent] = v;
+            }
+            // Descend from the root along the largest subtrees to a leaf.
+            if (size[root] > 0) for (chosen = root; bestChild[chosen] >= 0; chosen = bestChild[chosen]) {}
+            // Everything reachable is covered: fall back to any node that is not a landmark yet.
+            if (chosen < 0 || isLandmark[chosen]) {
+                // First free node.
+                chosen = -1;
+                // Scan from a random offset.
+                for (int i = 0, start = pick(rng); i < n && chosen < 0; ++i) if (!isLandmark[(start + i) % n]) chosen = (start + i) % n;
+            }
+        }
+        // Mark it.
+        isLandmark[chosen] = 1;
+        // Record the external ID.
+        landmarks.ids.push_back(graph.externalId(chosen));
+        // Distances from and to the landmark.
+        searchColumns(graph, {chosen}, workspaces, pool, stepFrom, stepTo);
+        from.push_back(std::move(stepFrom[0]));
+        to.push_back(std::move(stepTo[0]));
+        // Update the distances to the nearest landmark (the start no longer counts after the first step).
+        for (int v = 0; v < n; ++v) nearest[v] = std::min(step == 0 ? INF : nearest[v], std::min(from.back()[v], to.back()[v]));
+    }
+    // Interleave the columns into the tables.
+    storeColumns(landmarks, from, to, n);
+    // Done.
+    return landmarks;
+}
+
+// Recomputes the tables for the current landmarks.
+bool Landmarks::refresh(const CsrGraph& graph, ThreadPool& pool) {
+    // Number of nodes.
+    const int n = graph.numNodes();
+    // Number of landmarks.
+    const int k = count();
+    // Internal indices of the landmarks.
+    std::vector<int> sources(k);
+    // Translate them.
+    for (int i = 0; i < k; ++i) {
+        // Look up the node.
+        sources[i] = graph.internalId(ids[i]);
+        // A vanished landmark needs a new selection.
+        if (sources[i] < 0) return false;
+    }
+    // Columns of both tables.
+    std::vector<std::vector<double>> from, to;
+    // Per-worker scratch.
+    std::vector<QueryWorkspace> workspaces(pool.size(), QueryWorkspace(n));
+    // One full search per landmark and direction, all in parallel.
+    searchColumns(graph, sources, workspaces, pool, from, to);
+    // Interleave the columns into the tables.
+    storeColumns(*this, from, to, n);
+    // Success.
+    return true;
+}
+
+// Lower bound on d(u, t) for internal indices u and t.
+double Landmarks::lowerBound(int u, int t) const {
+    // Evaluate the potential towards t.
+    return LandmarkPotential(*this, t)(u);
+}
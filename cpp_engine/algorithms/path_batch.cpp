@@ -0,0 +1,64 @@
+#include "../include/algorithms.h"
+#include <algorithm>
+
+namespace {
+    // Queries per block: large enough to keep every worker busy, small enough to stream the output.
+    const size_t BLOCK_SIZE = 4096;
+    // Names in enum order.
+    const char* const ALGORITHM_NAMES[] = {"dijkstra", "astar", "alt", "bidijkstra", "biastar", "ch", "cch", "crp"};
+}
+
+// Parses an algorithm name.
+bool parsePathAlgorithm(const std::string& name, PathAlgorithm& algorithm) {
+    // Match each supported name.
+    for (int i = 0; i < 8; ++i) {
+        // Found it.
+        if (name == ALGORITHM_NAMES[i]) { algorithm = static_cast<PathAlgorithm>(i); return true; }
+    }
+    // Unknown name.
+    return false;
+}
+
+// Name of an algorithm.
+const char* pathAlgorithmName(PathAlgorithm algorithm) {
+    // Names are listed in enum order.
+    return ALGORITHM_NAMES[static_cast<int>(algorithm)];
+}
+
+// Answers a batch of queries in parallel, block by block.
+void Algorithms::shortestPathBatch(const CsrGraph& graph, const PathIndexes& indexes, const std::vector<PathQuery>& queries, bool withPaths,
+                                   const std::function<void(size_t, const std::vector<PathResult>&)>& emit, QueueKind queue, ThreadPool& pool) {
+    // Results of the current block.
+    std::vector<PathResult> results;
+    // Consecutive blocks, in query order.
+    for (size_t first = 0; first < queries.size(); first += BLOCK_SIZE) {
+        // Queries in this block.
+        const size_t count = std::min(BLOCK_SIZE, queries.size() - first);
+        // Fresh results.
+        results.assign(count, PathResult());
+        // One query per item; workers share the graph and indexes read-only.
+        pool.parallelFor(count, [&](size_t i, unsigned) {
+            // This thread's scratch (the second one only for bidirectional searches).
+            QueryWorkspace& forward = threadWorkspace();
+            QueryWorkspace& backward = threadReverseWorkspace();
+            // The query and its slot.
+            const PathQuery& query = queries[first + i];
+            PathResult& result = results[i];
+            // Run the requested algorithm.
+            switch (query.algorithm) {
+                case PathAlgorithm::Dijkstra: result.path = dijkstra(graph, forward, query.source, query.target, result.weight, queue); break;
+                case PathAlgorithm::AStar: result.path = aStar(graph, forward, query.source, query.target, result.weight, queue); break;
+                case PathAlgorithm::Alt: result.path = landmarkAStar(graph, *indexes.landmarks, forward, query.source, query.target, result.weight, queue); break;
+                case PathAlgorithm::BiDijkstra: result.path = bidirectionalDijkstra(graph, forward, backward, query.source, query.target, result.weight, queue); break;
+                case PathAlgorithm::BiAStar: result.path = bidirectionalAStar(graph, forward, backward, query.source, query.target, result.weight, queue); break;
+                case PathAlgorithm::CH: result.path = contractionHierarchyQuery(graph, *indexes.ch, forward, backward, query.source, query.target, result.weight); break;
+                case PathAlgorithm::CCH: result.path = customizableCHQuery(graph, *indexes.cch, forward, backward, query.source, query.target, result.weight); break;
+                case PathAlgorithm::CRP: result.path = crpQuery(graph, *indexes.crp, forward, query.source, query.target, result.weight); break;
+            }
+            // Drop the path if only the weight was asked for.
+            if (!withPaths) std::vector<int>().swap(result.path);
+        });
+        // Hand the block over in order.
+        emit(first, results);
+    }
+}
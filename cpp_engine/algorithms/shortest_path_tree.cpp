@@ -0,0 +1,188 @@
+#include "../include/shortest_path_tree.h"
+#include <algorithm>
+
+// Grows the full tree of source.
+ShortestPathTree::ShortestPathTree(const CsrGraph& graph, int source)
+    : root(source), dist(graph.numNodes(), INF), parentOf(graph.numNodes(), -1), firstChild(graph.numNodes(), -1),
+      nextSibling(graph.numNodes(), -1), prevSibling(graph.numNodes(), -1), pendingParent(graph.numNodes(), -1), detached(graph.numNodes(), 0) {
+    // Heap sized for the graph.
+    queue.reset(graph.numNodes());
+    // Start at the source.
+    dist[root] = 0.0;
+    queue.push(root, 0.0);
+    // Plain Dijkstra; nodes are linked under their parent as they are settled.
+    while (!queue.empty()) {
+        // Closest unsettled node.
+        std::pair<double, int> top = queue.pop();
+        // Attach it to the tree.
+        int u = top.second;
+        if (pendingParent[u] >= 0) link(u, pendingParent[u]);
+        // Count it.
+        ++reached;
+        // Relax its edges.
+        for (int e = graph.beginEdge(u); e < graph.endEdge(u); ++e) {
+            // Head and candidate distance.
+            int v = graph.edgeHead(e);
+            double d = top.first + graph.edgeWeight(e);
+            // Improve it.
+            if (d < dist[v]) { dist[v] = d; pendingParent[v] = u; queue.push(v, d); }
+        }
+    }
+    // The pending parents are all linked now.
+    std::fill(pendingParent.begin(), pendingParent.end(), -1);
+}
+
+// Repairs the tree after the weights of u -> v changed.
+size_t ShortestPathTree::edgeChanged(const CsrGraph& graph, int u, int v) {
+    // Nothing relabelled yet.
+    changed = 0;
+    // Unreachable tails and self-loops cannot change any distance.
+    if (u == v || dist[u] == INF) return 0;
+    // Best way into v over the changed edges now.
+    double through = dist[u] + edgeWeight(graph, u, v);
+    // Decrease: v gets closer, and so may everything reachable from it.
+    if (through < dist[v]) {
+        // Relabel v.
+        lower(v, through, u);
+        // Propagate in distance order; only nodes whose distance drops are queued.
+        while (!queue.empty()) {
+            // Closest queued node.
+            std::pair<double, int> top = queue.pop();
+            // Relax its edges.
+            for (int e = graph.beginEdge(top.second); e < graph.endEdge(top.second); ++e) {
+                // Candidate distance of the head.
+                double d = top.first + graph.edgeWeight(e);
+                // It improves: move the head under this node.
+                if (d < dist[graph.edgeHead(e)]) lower(graph.edgeHead(e), d, top.second);
+            }
+        }
+        // Relabelled nodes.
+        return changed;
+    }
+    // Only an increase of the tree edge into v can lengthen paths; anything else leaves the tree as is.
+    if (parentOf[v] != u || through <= dist[v]) return 0;
+    // Detach the subtree of v; its nodes are exactly the ones whose tree path used the edge.
+    unlink(v);
+    subtree.clear();
+    stack.assign(1, v);
+    // Collect it depth first.
+    while (!stack.empty()) {
+        // Next node.
+        int x = stack.back();
+        stack.pop_back();
+        // Mark it.
+        detached[x] = 1;
+        subtree.push_back(x);
+        // Its children follow.
+        for (int c = firstChild[x]; c >= 0; c = nextSibling[c]) stack.push_back(c);
+    }
+    // Dissolve the subtree's links; every node is relinked as it is settled again.
+    for (int x : subtree) {
+        // No parent, children or siblings.
+        parentOf[x] = firstChild[x] = nextSibling[x] = prevSibling[x] = -1;
+        // Unknown distance.
+        dist[x] = INF;
+    }
+    // Seed every node with its cheapest edge from the rest of the tree, whose labels are unaffected.
+    for (int x : subtree) {
+        // Incoming edges.
+        for (int e = graph.beginInEdge(x); e < graph.endInEdge(x); ++e) {
+            // Tail outside the subtree and reachable.
+            int y = graph.inEdgeTail(e);
+            if (detached[y] || dist[y] == INF) continue;
+            // Candidate distance.
+            double d = dist[y] + graph.inEdgeWeight(e);
+            // Keep the best one.
+            if (d < dist[x]) { dist[x] = d; pendingParent[x] = y; }
+        }
+        // Queue the seeded nodes.
+        if (dist[x] < INF) queue.push(x, dist[x]);
+    }
+    // Re-settle the subtree among itself.
+    while (!queue.empty()) {
+        // Closest queued node; its label is final.
+        std::pair<double, int> top = queue.pop();
+        int x = top.second;
+        // Attach it under its best parent.
+        link(x, pendingParent[x]);
+        pendingParent[x] = -1;
+        // Relax its edges into the subtree.
+        for (int e = graph.beginEdge(x); e < graph.endEdge(x); ++e) {
+            // Head inside the subtree.
+            int y = graph.edgeHead(e);
+            if (!detached[y]) continue;
+            // Candidate distance.
+            double d = top.first + graph.edgeWeight(e);
+            // Improve it.
+            if (d < dist[y]) { dist[y] = d; pendingParent[y] = x; queue.push(y, d); }
+        }
+    }
+    // Clear the marks; nodes never reached again are unreachable now.
+    for (int x : subtree) {
+        // Unmark.
+        detached[x] = 0;
+        // Lost for good.
+        if (dist[x] == INF) --reached;
+    }
+    // Every node of the subtree got a new (longer or lost) label.
+    return subtree.size();
+}
+
+// External IDs of the tree path from the source to u.
+std::vector<int> ShortestPathTree::pathTo(const CsrGraph& graph, int u) const {
+    // Unreachable.
+    if (dist[u] == INF) return {};
+    // Walk the parents up to the source.
+    std::vector<int> path;
+    for (int x = u; x >= 0; x = parentOf[x]) path.push_back(graph.externalId(x));
+    // Source first.
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+// Makes child the first child of parent.
+void ShortestPathTree::link(int child, int parent) {
+    // Point at the parent.
+    parentOf[child] = parent;
+    // Push onto the parent's child list.
+    prevSibling[child] = -1;
+    nextSibling[child] = firstChild[parent];
+    if (firstChild[parent] >= 0) prevSibling[firstChild[parent]] = child;
+    firstChild[parent] = child;
+}
+
+// Removes child from its parent's child list.
+void ShortestPathTree::unlink(int child) {
+    // Parent it hangs off (the source and unreachable nodes have none).
+    int parent = parentOf[child];
+    if (parent < 0) return;
+    // Bridge over it.
+    if (prevSibling[child] >= 0) nextSibling[prevSibling[child]] = nextSibling[child];
+    else firstChild[parent] = nextSibling[child];
+    if (nextSibling[child] >= 0) prevSibling[nextSibling[child]] = prevSibling[child];
+    // Detached.
+    parentOf[child] = nextSibling[child] = prevSibling[child] = -1;
+}
+
+// Lowers the label of v and queues it.
+void ShortestPathTree::lower(int v, double d, int p) {
+    // First time reached.
+    if (dist[v] == INF) ++reached;
+    // Move it under its new parent (its own subtree comes along and is fixed by the propagation).
+    unlink(v);
+    link(v, p);
+    // New label.
+    dist[v] = d;
+    queue.push(v, d);
+    // Count it.
+    ++changed;
+}
+
+// Cheapest weight of the edges u -> v.
+double ShortestPathTree::edgeWeight(const CsrGraph& graph, int u, int v) {
+    // Scan u's edges for parallel ones.
+    double best = INF;
+    for (int e = graph.beginEdge(u); e < graph.endEdge(u); ++e) if (graph.edgeHead(e) == v) best = std::min(best, graph.edgeWeight(e));
+    // Cheapest one.
+    return best;
+}
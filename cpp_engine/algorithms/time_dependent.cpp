@@ -0,0 +1,220 @@
+#include "../include/algorithms.h"
+#include "../include/stats.h"
+#include "../include/travel_time.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+    // Arrival-time functions closer than this are treated as equal.
+    const double EPSILON = 1e-9;
+
+    // Value of a label (departure -> arrival) at a departure within its domain.
+    double valueAt(const std::vector<Breakpoint>& label, double departure) {
+        // First breakpoint after the departure.
+        auto next = std::upper_bound(label.begin(), label.end(), departure, [](double time, const Breakpoint& point) { return time < point.time; });
+        // Clamp to the domain at both ends.
+        if (next == label.begin()) return label.front().value;
+        if (next == label.end()) return label.back().value;
+        // Linear in between.
+        const Breakpoint& a = next[-1];
+        const Breakpoint& b = *next;
+        return a.value + (b.value - a.value) * (departure - a.time) / (b.time - a.time);
+    }
+
+    // Appends a breakpoint unless it continues the line through the last two (keeps labels small).
+    void append(std::vector<Breakpoint>& label, Breakpoint point) {
+        // Same departure as the last breakpoint: keep the earlier arrival.
+        if (!label.empty() && point.time - label.back().time <= EPSILON) { label.back().value = std::min(label.back().value, point.value); return; }
+        // Collinear with the last two: move the last one instead.
+        if (label.size() >= 2) {
+            const Breakpoint& a = label[label.size() - 2];
+            const Breakpoint& b = label.back();
+            // Value on the line through a and b at the new departure.
+            double predicted = a.value + (b.value - a.value) * (point.time - a.time) / (b.time - a.time);
+            if (std::fabs(predicted - point.value) <= EPSILON * std::max(1.0, std::fabs(point.value))) { label.back() = point; return; }
+        }
+        // New piece.
+        label.push_back(point);
+    }
+
+    // Composes a label with the travel-time function of edge e: arrival at the head for every departure.
+    void extend(const CsrGraph& graph, int e, const std::vector<Breakpoint>& label, std::vector<Breakpoint>& result) {
+        // Start over.
+        result.clear();
+        // Constant edges shift the whole label.
+        int f = graph.profile.empty() ? -1 : graph.profile[e];
+        if (f < 0 || graph.firstBreakpoint[f + 1] - graph.firstBreakpoint[f] == 1) {
+            // Same breakpoints, later arrivals.
+            double weight = graph.travelTime(e, 0.0);
+            for (const Breakpoint& point : label) result.push_back({point.time, point.value + weight});
+            return;
+        }
+        // Breakpoints of the edge's function.
+        const Breakpoint* points = graph.breakpoints.data() + graph.firstBreakpoint[f];
+        int count = graph.firstBreakpoint[f + 1] - graph.firstBreakpoint[f];
+        // Every piece of the label.
+        for (size_t i = 0; i < label.size(); ++i) {
+            // Start of the piece.
+            const Breakpoint& a = label[i];
+            append(result, {a.time, a.value + TravelTime::evaluate(points, count, a.value)});
+            // Last breakpoint closes the label.
+            if (i + 1 == label.size()) break;
+            // End of the piece; arrivals never decrease along a label (FIFO).
+            const Breakpoint& b = label[i + 1];
+            if (b.value <= a.value) continue;
+            // Edge breakpoints reached strictly inside the piece add a breakpoint at their preimage.
+            double period = std::floor(a.value / TravelTime::PERIOD);
+            // First edge breakpoint after the piece's start.
+            int k = static_cast<int>(std::upper_bound(points, points + count, a.value - period * TravelTime::PERIOD,
+                                                      [](double time, const Breakpoint& point) { return time < point.time; }) - points);
+            // Walk the periodic breakpoints up to the piece's end.
+            for (;; ++k) {
+                // Next period.
+                if (k == count) { k = 0; period += 1.0; }
+                // Arrival time of the breakpoint.
+                double arrival = period * TravelTime::PERIOD + points[k].time;
+                if (arrival >= b.value) break;
+                // Departure reaching it.
+                double departure = a.time + (b.time - a.time) * (arrival - a.value) / (b.value - a.value);
+                append(result, {departure, arrival + points[k].value});
+            }
+        }
+    }
+
+    // Lower envelope of two labels over the same domain; sets improved if candidate is below
+    // current anywhere.
+    std::vector<Breakpoint> lowerEnvelope(const std::vector<Breakpoint>& current, const std::vector<Breakpoint>& candidate, bool& improved) {
+        // The envelope.
+        std::vector<Breakpoint> result;
+        improved = false;
+        // Departure and difference candidate - current at the previous breakpoint.
+        double previousTime = 0.0, previousDifference = 0.0;
+        // Merge the departures of both labels.
+        size_t i = 0, j = 0;
+        while (i < current.size() || j < candidate.size()) {
+            // Next departure in either label.
+            double time = j == candidate.size() || (i < current.size() && current[i].time < candidate[j].time) ? current[i].time : candidate[j].time;
+            // Consume it in both.
+            if (i < current.size() && current[i].time == time) ++i;
+            if (j < candidate.size() && candidate[j].time == time) ++j;
+            // Both values.
+            double ours = valueAt(current, time), theirs = valueAt(candidate, time);
+            double difference = theirs - ours;
+            // Crossing since the previous departure.
+            if (!result.empty() && ((previousDifference < 0.0 && difference > 0.0) || (previousDifference > 0.0 && difference < 0.0))) {
+                // Both are linear in between, so they meet where the difference vanishes.
+                double crossing = previousTime + (time - previousTime) * previousDifference / (previousDifference - difference);
+                append(result, {crossing, valueAt(candidate, crossing)});
+            }
+            // Strictly better somewhere.
+            if (difference < -EPSILON * std::max(1.0, std::fabs(ours))) improved = true;
+            // Lower of the two.
+            append(result, {time, std::min(ours, theirs)});
+            // Remember for the next crossing test.
+            previousTime = time;
+            previousDifference = difference;
+        }
+        return result;
+    }
+}
+
+// Earliest arrival from start to end when departing at the given time.
+std::vector<int> Algorithms::timeDependentDijkstra(const CsrGraph& graph, QueryWorkspace& workspace, int startNode, int endNode, double departure, double& arrival) {
+    // Translate the endpoints to internal indices.
+    int source = graph.internalId(startNode);
+    int target = graph.internalId(endNode);
+    // Unreachable until found.
+    arrival = INF;
+    // Unknown endpoints cannot be connected.
+    if (source < 0 || target < 0) return {};
+    // Labels are arrival times.
+    workspace.reset(graph.numNodes());
+    IndexedDaryHeap<4>& queue = workspace.daryQueue;
+    queue.reset(graph.numNodes());
+    // Leave the source at the departure time.
+    workspace.setLabel(source, departure, -1);
+    queue.push(source, departure);
+    // Counts of this search, published when it returns.
+    ROUTE_STATS(Stats::Local counters; ++counters[Stats::HeapPushes];)
+    // FIFO functions make the earliest arrival at a settled node final.
+    while (!queue.empty()) {
+        // Earliest unsettled arrival.
+        auto [time, u] = queue.pop();
+        ROUTE_STATS(++counters[Stats::HeapPops]; ++counters[Stats::NodesSettled];)
+        // Done once the target is settled.
+        if (u == target) break;
+        // Count u's edges.
+        ROUTE_STATS(counters[Stats::EdgesRelaxed] += graph.firstOut[u + 1] - graph.firstOut[u];)
+        // Leave u at its arrival time over every outgoing edge.
+        for (int e = graph.firstOut[u]; e < graph.firstOut[u + 1]; ++e) {
+            // Arrival at the head.
+            int v = graph.head[e];
+            double next = time + graph.travelTime(e, time);
+            // Keep the earlier arrival.
+            if (next < workspace.distance(v)) {
+                workspace.setLabel(v, next, u);
+                queue.push(v, next);
+                ROUTE_STATS(++counters[Stats::HeapPushes];)
+            }
+        }
+    }
+    // Target not reached.
+    if (!workspace.reached(target)) return {};
+    // Arrival time and path.
+    arrival = workspace.distance(target);
+    return workspace.extractPath(graph, target);
+}
+
+// Arrival-time function at end for departures from start within [from, to].
+std::vector<Breakpoint> Algorithms::timeDependentProfile(const CsrGraph& graph, QueryWorkspace& workspace, int startNode, int endNode, double from, double to) {
+    // Translate the endpoints to internal indices.
+    int source = graph.internalId(startNode);
+    int target = graph.internalId(endNode);
+    // Unknown endpoints cannot be connected.
+    if (source < 0 || target < 0) return {};
+    // Function label of every reached node, indexed through the workspace's parent slots.
+    std::vector<std::vector<Breakpoint>> labels;
+    workspace.reset(graph.numNodes());
+    // Label of a node, created empty on first touch.
+    auto labelOf = [&](int u) -> std::vector<Breakpoint>& {
+        if (!workspace.reached(u)) { workspace.setLabel(u, INF, static_cast<int>(labels.size())); labels.emplace_back(); }
+        return labels[workspace.parent(u)];
+    };
+    // Queue keyed by the earliest arrival of each label.
+    IndexedDaryHeap<4>& queue = workspace.daryQueue;
+    queue.reset(graph.numNodes());
+    // The source is reached at the departure itself.
+    labelOf(source) = {{from, from}, {to, to}};
+    queue.push(source, from);
+    // Scratch for extended labels.
+    std::vector<Breakpoint> extended;
+    // Label-correcting: a node is scanned again whenever its function improves.
+    while (!queue.empty()) {
+        // Label with the earliest arrival.
+        auto [key, u] = queue.pop();
+        // Nothing left can improve the target's latest arrival.
+        if (workspace.reached(target) && key >= labels[workspace.parent(target)].back().value) break;
+        // Propagate along every outgoing edge.
+        for (int e = graph.firstOut[u]; e < graph.firstOut[u + 1]; ++e) {
+            // Arrival at the head for every departure.
+            extend(graph, e, labels[workspace.parent(u)], extended);
+            // Merge into the head's function.
+            int v = graph.head[e];
+            std::vector<Breakpoint>& label = labelOf(v);
+            // First label of v.
+            if (label.empty()) { label = extended; queue.push(v, label.front().value); continue; }
+            // Lower envelope; requeue v only if it got better.
+            bool improved = false;
+            std::vector<Breakpoint> merged = lowerEnvelope(label, extended, improved);
+            if (!improved) continue;
+            // The earliest arrival lies at some breakpoint.
+            label = std::move(merged);
+            double earliest = INF;
+            for (const Breakpoint& point : label) earliest = std::min(earliest, point.value);
+            queue.push(v, earliest);
+        }
+    }
+    // Target's arrival function, or nothing if it is unreachable.
+    return workspace.reached(target) ? labels[workspace.parent(target)] : std::vector<Breakpoint>();
+}
@@ -1,49 +1,113 @@
 #include "../include/union_find.h"
+#include "../include/algorithms.h"
+#include <algorithm>
 
-// Constructor: initializes Union-Find for a given set of node IDs.
-UnionFind::UnionFind(const std::vector<int>& nodeIds) {
-    // For each node ID in the input vector.
-    for (int id : nodeIds) {
-        // Create a new set for this node.
-        makeSet(id);
+namespace {
+    // Elements or pairs handed to a worker at a time; amortizes the pool's per-item overhead.
+    const size_t CHUNK_SIZE = 1024;
+
+    // Runs body(begin, end) over [0, count) in chunks on the pool.
+    template <typename Body>
+    void parallelChunks(ThreadPool& pool, size_t count, Body body) {
+        // Number of chunks.
+        size_t chunks = (count + CHUNK_SIZE - 1) / CHUNK_SIZE;
+        // One chunk per item.
+        pool.parallelFor(chunks, [&](size_t chunk, unsigned) { body(chunk * CHUNK_SIZE, std::min(count, (chunk + 1) * CHUNK_SIZE)); });
+    }
+}
+
+// Creates n singletons.
+DisjointSets::DisjointSets(int n) : parent(n), sizeOf(n, 1), sets(n) {
+    // Every element is its own root.
+    for (int x = 0; x < n; ++x) parent[x] = x;
+}
+
+// Representative of the set containing x, halving the path on the way.
+int DisjointSets::find(int x) {
+    // Climb until the root.
+    while (parent[x] != x) {
+        // Skip every other node: point x at its grandparent and continue from there.
+        parent[x] = parent[parent[x]];
+        x = parent[x];
+    }
+    // Root.
+    return x;
+}
+
+// Merges the sets of a and b by size.
+bool DisjointSets::unite(int a, int b) {
+    // Roots of both.
+    a = find(a);
+    b = find(b);
+    // Already one set.
+    if (a == b) return false;
+    // Hang the smaller set under the larger one.
+    if (sizeOf[a] < sizeOf[b]) std::swap(a, b);
+    parent[b] = a;
+    sizeOf[a] += sizeOf[b];
+    // One set fewer.
+    --sets;
+    return true;
+}
+
+// Creates n singletons.
+ConcurrentDisjointSets::ConcurrentDisjointSets(int n) : n(n), parent(new std::atomic<int>[n]) {
+    // Every element is its own root.
+    for (int x = 0; x < n; ++x) parent[x].store(x, std::memory_order_relaxed);
+}
+
+// Representative of the set containing x.
+int ConcurrentDisjointSets::find(int x) {
+    // Climb until the root.
+    while (true) {
+        // Parent of x.
+        int p = parent[x].load(std::memory_order_acquire);
+        // x is a root.
+        if (p == x) return x;
+        // Grandparent.
+        int gp = parent[p].load(std::memory_order_acquire);
+        // Halve the path; if another thread changed parent[x] meanwhile, its value is at least as good.
+        if (p != gp) parent[x].compare_exchange_weak(p, gp, std::memory_order_release, std::memory_order_relaxed);
+        // Continue from the grandparent.
+        x = gp;
     }
 }
 
-// Makes a new set containing only the element 'v'.
-void UnionFind::makeSet(int v) {
-    // The parent of 'v' is 'v' itself.
-    parent[v] = v;
-    // The initial rank of 'v' is 0.
-    rank[v] = 0;
-}
-
-// Finds the representative (root) of the set containing 'v' with path compression.
-int UnionFind::findSet(int v) {
-    // If 'v' is not its own parent, it's not the root.
-    if (v == parent[v])
-        // If 'v' is its own parent, it is the root.
-        return v;
-    // Recursively find the root and apply path compression.
-    return parent[v] = findSet(parent[v]);
-}
-
-// Unites the sets containing elements 'a' and 'b' using union by rank.
-void UnionFind::uniteSets(int a, int b) {
-    // Find the representative of the set containing 'a'.
-    a = findSet(a);
-    // Find the representative of the set containing 'b'.
-    b = findSet(b);
-    // If 'a' and 'b' are not already in the same set.
-    if (a != b) {
-        // If rank of 'a' is less than rank of 'b'.
-        if (rank[a] < rank[b])
-            // Swap 'a' and 'b'.
-            std::swap(a, b);
-        // Make 'b' a child of 'a'.
-        parent[b] = a;
-        // If ranks were equal, increment rank of 'a'.
-        if (rank[a] == rank[b])
-            // Increment rank of the new root.
-            rank[a]++;
+// Merges the sets of a and b.
+bool ConcurrentDisjointSets::unite(int a, int b) {
+    // Retry until the link succeeds or the elements turn out to share a set.
+    while (true) {
+        // Current roots.
+        a = find(a);
+        b = find(b);
+        // Already one set.
+        if (a == b) return false;
+        // The larger index goes under the smaller one.
+        if (a < b) std::swap(a, b);
+        // Link a only if it is still a root; otherwise someone linked it first and we retry.
+        int expected = a;
+        if (parent[a].compare_exchange_strong(expected, b, std::memory_order_acq_rel, std::memory_order_acquire)) return true;
     }
-}
\ No newline at end of file
+}
+
+// Weakly connected components of a graph.
+std::vector<int> Algorithms::componentsOfGraph(const CsrGraph& graph, ThreadPool& pool) {
+    // One singleton per node.
+    ConcurrentDisjointSets components(graph.numNodes());
+    // Unite the ends of every edge, node ranges in parallel.
+    parallelChunks(pool, static_cast<size_t>(graph.numNodes()), [&](size_t begin, size_t end) {
+        // Nodes of this chunk.
+        for (size_t u = begin; u < end; ++u) {
+            // Every outgoing edge.
+            for (int e = graph.beginEdge(static_cast<int>(u)); e < graph.endEdge(static_cast<int>(u)); ++e) components.unite(static_cast<int>(u), graph.edgeHead(e));
+        }
+    });
+    // Label of every node: the smallest index of its component.
+    std::vector<int> labels(graph.numNodes());
+    parallelChunks(pool, labels.size(), [&](size_t begin, size_t end) {
+        // Nodes of this chunk.
+        for (size_t u = begin; u < end; ++u) labels[u] = components.find(static_cast<int>(u));
+    });
+    // Return the labels.
+    return labels;
+}
@@ -0,0 +1,153 @@
+#include "generators.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+// Builds a width x height bidirectional grid with random weights.
+Graph Generators::grid(int width, int height, unsigned seed, double spacing) {
+    // Deterministic random source.
+    std::mt19937 rng(seed);
+    // Weights between one and three grid spacings.
+    std::uniform_real_distribution<double> weight(spacing, 3.0 * spacing);
+    // Graph being built.
+    Graph graph;
+    // Add every node at its grid position; ID = row * width + column.
+    for (int row = 0; row < height; ++row) {
+        // For each column.
+        for (int col = 0; col < width; ++col) {
+            // Add the node.
+            graph.addNode(row * width + col, col * spacing, row * spacing);
+        }
+    }
+    // Connect horizontal and vertical neighbors in both directions.
+    for (int row = 0; row < height; ++row) {
+        // For each column.
+        for (int col = 0; col < width; ++col) {
+            // ID of this node.
+            int id = row * width + col;
+            // Right neighbor.
+            if (col + 1 < width) {
+                // Forward edge.
+                graph.addEdge(id, id + 1, weight(rng));
+                // Backward edge.
+                graph.addEdge(id + 1, id, weight(rng));
+            }
+            // Lower neighbor.
+            if (row + 1 < height) {
+                // Forward edge.
+                graph.addEdge(id, id + width, weight(rng));
+                // Backward edge.
+                graph.addEdge(id + width, id, weight(rng));
+            }
+        }
+    }
+    // Return the grid.
+    return graph;
+}
+
+// Builds a random geometric graph.
+Graph Generators::randomGeometric(int n, unsigned seed, double averageDegree, double spacing) {
+    // Deterministic random source.
+    std::mt19937 rng(seed);
+    // Side of the square.
+    double side = std::sqrt(static_cast<double>(n)) * spacing;
+    std::uniform_real_distribution<double> coordinate(0.0, side);
+    // Detour factor of the edges.
+    std::uniform_real_distribution<double> detour(1.0, 1.5);
+    // Radius whose disc holds averageDegree nodes on average.
+    double radius = spacing * std::sqrt(averageDegree / 3.141592653589793);
+    // Graph being built.
+    Graph graph;
+    // Node positions.
+    std::vector<double> xs(n), ys(n);
+    for (int i = 0; i < n; ++i) {
+        // Draw and add the node.
+        xs[i] = coordinate(rng);
+        ys[i] = coordinate(rng);
+        graph.addNode(i, xs[i], ys[i]);
+    }
+    // Buckets of radius-sized cells, so that neighbors are searched in the 3 x 3 cells around a node.
+    int cells = std::max(1, static_cast<int>(side / radius));
+    std::vector<std::vector<int>> bucket(static_cast<size_t>(cells) * cells);
+    // Cell of a coordinate.
+    auto cellOf = [&](double value) { return std::min(cells - 1, static_cast<int>(value / side * cells)); };
+    for (int i = 0; i < n; ++i) bucket[static_cast<size_t>(cellOf(ys[i])) * cells + cellOf(xs[i])].push_back(i);
+    // Connect every pair within the radius once, in both directions.
+    for (int i = 0; i < n; ++i) {
+        // Cell of node i.
+        int cx = cellOf(xs[i]), cy = cellOf(ys[i]);
+        // Neighboring cells.
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                // Skip cells outside the square.
+                if (cx + dx < 0 || cx + dx >= cells || cy + dy < 0 || cy + dy >= cells) continue;
+                // Candidates with a larger index (each pair once).
+                for (int j : bucket[static_cast<size_t>(cy + dy) * cells + cx + dx]) {
+                    // Distance check.
+                    double length = std::hypot(xs[i] - xs[j], ys[i] - ys[j]);
+                    if (j <= i || length > radius) continue;
+                    // Both directions.
+                    graph.addEdge(i, j, length * detour(rng));
+                    graph.addEdge(j, i, length * detour(rng));
+                }
+            }
+        }
+    }
+    // Return the graph.
+    return graph;
+}
+
+// Builds a road-like street grid with a speed hierarchy.
+Graph Generators::roadLike(int width, int height, unsigned seed, double spacing) {
+    // Deterministic random source.
+    std::mt19937 rng(seed);
+    // Intersections move up to 30% of a block.
+    std::uniform_real_distribution<double> jitter(-0.3 * spacing, 0.3 * spacing);
+    // Congestion factor per edge and direction.
+    std::uniform_real_distribution<double> congestion(1.0, 1.2);
+    // Chance that a local street segment is missing.
+    std::bernoulli_distribution missing(0.1);
+    // Speeds (m/s) of local streets, arterials and highways.
+    const double speeds[] = {8.0, 15.0, 30.0};
+    // Class of a grid line.
+    auto classOf = [](int line) { return line % 16 == 0 ? 2 : line % 4 == 0 ? 1 : 0; };
+    // Graph being built.
+    Graph graph;
+    // Intersections; ID = row * width + column.
+    std::vector<double> xs(static_cast<size_t>(width) * height), ys(xs.size());
+    for (int row = 0; row < height; ++row) {
+        // For each column.
+        for (int col = 0; col < width; ++col) {
+            // Jittered position.
+            int id = row * width + col;
+            xs[id] = col * spacing + jitter(rng);
+            ys[id] = row * spacing + jitter(rng);
+            graph.addNode(id, xs[id], ys[id]);
+        }
+    }
+    // Adds a street segment in both directions.
+    auto connect = [&](int a, int b, int roadClass) {
+        // Local streets are sometimes missing.
+        if (roadClass == 0 && missing(rng)) return;
+        // Travel time relative to a highway of the same length.
+        double length = std::hypot(xs[a] - xs[b], ys[a] - ys[b]);
+        double factor = speeds[2] / speeds[roadClass];
+        graph.addEdge(a, b, length * factor * congestion(rng));
+        graph.addEdge(b, a, length * factor * congestion(rng));
+    };
+    // Horizontal segments take the class of their row, vertical ones that of their column.
+    for (int row = 0; row < height; ++row) {
+        // For each column.
+        for (int col = 0; col < width; ++col) {
+            // ID of this intersection.
+            int id = row * width + col;
+            // Right neighbor.
+            if (col + 1 < width) connect(id, id + 1, classOf(row));
+            // Lower neighbor.
+            if (row + 1 < height) connect(id, id + width, classOf(col));
+        }
+    }
+    // Return the network.
+    return graph;
+}
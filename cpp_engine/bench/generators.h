@@ -0,0 +1,22 @@
+#ifndef BENCH_GENERATORS_H
+#define BENCH_GENERATORS_H
+
+#include "../include/graph.h"
+
+// Deterministic synthetic graphs for the benchmarks. The same seed always yields the same graph.
+namespace Generators {
+    // width x height grid with edges in both directions between 4-neighbors; coordinates are
+    // spacing apart and weights are uniform in [spacing, 3*spacing], so Euclidean A* is admissible.
+    Graph grid(int width, int height, unsigned seed, double spacing = 10.0);
+    // n nodes uniform in a square of side sqrt(n) * spacing, each connected in both directions to
+    // every node within the radius that gives the requested average degree; weights are the
+    // Euclidean length times a factor in [1, 1.5].
+    Graph randomGeometric(int n, unsigned seed, double averageDegree = 6.0, double spacing = 100.0);
+    // Road-like network: a width x height street grid with blocks spacing meters apart, jittered
+    // intersections and some local streets missing. Every 4th line is an arterial and every 16th a
+    // highway, with speeds of 8, 15 and 30 m/s; weights are travel times scaled so that a highway
+    // costs its length, which keeps Euclidean A* admissible while the hierarchy shapes the paths.
+    Graph roadLike(int width, int height, unsigned seed, double spacing = 100.0);
+}
+
+#endif
@@ -0,0 +1,191 @@
+// Measures JSON graph loading throughput: the streaming JsonReader loader against the previous
+// line-based parser, on a generated grid with millions of edges.
+//
+// Usage: json_bench [grid_side] [work_dir]
+// Writes the grid twice (one object per line as dump_graph_json does, and minified with shuffled
+// key order), then prints one CSV row per (parser, file): time, MB/s and the node/edge counts read.
+// "tokenize" only walks the document without building a graph; "legacy" reads nothing from the
+// minified file, which is the bug the new loader fixes.
+#include "../include/graph_io.h"
+#include "../include/json_reader.h"
+#include "../include/mapped_file.h"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <random>
+#include <string>
+
+namespace {
+    // Helper to trim whitespace
+    std::string trim(const std::string& str) {
+        // Find the first non-whitespace character.
+        const auto strBegin = str.find_first_not_of(" \t\n\r");
+        // If no non-whitespace character is found, return an empty string.
+        if (strBegin == std::string::npos) return "";
+        // Find the last non-whitespace character.
+        const auto strEnd = str.find_last_not_of(" \t\n\r");
+        // Return the substring containing only non-whitespace characters.
+        return str.substr(strBegin, strEnd - strBegin + 1);
+    }
+
+    // The previous loader, kept verbatim (minus comments) as the baseline: one object per line,
+    // fields located with find() and re-scanned with substr/stoi/stod.
+    bool legacyLoadGraphFromJson(const std::string& filepath, Graph& graph) {
+        std::ifstream file(filepath);
+        if (!file.is_open()) return false;
+        std::string line;
+        std::string current_section;
+        while (std::getline(file, line)) {
+            line = trim(line);
+            if (line.empty() || line == "{" || line == "}" || line == "[" || line == "]") continue;
+            if (line.find("\"nodes\"") != std::string::npos) { current_section = "nodes"; continue; }
+            else if (line.find("\"edges\"") != std::string::npos) { current_section = "edges"; continue; }
+            if (current_section == "nodes") {
+                size_t id_pos = line.find("\"id\":");
+                size_t x_pos = line.find("\"x\":");
+                size_t y_pos = line.find("\"y\":");
+                if (id_pos != std::string::npos) {
+                    int id = 0;
+                    double x = 0.0, y = 0.0;
+                    std::string temp = line.substr(id_pos + 5);
+                    size_t comma_pos = temp.find(',');
+                    id = std::stoi(trim(temp.substr(0, comma_pos)));
+                    if (x_pos != std::string::npos) {
+                        temp = line.substr(x_pos + 4);
+                        comma_pos = temp.find(',');
+                        x = std::stod(trim(temp.substr(0, comma_pos)));
+                    }
+                    if (y_pos != std::string::npos) {
+                        temp = line.substr(y_pos + 4);
+                        size_t brace_pos = temp.find('}');
+                        y = std::stod(trim(temp.substr(0, brace_pos)));
+                    }
+                    graph.addNode(id, x, y);
+                }
+            } else if (current_section == "edges") {
+                size_t from_pos = line.find("\"from\":");
+                size_t to_pos = line.find("\"to\":");
+                size_t weight_pos = line.find("\"weight\":");
+                if (from_pos != std::string::npos && to_pos != std::string::npos && weight_pos != std::string::npos) {
+                    std::string temp = line.substr(from_pos + 7);
+                    size_t comma_pos = temp.find(',');
+                    int from_node = std::stoi(trim(temp.substr(0, comma_pos)));
+                    temp = line.substr(to_pos + 5);
+                    comma_pos = temp.find(',');
+                    int to_node = std::stoi(trim(temp.substr(0, comma_pos)));
+                    temp = line.substr(weight_pos + 9);
+                    size_t brace_pos = temp.find('}');
+                    double weight = std::stod(trim(temp.substr(0, brace_pos)));
+                    graph.addEdge(from_node, to_node, weight);
+                }
+            }
+        }
+        return true;
+    }
+
+    // Writes a side x side bidirectional grid; pretty puts one object per line, otherwise the file
+    // is a single line with edge keys in a different order. Returns the number of edges.
+    long long writeGrid(const std::string& path, int side, bool pretty) {
+        // Output file.
+        FILE* file = std::fopen(path.c_str(), "wb");
+        // Nothing written.
+        if (!file) return 0;
+        // Same weights in both files.
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<double> weight(10.0, 30.0);
+        // Separators of the two layouts.
+        const char* newline = pretty ? "\n" : "";
+        const char* indent = pretty ? "    " : "";
+        // Nodes.
+        std::fprintf(file, "{%s%s\"nodes\": [%s", newline, pretty ? "  " : "", newline);
+        for (int id = 0; id < side * side; ++id) {
+            // Node object.
+            std::fprintf(file, "%s{ \"id\": %d, \"x\": %d.0, \"y\": %d.0 }%s%s", indent, id, (id % side) * 10, (id / side) * 10,
+                         id + 1 < side * side ? "," : "", newline);
+        }
+        // Edges to the right and down neighbors, both directions.
+        std::fprintf(file, "%s],%s%s\"edges\": [%s", pretty ? "  " : "", newline, pretty ? "  " : "", newline);
+        // Edges written so far.
+        long long edges = 0;
+        // Writes one edge object.
+        auto edge = [&](int from, int to) {
+            // Separator after the previous edge.
+            if (edges++) std::fprintf(file, ",%s", newline);
+            // Pretty files use the dump_graph_json key order; minified ones lead with the weight.
+            if (pretty) std::fprintf(file, "%s{ \"from\": %d, \"to\": %d, \"weight\": %.6f }", indent, from, to, weight(rng));
+            else std::fprintf(file, "{\"weight\":%.6f,\"to\":%d,\"from\":%d}", weight(rng), to, from);
+        };
+        // Every node.
+        for (int id = 0; id < side * side; ++id) {
+            // Right neighbor.
+            if ((id % side) + 1 < side) { edge(id, id + 1); edge(id + 1, id); }
+            // Lower neighbor.
+            if (id + side < side * side) { edge(id, id + side); edge(id + side, id); }
+        }
+        // Close the document.
+        std::fprintf(file, "%s%s]%s}%s", newline, pretty ? "  " : "", newline, newline);
+        std::fclose(file);
+        // Edge count.
+        return edges;
+    }
+
+    // Runs one loader on one file and prints its row.
+    void measure(const char* parser, const char* name, const std::string& path, const std::function<bool(Graph&)>& load) {
+        // Graph being filled.
+        Graph graph;
+        // Start the clock.
+        auto begin = std::chrono::steady_clock::now();
+        // Load.
+        bool ok = load(graph);
+        // Elapsed time in seconds.
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        // Size of the input.
+        double megabytes = static_cast<double>(std::filesystem::file_size(path)) / (1024.0 * 1024.0);
+        // Edges read.
+        long long edges = 0;
+        for (const auto& entry : graph.adj) edges += static_cast<long long>(entry.second.size());
+        // Report the row.
+        std::printf("%s,%s,%.1f,%.1f,%.1f,%zu,%lld,%s\n", parser, name, megabytes, seconds * 1000.0, megabytes / seconds,
+                    graph.nodes.size(), edges, ok ? "ok" : "error");
+    }
+}
+
+// Entry point.
+int main(int argc, char* argv[]) {
+    // Grid side (1000 gives 1M nodes and ~4M edges).
+    int side = argc > 1 ? std::stoi(argv[1]) : 1000;
+    // Directory for the generated files.
+    std::filesystem::path dir = argc > 2 ? std::filesystem::path(argv[2]) : std::filesystem::temp_directory_path();
+    // Both layouts.
+    const std::pair<const char*, std::string> files[] = {{"pretty", (dir / "json_bench_pretty.json").string()},
+                                                         {"minified", (dir / "json_bench_minified.json").string()}};
+    // Generate them.
+    long long edges = writeGrid(files[0].second, side, true);
+    writeGrid(files[1].second, side, false);
+    // Summary on stderr, CSV on stdout.
+    std::fprintf(stderr, "grid %dx%d: %d nodes, %lld edges\n", side, side, side * side, edges);
+    std::printf("parser,file,mb,ms,mb_per_s,nodes,edges,status\n");
+    // Every file.
+    for (const auto& file : files) {
+        // Pure parsing: walk the whole document without building anything.
+        measure("tokenize", file.first, file.second, [&](Graph&) {
+            // Map the file.
+            MappedFile mapped;
+            std::string error;
+            if (!mapped.open(file.second, error)) return false;
+            // Skip the top-level value.
+            JsonReader reader(mapped.data(), mapped.size());
+            return reader.skipValue() && reader.finish();
+        });
+        // Streaming loader into a Graph.
+        measure("json_reader", file.first, file.second, [&](Graph& graph) { return GraphIO::loadGraphFromJson(file.second, graph); });
+        // Previous loader into a Graph.
+        measure("legacy", file.first, file.second, [&](Graph& graph) { return legacyLoadGraphFromJson(file.second, graph); });
+    }
+    // Clean up.
+    for (const auto& file : files) std::filesystem::remove(file.second);
+    // Done.
+    return 0;
+}
@@ -0,0 +1,90 @@
+// Compares the priority queue policies of the search kernels on the sample graph and synthetic grids.
+//
+// Usage: queue_bench [sample_graph.json] [queries_per_graph]
+// Prints one CSV row per (graph, algorithm, queue): total and per-query time plus a checksum of the
+// path weights, which must be identical across queues of the same algorithm (and between
+// dijkstra and bidijkstra).
+#include "../include/algorithms.h"
+#include "../include/graph_io.h"
+#include "generators.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Runs every (algorithm, queue) combination on one graph.
+static void benchmarkGraph(const std::string& name, const Graph& graph, int queries) {
+    // Freeze once; all kernels run on the CSR copy.
+    CsrGraph csr(graph);
+    // Nothing to do on an empty graph.
+    if (csr.numNodes() == 0) return;
+    // Fixed random query pairs, shared by all combinations.
+    std::mt19937 rng(42);
+    // Uniform choice of internal node.
+    std::uniform_int_distribution<int> pick(0, csr.numNodes() - 1);
+    // Query pairs as external IDs.
+    std::vector<std::pair<int, int>> pairs;
+    // Draw the pairs.
+    for (int i = 0; i < queries; ++i) pairs.push_back({csr.externalId(pick(rng)), csr.externalId(pick(rng))});
+    // Queue policies under test.
+    const std::pair<const char*, QueueKind> queues[] = {
+        {"binary", QueueKind::Binary}, {"dary4", QueueKind::Dary4}, {"radix", QueueKind::Radix}, {"bucket", QueueKind::Bucket}};
+    // Reused workspaces, as the engine does (the second one holds backward labels).
+    QueryWorkspace workspace(csr.numNodes()), reverseWorkspace(csr.numNodes());
+    // Algorithms under test.
+    const char* algorithms[] = {"dijkstra", "astar", "bidijkstra", "biastar"};
+    // Every algorithm.
+    for (int algorithm = 0; algorithm < 4; ++algorithm) {
+        // Every queue.
+        for (const auto& queue : queues) {
+            // Sum of finite path weights.
+            double checksum = 0;
+            // Start the clock.
+            auto begin = std::chrono::steady_clock::now();
+            // Run all queries.
+            for (const auto& pair : pairs) {
+                // Weight of this query's path.
+                double weight = 0;
+                // Run the selected algorithm.
+                switch (algorithm) {
+                    case 0: Algorithms::dijkstra(csr, workspace, pair.first, pair.second, weight, queue.second); break;
+                    case 1: Algorithms::aStar(csr, workspace, pair.first, pair.second, weight, queue.second); break;
+                    case 2: Algorithms::bidirectionalDijkstra(csr, workspace, reverseWorkspace, pair.first, pair.second, weight, queue.second); break;
+                    default: Algorithms::bidirectionalAStar(csr, workspace, reverseWorkspace, pair.first, pair.second, weight, queue.second); break;
+                }
+                // Accumulate reachable results.
+                if (weight != INF) checksum += weight;
+            }
+            // Elapsed time in milliseconds.
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+            // Report the row.
+            std::printf("%s,%d,%s,%s,%d,%.3f,%.3f,%.4f\n", name.c_str(), csr.numNodes(), algorithms[algorithm],
+                        queue.first, queries, ms, ms * 1000.0 / queries, checksum);
+        }
+    }
+}
+
+// Entry point.
+int main(int argc, char* argv[]) {
+    // Sample graph path.
+    std::string samplePath = argc > 1 ? argv[1] : "data/sample_graph.json";
+    // Queries per graph.
+    int queries = argc > 2 ? std::stoi(argv[2]) : 200;
+    // CSV header.
+    std::printf("graph,nodes,algorithm,queue,queries,total_ms,us_per_query,checksum\n");
+    // Sample graph, if it can be loaded.
+    Graph sample;
+    // Benchmark it.
+    if (GraphIO::loadGraphFromJson(samplePath, sample)) benchmarkGraph("sample", sample, queries);
+    // Synthetic grids of increasing size.
+    for (int side : {100, 300, 600}) {
+        // Generate the grid.
+        Graph grid = Generators::grid(side, side, 7);
+        // Benchmark it.
+        benchmarkGraph("grid" + std::to_string(side), grid, queries);
+    }
+    // Done.
+    return 0;
+}
@@ -0,0 +1,481 @@
+// End-to-end benchmark suite on deterministic synthetic road graphs, for tracking regressions
+// between releases.
+//
+// Usage: route_bench [--scale small|medium|large] [--seed <n>] [--format json|csv]
+//                    [--scenarios load,queries,apsp,unionfind,updates] [--work-dir <dir>] [--output <file>]
+// Every scenario runs on a grid, a random geometric graph and a road-like network (see
+// generators.h) of the chosen scale. Each row reports one operation: its sample count, total time,
+// mean and p50/p90/p99/max latency in microseconds, and a checksum of the results, which must not
+// change between builds unless the answers do. Operations too fast to time one by one (union-find
+// steps, connectivity queries) are timed in batches of BATCH and reported per operation.
+#include "../include/algorithms.h"
+#include "../include/dynamic_connectivity.h"
+#include "../include/engine.h"
+#include "../include/graph_io.h"
+#include "../include/union_find.h"
+#include "generators.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+    // Operations per timed sample for the very fast ones.
+    const int BATCH = 256;
+
+    // Latency summary of one operation.
+    struct Row {
+        // Scenario, graph and operation names.
+        std::string scenario, graph, operation;
+        // Size of the graph.
+        int nodes = 0;
+        int edges = 0;
+        // Number of samples and total time.
+        size_t samples = 0;
+        double totalMs = 0.0;
+        // Mean and percentile latencies in microseconds.
+        double meanUs = 0.0, p50Us = 0.0, p90Us = 0.0, p99Us = 0.0, maxUs = 0.0;
+        // Checksum of the results.
+        double checksum = 0.0;
+    };
+
+    // Benchmark settings.
+    struct Options {
+        // Graph sizes: "small", "medium" or "large".
+        std::string scale = "small";
+        // Seed of the generators and of the query workloads.
+        unsigned seed = 1;
+        // "json" or "csv".
+        std::string format = "json";
+        // Scenarios to run.
+        std::vector<std::string> scenarios = {"load", "queries", "apsp", "unionfind", "updates"};
+        // Directory for the generated files.
+        std::string workDir = std::filesystem::temp_directory_path().string();
+        // Output file; standard output if empty.
+        std::string output;
+    };
+
+    // Microseconds elapsed since begin.
+    double elapsedUs(std::chrono::steady_clock::time_point begin) {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count();
+    }
+
+    // Collects per-operation latencies and summarizes them into rows.
+    class Recorder {
+    public:
+        // Rows produced so far.
+        std::vector<Row> rows;
+
+        // Sets the graph the next rows belong to.
+        void setGraph(const std::string& name, const CsrGraph& graph) { graphName = name; nodes = graph.numNodes(); edges = graph.numEdges(); }
+        // Summarizes samples (microseconds per operation) into a row.
+        void add(const std::string& scenario, const std::string& operation, std::vector<double> samples, double checksum) {
+            // Row header.
+            Row row;
+            row.scenario = scenario;
+            row.graph = graphName;
+            row.operation = operation;
+            row.nodes = nodes;
+            row.edges = edges;
+            row.samples = samples.size();
+            row.checksum = checksum;
+            // Nothing measured.
+            if (samples.empty()) { rows.push_back(row); return; }
+            // Nearest-rank percentiles.
+            std::sort(samples.begin(), samples.end());
+            auto percentile = [&samples](double p) { return samples[std::max<size_t>(1, static_cast<size_t>(std::ceil(p * samples.size()))) - 1]; };
+            double total = 0.0;
+            for (double sample : samples) total += sample;
+            row.totalMs = total / 1000.0;
+            row.meanUs = total / samples.size();
+            row.p50Us = percentile(0.50);
+            row.p90Us = percentile(0.90);
+            row.p99Us = percentile(0.99);
+            row.maxUs = samples.back();
+            rows.push_back(row);
+        }
+
+    private:
+        // Graph of the next rows.
+        std::string graphName;
+        int nodes = 0;
+        int edges = 0;
+    };
+
+    // A generated graph.
+    struct Workload {
+        // Name including its size.
+        std::string name;
+        // Generated adjacency lists.
+        Graph graph;
+    };
+
+    // The three graph families at the given size; side is the grid side, so all have side^2 nodes.
+    std::vector<Workload> generate(int side, unsigned seed) {
+        // One graph per family.
+        std::vector<Workload> workloads;
+        workloads.push_back({"grid" + std::to_string(side), Generators::grid(side, side, seed)});
+        workloads.push_back({"geometric" + std::to_string(side * side), Generators::randomGeometric(side * side, seed)});
+        workloads.push_back({"road" + std::to_string(side), Generators::roadLike(side, side, seed)});
+        return workloads;
+    }
+
+    // Writing and reading a graph: JSON export and import, freezing, snapshot save and map.
+    void benchmarkLoad(Recorder& recorder, const Workload& workload, const CsrGraph& csr, const Options& options) {
+        // Files in the work directory.
+        std::string base = (std::filesystem::path(options.workDir) / ("route_bench_" + workload.name)).string();
+        std::string jsonPath = base + ".json", snapshotPath = base + ".snap";
+        // Repetitions of every step.
+        const int repetitions = 3;
+        std::vector<double> write, read, freeze, save, map;
+        double checksum = 0.0;
+        for (int r = 0; r < repetitions; ++r) {
+            // JSON export.
+            auto begin = std::chrono::steady_clock::now();
+            { std::ofstream file(jsonPath, std::ios::binary); GraphIO::writeGraphJson(workload.graph, file); }
+            write.push_back(elapsedUs(begin));
+            // JSON import.
+            Graph loaded;
+            begin = std::chrono::steady_clock::now();
+            GraphIO::loadGraphFromJson(jsonPath, loaded);
+            read.push_back(elapsedUs(begin));
+            // Freezing into CSR.
+            begin = std::chrono::steady_clock::now();
+            CsrGraph frozen(loaded);
+            freeze.push_back(elapsedUs(begin));
+            checksum += frozen.numEdges();
+            // Snapshot save and map.
+            std::string error;
+            begin = std::chrono::steady_clock::now();
+            GraphIO::saveSnapshot(csr, snapshotPath, error);
+            save.push_back(elapsedUs(begin));
+            CsrGraph mapped;
+            begin = std::chrono::steady_clock::now();
+            GraphIO::loadSnapshot(snapshotPath, mapped, error);
+            map.push_back(elapsedUs(begin));
+            checksum += mapped.numEdges();
+        }
+        // One row per step.
+        recorder.add("load", "json_write", write, 0.0);
+        recorder.add("load", "json_read", read, 0.0);
+        recorder.add("load", "freeze", freeze, 0.0);
+        recorder.add("load", "snapshot_save", save, 0.0);
+        recorder.add("load", "snapshot_load", map, checksum);
+        // Remove the files again.
+        std::filesystem::remove(jsonPath);
+        std::filesystem::remove(snapshotPath);
+    }
+
+    // Point-to-point queries: short (a random walk apart) and long (uniform) pairs for every algorithm.
+    void benchmarkQueries(Recorder& recorder, const CsrGraph& csr, int queries, unsigned seed) {
+        // Fixed query pairs.
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<int> pick(0, csr.numNodes() - 1);
+        std::vector<std::pair<int, int>> shortPairs, longPairs;
+        for (int i = 0; i < queries; ++i) {
+            // Long: two uniform nodes.
+            longPairs.push_back({csr.externalId(pick(rng)), csr.externalId(pick(rng))});
+            // Short: the end of a 20-step random walk.
+            int source = pick(rng), target = source;
+            for (int step = 0; step < 20 && csr.firstOut[target] < csr.firstOut[target + 1]; ++step) {
+                // Random outgoing edge.
+                int degree = csr.firstOut[target + 1] - csr.firstOut[target];
+                target = csr.head[csr.firstOut[target] + static_cast<int>(rng() % degree)];
+            }
+            shortPairs.push_back({csr.externalId(source), csr.externalId(target)});
+        }
+        // Preprocessing, timed once each.
+        auto begin = std::chrono::steady_clock::now();
+        ContractionHierarchy ch = ContractionHierarchy::build(csr);
+        recorder.add("queries", "ch_build", {elapsedUs(begin)}, 0.0);
+        begin = std::chrono::steady_clock::now();
+        CustomizableCH cch = CustomizableCH::build(csr);
+        cch.customize(csr);
+        recorder.add("queries", "cch_build", {elapsedUs(begin)}, 0.0);
+        begin = std::chrono::steady_clock::now();
+        Landmarks landmarks = Landmarks::select(csr, 8, LandmarkSelection::Avoid);
+        recorder.add("queries", "alt_build", {elapsedUs(begin)}, 0.0);
+        // Reused workspaces, as the engine does.
+        QueryWorkspace workspace(csr.numNodes()), reverseWorkspace(csr.numNodes());
+        // Algorithms under test.
+        const char* algorithms[] = {"dijkstra", "astar", "bidijkstra", "alt", "ch", "cch"};
+        // Both query mixes.
+        for (int mix = 0; mix < 2; ++mix) {
+            const std::vector<std::pair<int, int>>& pairs = mix == 0 ? shortPairs : longPairs;
+            // Every algorithm.
+            for (int algorithm = 0; algorithm < 6; ++algorithm) {
+                // Per-query latencies and the sum of finite weights.
+                std::vector<double> samples;
+                double checksum = 0.0;
+                for (const auto& pair : pairs) {
+                    // Weight of this query's path.
+                    double weight = 0.0;
+                    begin = std::chrono::steady_clock::now();
+                    switch (algorithm) {
+                        case 0: Algorithms::dijkstra(csr, workspace, pair.first, pair.second, weight); break;
+                        case 1: Algorithms::aStar(csr, workspace, pair.first, pair.second, weight); break;
+                        case 2: Algorithms::bidirectionalDijkstra(csr, workspace, reverseWorkspace, pair.first, pair.second, weight); break;
+                        case 3: Algorithms::landmarkAStar(csr, landmarks, workspace, pair.first, pair.second, weight); break;
+                        case 4: Algorithms::contractionHierarchyQuery(csr, ch, workspace, reverseWorkspace, pair.first, pair.second, weight); break;
+                        default: Algorithms::customizableCHQuery(csr, cch, workspace, reverseWorkspace, pair.first, pair.second, weight); break;
+                    }
+                    samples.push_back(elapsedUs(begin));
+                    // Accumulate reachable results.
+                    if (weight != INF) checksum += weight;
+                }
+                recorder.add("queries", std::string(mix == 0 ? "short_" : "long_") + algorithms[algorithm], samples, checksum);
+            }
+        }
+    }
+
+    // All-pairs shortest paths with the tiled Floyd-Warshall kernel in both precisions.
+    void benchmarkApsp(Recorder& recorder, const CsrGraph& csr) {
+        // Repetitions of each precision.
+        const int repetitions = 3;
+        std::vector<double> single, twice;
+        double checksum = 0.0;
+        for (int r = 0; r < repetitions; ++r) {
+            // Single precision.
+            auto begin = std::chrono::steady_clock::now();
+            DistanceMatrix<float> floats = Algorithms::floydWarshallMatrix<float>(csr);
+            single.push_back(elapsedUs(begin));
+            // Double precision.
+            begin = std::chrono::steady_clock::now();
+            DistanceMatrix<double> doubles = Algorithms::floydWarshallMatrix<double>(csr);
+            twice.push_back(elapsedUs(begin));
+            // Distance from the first node to every other one.
+            if (r == 0) for (int v = 0; v < doubles.size(); ++v) if (doubles.distance(0, v) != INF) checksum += doubles.distance(0, v);
+        }
+        recorder.add("apsp", "floyd_warshall_float", single, 0.0);
+        recorder.add("apsp", "floyd_warshall_double", twice, checksum);
+    }
+
+    // Union-find over the edges, parallel components, and dynamic connectivity with edge removals.
+    void benchmarkUnionFind(Recorder& recorder, const CsrGraph& csr, unsigned seed) {
+        // Edges as internal (tail, head) pairs.
+        std::vector<std::pair<int, int>> edges;
+        for (int u = 0; u < csr.numNodes(); ++u) for (int e = csr.firstOut[u]; e < csr.firstOut[u + 1]; ++e) edges.push_back({u, csr.head[e]});
+        std::mt19937 rng(seed);
+        std::shuffle(edges.begin(), edges.end(), rng);
+        // Sequential unions in batches.
+        DisjointSets sets(csr.numNodes());
+        std::vector<double> samples;
+        double merged = 0.0;
+        for (size_t first = 0; first < edges.size(); first += BATCH) {
+            // One batch of unions.
+            size_t last = std::min(edges.size(), first + BATCH);
+            auto begin = std::chrono::steady_clock::now();
+            for (size_t i = first; i < last; ++i) merged += sets.unite(edges[i].first, edges[i].second);
+            samples.push_back(elapsedUs(begin) / (last - first));
+        }
+        recorder.add("unionfind", "unite", samples, merged);
+        // Finds on the fully merged structure.
+        samples.clear();
+        double roots = 0.0;
+        std::uniform_int_distribution<int> pick(0, csr.numNodes() - 1);
+        for (int b = 0; b < 256; ++b) {
+            auto begin = std::chrono::steady_clock::now();
+            for (int i = 0; i < BATCH; ++i) roots += sets.find(pick(rng));
+            samples.push_back(elapsedUs(begin) / BATCH);
+        }
+        recorder.add("unionfind", "find", samples, roots);
+        // Components on all cores.
+        samples.clear();
+        double components = 0.0;
+        for (int r = 0; r < 3; ++r) {
+            auto begin = std::chrono::steady_clock::now();
+            std::vector<int> labels = Algorithms::componentsOfGraph(csr);
+            samples.push_back(elapsedUs(begin));
+            if (r == 0) for (int u = 0; u < csr.numNodes(); ++u) components += labels[u] == u;
+        }
+        recorder.add("unionfind", "components", samples, components);
+        // Dynamic connectivity: bulk build, then cut and relink random edges.
+        std::vector<int> handles;
+        auto begin = std::chrono::steady_clock::now();
+        DynamicConnectivity zones(csr, handles);
+        recorder.add("unionfind", "dynamic_build", {elapsedUs(begin)}, zones.count());
+        std::vector<double> cuts, links;
+        std::uniform_int_distribution<int> pickEdge(0, csr.numEdges() - 1);
+        for (int i = 0; i < 2000 && csr.numEdges() > 0; ++i) {
+            // Cut one edge (the hard case: it may be a spanning tree edge that needs a replacement).
+            int e = pickEdge(rng);
+            begin = std::chrono::steady_clock::now();
+            zones.cut(handles[e]);
+            cuts.push_back(elapsedUs(begin));
+            // Link it again.
+            int tail = static_cast<int>(std::upper_bound(csr.firstOut.data(), csr.firstOut.data() + csr.numNodes() + 1, e) - csr.firstOut.data()) - 1;
+            begin = std::chrono::steady_clock::now();
+            handles[e] = zones.link(csr.externalId(tail), csr.externalId(csr.head[e]));
+            links.push_back(elapsedUs(begin));
+        }
+        recorder.add("unionfind", "dynamic_cut", cuts, 0.0);
+        recorder.add("unionfind", "dynamic_link", links, zones.count());
+        // Connectivity queries.
+        samples.clear();
+        double connected = 0.0;
+        for (int b = 0; b < 64; ++b) {
+            begin = std::chrono::steady_clock::now();
+            for (int i = 0; i < BATCH; ++i) connected += zones.connected(csr.externalId(pick(rng)), csr.externalId(pick(rng)));
+            samples.push_back(elapsedUs(begin) / BATCH);
+        }
+        recorder.add("unionfind", "dynamic_connected", samples, connected);
+    }
+
+    // Weight of the "Weight:" line of a shortest_path answer, or 0.
+    double parseWeight(const std::string& text) {
+        // Position of the weight.
+        size_t at = text.find("Weight: ");
+        return at == std::string::npos ? 0.0 : std::strtod(text.c_str() + at + 8, nullptr);
+    }
+
+    // Live traffic through the engine: weight updates interleaved with queries, which pay for the
+    // cache invalidation and CCH re-customization the updates cause.
+    void benchmarkUpdates(Recorder& recorder, const Workload& workload, const CsrGraph& csr, const Options& options, int rounds) {
+        // The engine loads the graph like the backend does.
+        std::string path = (std::filesystem::path(options.workDir) / ("route_bench_" + workload.name + "_updates.json")).string();
+        { std::ofstream file(path, std::ios::binary); GraphIO::writeGraphJson(workload.graph, file); }
+        Engine engine;
+        std::ostringstream out, err;
+        engine.execute({"load_graph", path}, out, err);
+        std::filesystem::remove(path);
+        // Warm the CCH so that the first round does not pay for the build.
+        std::mt19937 rng(options.seed);
+        std::uniform_int_distribution<int> pick(0, csr.numNodes() - 1);
+        engine.execute({"shortest_path", "cch", std::to_string(csr.externalId(0)), std::to_string(csr.externalId(pick(rng)))}, out, err);
+        // Random edges with their current weights.
+        std::uniform_int_distribution<int> pickEdge(0, csr.numEdges() - 1);
+        std::uniform_real_distribution<double> factor(0.5, 2.0);
+        std::vector<double> updates, dijkstra, cch;
+        double dijkstraChecksum = 0.0, cchChecksum = 0.0;
+        for (int i = 0; i < rounds && csr.numEdges() > 0; ++i) {
+            // Change one edge's weight (the original weight times a random factor).
+            int e = pickEdge(rng);
+            int tail = static_cast<int>(std::upper_bound(csr.firstOut.data(), csr.firstOut.data() + csr.numNodes() + 1, e) - csr.firstOut.data()) - 1;
+            std::vector<std::string> update = {"update_edge_weight", std::to_string(csr.externalId(tail)), std::to_string(csr.externalId(csr.head[e])),
+                                               std::to_string(csr.weight[e] * factor(rng))};
+            auto begin = std::chrono::steady_clock::now();
+            engine.execute(update, out, err);
+            updates.push_back(elapsedUs(begin));
+            // Query both ways after it.
+            std::string source = std::to_string(csr.externalId(pick(rng))), target = std::to_string(csr.externalId(pick(rng)));
+            for (int algorithm = 0; algorithm < 2; ++algorithm) {
+                // Fresh output for the weight.
+                out.str("");
+                begin = std::chrono::steady_clock::now();
+                engine.execute({"shortest_path", algorithm == 0 ? "dijkstra" : "cch", source, target}, out, err);
+                (algorithm == 0 ? dijkstra : cch).push_back(elapsedUs(begin));
+                (algorithm == 0 ? dijkstraChecksum : cchChecksum) += parseWeight(out.str());
+            }
+            // Keep the buffer small.
+            out.str("");
+        }
+        recorder.add("updates", "update_edge_weight", updates, 0.0);
+        recorder.add("updates", "query_dijkstra", dijkstra, dijkstraChecksum);
+        recorder.add("updates", "query_cch", cch, cchChecksum);
+    }
+
+    // Prints the rows as CSV.
+    void writeCsv(std::FILE* file, const std::vector<Row>& rows) {
+        // Header.
+        std::fprintf(file, "scenario,graph,nodes,edges,operation,samples,total_ms,mean_us,p50_us,p90_us,p99_us,max_us,checksum\n");
+        // One line per row.
+        for (const Row& row : rows) {
+            std::fprintf(file, "%s,%s,%d,%d,%s,%zu,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.6f\n", row.scenario.c_str(), row.graph.c_str(), row.nodes, row.edges,
+                         row.operation.c_str(), row.samples, row.totalMs, row.meanUs, row.p50Us, row.p90Us, row.p99Us, row.maxUs, row.checksum);
+        }
+    }
+
+    // Prints the rows as one JSON document with the settings they were measured with.
+    void writeJson(std::FILE* file, const std::vector<Row>& rows, const Options& options) {
+        // Settings.
+        std::fprintf(file, "{\n  \"scale\": \"%s\",\n  \"seed\": %u,\n  \"results\": [\n", options.scale.c_str(), options.seed);
+        // One object per row.
+        for (size_t i = 0; i < rows.size(); ++i) {
+            const Row& row = rows[i];
+            std::fprintf(file,
+                         "    {\"scenario\": \"%s\", \"graph\": \"%s\", \"nodes\": %d, \"edges\": %d, \"operation\": \"%s\", \"samples\": %zu, "
+                         "\"total_ms\": %.3f, \"mean_us\": %.3f, \"p50_us\": %.3f, \"p90_us\": %.3f, \"p99_us\": %.3f, \"max_us\": %.3f, \"checksum\": %.6f}%s\n",
+                         row.scenario.c_str(), row.graph.c_str(), row.nodes, row.edges, row.operation.c_str(), row.samples, row.totalMs, row.meanUs,
+                         row.p50Us, row.p90Us, row.p99Us, row.maxUs, row.checksum, i + 1 < rows.size() ? "," : "");
+        }
+        // Close the document.
+        std::fprintf(file, "  ]\n}\n");
+    }
+
+    // Parses the command line; false on unknown or malformed options.
+    bool parseOptions(int argc, char* argv[], Options& options) {
+        // Flag-value pairs.
+        for (int i = 1; i < argc; i += 2) {
+            // Every flag takes a value.
+            if (i + 1 >= argc) return false;
+            std::string flag = argv[i], value = argv[i + 1];
+            if (flag == "--scale" && (value == "small" || value == "medium" || value == "large")) options.scale = value;
+            else if (flag == "--seed") options.seed = static_cast<unsigned>(std::stoul(value));
+            else if (flag == "--format" && (value == "json" || value == "csv")) options.format = value;
+            else if (flag == "--scenarios") options.scenarios = split(value, ',');
+            else if (flag == "--work-dir") options.workDir = value;
+            else if (flag == "--output") options.output = value;
+            else return false;
+        }
+        return true;
+    }
+}
+
+// Entry point.
+int main(int argc, char* argv[]) {
+    // Settings.
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        // Print usage instructions.
+        std::fprintf(stderr, "Usage: route_bench [--scale small|medium|large] [--seed <n>] [--format json|csv]\n"
+                             "                   [--scenarios load,queries,apsp,unionfind,updates] [--work-dir <dir>] [--output <file>]\n");
+        return 1;
+    }
+    // Whether a scenario was selected.
+    auto selected = [&options](const char* name) { return std::find(options.scenarios.begin(), options.scenarios.end(), name) != options.scenarios.end(); };
+    // Sizes per scale: grid side of the main graphs and of the APSP graphs, queries and update rounds.
+    int side = options.scale == "small" ? 100 : options.scale == "medium" ? 300 : 1000;
+    int apspSide = options.scale == "small" ? 24 : options.scale == "medium" ? 40 : 64;
+    int queries = options.scale == "small" ? 500 : 1000;
+    int rounds = options.scale == "small" ? 200 : 500;
+    // Results.
+    Recorder recorder;
+    // Main graphs.
+    if (selected("load") || selected("queries") || selected("unionfind") || selected("updates")) {
+        for (const Workload& workload : generate(side, options.seed)) {
+            // Frozen once; every scenario reads the same copy.
+            CsrGraph csr(workload.graph);
+            recorder.setGraph(workload.name, csr);
+            if (selected("load")) benchmarkLoad(recorder, workload, csr, options);
+            if (selected("queries")) benchmarkQueries(recorder, csr, queries, options.seed);
+            if (selected("unionfind")) benchmarkUnionFind(recorder, csr, options.seed);
+            if (selected("updates")) benchmarkUpdates(recorder, workload, csr, options, rounds);
+        }
+    }
+    // APSP runs on smaller graphs of the same families.
+    if (selected("apsp")) {
+        for (const Workload& workload : generate(apspSide, options.seed)) {
+            // Frozen copy.
+            CsrGraph csr(workload.graph);
+            recorder.setGraph(workload.name, csr);
+            benchmarkApsp(recorder, csr);
+        }
+    }
+    // Destination.
+    std::FILE* file = options.output.empty() ? stdout : std::fopen(options.output.c_str(), "w");
+    if (!file) { std::fprintf(stderr, "Could not open %s for writing.\n", options.output.c_str()); return 1; }
+    // Write the results.
+    if (options.format == "csv") writeCsv(file, recorder.rows);
+    else writeJson(file, recorder.rows, options);
+    // Close the file.
+    if (file != stdout) std::fclose(file);
+    return 0;
+}
@@ -2,14 +2,103 @@
 #define ALGORITHMS_H
 
 #include "graph.h"
+#include "csr_graph.h"
+#include "contraction_hierarchy.h"
+#include "crp_overlay.h"
+#include "customizable_ch.h"
+#include "distance_matrix.h"
+#include "landmarks.h"
+#include "path_batch.h"
+#include "query_workspace.h"
+#include "thread_pool.h"
+#include <functional>
 #include <vector>
 #include <map>
 
 // Contains functions for various graph algorithms.
+// The CsrGraph overloads are the real kernels; the Graph overloads freeze the graph first.
+// Node IDs in arguments and returned paths are always external IDs.
+// Overloads without a QueryWorkspace use a thread-local one, so repeated queries never re-initialize O(V) state.
+// The priority queue policy is selectable per query (see priority_queues.h); the indexed 4-ary heap is the default.
 namespace Algorithms {
+    // Endpoint of a search between point sets: a node and the cost of reaching it from the start
+    // point (sources), or of going on from it to the end point (targets).
+    struct SearchSeed {
+        int node;
+        double offset;
+    };
+
+    std::vector<int> dijkstra(const CsrGraph& graph, QueryWorkspace& workspace, int startNode, int endNode, double& pathWeight, QueueKind queue = QueueKind::Dary4);
+    std::vector<int> dijkstra(const CsrGraph& graph, int startNode, int endNode, double& pathWeight);
     std::vector<int> dijkstra(const Graph& graph, int startNode, int endNode, double& pathWeight);
+    // Dijkstra between point sets: every source starts at its offset, and the answer is the path to
+    // the target whose distance plus offset is smallest (routes between points on edges).
+    std::vector<int> dijkstra(const CsrGraph& graph, QueryWorkspace& workspace, const std::vector<SearchSeed>& sources, const std::vector<SearchSeed>& targets, double& pathWeight);
+    std::vector<int> aStar(const CsrGraph& graph, QueryWorkspace& workspace, int startNode, int endNode, double& pathWeight, QueueKind queue = QueueKind::Dary4);
+    std::vector<int> aStar(const CsrGraph& graph, int startNode, int endNode, double& pathWeight);
     std::vector<int> aStar(const Graph& graph, int startNode, int endNode, double& pathWeight);
+    // A* with the max-over-landmarks ALT potential; landmarks must have been computed on this graph.
+    std::vector<int> landmarkAStar(const CsrGraph& graph, const Landmarks& landmarks, QueryWorkspace& workspace, int startNode, int endNode, double& pathWeight, QueueKind queue = QueueKind::Dary4);
+    // Bidirectional variants search forward from the start and backward over incoming edges from the end.
+    // They need a second workspace for the backward labels; biastar uses consistent average potentials.
+    std::vector<int> bidirectionalDijkstra(const CsrGraph& graph, QueryWorkspace& forward, QueryWorkspace& backward, int startNode, int endNode, double& pathWeight, QueueKind queue = QueueKind::Dary4);
+    std::vector<int> bidirectionalDijkstra(const CsrGraph& graph, int startNode, int endNode, double& pathWeight);
+    std::vector<int> bidirectionalDijkstra(const Graph& graph, int startNode, int endNode, double& pathWeight);
+    std::vector<int> bidirectionalAStar(const CsrGraph& graph, QueryWorkspace& forward, QueryWorkspace& backward, int startNode, int endNode, double& pathWeight, QueueKind queue = QueueKind::Dary4);
+    std::vector<int> bidirectionalAStar(const CsrGraph& graph, int startNode, int endNode, double& pathWeight);
+    std::vector<int> bidirectionalAStar(const Graph& graph, int startNode, int endNode, double& pathWeight);
+    // Contraction hierarchy query; ch must have been built from (or loaded for) this graph.
+    std::vector<int> contractionHierarchyQuery(const CsrGraph& graph, const ContractionHierarchy& ch, QueryWorkspace& forward, QueryWorkspace& backward, int startNode, int endNode, double& pathWeight);
+    // Customizable CH query; cch must have been built for this graph's topology and customized with its weights.
+    std::vector<int> customizableCHQuery(const CsrGraph& graph, const CustomizableCH& cch, QueryWorkspace& forward, QueryWorkspace& backward, int startNode, int endNode, double& pathWeight);
+    // CRP overlay query; crp must have been built for this graph's topology and customized with its weights.
+    std::vector<int> crpQuery(const CsrGraph& graph, const CrpOverlay& crp, QueryWorkspace& workspace, int startNode, int endNode, double& pathWeight);
+    // Up to k shortest loopless paths from startNode to endNode, shortest first (Yen's algorithm).
+    // backward holds a reverse shortest path tree to endNode that serves as the exact A* potential of
+    // every spur search and ends it as soon as the tree path from the settled node avoids the
+    // blocked root; forward is reused by all spur searches. Candidate paths share one pooled buffer,
+    // and only the best k minus accepted of them are kept.
+    std::vector<PathResult> kShortestPaths(const CsrGraph& graph, QueryWorkspace& forward, QueryWorkspace& backward, int startNode, int endNode, int k);
+    // Time-dependent Dijkstra over the edges' travel-time functions (static weights where an edge has
+    // none): earliest arrival at endNode when leaving startNode at departure (minutes). FIFO
+    // functions keep it label-setting.
+    std::vector<int> timeDependentDijkstra(const CsrGraph& graph, QueryWorkspace& workspace, int startNode, int endNode, double departure, double& arrival);
+    // Profile search: the arrival time at endNode as a piecewise-linear function of the departure
+    // from startNode over [from, to], found label-correcting with one function label per node.
+    // Empty if endNode is unreachable.
+    std::vector<Breakpoint> timeDependentProfile(const CsrGraph& graph, QueryWorkspace& workspace, int startNode, int endNode, double from, double to);
+    // Distance tables between lists of external IDs: row-major, sources.size() x targets.size(),
+    // INF where a target is unreachable or an ID unknown. Without a hierarchy, every source runs a
+    // one-to-many Dijkstra that stops once all targets are settled; with one, targets leave their
+    // backward search spaces in per-node buckets that the forward searches scan (many-to-many).
+    // Searches run in parallel with one thread-local workspace per worker.
+    std::vector<double> distanceTable(const CsrGraph& graph, const std::vector<int>& sources, const std::vector<int>& targets, ThreadPool& pool = ThreadPool::shared());
+    std::vector<double> distanceTable(const CsrGraph& graph, const ContractionHierarchy& ch, const std::vector<int>& sources, const std::vector<int>& targets,
+                                      ThreadPool& pool = ThreadPool::shared());
+    std::vector<double> distanceTable(const CsrGraph& graph, const CustomizableCH& cch, const std::vector<int>& sources, const std::vector<int>& targets,
+                                      ThreadPool& pool = ThreadPool::shared());
+    // Answers a batch of point-to-point queries in parallel over the shared read-only graph and
+    // indexes, each worker searching with its own thread-local workspaces. Queries are processed in
+    // consecutive blocks; emit(first, results) receives each block's results in query order as soon
+    // as the block is done (results[i] answers queries[first + i]), so output can be streamed while
+    // memory stays bounded by one block. Paths are omitted when withPaths is false.
+    void shortestPathBatch(const CsrGraph& graph, const PathIndexes& indexes, const std::vector<PathQuery>& queries, bool withPaths,
+                           const std::function<void(size_t, const std::vector<PathResult>&)>& emit, QueueKind queue = QueueKind::Dary4,
+                           ThreadPool& pool = ThreadPool::shared());
+    // Weakly connected components (edge directions ignored): every edge is united in parallel on a
+    // ConcurrentDisjointSets. labels[u] is the smallest internal index of u's component.
+    std::vector<int> componentsOfGraph(const CsrGraph& graph, ThreadPool& pool = ThreadPool::shared());
+    // Workspace used by the overloads that do not take one explicitly.
+    QueryWorkspace& threadWorkspace();
+    // Backward-search workspace used by the bidirectional overloads that do not take one explicitly.
+    QueryWorkspace& threadReverseWorkspace();
+    // Tiled Floyd-Warshall into a dense matrix (T = float or double): per tile column, the diagonal
+    // tile, then its row and column tiles, then all remaining tiles, each phase in parallel.
+    template <typename T>
+    DistanceMatrix<T> floydWarshallMatrix(const CsrGraph& graph, ThreadPool& pool = ThreadPool::shared());
+    // Same result as nested maps keyed by external IDs (double precision).
+    std::map<int, std::map<int, double>> floydWarshall(const CsrGraph& graph, std::map<int, std::map<int, int>>& predecessors);
     std::map<int, std::map<int, double>> floydWarshall(const Graph& graph, std::map<int, std::map<int, int>>& predecessors);
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,94 @@
+#ifndef CONTRACTION_HIERARCHY_H
+#define CONTRACTION_HIERARCHY_H
+
+#include "csr_graph.h"
+#include "query_workspace.h"
+#include "thread_pool.h"
+#include <string>
+#include <vector>
+
+// Contraction hierarchy (CH) over the internal node indices of a CsrGraph.
+//
+// Preprocessing contracts the nodes one by one in order of importance (edge difference plus the
+// number of already contracted neighbors). Contracting v removes it from the remaining graph and
+// adds a shortcut u->w for every pair of remaining neighbors whose shortest path runs through v,
+// which a bounded witness search from u decides. Nodes are contracted in rounds: every round takes
+// the nodes whose priority is a local minimum among their neighbors, an independent set whose
+// witness searches and shortcuts are computed in parallel on a ThreadPool.
+//
+// Every arc remembers the two arcs a shortcut replaces, so paths unpack into original edges.
+// A query is a bidirectional Dijkstra that only relaxes arcs towards higher ranked nodes: the
+// forward search uses the upward arcs leaving a node, the backward search the downward arcs
+// entering it. The hierarchy is tied to the exact graph and weights it was built from
+// (see fingerprint) and can be saved to and loaded from a binary file.
+class ContractionHierarchy {
+public:
+    // Original edge or shortcut tail->head.
+    struct Arc {
+        // Internal index of the source node.
+        int tail;
+        // Internal index of the target node.
+        int head;
+        // Length of the arc (for shortcuts, the sum of both halves).
+        double weight;
+        // Arc tail->middle replaced by a shortcut, or -1 for original edges.
+        int firstChild;
+        // Arc middle->head replaced by a shortcut, or -1 for original edges.
+        int secondChild;
+    };
+    // Entry of the upward/downward search graphs.
+    struct SearchArc {
+        // Higher ranked endpoint (head of an upward arc, tail of a downward arc).
+        int node;
+        // Length of the arc.
+        double weight;
+        // Index into arcs.
+        int arc;
+    };
+
+    // Contraction position of every node (0 = contracted first).
+    std::vector<int> rank;
+    // All arcs of the hierarchy: original edges that survive plus shortcuts.
+    std::vector<Arc> arcs;
+    // Offset of each node's upward arcs in up; size N+1.
+    std::vector<int> firstUp;
+    // Arcs u->v with rank[v] > rank[u], grouped by u.
+    std::vector<SearchArc> up;
+    // Offset of each node's downward arcs in down; size N+1.
+    std::vector<int> firstDown;
+    // Arcs u->v with rank[u] > rank[v], grouped by v.
+    std::vector<SearchArc> down;
+    // Fingerprint of the graph the hierarchy was built from.
+    unsigned long long fingerprint = 0;
+
+    // Contracts a graph; witness searches run on the given pool.
+    static ContractionHierarchy build(const CsrGraph& graph, ThreadPool& pool = ThreadPool::shared());
+    // Hash of the node IDs, topology and weights of a graph; a hierarchy only answers queries on
+    // graphs with the same fingerprint.
+    static unsigned long long fingerprintOf(const CsrGraph& graph);
+
+    // Number of nodes.
+    int numNodes() const { return static_cast<int>(rank.size()); }
+    // Number of arcs that are shortcuts.
+    int numShortcuts() const;
+    // Runs the upward searches from source and target (internal indices) and returns the node
+    // where the shortest path peaks, or -1 if there is none. Parents in the workspaces are arc indices.
+    int query(QueryWorkspace& forward, QueryWorkspace& backward, int source, int target) const;
+    // Runs one complete upward search from source (over downward arcs in reverse if backward) and
+    // lists the settled nodes that were not stalled; their labels are then exact distances from
+    // (or to) source. Many-to-many searches combine these search spaces.
+    void upwardSearch(QueryWorkspace& workspace, int source, bool backward, std::vector<int>& settled) const;
+    // Appends the internal nodes of an arc after its tail (i.e. head last), expanding shortcuts.
+    void unpackArc(int arc, std::vector<int>& nodes) const;
+
+    // Writes the hierarchy to a binary file; returns false and sets error on failure.
+    bool save(const std::string& filepath, std::string& error) const;
+    // Reads a hierarchy written by save; returns false and sets error on failure.
+    bool load(const std::string& filepath, std::string& error);
+
+private:
+    // Rebuilds the upward/downward search graphs from rank and arcs.
+    void buildSearchGraphs();
+};
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef CRP_OVERLAY_H
+#define CRP_OVERLAY_H
+
+#include "csr_graph.h"
+#include "graph_partition.h"
+#include "query_workspace.h"
+#include "thread_pool.h"
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Customizable route planning (CRP) overlay over the internal node indices of a CsrGraph.
+//
+// Preprocessing only looks at the topology: a MultilevelPartition splits the nodes into nested
+// cells, and a node is a boundary node of a level if an edge joins it to another cell of that
+// level. Every cell keeps a clique matrix over its boundary nodes: entry (i, j) is the length of
+// the shortest path from boundary node i to boundary node j that stays inside the cell. The
+// matrices of a level are stored row-major one after the other in a single array.
+//
+// Customization applies a metric bottom-up, every cell of a level in parallel. Cells of the
+// lowest level run a Dijkstra from each boundary node over the original edges inside the cell.
+// Cells of higher levels run it over the level below: their nodes are the boundary nodes of their
+// subcells, which cell ids keep in one contiguous range of the level below, so distances live in a
+// dense local array and relaxing a clique row is a stride-1 pass over the row and the subcell's
+// slice of that array. A node reached over a clique arc skips its own clique, which is closed
+// under shortest paths already. After a weight change, only the cells containing the edge are
+// customized again.
+//
+// Queries are a unidirectional multilevel Dijkstra: a node is settled on the highest level whose
+// cell contains neither source nor target, relaxing its clique row and the original edges leaving
+// that cell, or over its original edges if there is no such level. Clique arcs on the resulting
+// path are unpacked by searches restricted to their cell, one level down at a time.
+class CrpOverlay {
+public:
+    // Cells and clique matrices of one level.
+    struct Level {
+        // Cell of every node.
+        std::vector<int> cellOf;
+        // Offset of each cell's boundary nodes; size cells+1.
+        std::vector<int> firstBoundary;
+        // Boundary nodes grouped by cell, ascending within a cell.
+        std::vector<int> boundary;
+        // Position of every node in boundary, -1 if it is not a boundary node of this level.
+        std::vector<int> boundaryIndex;
+        // Offset of each cell's clique matrix in weights; size cells+1.
+        std::vector<size_t> firstWeight;
+        // Clique matrices of all cells, each row-major over the cell's boundary nodes.
+        std::vector<double> weights;
+        // Above level 0: offset of each cell's subcells among the cells of the level below; size cells+1.
+        std::vector<int> firstSubcell;
+        // Number of cells.
+        int numCells() const { return static_cast<int>(firstBoundary.size()) - 1; }
+    };
+
+    // Levels from the smallest cells up.
+    std::vector<Level> levels;
+    // Largest cell of every level.
+    std::vector<int> cellSizes;
+
+    // Partitions a graph's topology with the given cell sizes and finds the boundary nodes.
+    static CrpOverlay build(const CsrGraph& graph, const std::vector<int>& cellSizes, ThreadPool& pool = ThreadPool::shared());
+    // Computes every clique matrix from the graph's current weights.
+    void customize(const CsrGraph& graph, ThreadPool& pool = ThreadPool::shared());
+    // Recomputes only the cells containing the given changed edges (internal from/to pairs).
+    void customizeEdges(const CsrGraph& graph, const std::vector<std::pair<int, int>>& changed, ThreadPool& pool = ThreadPool::shared());
+
+    // Number of nodes.
+    int numNodes() const { return nodeCount; }
+    // Number of levels.
+    int numLevels() const { return static_cast<int>(levels.size()); }
+    // Total number of clique matrix entries.
+    size_t numEntries() const;
+    // Highest level whose cell of v contains neither source nor target, or -1.
+    int queryLevel(int v, int source, int target) const;
+    // Multilevel Dijkstra from source to target (internal indices); parents in the workspace are
+    // predecessor nodes, connected by an original edge or by a clique arc. Returns whether target was reached.
+    bool query(const CsrGraph& graph, QueryWorkspace& workspace, int source, int target) const;
+    // Appends the internal nodes of the path behind the arc from -> to after from: the arc is a
+    // clique arc of the given level, or an original edge if level is -1.
+    void unpackArc(const CsrGraph& graph, QueryWorkspace& workspace, int level, int from, int to, std::vector<int>& nodes) const;
+
+private:
+    // Number of nodes of the graph.
+    int nodeCount = 0;
+    // Dijkstra from source restricted to one cell of a level, over the original edges on level 0
+    // and over the level below otherwise; stops once target is settled, or with target -1 once
+    // every boundary node of the cell is.
+    void cellSearch(const CsrGraph& graph, QueryWorkspace& workspace, int level, int cell, int source, int target) const;
+    // Computes the clique matrix of one cell; the level below must be customized.
+    void customizeCell(const CsrGraph& graph, int level, int cell, QueryWorkspace& workspace, std::vector<double>& scratch);
+};
+
+#endif
@@ -0,0 +1,167 @@
+#ifndef CSR_GRAPH_H
+#define CSR_GRAPH_H
+
+#include "graph.h"
+#include "mapped_file.h"
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Contiguous array of a CsrGraph: either owns its elements (graphs frozen in memory) or views
+// elements stored elsewhere (graphs mapped from a snapshot). Offers the std::vector operations the
+// CSR code uses; the growing operations switch a view to owned storage.
+template <typename T>
+class CsrArray {
+public:
+    // Creates an empty array.
+    CsrArray() = default;
+    // Copies; owned elements are copied, views keep pointing at the same memory.
+    CsrArray(const CsrArray& other) : storage(other.storage), items(other.items), count(other.count) { if (other.owned()) sync(); }
+    // Moves; the vector keeps its buffer, so the pointer stays valid.
+    CsrArray(CsrArray&& other) noexcept : storage(std::move(other.storage)), items(other.items), count(other.count) { other.items = nullptr; other.count = 0; }
+    // Copy assignment.
+    CsrArray& operator=(const CsrArray& other) { if (this != &other) { storage = other.storage; items = other.items; count = other.count; if (other.owned()) sync(); } return *this; }
+    // Move assignment.
+    CsrArray& operator=(CsrArray&& other) noexcept { storage = std::move(other.storage); items = other.items; count = other.count; other.items = nullptr; other.count = 0; return *this; }
+
+    // Views n elements owned elsewhere (which must outlive the array).
+    void view(T* data, size_t n) { storage.clear(); storage.shrink_to_fit(); items = data; count = n; }
+    // Whether the elements are owned.
+    bool owned() const { return items == storage.data(); }
+
+    // Number of elements.
+    size_t size() const { return count; }
+    // Whether there are no elements.
+    bool empty() const { return count == 0; }
+    // Element access.
+    T& operator[](size_t i) { return items[i]; }
+    const T& operator[](size_t i) const { return items[i]; }
+    // Raw elements.
+    T* data() { return items; }
+    const T* data() const { return items; }
+    // Iteration.
+    T* begin() { return items; }
+    T* end() { return items + count; }
+    const T* begin() const { return items; }
+    const T* end() const { return items + count; }
+    // Last element.
+    const T& back() const { return items[count - 1]; }
+
+    // Owned-storage operations, mirroring std::vector.
+    void reserve(size_t n) { own(); storage.reserve(n); sync(); }
+    void push_back(const T& value) { own(); storage.push_back(value); sync(); }
+    void assign(size_t n, const T& value) { storage.assign(n, value); sync(); }
+    void resize(size_t n) { own(); storage.resize(n); sync(); }
+
+private:
+    // Owned elements (empty for views).
+    std::vector<T> storage;
+    // First element.
+    T* items = nullptr;
+    // Number of elements.
+    size_t count = 0;
+
+    // Copies viewed elements into owned storage before growing.
+    void own() { if (!owned()) { storage.assign(items, items + count); sync(); } }
+    // Points at the owned storage.
+    void sync() { items = storage.data(); count = storage.size(); }
+};
+
+// Read-optimized, frozen copy of a Graph in compressed sparse row (CSR) form.
+//
+// External node IDs (arbitrary ints) are remapped to dense internal indices 0..N-1 in ascending
+// ID order. The outgoing edges of internal node u are the index range [firstOut[u], firstOut[u+1])
+// of the head/weight arrays, and coordinates are kept as separate x/y arrays. All search kernels
+// run on internal indices and translate back to external IDs only when reporting a path.
+// The incoming edges are mirrored in a second, backward CSR (firstIn/tail/inWeight) so reverse
+// searches scan a contiguous range as well; inEdge links every backward entry to its forward edge.
+// A CsrGraph either owns its arrays or views them inside a mapped snapshot (see GraphIO::loadSnapshot).
+class CsrGraph {
+public:
+    // Offset of the first outgoing edge of each node; size N+1.
+    CsrArray<int> firstOut;
+    // Internal index of the target node of each edge; size M.
+    CsrArray<int> head;
+    // Weight of each edge; size M.
+    CsrArray<double> weight;
+    // Offset of the first incoming edge of each node; size N+1.
+    CsrArray<int> firstIn;
+    // Internal index of the source node of each incoming edge; size M.
+    CsrArray<int> tail;
+    // Weight of each incoming edge (kept equal to the forward copy); size M.
+    CsrArray<double> inWeight;
+    // Forward edge index of each incoming edge; size M.
+    CsrArray<int> inEdge;
+    // X coordinate of each node; size N.
+    CsrArray<double> xs;
+    // Y coordinate of each node; size N.
+    CsrArray<double> ys;
+    // External ID of each internal node, sorted ascending; size N.
+    CsrArray<int> ids;
+    // Travel-time function of each edge (-1 for a constant weight); size M, or empty if no edge has one.
+    CsrArray<int> profile;
+    // Offset of the first breakpoint of each function; size F+1 (empty without functions).
+    CsrArray<int> firstBreakpoint;
+    // Breakpoints of all functions, function by function (see TravelTime).
+    CsrArray<Breakpoint> breakpoints;
+    // Snapshot the arrays point into, if they were mapped rather than built.
+    std::shared_ptr<const MappedFile> mapping;
+    // Smallest positive edge weight (INF if there is none); sizes bucket-queue buckets.
+    double minPositiveWeight = INF;
+    // Smallest edge weight (a lower bound after updates; INF if there are no edges).
+    double minWeight = INF;
+
+    // Creates an empty graph.
+    CsrGraph() = default;
+    // Freezes the current contents of a Graph.
+    explicit CsrGraph(const Graph& graph);
+
+    // Number of nodes.
+    int numNodes() const { return static_cast<int>(ids.size()); }
+    // Number of edges.
+    int numEdges() const { return static_cast<int>(head.size()); }
+    // First outgoing edge of internal node u.
+    int beginEdge(int u) const { return firstOut[u]; }
+    // One past the last outgoing edge of internal node u.
+    int endEdge(int u) const { return firstOut[u + 1]; }
+    // Target of edge e.
+    int edgeHead(int e) const { return head[e]; }
+    // Weight of edge e.
+    double edgeWeight(int e) const { return weight[e]; }
+    // First incoming edge of internal node u.
+    int beginInEdge(int u) const { return firstIn[u]; }
+    // One past the last incoming edge of internal node u.
+    int endInEdge(int u) const { return firstIn[u + 1]; }
+    // Source of incoming edge e.
+    int inEdgeTail(int e) const { return tail[e]; }
+    // Weight of incoming edge e.
+    double inEdgeWeight(int e) const { return inWeight[e]; }
+    // Whether any edge has a travel-time function.
+    bool timeDependent() const { return !profile.empty(); }
+    // Travel time of edge e when entered at time t: its function's value, or its weight if it has none.
+    double travelTime(int e, double t) const {
+        // Constant edges.
+        if (profile.empty() || profile[e] < 0) return weight[e];
+        // Breakpoints of the edge's function.
+        int f = profile[e];
+        return TravelTime::evaluate(breakpoints.data() + firstBreakpoint[f], firstBreakpoint[f + 1] - firstBreakpoint[f], t);
+    }
+    // X coordinate of internal node u.
+    double x(int u) const { return xs[u]; }
+    // Y coordinate of internal node u.
+    double y(int u) const { return ys[u]; }
+    // External ID of internal node u.
+    int externalId(int u) const { return ids[u]; }
+    // Internal index of an external node ID, or -1 if the node does not exist.
+    int internalId(int id) const;
+    // Index of the first edge u->v (internal indices), or -1 if there is none.
+    int findEdge(int u, int v) const;
+    // Updates the weight of the first edge from->to (external IDs), mirroring Graph::updateEdgeWeight
+    // (the edge loses its travel-time function); the previous weight is stored in oldWeight if given.
+    bool updateEdgeWeight(int from, int to, double newWeight, double* oldWeight = nullptr);
+    // Gives the first edge from->to (external IDs) a normalized travel-time function, mirroring
+    // Graph::setTravelTimeFunction; the function is appended to the breakpoint arrays.
+    bool setTravelTimeFunction(int from, int to, const std::vector<Breakpoint>& points);
+};
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef CUSTOMIZABLE_CH_H
+#define CUSTOMIZABLE_CH_H
+
+#include "csr_graph.h"
+#include "query_workspace.h"
+#include "thread_pool.h"
+#include <utility>
+#include <vector>
+
+// Customizable contraction hierarchy (CCH) over the internal node indices of a CsrGraph.
+//
+// Preprocessing only looks at the topology: a nested dissection order (recursive bisection with
+// the separators ranked above both halves) is contracted without witness searches, which yields
+// a chordal supergraph whose undirected edges never change afterwards. Every edge {u, w} with
+// rank[u] < rank[w] carries an upward weight (u->w) and a downward weight (w->u), and knows its
+// lower triangles: the nodes x below both endpoints, whose edges {x, u} and {x, w} form a path
+// u->x->w (and w->x->u).
+//
+// Customization applies a metric: each edge starts from the cheapest original edge between its
+// endpoints and takes the minimum over its lower triangles. Edges whose lower endpoint sits on
+// the same elimination tree level never depend on each other, so levels are customized one after
+// the other with the nodes of a level in parallel. A small batch of changed edges is instead
+// re-customized incrementally by propagating changes upwards through the triangles.
+//
+// Queries walk the elimination tree from source and target to the root, relaxing every upward
+// arc on the way; no priority queue is involved.
+class CustomizableCH {
+public:
+    // Position of every node in the contraction order.
+    std::vector<int> rank;
+    // Elimination tree parent of every node (lowest ranked upper neighbor), -1 for roots.
+    std::vector<int> parent;
+    // Offset of each node's upward edges; size N+1. Edge ids are positions in upHead.
+    std::vector<int> firstUp;
+    // Upper endpoint of every edge, sorted by rank within each node.
+    std::vector<int> upHead;
+    // Lower endpoint of every edge.
+    std::vector<int> edgeTail;
+    // Offset of each node's downward edges; size N+1.
+    std::vector<int> firstDown;
+    // Lower endpoint of every downward edge, sorted by rank within each node.
+    std::vector<int> downTail;
+    // Edge id of every downward edge.
+    std::vector<int> downEdge;
+    // Offset of each edge's lower triangles; size M+1.
+    std::vector<int> firstTriangle;
+    // Edge {x, u} of every lower triangle of edge {u, w}.
+    std::vector<int> triangleLow;
+    // Edge {x, w} of every lower triangle of edge {u, w}.
+    std::vector<int> triangleHigh;
+    // Nodes grouped by elimination tree level (leaves first); offsets in levelStart.
+    std::vector<int> levelNodes;
+    // Offset of each level in levelNodes.
+    std::vector<int> levelStart;
+    // Cheapest original edge lower->upper (INF if none) per edge.
+    std::vector<double> inputUp;
+    // Cheapest original edge upper->lower (INF if none) per edge.
+    std::vector<double> inputDown;
+    // Customized weight lower->upper per edge.
+    std::vector<double> upWeight;
+    // Customized weight upper->lower per edge.
+    std::vector<double> downWeight;
+
+    // Computes the nested dissection order and the chordal supergraph of a graph's topology.
+    static CustomizableCH build(const CsrGraph& graph, ThreadPool& pool = ThreadPool::shared());
+    // Applies the graph's current weights to every edge.
+    void customize(const CsrGraph& graph, ThreadPool& pool = ThreadPool::shared());
+    // Re-customizes only what depends on the given changed edges (internal from/to pairs).
+    void customizeEdges(const CsrGraph& graph, const std::vector<std::pair<int, int>>& changed);
+
+    // Number of nodes.
+    int numNodes() const { return static_cast<int>(rank.size()); }
+    // Number of undirected edges.
+    int numEdges() const { return static_cast<int>(upHead.size()); }
+    // Number of lower triangles.
+    int numTriangles() const { return static_cast<int>(triangleLow.size()); }
+    // Edge id between two nodes in either order, or -1 if they are not adjacent.
+    int findEdge(int a, int b) const;
+    // Walks the elimination tree from source, relaxing upward (or, if backward, downward) weights, so
+    // the labels of all ancestors are final; appends the reached ancestors to reached if given.
+    void upwardSearch(QueryWorkspace& workspace, int source, bool backward, std::vector<int>* reached = nullptr) const;
+    // Runs the elimination tree searches from source and target (internal indices) and returns
+    // the node where the shortest path peaks, or -1. Parents in the workspaces are edge ids.
+    int query(QueryWorkspace& forward, QueryWorkspace& backward, int source, int target) const;
+    // Appends the internal nodes of an edge traversed upwards (or downwards) after its start node.
+    void unpackEdge(int edge, bool upward, std::vector<int>& nodes) const;
+
+private:
+    // Marks for the partial re-customization queue, sized to the edge count.
+    std::vector<char> queued;
+    // Recomputes both weights of an edge from its input and lower triangles.
+    void recomputeEdge(int edge);
+    // Recomputes the input weights of an edge from the graph's parallel edges.
+    void loadInput(const CsrGraph& graph, int edge);
+};
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef DISTANCE_MATRIX_H
+#define DISTANCE_MATRIX_H
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// Dense all-pairs shortest path result over the internal indices of a CsrGraph.
+//
+// Distances (float or double) and predecessors (int32 internal indices) are row-major. Rows are
+// padded to `stride` columns, a multiple of the tile size used to compute them, and the padding
+// holds INF so the SIMD kernels never need a remainder loop. Row u, column v holds the shortest
+// distance from u to v and the node before v on that path (-1 if v is unreachable from u).
+template <typename T>
+class DistanceMatrix {
+public:
+    // External ID of every row and column, sorted ascending (same order as CsrGraph::ids).
+    std::vector<int> ids;
+    // Number of columns per row in memory (>= size()).
+    size_t stride = 0;
+    // Distance matrix; size size() * stride.
+    std::vector<T> dist;
+    // Predecessor matrix; size size() * stride.
+    std::vector<int> pred;
+
+    // Number of nodes.
+    int size() const { return static_cast<int>(ids.size()); }
+    // Internal index of an external ID, or -1 if the node is not in the matrix.
+    int index(int id) const {
+        // Binary search in the sorted ID array.
+        auto it = std::lower_bound(ids.begin(), ids.end(), id);
+        // Position in the array is the internal index.
+        return it == ids.end() || *it != id ? -1 : static_cast<int>(it - ids.begin());
+    }
+    // Shortest distance between internal indices (INF if unreachable).
+    T distance(int from, int to) const { return dist[static_cast<size_t>(from) * stride + to]; }
+    // Node before `to` on the shortest path from `from` (internal indices; -1 if unreachable).
+    int predecessor(int from, int to) const { return pred[static_cast<size_t>(from) * stride + to]; }
+    // Shortest path between two external IDs as external IDs; empty if unknown or unreachable.
+    std::vector<int> path(int fromId, int toId) const {
+        // Translate the endpoints.
+        int from = index(fromId), to = index(toId);
+        // Path built backwards.
+        std::vector<int> result;
+        // Unknown or unreachable target.
+        if (from < 0 || to < 0 || predecessor(from, to) < 0) return result;
+        // Follow the predecessor row of the source; a path never has more than size() nodes.
+        for (int curr = to; static_cast<int>(result.size()) <= size(); curr = predecessor(from, curr)) {
+            // Record the node.
+            result.push_back(ids[curr]);
+            // Stop at the source.
+            if (curr == from) break;
+        }
+        // Return it in path order.
+        std::reverse(result.begin(), result.end());
+        return result;
+    }
+};
+
+#endif
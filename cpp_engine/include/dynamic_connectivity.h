@@ -0,0 +1,156 @@
+#ifndef DYNAMIC_CONNECTIVITY_H
+#define DYNAMIC_CONNECTIVITY_H
+
+#include "csr_graph.h"
+#include "thread_pool.h"
+#include <cstdint>
+#include <random>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Fully dynamic connectivity over undirected links between nodes (Holm, de Lichtenberg and Thorup).
+//
+// Every link has a level, initially 0. Level i holds a spanning forest F_i of the links of level
+// >= i (so F_0 spans every component and F_0 ⊇ F_1 ⊇ ...), each tree stored as an Euler tour in a
+// treap: one entry per node plus two per tree link, with subtree aggregates telling whether a
+// part of the tour contains level-i tree links or nodes with level-i non-tree links. Linking
+// two trees concatenates their tours and cutting splits one, in O(log n) expected each.
+// Removing a tree link of level l searches levels l..0 for a replacement: the smaller of the
+// two halves has its level-i tree links pushed to level i+1, then its level-i non-tree links are
+// tried one by one, each either reconnecting the halves (and becoming a tree link) or moving to
+// level i+1 as well. A level-i tree has at most n / 2^i nodes, so a link rises at most log2 n
+// times and every update costs O(log^2 n) amortized; connected() is O(log n).
+//
+// Nodes are external IDs remapped to dense slots; links are identified by the handle link()
+// returns. Each component's representative is its smallest node ID.
+class DynamicConnectivity {
+public:
+    // Creates an empty structure.
+    DynamicConnectivity() = default;
+    // Builds the structure for a graph in O(V + E): every edge (directions ignored) becomes a link,
+    // with a spanning forest found in parallel. handles[e] is the link of CSR edge e (-1 for self-loops).
+    DynamicConnectivity(const CsrGraph& graph, std::vector<int>& handles, ThreadPool& pool = ThreadPool::shared());
+
+    // Adds a node as its own component (no-op if it exists).
+    void addNode(int id);
+    // Links a and b (adding unknown nodes); returns the link's handle, or -1 for a self-loop.
+    int link(int a, int b);
+    // Links every pair, with the same handles as calling link() on each in order. Large batches
+    // look up the tours of their ends and decide which links join the spanning forest in parallel
+    // (a lock-free union-find over the tours touched), so only the tour updates run serially.
+    std::vector<int> linkBatch(const std::vector<std::pair<int, int>>& pairs, ThreadPool& pool = ThreadPool::shared());
+    // Removes a link returned by link() or the constructor (no-op for -1).
+    void cut(int handle);
+    // Whether a and b are in the same component (unknown IDs are only connected to themselves).
+    bool connected(int a, int b);
+    // Smallest node ID in the component of id (id itself if unknown).
+    int representative(int id);
+    // Number of components.
+    int count() const { return components; }
+    // Number of nodes.
+    int size() const { return static_cast<int>(ids.size()); }
+    // Number of levels in use.
+    int levels() const { return static_cast<int>(levelData.size()); }
+
+private:
+    // Entry of an Euler tour treap: a node occurrence or one direction of a tree link.
+    struct TourNode {
+        // Treap links.
+        int left = -1;
+        int right = -1;
+        int parent = -1;
+        // Random heap priority.
+        uint32_t priority = 0;
+        // Entries and node occurrences in the subtree.
+        int size = 1;
+        int vertices = 0;
+        // Node slot of an occurrence (-1 for a link entry).
+        int vertex = -1;
+        // Link of a link entry (-1 for an occurrence).
+        int edge = -1;
+        // This entry is the marked half of a tree link whose level equals the tour's level.
+        bool ownTree = false;
+        // This occurrence's node has non-tree links at the tour's level.
+        bool ownNonTree = false;
+        // Whether any entry of the subtree has the flags above.
+        bool subTree = false;
+        bool subNonTree = false;
+        // Smallest external ID among the subtree's occurrences.
+        int minId = 0;
+    };
+    // A link.
+    struct Link {
+        // Endpoint slots.
+        int u;
+        int v;
+        // Current level.
+        int level = 0;
+        // Whether it is in the spanning forests (levels 0..level) or a non-tree link of its level.
+        bool tree = false;
+        // Whether it still exists.
+        bool live = true;
+        // Positions in the non-tree lists of u and v at its level.
+        int positionU = -1;
+        int positionV = -1;
+        // Tour entries (u -> v, v -> u) of a tree link in each forest 0..level.
+        std::vector<std::pair<int, int>> arcs = {};
+    };
+    // Per-level state.
+    struct Level {
+        // Tour occurrence of every node slot (-1 until the node is needed at this level).
+        std::vector<int> occurrence;
+        // Non-tree links of this level at every node slot.
+        std::vector<std::vector<int>> nonTree;
+    };
+
+    // Treap primitives.
+    int newNode(int vertex, int edge);
+    void freeNode(int x);
+    void update(int x);
+    void refresh(int x);
+    int merge(int a, int b);
+    void split(int root, int count, int& a, int& b);
+    int rootOf(int x) const;
+    int rankOf(int x) const;
+    // Occurrence of slot v at level i, created on demand.
+    int occurrenceAt(int level, int v);
+    // Level i, created on demand.
+    Level& levelAt(int level);
+    // Rotates the tour containing the occurrence x so that x comes first; returns the new root.
+    int reroot(int x);
+    // Whether slots u and v are connected in forest i.
+    bool connectedAt(int level, int u, int v);
+    // Adds the tree link to forest i.
+    void linkAt(int level, int handle);
+    // Removes the tree link from forest i.
+    void cutAt(int level, int handle);
+    // Adds / removes a non-tree link to / from the lists of its level.
+    void addNonTree(int handle);
+    void removeNonTree(int handle);
+    // Marks the occurrence of slot v at level i as having non-tree links or not.
+    void setNonTreeFlag(int level, int v);
+    // First entry in the treap rooted at root whose own flag (tree or non-tree) is set, or -1.
+    int findFlagged(int root, bool tree) const;
+    // Looks for a replacement after tree link (u, v) of level maxLevel was cut; returns true if found.
+    bool replace(int u, int v, int maxLevel);
+    // Dense slot of an external ID, creating it if needed.
+    int slot(int id);
+
+    // Treap entries and the free list.
+    std::vector<TourNode> nodes;
+    std::vector<int> freeNodes;
+    // Levels 0, 1, ...
+    std::vector<Level> levelData;
+    // Links by handle.
+    std::vector<Link> links;
+    // External ID of every slot, and the slot of every ID.
+    std::vector<int> ids;
+    std::unordered_map<int, int> slotOf;
+    // Number of components.
+    int components = 0;
+    // Priorities.
+    std::mt19937 random{0x5eed};
+};
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef EDGE_PROFILES_H
+#define EDGE_PROFILES_H
+
+#include "segment_tree.h"
+#include "travel_time.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Aggregate of a range of time buckets.
+struct BucketStats {
+    // Smallest and largest travel time.
+    double min;
+    double max;
+    // Sum of the travel times (mean = sum / number of buckets).
+    double sum;
+};
+
+// Monoid combining bucket aggregates, so one segment tree answers min, max and mean together.
+struct BucketStatsMonoid {
+    using Value = BucketStats;
+    static Value identity() { return {std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(), 0.0}; }
+    static Value combine(const Value& a, const Value& b) { return {std::min(a.min, b.min), std::max(a.max, b.max), a.sum + b.sum}; }
+};
+
+// Travel-time profiles of edges over the time buckets of a day.
+//
+// The day is split into equal buckets (96 of 15 minutes by default). A profiled edge keeps one
+// travel time per bucket in a segment tree of BucketStats, so the min, max and mean over any
+// window ("07:00-09:00") take O(log T) without scanning the buckets, and a batch of bucket
+// updates recomputes each inner node once. Edges are keyed by external (from, to) and, as with
+// weight updates, a profile belongs to the first of parallel edges. The engine keeps the profile
+// and the edge's travel-time function (see TravelTime) in step: setting buckets rebuilds the
+// function through travelTimeFunction, and an edge that only has a function gets its buckets
+// through sample.
+class EdgeProfiles {
+public:
+    // Creates an empty store with the given number of buckets per day.
+    explicit EdgeProfiles(int buckets = 96);
+
+    // Sets buckets (index, travel time) of edge from -> to; an edge without a profile starts flat at baseWeight.
+    void set(int from, int to, double baseWeight, const std::vector<std::pair<int, double>>& values);
+    // Sets every bucket of edge from -> to to the function's travel time at the bucket's midpoint.
+    void sample(int from, int to, const Breakpoint* points, int count);
+    // Travel-time function through the bucket midpoints of edge from -> to (empty if it has no
+    // profile). A bucket faster than waiting for the next one breaks FIFO, so its travel time is
+    // lowered to the wait plus the next bucket's; the buckets themselves keep the values as set.
+    std::vector<Breakpoint> travelTimeFunction(int from, int to) const;
+    // Profile of edge from -> to, or null.
+    const SegmentTree<BucketStatsMonoid>* find(int from, int to) const;
+    // Aggregate over the buckets overlapping the window [startMinute, endMinute) of the day; windows
+    // that end at or before their start wrap past midnight. Returns the number of buckets
+    // aggregated (0 if the edge has no profile) and the window's first and last bucket.
+    int query(int from, int to, double startMinute, double endMinute, BucketStats& stats, int& firstBucket, int& lastBucket) const;
+    // Drops the profile of edge from -> to.
+    void remove(int from, int to);
+    // Drops every profile and sets the number of buckets per day.
+    void reset(int buckets);
+    // Drops every profile.
+    void clear() { profiles.clear(); }
+
+    // Number of buckets per day.
+    int buckets() const { return bucketCount; }
+    // Length of a bucket in minutes.
+    double bucketMinutes() const { return MINUTES_PER_DAY / bucketCount; }
+    // Number of profiled edges.
+    size_t size() const { return profiles.size(); }
+
+    // Minutes in a day.
+    static constexpr double MINUTES_PER_DAY = 1440.0;
+    // Parses "HH:MM" (or plain minutes) into minutes of the day; false if malformed.
+    static bool parseTime(const std::string& text, double& minutes);
+
+private:
+    // Key of an edge.
+    static uint64_t key(int from, int to) { return (static_cast<uint64_t>(static_cast<uint32_t>(from)) << 32) | static_cast<uint32_t>(to); }
+
+    // Number of buckets per day.
+    int bucketCount;
+    // Profile of every profiled edge.
+    std::unordered_map<uint64_t, SegmentTree<BucketStatsMonoid>> profiles;
+};
+
+#endif
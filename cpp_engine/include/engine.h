@@ -0,0 +1,134 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include "graph.h"
+#include "csr_graph.h"
+#include "contraction_hierarchy.h"
+#include "crp_overlay.h"
+#include "customizable_ch.h"
+#include "dynamic_connectivity.h"
+#include "edge_profiles.h"
+#include "landmarks.h"
+#include "path_cache.h"
+#include "query_workspace.h"
+#include "shortest_path_tree.h"
+#include "spatial_index.h"
+#include "stats.h"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Splits a command line into tokens separated by a delimiter.
+std::vector<std::string> split(const std::string& s, char delimiter);
+
+// Owns the engine state (graph and zones) and executes CLI commands against it.
+// A single Engine lives for the whole process, so in serve mode mutations persist across requests.
+class Engine {
+public:
+    Graph graph;
+    // Graph::version when the current graph was loaded; deltas requested from before it are sent in full.
+    unsigned long long graphBaseVersion = 0;
+    // Zones: connected components of the graph's edges (directions ignored) plus the links made by
+    // unite_sets / unite_batch, kept up to date as edges are added and removed; null without a graph.
+    std::unique_ptr<DynamicConnectivity> zoneConnectivity;
+    // Zone links of the graph's edges, by packed external (from, to); one handle per parallel edge.
+    std::unordered_map<uint64_t, std::vector<int>> zoneEdgeLinks;
+    // Frozen CSR copy of the graph used by all queries; rebuilt lazily after topology changes.
+    std::unique_ptr<CsrGraph> csr;
+    // Graph::topologyVersion the CSR copy was built from.
+    unsigned long long csrTopologyVersion = 0;
+    // Set while `graph` is empty because the CSR copy was mapped from a snapshot; the adjacency lists
+    // are rebuilt from it only when a command needs them (topology edits, JSON dumps).
+    bool graphDeferred = false;
+    // Set while the zones of a loaded graph have not been created yet.
+    bool zonesDeferred = false;
+    // Contraction hierarchy for "shortest_path ch"; built (or loaded) on demand, dropped on any change.
+    std::unique_ptr<ContractionHierarchy> ch;
+    // Graph::topologyVersion the hierarchy was built for.
+    unsigned long long chTopologyVersion = 0;
+    // Customizable contraction hierarchy for "shortest_path cch"; rebuilt only after topology changes.
+    std::unique_ptr<CustomizableCH> cch;
+    // Graph::topologyVersion the CCH was built for.
+    unsigned long long cchTopologyVersion = 0;
+    // Edges (internal from/to) whose weight changed since the last customization.
+    std::vector<std::pair<int, int>> cchPending;
+    // CRP overlay for "shortest_path crp"; repartitioned only after topology changes.
+    std::unique_ptr<CrpOverlay> crp;
+    // Graph::topologyVersion the overlay was built for.
+    unsigned long long crpTopologyVersion = 0;
+    // Edges (internal from/to) whose weight changed since the last customization of the overlay.
+    std::vector<std::pair<int, int>> crpPending;
+    // Largest cell of every overlay level, as set by build_crp.
+    std::vector<int> crpCellSizes{256, 4096, 65536};
+    // Landmark tables for "shortest_path alt"; selected on demand and refreshed lazily.
+    std::unique_ptr<Landmarks> landmarks;
+    // Graph::topologyVersion the landmark tables were computed for.
+    unsigned long long landmarksTopologyVersion = 0;
+    // Set when a weight decreased, which can break the landmark lower bounds (increases cannot).
+    bool landmarksStale = false;
+    // Number of landmarks and selection used when landmarks are chosen implicitly.
+    int landmarkCount = 8;
+    LandmarkSelection landmarkSelection = LandmarkSelection::Avoid;
+    // Resident shortest path trees of the sources registered with maintain_source, by external ID;
+    // repaired in place by weight updates.
+    std::map<int, std::unique_ptr<ShortestPathTree>> maintainedTrees;
+    // Graph::topologyVersion the maintained trees were grown on.
+    unsigned long long maintainedTopologyVersion = 0;
+    // Answers of recent shortest_path queries, invalidated edge by edge.
+    PathCache pathCache;
+    // Travel-time profiles of edges over the time buckets of a day.
+    EdgeProfiles edgeProfiles;
+    // Search scratch space reused by every query the engine runs.
+    QueryWorkspace workspace;
+    // Backward-search scratch space for the bidirectional algorithms.
+    QueryWorkspace reverseWorkspace;
+    // Nearest-node and nearest-edge index for coordinate queries; built on demand, then kept up to
+    // date by add_node, add_edge and remove_edge and rebuilt after any other topology change.
+    std::unique_ptr<SpatialIndex> spatial;
+    // Graph::topologyVersion the spatial index reflects.
+    unsigned long long spatialTopologyVersion = 0;
+    // Latency of every successful command, by command name.
+    std::map<std::string, LatencyHistogram> commandLatency;
+    // Set by "trace on": every command is followed by a "Trace:" line with its time and search counters.
+    bool traceCommands = false;
+
+    // Executes one command (args[0] is the command name) and returns its exit status; times it and
+    // traces it if enabled.
+    int execute(const std::vector<std::string>& args, std::ostream& out, std::ostream& err);
+    // Executes one command without timing it.
+    int executeCommand(const std::vector<std::string>& args, std::ostream& out, std::ostream& err);
+    // Returns the CSR copy of the graph, refreezing it if nodes or edges were added since the last query.
+    const CsrGraph& frozenGraph();
+    // Returns the adjacency-list graph, rebuilding it from a mapped snapshot first if needed.
+    Graph& mutableGraph();
+    // Returns the zone structure, creating it from the graph's edges on first use (null if no graph is loaded).
+    DynamicConnectivity* zones();
+    // Rebuilds the zones from the graph's edges alone.
+    void rebuildZones();
+    // Weight of the first edge from -> to (external IDs); false if there is none.
+    bool edgeWeight(int from, int to, double& weight);
+    // Samples the travel-time function of the first edge from -> to into its bucket profile, unless it already has one.
+    void sampleEdgeProfile(int from, int to);
+    // Whether a node with this external ID exists, without rebuilding a mapped graph.
+    bool hasNode(int id);
+    // Returns the contraction hierarchy of the current graph, contracting it if there is none.
+    const ContractionHierarchy& hierarchy();
+    // Returns the CCH of the current graph customized with the current weights.
+    const CustomizableCH& customizedCch();
+    // Returns the CRP overlay of the current graph customized with the current weights.
+    const CrpOverlay& customizedCrp();
+    // Returns up-to-date landmark tables, selecting landmarks if there are none.
+    const Landmarks& landmarkTables();
+    // Returns the spatial index of the current graph, (re)building it when it is missing, stale or overgrown.
+    const SpatialIndex& spatialIndex();
+    // Returns the maintained tree of a source, regrowing every tree first if nodes or edges were added (null if not maintained).
+    const ShortestPathTree* maintainedTree(int id);
+    // Prints the command reference.
+    static void printUsage(std::ostream& err);
+};
+
+#endif
@@ -4,6 +4,7 @@
 #include <vector>
 #include <map>
 #include <limits> // Required for std::numeric_limits
+#include "travel_time.h"
 
 // Represents an edge in the graph.
 struct Edge {
@@ -11,6 +12,10 @@ struct Edge {
     int to;
     double weight;
     double x, y;
+    // Graph::version of the edge's last change (insertion or weight update).
+    unsigned long long version;
+    // Travel-time function in Graph's breakpoint arena, or -1 for a constant weight.
+    int profile = -1;
 };
 
 // Represents a node in the graph, primarily for storing coordinates if needed.
@@ -18,24 +23,53 @@ struct Node {
     int id;
     double x;
     double y;
+    // Graph::version of the node's last change (insertion or new coordinates).
+    unsigned long long version;
 };
 
+class CsrGraph;
+
 
 // Represents a directed, weighted graph using an adjacency list.
 class Graph {
 public:
     std::map<int, std::vector<Edge>> adj;
+    // Reverse adjacency: incoming edges per node, where Edge::to holds the edge's source.
+    std::map<int, std::vector<Edge>> radj;
     std::map<int, Node> nodes;
+    // Incremented whenever nodes or edges are added or removed (weight updates do not count).
+    unsigned long long topologyVersion = 0;
+    // Mutation counter: incremented by every change, weight updates included; each node and edge
+    // keeps the value of its last change, so exports can be limited to what changed since a version.
+    unsigned long long version = 0;
+    // Graph::version of the last edge removal; removals leave nothing to export, so deltas from before it cannot be sent.
+    unsigned long long removalVersion = 0;
+    // Breakpoint arena of the edges' travel-time functions: function f is breakpoints[firstBreakpoint[f] .. firstBreakpoint[f+1]).
+    // Functions are only appended; freezing copies the ones still in use.
+    std::vector<Breakpoint> breakpoints;
+    std::vector<int> firstBreakpoint{0};
 
     // Adds a node to the graph.
     void addNode(int id, double x = 0.0, double y = 0.0);
-    void addEdge(int from, int to, double weight);
-    bool updateEdgeWeight(int from, int to, double newWeight);
+    // Adds an edge; profile is a function from addTravelTimeFunction, or -1 for a constant weight.
+    void addEdge(int from, int to, double weight, int profile = -1);
+    // Appends a normalized travel-time function (see TravelTime::normalize) to the arena and returns its index.
+    int addTravelTimeFunction(const std::vector<Breakpoint>& points);
+    // Gives the first edge from->to the travel-time function from addTravelTimeFunction (its weight stays the static weight).
+    bool setTravelTimeFunction(int from, int to, int function);
+    // Updates the first edge from->to, which loses its travel-time function; the previous weight is stored in oldWeight if given.
+    bool updateEdgeWeight(int from, int to, double newWeight, double* oldWeight = nullptr);
+    // Removes the first edge from->to; its weight is stored in weight if given.
+    bool removeEdge(int from, int to, double* weight = nullptr);
     const std::vector<Edge>& getEdges(int nodeId) const;
+    // Returns the incoming edges of a node (Edge::to is the source of each edge).
+    const std::vector<Edge>& getIncomingEdges(int nodeId) const;
     std::vector<int> getAllNodeIds() const;
     const Node* getNode(int id) const;
     // Checks if a node exists in the graph.
     bool nodeExists(int id) const;
+    // Returns a frozen CSR copy with dense node indices for the search kernels.
+    CsrGraph freeze() const;
 };
 
 // Standard infinity representation for pathfinding algorithms.
@@ -2,12 +2,43 @@
 #define GRAPH_IO_H
 
 #include "graph.h"
+#include "csr_graph.h"
+#include <ostream>
 #include <string>
 
 // Contains functions for reading and writing graph data.
 namespace GraphIO {
+    // Loads {"nodes": [{"id", "x", "y"}...], "edges": [{"from", "to", "weight"}...]} in one pass over
+    // the mapped file. Any JSON layout (minified or pretty), any key order; unknown keys are skipped.
+    // On failure, error names the reason and byte offset; graph may hold what was read before it.
+    bool loadGraphFromJson(const std::string& filepath, Graph& graph, std::string& error);
+    // Same, without the error message.
     bool loadGraphFromJson(const std::string& filepath, Graph& graph);
+    // Selection of writeGraphJson.
+    struct JsonExportOptions {
+        // Only nodes inside [minX, maxX] x [minY, maxY], and edges with both ends inside.
+        bool clip = false;
+        double minX = 0.0, minY = 0.0, maxX = 0.0, maxY = 0.0;
+        // Only nodes and edges changed after this Graph::version; 0 selects everything.
+        unsigned long long since = 0;
+    };
+    // Streams the graph as {"version", "full", "nodes", "edges"} JSON through a fixed-size buffer,
+    // formatting numbers with std::to_chars (shortest round-trip form). "version" is the value to
+    // pass as `since` next time; "full" is false for a delta, which lists only changed elements.
+    // The second and later edges between the same two nodes carry "parallel" (1, 2, ...), so a delta
+    // can tell a new parallel edge from a weight change of the first one.
+    void writeGraphJson(const Graph& graph, std::ostream& out, const JsonExportOptions& options = JsonExportOptions());
+    // Returns the whole graph as a JSON string.
     std::string saveGraphToJson(const Graph& graph);
+    // Binary snapshot of a frozen graph: a checksummed header followed by the CSR arrays (forward and
+    // backward), coordinates and the sorted ID map, each section aligned and checksummed. Loading
+    // maps the file and points the arrays into it, so nothing is parsed or copied; pages are
+    // faulted in as the checksums are verified. Native byte order; other orders are rejected.
+    bool saveSnapshot(const CsrGraph& graph, const std::string& filepath, std::string& error);
+    // Maps a snapshot written by saveSnapshot into graph; returns false and sets error on failure.
+    bool loadSnapshot(const std::string& filepath, CsrGraph& graph, std::string& error);
+    // Checks whether a file starts with the snapshot signature.
+    bool isSnapshot(const std::string& filepath);
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,35 @@
+#ifndef GRAPH_PARTITION_H
+#define GRAPH_PARTITION_H
+
+#include "csr_graph.h"
+#include "thread_pool.h"
+#include <vector>
+
+// Nested multilevel partition of the internal node indices of a CsrGraph into cells.
+//
+// Built top-down by recursive bisection with inertial flow: the nodes of a cell are projected
+// onto four directions of the plane (0, 45, 90 and 135 degrees, using the stored coordinates),
+// the first and last quarter along a direction become source and sink, and a unit-capacity max
+// flow between them (edge directions ignored) gives a minimum edge cut. The direction with the
+// smallest cut wins, and the nodes reachable from the source in its residual graph form one half,
+// so both halves keep at least a quarter of the cell. Cells are bisected until they fit the
+// smallest size; every level then assigns a node the largest cell of the recursion that has at
+// most cellSizes[level] nodes, so the cells of a level nest within those of the next.
+class MultilevelPartition {
+public:
+    // Largest cell of every level, ascending; levels whose size would cover the whole graph are dropped.
+    std::vector<int> cellSizes;
+    // Cell of every node, per level. Cells inside one cell of the level above have consecutive ids.
+    std::vector<std::vector<int>> cellOf;
+    // Number of cells per level.
+    std::vector<int> numCells;
+
+    // Partitions a graph with the given (ascending, positive) cell sizes; cells of a recursion
+    // round are bisected in parallel, and the directions of a cell too.
+    static MultilevelPartition inertialFlow(const CsrGraph& graph, const std::vector<int>& cellSizes, ThreadPool& pool = ThreadPool::shared());
+
+    // Number of levels.
+    int numLevels() const { return static_cast<int>(cellSizes.size()); }
+};
+
+#endif
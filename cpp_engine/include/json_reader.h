@@ -0,0 +1,67 @@
+#ifndef JSON_READER_H
+#define JSON_READER_H
+
+#include <cstddef>
+#include <string_view>
+
+// Single-pass pull parser over a JSON document held in memory (typically a mapped file).
+//
+// The caller drives it with the grammar it expects (expect/consume for punctuation, readString,
+// readInt and readDouble for values, skipValue for anything it does not care about), so documents
+// are consumed front to back without building a tree. Nothing is allocated: strings are returned
+// as views into the input (raw, escapes left in place) and numbers are converted in place with
+// std::from_chars. Whitespace between tokens is arbitrary. The first error stops the parse and is
+// reported with the byte offset it occurred at.
+class JsonReader {
+public:
+    // Kinds of value that can start at the current position.
+    enum class Token { Object, Array, String, Number, Literal, End, Invalid };
+
+    // Reads the size bytes at data; the buffer must outlive the reader.
+    JsonReader(const char* data, size_t size);
+
+    // Kind of the next value, after skipping whitespace (does not consume anything).
+    Token peek();
+    // Consumes the punctuation character c, or fails.
+    bool expect(char c);
+    // Consumes c if it is the next character; never fails.
+    bool consume(char c);
+    // Reads a string; the view excludes the quotes.
+    bool readString(std::string_view& value);
+    // Reads an object key and the colon after it.
+    bool readKey(std::string_view& key);
+    // Reads a number that fits an int (no fraction or exponent).
+    bool readInt(int& value);
+    // Reads any number.
+    bool readDouble(double& value);
+    // Skips one complete value of any kind, nested ones included.
+    bool skipValue();
+    // Checks that only whitespace remains.
+    bool finish();
+    // Records an error at the current position (the first one wins); always returns false.
+    bool fail(const char* message);
+
+    // Byte offset of the current position, or of the error once one occurred.
+    size_t offset() const { return static_cast<size_t>(position - begin); }
+    // Message of the first error, or nullptr.
+    const char* error() const { return message; }
+
+private:
+    // Advances past spaces, tabs and line breaks.
+    void skipWhitespace();
+    // Extent of the number starting at the current position.
+    const char* scanNumber();
+    // Skips a value nested depth levels deep.
+    bool skipValue(int depth);
+
+    // Start of the document.
+    const char* begin;
+    // Next unread byte.
+    const char* position;
+    // One past the last byte.
+    const char* end;
+    // First error, if any.
+    const char* message = nullptr;
+};
+
+#endif
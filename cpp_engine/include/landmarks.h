@@ -0,0 +1,89 @@
+#ifndef LANDMARKS_H
+#define LANDMARKS_H
+
+#include "csr_graph.h"
+#include "query_workspace.h"
+#include "thread_pool.h"
+#include <string>
+#include <vector>
+
+// How landmarks are chosen.
+enum class LandmarkSelection {
+    // Each new landmark is the node farthest from the landmarks chosen so far.
+    Farthest,
+    // Goldberg-Werneck "avoid": grow a shortest path tree from a random root and descend into
+    // the subtree whose distances the current landmarks bound worst.
+    Avoid
+};
+
+// Parses a selection name ("farthest", "avoid"); returns false if unknown.
+bool parseLandmarkSelection(const std::string& name, LandmarkSelection& selection);
+
+// Landmark distance tables for ALT (A*, landmarks, triangle inequality) potentials.
+//
+// For every landmark L the tables hold d(L, v) and d(v, L) for all nodes v, stored node-major
+// (all landmarks of a node are adjacent) so one potential evaluation touches one or two cache
+// lines. The triangle inequality gives d(v, t) >= max(d(L, t) - d(L, v), d(v, L) - d(t, L)) for
+// every L, and the maximum over landmarks is a consistent A* potential.
+// Tables computed before weights were raised remain valid lower bounds and stay consistent, so
+// only weight decreases and topology changes require refresh(), which recomputes the tables
+// for the same landmarks in parallel.
+class Landmarks {
+public:
+    // External IDs of the landmarks.
+    std::vector<int> ids;
+    // d(L_i, v) at fromLandmark[v * count() + i] (INF if v is unreachable from L_i).
+    std::vector<double> fromLandmark;
+    // d(v, L_i) at toLandmark[v * count() + i] (INF if L_i is unreachable from v).
+    std::vector<double> toLandmark;
+
+    // Chooses count landmarks on the graph and computes their tables. Each choice depends on the
+    // tables of the previous landmarks, so landmarks are chosen one at a time, each with its forward
+    // and backward search in parallel.
+    static Landmarks select(const CsrGraph& graph, int count, LandmarkSelection selection, ThreadPool& pool = ThreadPool::shared());
+    // Recomputes the tables for the current landmarks; returns false if a landmark no longer exists.
+    bool refresh(const CsrGraph& graph, ThreadPool& pool = ThreadPool::shared());
+
+    // Number of landmarks.
+    int count() const { return static_cast<int>(ids.size()); }
+    // Lower bound on d(u, t) for internal indices u and t.
+    double lowerBound(int u, int t) const;
+};
+
+// A* potential towards a fixed target from landmark tables.
+struct LandmarkPotential {
+    // Tables in use.
+    const Landmarks& landmarks;
+    // d(L_i, t) for every landmark.
+    const double* targetFrom;
+    // d(t, L_i) for every landmark.
+    const double* targetTo;
+    // Binds the tables to a target (internal index).
+    LandmarkPotential(const Landmarks& tables, int target)
+        : landmarks(tables), targetFrom(tables.fromLandmark.data() + static_cast<size_t>(target) * tables.count()),
+          targetTo(tables.toLandmark.data() + static_cast<size_t>(target) * tables.count()) {}
+    // Max-over-landmarks lower bound on the distance from u to the target.
+    double operator()(int u) const {
+        // Number of landmarks.
+        const int k = landmarks.count();
+        // Row of u in both tables.
+        const double* from = landmarks.fromLandmark.data() + static_cast<size_t>(u) * k;
+        const double* to = landmarks.toLandmark.data() + static_cast<size_t>(u) * k;
+        // Trivial bound.
+        double best = 0;
+        // Both triangle bounds of every landmark; INF - INF is NaN and never wins a comparison.
+        for (int i = 0; i < k; ++i) {
+            // Landmark behind the target: d(L, t) - d(L, u).
+            double behind = targetFrom[i] - from[i];
+            // Landmark beyond the target: d(u, L) - d(t, L).
+            double beyond = to[i] - targetTo[i];
+            // Keep the best bound.
+            if (behind > best) best = behind;
+            if (beyond > best) best = beyond;
+        }
+        // Lower bound (INF means the target is unreachable from u).
+        return best;
+    }
+};
+
+#endif
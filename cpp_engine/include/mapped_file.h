@@ -0,0 +1,38 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+// Read-only file contents mapped into memory.
+//
+// On POSIX systems the file is mapped privately with write access: pages are loaded on first
+// touch, and writes (e.g. weight updates patched into mapped arrays) copy the touched page instead
+// of reaching the file. Elsewhere the file is read into a heap buffer with the same interface.
+class MappedFile {
+public:
+    // Creates an empty mapping.
+    MappedFile() = default;
+    // Unmaps the file.
+    ~MappedFile();
+    // Not copyable; shared through std::shared_ptr by everything that points into it.
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Maps a whole file; returns false and sets error on failure.
+    bool open(const std::string& filepath, std::string& error);
+    // First byte of the mapping.
+    char* data() const { return bytes; }
+    // Length of the mapping in bytes.
+    size_t size() const { return length; }
+
+private:
+    // Start of the mapped (or read) bytes.
+    char* bytes = nullptr;
+    // Number of bytes.
+    size_t length = 0;
+    // Whether bytes came from mmap (true) or from new[] (false).
+    bool mapped = false;
+};
+
+#endif
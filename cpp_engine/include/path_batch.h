@@ -0,0 +1,41 @@
+#ifndef PATH_BATCH_H
+#define PATH_BATCH_H
+
+#include "contraction_hierarchy.h"
+#include "crp_overlay.h"
+#include "customizable_ch.h"
+#include "landmarks.h"
+#include <string>
+#include <vector>
+
+// Point-to-point algorithms selectable per query.
+enum class PathAlgorithm { Dijkstra, AStar, Alt, BiDijkstra, BiAStar, CH, CCH, CRP };
+
+// Parses "dijkstra", "astar", "alt", "bidijkstra", "biastar", "ch", "cch" or "crp"; returns false for other names.
+bool parsePathAlgorithm(const std::string& name, PathAlgorithm& algorithm);
+// Name of an algorithm as accepted by parsePathAlgorithm.
+const char* pathAlgorithmName(PathAlgorithm algorithm);
+
+// One query of a batch (external IDs).
+struct PathQuery {
+    int source;
+    int target;
+    PathAlgorithm algorithm;
+};
+
+// Answer to one query: INF and an empty path if the target is unreachable or an ID unknown.
+struct PathResult {
+    double weight = 0.0;
+    std::vector<int> path;
+};
+
+// Read-only speedup structures a batch may use; each must be set (and up to date for the graph)
+// if any query of the batch uses the corresponding algorithm.
+struct PathIndexes {
+    const ContractionHierarchy* ch = nullptr;
+    const CustomizableCH* cch = nullptr;
+    const CrpOverlay* crp = nullptr;
+    const Landmarks* landmarks = nullptr;
+};
+
+#endif
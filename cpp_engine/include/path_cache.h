@@ -0,0 +1,141 @@
+#ifndef PATH_CACHE_H
+#define PATH_CACHE_H
+
+#include "csr_graph.h"
+#include "path_batch.h"
+#include "query_workspace.h"
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Fixed-capacity cache of point-to-point answers keyed by (algorithm, source, target).
+//
+// Entries hold the path (external IDs) and its weight, tagged with the graph version they were
+// computed at; unreachable answers are cached too. Replacement is CLOCK: a hit sets the entry's
+// reference bit, and the hand evicts the first entry whose bit is clear, clearing bits as it
+// passes. Invalidation is precise rather than version-based: a reverse index maps every edge to
+// the entries whose path uses it, so a weight increase evicts exactly those entries. A decrease
+// (or a new edge) can also shorten paths that do not use the edge; those are found with two
+// searches bounded by the longest cached weight, backward from the edge's tail to the cached
+// sources and forward from its head to the cached targets. A decrease cannot connect a pair
+// cached as unreachable, so only finite weights bound its searches; a new edge can, and then
+// searches the whole component. Changes are queued and resolved on the next lookup, so a burst
+// of updates costs one refreeze of the graph.
+class PathCache {
+public:
+    // Counters since the cache was created.
+    struct Stats {
+        // Lookups answered from the cache.
+        uint64_t hits = 0;
+        // Lookups that were not.
+        uint64_t misses = 0;
+        // Entries stored.
+        uint64_t insertions = 0;
+        // Entries dropped by CLOCK to make room.
+        uint64_t evictions = 0;
+        // Entries dropped because an edge change made them wrong (or possibly improvable).
+        uint64_t invalidations = 0;
+        // Entries dropped by clear() or a capacity change.
+        uint64_t flushes = 0;
+    };
+
+    // Creates a cache holding up to capacity entries (0 disables caching).
+    explicit PathCache(size_t capacity = 4096);
+
+    // Copies the entry for (algorithm, source, target) into path and weight; false on a miss.
+    // Pending decreases must have been resolved (see resolvePending).
+    bool lookup(PathAlgorithm algorithm, int source, int target, std::vector<int>& path, double& weight);
+    // Stores an answer computed at the given graph version, evicting an entry if the cache is full.
+    void insert(PathAlgorithm algorithm, int source, int target, const std::vector<int>& path, double weight, unsigned long long version);
+    // Edge from -> to (external IDs) got more expensive: evicts every entry whose path uses it.
+    void edgeIncreased(int from, int to);
+    // Edge from -> to got cheaper: evicts the entries using it now, and queues the search for
+    // entries it could shorten.
+    void edgeDecreased(int from, int to);
+    // Edge from -> to was added: like a decrease, but pairs cached as unreachable may be connected too.
+    void edgeAdded(int from, int to);
+    // Whether changes are waiting to be resolved.
+    bool hasPending() const { return !pending.empty() || !pendingAdded.empty(); }
+    // Resolves queued changes against the current graph, evicting every entry a changed edge could improve.
+    void resolvePending(const CsrGraph& graph, QueryWorkspace& forward, QueryWorkspace& backward);
+    // Drops every entry; entries tagged with an older version than minVersion are never returned again.
+    void clear(unsigned long long minVersion = 0);
+    // Changes the capacity, dropping every entry.
+    void setCapacity(size_t capacity);
+
+    // Number of entries held.
+    size_t size() const { return index.size(); }
+    // Maximum number of entries.
+    size_t capacity() const { return slots.size(); }
+    // Counters.
+    const Stats& stats() const { return counters; }
+
+private:
+    // One cached answer.
+    struct Entry {
+        // Key.
+        PathAlgorithm algorithm = PathAlgorithm::Dijkstra;
+        int source = 0;
+        int target = 0;
+        // Answer.
+        double weight = 0.0;
+        std::vector<int> path;
+        // Graph version the answer was computed at.
+        unsigned long long version = 0;
+        // Unique insertion number; reverse index references to an older occupant of the slot are stale.
+        uint64_t stamp = 0;
+        // CLOCK reference bit.
+        bool referenced = false;
+        // Whether the slot holds an entry.
+        bool live = false;
+    };
+    // Reverse index reference to an entry.
+    struct Use {
+        int slot;
+        uint64_t stamp;
+    };
+    // Hash of a packed key.
+    struct KeyHash {
+        size_t operator()(const std::pair<uint64_t, int>& key) const { return std::hash<uint64_t>()(key.first * 0x9E3779B97F4A7C15ULL + static_cast<uint64_t>(key.second)); }
+    };
+
+    // Packs two external IDs.
+    static uint64_t pack(int a, int b) { return (static_cast<uint64_t>(static_cast<uint32_t>(a)) << 32) | static_cast<uint32_t>(b); }
+    // Lookup key of (algorithm, source, target).
+    static std::pair<uint64_t, int> key(PathAlgorithm algorithm, int source, int target) { return {pack(source, target), static_cast<int>(algorithm)}; }
+    // Frees a slot; its reverse index references go stale.
+    void release(int slot);
+    // Evicts every entry whose path uses from -> to.
+    void evictUsers(int from, int to);
+    // Slot for a new entry: a free one, or the CLOCK victim.
+    int acquireSlot();
+    // Rebuilds the reverse index without stale references.
+    void compactUses();
+
+    // Entry storage; the CLOCK hand sweeps it in order.
+    std::vector<Entry> slots;
+    // Slots that hold no entry.
+    std::vector<int> freeSlots;
+    // Slot of every cached key.
+    std::unordered_map<std::pair<uint64_t, int>, int, KeyHash> index;
+    // Entries using each edge (packed external from/to); references are checked against the slot's stamp.
+    std::unordered_map<uint64_t, std::vector<Use>> uses;
+    // Total references in `uses`, and the number of them that belong to live entries.
+    size_t useCount = 0;
+    size_t liveUseCount = 0;
+    // Edges (packed external from/to) that got cheaper, and edges that were added, since the last resolvePending.
+    std::vector<uint64_t> pending;
+    std::vector<uint64_t> pendingAdded;
+    // Next slot the CLOCK hand inspects.
+    size_t hand = 0;
+    // Stamp of the next entry.
+    uint64_t nextStamp = 1;
+    // Entries tagged below this version are treated as absent.
+    unsigned long long minimumVersion = 0;
+    // Counters.
+    Stats counters;
+};
+
+#endif
@@ -0,0 +1,474 @@
+#ifndef PRIORITY_QUEUES_H
+#define PRIORITY_QUEUES_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Priority queue policies for the search kernels in search_kernel.h.
+//
+// Every queue stores (key, node) pairs for internal node indices and exposes the same interface:
+//   reset(numNodes)  prepare for a new query (cost proportional to what the last query left behind)
+//   push(node, key)  insert node, or lower its key if the queue supports decrease-key
+//   empty()          whether no entries remain
+//   pop()            remove and return the entry with the smallest key
+// Queues without decrease-key keep superseded entries around; the kernel skips them when popped.
+// Keys must be non-negative for RadixHeap.
+
+// Selects the queue a search kernel runs with.
+enum class QueueKind {
+    // std::push_heap binary heap with lazy deletion (the original behavior).
+    Binary,
+    // Indexed 4-ary heap with decrease-key.
+    Dary4,
+    // Monotone radix heap over the bit patterns of non-negative double keys.
+    Radix,
+    // Dial-style bucket queue with decrease-key for integer or quantized weights.
+    Bucket
+};
+
+// Parses a queue name ("binary", "dary4", "radix", "bucket"); returns false if unknown.
+inline bool parseQueueKind(const std::string& name, QueueKind& kind) {
+    // Match each supported name.
+    if (name == "binary") kind = QueueKind::Binary;
+    else if (name == "dary4") kind = QueueKind::Dary4;
+    else if (name == "radix") kind = QueueKind::Radix;
+    else if (name == "bucket") kind = QueueKind::Bucket;
+    // Unknown name.
+    else return false;
+    // Parsed successfully.
+    return true;
+}
+
+// Binary heap with lazy deletion; superseded entries stay in the heap until popped.
+class BinaryHeapQueue {
+public:
+    // Prepares for a new query.
+    void reset(int) { heap.clear(); }
+    // Inserts an entry (older entries of the same node become stale).
+    void push(int node, double key) {
+        // Append the entry.
+        heap.push_back({key, node});
+        // Restore the heap property.
+        std::push_heap(heap.begin(), heap.end(), std::greater<std::pair<double, int>>());
+    }
+    // Whether no entries remain.
+    bool empty() const { return heap.empty(); }
+    // Removes and returns the smallest entry.
+    std::pair<double, int> pop() {
+        // Move the smallest entry to the back.
+        std::pop_heap(heap.begin(), heap.end(), std::greater<std::pair<double, int>>());
+        // Take it.
+        std::pair<double, int> top = heap.back();
+        // Remove it.
+        heap.pop_back();
+        // Return it.
+        return top;
+    }
+
+private:
+    // Heap storage, reused across queries.
+    std::vector<std::pair<double, int>> heap;
+};
+
+// Indexed d-ary min-heap with decrease-key; every node is in the heap at most once.
+template <int D>
+class IndexedDaryHeap {
+public:
+    // Prepares for a new query; only nodes left in the heap need their positions cleared.
+    void reset(int numNodes) {
+        // Forget the positions of leftover entries.
+        for (const Entry& entry : heap) position[entry.node] = -1;
+        // Empty the heap.
+        heap.clear();
+        // Grow the position index if the graph gained nodes.
+        if (static_cast<int>(position.size()) < numNodes) position.resize(numNodes, -1);
+    }
+    // Inserts node or lowers its key.
+    void push(int node, double key) {
+        // Current slot of the node (-1 if not in the heap).
+        int slot = position[node];
+        // New node: append at the bottom.
+        if (slot < 0) {
+            // Place the entry at the end.
+            slot = static_cast<int>(heap.size());
+            // Append it.
+            heap.push_back({key, node});
+        } else if (key < heap[slot].key) {
+            // Lower the key in place.
+            heap[slot].key = key;
+        } else {
+            // Keys never increase.
+            return;
+        }
+        // Restore the heap property.
+        siftUp(slot);
+    }
+    // Whether no entries remain.
+    bool empty() const { return heap.empty(); }
+    // Removes and returns the smallest entry.
+    std::pair<double, int> pop() {
+        // The root holds the minimum.
+        Entry top = heap.front();
+        // The node leaves the heap.
+        position[top.node] = -1;
+        // Move the last entry to the root.
+        Entry last = heap.back();
+        // Shrink the heap.
+        heap.pop_back();
+        // Re-insert the last entry from the root downwards.
+        if (!heap.empty()) {
+            // Place it at the root.
+            heap[0] = last;
+            // Record its position.
+            position[last.node] = 0;
+            // Restore the heap property.
+            siftDown(0);
+        }
+        // Return the minimum.
+        return {top.key, top.node};
+    }
+
+private:
+    // Heap entry.
+    struct Entry {
+        // Priority.
+        double key;
+        // Internal node index.
+        int node;
+    };
+    // Heap storage.
+    std::vector<Entry> heap;
+    // Slot of every node in the heap, or -1.
+    std::vector<int> position;
+
+    // Moves the entry at slot up until its parent is not larger.
+    void siftUp(int slot) {
+        // Entry being moved.
+        Entry entry = heap[slot];
+        // Climb while the parent is larger.
+        while (slot > 0) {
+            // Parent slot.
+            int parent = (slot - 1) / D;
+            // Stop when the parent is not larger.
+            if (heap[parent].key <= entry.key) break;
+            // Move the parent down.
+            heap[slot] = heap[parent];
+            // Record its new position.
+            position[heap[slot].node] = slot;
+            // Continue from the parent slot.
+            slot = parent;
+        }
+        // Place the entry.
+        heap[slot] = entry;
+        // Record its position.
+        position[entry.node] = slot;
+    }
+    // Moves the entry at slot down until no child is smaller.
+    void siftDown(int slot) {
+        // Entry being moved.
+        Entry entry = heap[slot];
+        // Number of entries.
+        const int size = static_cast<int>(heap.size());
+        // Descend while a child is smaller.
+        while (true) {
+            // First child slot.
+            int first = slot * D + 1;
+            // Stop at a leaf.
+            if (first >= size) break;
+            // Smallest child.
+            int best = first;
+            // Last child slot.
+            int last = std::min(first + D, size);
+            // Scan the children.
+            for (int child = first + 1; child < last; ++child) {
+                // Keep the smaller key.
+                if (heap[child].key < heap[best].key) best = child;
+            }
+            // Stop when no child is smaller.
+            if (heap[best].key >= entry.key) break;
+            // Move the child up.
+            heap[slot] = heap[best];
+            // Record its new position.
+            position[heap[slot].node] = slot;
+            // Continue from the child slot.
+            slot = best;
+        }
+        // Place the entry.
+        heap[slot] = entry;
+        // Record its position.
+        position[entry.node] = slot;
+    }
+};
+
+// Monotone radix heap. Non-negative IEEE doubles order exactly like their bit patterns read as
+// unsigned integers, so keys are bucketed by the highest bit in which they differ from the last
+// popped key. Requires keys pushed to be >= the last popped key (true for Dijkstra and for A*
+// with a consistent heuristic); smaller keys are popped next rather than breaking the heap.
+class RadixHeap {
+public:
+    // Prepares for a new query.
+    void reset(int) {
+        // Empty every bucket.
+        for (auto& bucket : buckets) bucket.clear();
+        // No entries.
+        count = 0;
+        // Monotone lower bound starts at zero.
+        last = 0;
+    }
+    // Inserts an entry (older entries of the same node become stale).
+    void push(int node, double key) {
+        // Append to the bucket of the key's bit pattern.
+        buckets[bucketOf(bitsOf(key))].push_back({bitsOf(key), node});
+        // Count the entry.
+        ++count;
+    }
+    // Whether no entries remain.
+    bool empty() const { return count == 0; }
+    // Removes and returns the smallest entry.
+    std::pair<double, int> pop() {
+        // Refill bucket 0 from the first non-empty bucket when it runs dry.
+        if (buckets[0].empty()) {
+            // First non-empty bucket.
+            int i = 1;
+            // Find it.
+            while (buckets[i].empty()) ++i;
+            // The new lower bound is the smallest key in that bucket.
+            uint64_t smallest = buckets[i][0].first;
+            // Find the smallest key.
+            for (const auto& entry : buckets[i]) smallest = std::min(smallest, entry.first);
+            // Advance the lower bound.
+            last = smallest;
+            // Redistribute; every entry lands in a strictly lower bucket.
+            for (const auto& entry : buckets[i]) buckets[bucketOf(entry.first)].push_back(entry);
+            // The source bucket is now empty.
+            buckets[i].clear();
+        }
+        // Any entry in bucket 0 has the minimum key.
+        std::pair<uint64_t, int> top = buckets[0].back();
+        // Remove it.
+        buckets[0].pop_back();
+        // Uncount it.
+        --count;
+        // Return it with the key converted back.
+        return {doubleOf(top.first), top.second};
+    }
+
+private:
+    // Buckets by highest differing bit (bucket 0 holds keys equal to the lower bound).
+    std::vector<std::pair<uint64_t, int>> buckets[65];
+    // Number of entries.
+    size_t count = 0;
+    // Bit pattern of the last popped key (monotone lower bound).
+    uint64_t last = 0;
+
+    // Bit pattern of a non-negative double.
+    static uint64_t bitsOf(double key) {
+        // Pattern storage.
+        uint64_t bits;
+        // Reinterpret the bytes.
+        std::memcpy(&bits, &key, sizeof(bits));
+        // Return the pattern.
+        return bits;
+    }
+    // Double value of a bit pattern.
+    static double doubleOf(uint64_t bits) {
+        // Value storage.
+        double key;
+        // Reinterpret the bytes.
+        std::memcpy(&key, &bits, sizeof(key));
+        // Return the value.
+        return key;
+    }
+    // Bucket of a key relative to the current lower bound.
+    int bucketOf(uint64_t bits) const {
+        // Keys at (or, for inconsistent inputs, below) the lower bound go to bucket 0.
+        if (bits <= last) return 0;
+        // One plus the index of the highest differing bit.
+        return 64 - countLeadingZeros(bits ^ last);
+    }
+    // Number of leading zero bits of a non-zero value.
+    static int countLeadingZeros(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+        // Use the compiler intrinsic.
+        return __builtin_clzll(value);
+#else
+        // Portable fallback.
+        int zeros = 0;
+        // Shift until the top bit is set.
+        while (!(value & (uint64_t(1) << 63))) { value <<= 1; ++zeros; }
+        // Return the count.
+        return zeros;
+#endif
+    }
+};
+
+// Dial-style bucket queue with decrease-key. Keys are quantized into buckets of a fixed width
+// (for integer weights, width 1; by default the smallest positive edge weight). A window of
+// kWindowSize buckets is scanned in order; keys beyond the window wait in an overflow list that
+// is re-bucketed when the window is exhausted. In exact mode the smallest key within the current
+// bucket is popped, so results are exact for any width; otherwise the most recently queued entry
+// is popped, which is still exact for plain Dijkstra when the width does not exceed the smallest
+// positive edge weight (no node can improve another node of its own bucket).
+class BucketQueue {
+public:
+    // Sets the key range covered by one bucket for subsequent queries.
+    void setWidth(double width) {
+        // Use a positive, finite bucket width.
+        bucketWidth = width > 0 && std::isfinite(width) ? width : 1.0;
+    }
+    // Selects whether the smallest key within a bucket is popped (needed for A* potentials).
+    void setExactOrder(bool exact) { exactOrder = exact; }
+    // Prepares for a new query.
+    void reset(int numNodes) {
+        // Forget the locations of leftover entries.
+        for (auto& bucket : window) for (const Entry& entry : bucket) where[entry.node] = -1;
+        // Forget leftover overflow entries.
+        for (const Entry& entry : overflow) where[entry.node] = -1;
+        // Empty the window.
+        for (auto& bucket : window) bucket.clear();
+        // Empty the overflow list.
+        overflow.clear();
+        // Grow the location index if the graph gained nodes.
+        if (static_cast<int>(where.size()) < numNodes) {
+            // Bucket of every node (-1: not queued, kWindowSize: overflow).
+            where.resize(numNodes, -1);
+            // Slot of every node within its bucket.
+            slot.resize(numNodes, -1);
+        }
+        // Window starts at bucket index 0.
+        base = 0;
+        // Current bucket within the window.
+        cursor = 0;
+        // No entries.
+        count = 0;
+    }
+    // Inserts node or lowers its key.
+    void push(int node, double key) {
+        // Location of the node if already queued.
+        int at = where[node];
+        // Already queued: only decreases matter.
+        if (at >= 0) {
+            // Current key of the node.
+            double current = (at == kWindowSize ? overflow : window[at])[slot[node]].key;
+            // Ignore non-decreasing updates.
+            if (key >= current) return;
+            // Unlink the old entry.
+            removeAt(at, slot[node]);
+        }
+        // Insert the entry at its new key.
+        insert({key, node});
+    }
+    // Whether no entries remain.
+    bool empty() const { return count == 0; }
+    // Removes and returns the smallest entry.
+    std::pair<double, int> pop() {
+        // Advance to the next non-empty bucket.
+        while (true) {
+            // Skip empty buckets in the window.
+            while (cursor < kWindowSize && window[cursor].empty()) ++cursor;
+            // Found a non-empty bucket.
+            if (cursor < kWindowSize) break;
+            // The window is exhausted: restart it at the smallest overflow key.
+            double smallest = overflow[0].key;
+            // Find the smallest overflow key.
+            for (const Entry& entry : overflow) smallest = std::min(smallest, entry.key);
+            // Jump the window to that bucket.
+            base = static_cast<long long>(std::floor(smallest / bucketWidth));
+            // Start scanning at the first bucket.
+            cursor = 0;
+            // Take the overflow list.
+            std::vector<Entry> pending;
+            // Swap it out so it can be rebuilt.
+            pending.swap(overflow);
+            // Re-insert every entry relative to the new window.
+            for (const Entry& entry : pending) { where[entry.node] = -1; --count; insert(entry); }
+        }
+        // Current bucket.
+        auto& bucket = window[cursor];
+        // Slot to pop: the most recent entry unless exact order is required.
+        int best = static_cast<int>(bucket.size()) - 1;
+        // Scan the bucket for the smallest key in exact mode.
+        for (int i = 0; exactOrder && i < static_cast<int>(bucket.size()); ++i) {
+            // Keep the smaller key.
+            if (bucket[i].key < bucket[best].key) best = i;
+        }
+        // Take the entry.
+        Entry top = bucket[best];
+        // Unlink it.
+        removeAt(cursor, best);
+        // Return it.
+        return {top.key, top.node};
+    }
+
+private:
+    // Number of buckets in the window.
+    static const int kWindowSize = 1024;
+    // Queue entry.
+    struct Entry {
+        // Priority.
+        double key;
+        // Internal node index.
+        int node;
+    };
+    // Buckets of the current window.
+    std::vector<Entry> window[kWindowSize];
+    // Entries beyond the window.
+    std::vector<Entry> overflow;
+    // Bucket of every node (-1: not queued, kWindowSize: overflow).
+    std::vector<int> where;
+    // Slot of every node within its bucket.
+    std::vector<int> slot;
+    // Key range covered by one bucket.
+    double bucketWidth = 1.0;
+    // Whether the smallest key within a bucket is popped.
+    bool exactOrder = true;
+    // Absolute bucket index of the first window bucket.
+    long long base = 0;
+    // Current bucket within the window.
+    int cursor = 0;
+    // Number of entries.
+    size_t count = 0;
+
+    // Places an entry into the window or the overflow list.
+    void insert(const Entry& entry) {
+        // Absolute bucket index of the key.
+        long long index = static_cast<long long>(std::floor(entry.key / bucketWidth));
+        // Keys behind the cursor (inconsistent inputs) go into the current bucket.
+        long long offset = std::max<long long>(cursor, index - base);
+        // Target location.
+        int at = offset < kWindowSize ? static_cast<int>(offset) : kWindowSize;
+        // Target list.
+        auto& bucket = at == kWindowSize ? overflow : window[at];
+        // Record the location.
+        where[entry.node] = at;
+        // Record the slot.
+        slot[entry.node] = static_cast<int>(bucket.size());
+        // Append the entry.
+        bucket.push_back(entry);
+        // Count it.
+        ++count;
+    }
+    // Removes the entry at a location by swapping in the bucket's last entry.
+    void removeAt(int at, int index) {
+        // List holding the entry.
+        auto& bucket = at == kWindowSize ? overflow : window[at];
+        // The node leaves the queue.
+        where[bucket[index].node] = -1;
+        // Move the last entry into the hole.
+        bucket[index] = bucket.back();
+        // Update the moved entry's slot.
+        slot[bucket[index].node] = index;
+        // Drop the last slot.
+        bucket.pop_back();
+        // Uncount the entry.
+        --count;
+    }
+};
+
+#endif
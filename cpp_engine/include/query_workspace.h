@@ -0,0 +1,74 @@
+#ifndef QUERY_WORKSPACE_H
+#define QUERY_WORKSPACE_H
+
+#include "graph.h"
+#include "priority_queues.h"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Reusable scratch state for point-to-point searches over a CsrGraph.
+//
+// Holds dense distance/parent arrays indexed by internal node index plus one instance of every
+// priority queue policy, so switching queues between queries allocates nothing.
+// Every label carries the epoch it was written in; labels from older epochs read as
+// "unreached" (INF / -1), so starting a new query is O(1) instead of O(V) and the cost of
+// a query is proportional to the nodes it actually touches. Buffers only grow, so one
+// workspace per thread can be reused for every query on a graph.
+class QueryWorkspace {
+public:
+    // Binary heap with lazy deletion.
+    BinaryHeapQueue binaryQueue;
+    // Indexed 4-ary heap with decrease-key.
+    IndexedDaryHeap<4> daryQueue;
+    // Monotone radix heap.
+    RadixHeap radixQueue;
+    // Dial-style bucket queue.
+    BucketQueue bucketQueue;
+
+    // Creates a workspace sized for a graph with the given number of nodes.
+    explicit QueryWorkspace(int numNodes = 0);
+
+    // Starts a new query on a graph with numNodes nodes, invalidating all labels.
+    void reset(int numNodes);
+    // Distance label of u, or INF if u was not reached in this query.
+    double distance(int u) const { return stamp[u] == epoch ? dist[u] : INF; }
+    // Parent of u in the search tree, or -1 if u was not reached or is the root.
+    int parent(int u) const { return stamp[u] == epoch ? parentOf[u] : -1; }
+    // Whether u was reached in this query.
+    bool reached(int u) const { return stamp[u] == epoch; }
+    // Sets the distance and parent labels of u.
+    void setLabel(int u, double d, int p) { stamp[u] = epoch; dist[u] = d; parentOf[u] = p; }
+    // Number of node slots currently allocated.
+    int capacity() const { return static_cast<int>(stamp.size()); }
+
+    // Walks parent pointers back from u and returns the external IDs of the path root..u.
+    template <class GraphT>
+    std::vector<int> extractPath(const GraphT& graph, int u) const;
+
+private:
+    // Tentative distance per node (valid only where stamp == epoch).
+    std::vector<double> dist;
+    // Parent per node (valid only where stamp == epoch).
+    std::vector<int> parentOf;
+    // Epoch in which each node's labels were last written.
+    std::vector<uint32_t> stamp;
+    // Current query epoch; never 0 so that freshly allocated stamps read as stale.
+    uint32_t epoch = 1;
+};
+
+// Walks parent pointers back from u and returns the external IDs of the path root..u.
+template <class GraphT>
+std::vector<int> QueryWorkspace::extractPath(const GraphT& graph, int u) const {
+    // Path collected backwards.
+    std::vector<int> path;
+    // Follow parents until the root.
+    for (int curr = u; curr != -1; curr = parent(curr)) {
+        // Translate to the external ID.
+        path.push_back(graph.externalId(curr));
+    }
+    // Reverse into root..u order.
+    return std::vector<int>(path.rbegin(), path.rend());
+}
+
+#endif
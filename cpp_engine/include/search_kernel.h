@@ -0,0 +1,257 @@
+#ifndef SEARCH_KERNEL_H
+#define SEARCH_KERNEL_H
+
+#include "csr_graph.h"
+#include "priority_queues.h"
+#include "query_workspace.h"
+#include "stats.h"
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+// Point-to-point label-setting search shared by Dijkstra and A*, parameterized by the priority
+// queue policy (see priority_queues.h) and a node potential. Dijkstra is the zero potential.
+// The bidirectional variant runs a forward search from the source and a backward search over the
+// incoming edges from the target, alternating between them until they provably meet.
+namespace SearchKernel {
+    // Potential of plain Dijkstra.
+    struct ZeroPotential {
+        // Every node has potential 0.
+        double operator()(int) const { return 0.0; }
+    };
+
+    // Euclidean distance to a fixed target, read from the graph's coordinate arrays.
+    struct EuclideanPotential {
+        // Graph providing coordinates.
+        const CsrGraph& graph;
+        // Internal index of the target.
+        int target;
+        // Straight-line distance from u to the target.
+        double operator()(int u) const {
+            // Calculate difference in x coordinates.
+            double dx = graph.x(u) - graph.x(target);
+            // Calculate difference in y coordinates.
+            double dy = graph.y(u) - graph.y(target);
+            // Return Euclidean distance.
+            return std::sqrt(dx * dx + dy * dy);
+        }
+    };
+
+    // Consistent average potential for bidirectional A*: half the difference between the Euclidean
+    // bound towards one endpoint and the bound from the other, shifted by half their distance.
+    // The forward search uses {graph, target, source}, the backward search {graph, source, target};
+    // the two then sum to the same constant at every node, which keeps the stopping rule exact, and
+    // the triangle inequality keeps each of them non-negative (as the radix heap requires).
+    struct AveragePotential {
+        // Bound towards the endpoint this search is heading for.
+        EuclideanPotential toward;
+        // Bound from the endpoint this search started at.
+        EuclideanPotential away;
+        // Creates the potential of a search from `from` towards `to`.
+        AveragePotential(const CsrGraph& graph, int to, int from) : toward{graph, to}, away{graph, from} {}
+        // Potential of u.
+        double operator()(int u) const {
+            // Average of the two bounds, clamped against rounding below zero.
+            return std::max(0.0, (toward(u) - away(u) + away(toward.target)) * 0.5);
+        }
+    };
+
+    // Runs the search from source until target is settled; labels are left in the workspace.
+    // Nodes may be reopened when the potential is inconsistent, matching the original A*.
+    template <class Queue, class Potential>
+    bool run(const CsrGraph& graph, QueryWorkspace& workspace, Queue& queue, int source, int target, const Potential& potential) {
+        // Start a new query on the labels.
+        workspace.reset(graph.numNodes());
+        // Start a new query on the queue.
+        queue.reset(graph.numNodes());
+        // Distance from the source to itself is 0.
+        workspace.setLabel(source, 0, -1);
+        // Seed the queue with the source.
+        queue.push(source, potential(source));
+        // Counts of this search, published when it returns.
+        ROUTE_STATS(Stats::Local counters; ++counters[Stats::HeapPushes];)
+        // Main loop.
+        while (!queue.empty()) {
+            // Entry with the smallest key.
+            std::pair<double, int> top = queue.pop();
+            ROUTE_STATS(++counters[Stats::HeapPops];)
+            // Node of the entry.
+            int u = top.second;
+            // Current distance label of the node (labels only ever decrease).
+            double d = workspace.distance(u);
+            // Skip entries superseded by a later improvement; keys are recomputed by the same expression.
+            if (top.first > d + potential(u)) { ROUTE_STATS(++counters[Stats::StalePops];) continue; }
+            // Stop once the target is settled.
+            if (u == target) { ROUTE_STATS(++counters[Stats::NodesSettled];) return true; }
+            // Count the node and its edges.
+            ROUTE_STATS(++counters[Stats::NodesSettled]; counters[Stats::EdgesRelaxed] += graph.endEdge(u) - graph.beginEdge(u);)
+            // Relax u's contiguous edge range.
+            for (int e = graph.beginEdge(u); e < graph.endEdge(u); ++e) {
+                // Neighbor node index.
+                int v = graph.edgeHead(e);
+                // Candidate distance through u.
+                double candidate = d + graph.edgeWeight(e);
+                // If a shorter path to v is found through u.
+                if (candidate < workspace.distance(v)) {
+                    // Update distance and predecessor of v.
+                    workspace.setLabel(v, candidate, u);
+                    // Potential-adjusted priority of v.
+                    double key = candidate + potential(v);
+                    // Queue v (or lower its key); an infinite potential means v cannot reach the target.
+                    if (key < INF) { queue.push(v, key); ROUTE_STATS(++counters[Stats::HeapPushes];) }
+                }
+            }
+        }
+        // Queue exhausted without settling the target.
+        return false;
+    }
+
+    // Runs the search with the workspace's queue of the requested kind.
+    template <class Potential>
+    bool runWith(QueueKind kind, const CsrGraph& graph, QueryWorkspace& workspace, int source, int target, const Potential& potential) {
+        // Dispatch once per query; the kernel itself is fully inlined per queue.
+        switch (kind) {
+            // Indexed 4-ary heap.
+            case QueueKind::Dary4: return run(graph, workspace, workspace.daryQueue, source, target, potential);
+            // Radix heap.
+            case QueueKind::Radix: return run(graph, workspace, workspace.radixQueue, source, target, potential);
+            // Bucket queue quantized by the smallest positive edge weight.
+            case QueueKind::Bucket:
+                // Size buckets to the graph's weight quantum.
+                workspace.bucketQueue.setWidth(graph.minPositiveWeight);
+                // Only potentials or zero-weight edges need the exact order within a bucket.
+                workspace.bucketQueue.setExactOrder(!std::is_same<Potential, ZeroPotential>::value || graph.minWeight <= 0);
+                // Run the search.
+                return run(graph, workspace, workspace.bucketQueue, source, target, potential);
+            // Binary heap with lazy deletion.
+            default: return run(graph, workspace, workspace.binaryQueue, source, target, potential);
+        }
+    }
+
+    // Settles the next node of one direction of a bidirectional search.
+    // Returns false once the search as a whole may stop. `key` is this side's last settled key and
+    // `otherKey` the opposite side's; both are lower bounds on everything still queued on that side.
+    template <bool Backward, class Queue, class Potential>
+    bool step(const CsrGraph& graph, QueryWorkspace& self, const QueryWorkspace& other, Queue& queue, const Potential& potential,
+              double& key, double otherKey, double slack, double& best, int& meeting) {
+        // Entry with the smallest key.
+        std::pair<double, int> top = queue.pop();
+        // Counts of this step, published when it returns.
+        ROUTE_STATS(Stats::Local counters; ++counters[Stats::HeapPops];)
+        // Node of the entry.
+        int u = top.second;
+        // Current distance label of the node.
+        double d = self.distance(u);
+        // Skip entries superseded by a later improvement.
+        if (top.first > d + potential(u)) { ROUTE_STATS(++counters[Stats::StalePops];) return true; }
+        // Advance this side's bound.
+        key = top.first;
+        // No unsettled path can beat the best meeting any more.
+        if (key + otherKey >= best + slack) return false;
+        // Edge range in the search direction.
+        int begin = Backward ? graph.beginInEdge(u) : graph.beginEdge(u);
+        // End of the range.
+        int end = Backward ? graph.endInEdge(u) : graph.endEdge(u);
+        // Count the node and its edges.
+        ROUTE_STATS(++counters[Stats::NodesSettled]; counters[Stats::EdgesRelaxed] += end - begin;)
+        // Relax u's edges.
+        for (int e = begin; e < end; ++e) {
+            // Neighbor node index.
+            int v = Backward ? graph.inEdgeTail(e) : graph.edgeHead(e);
+            // Candidate distance through u.
+            double candidate = d + (Backward ? graph.inEdgeWeight(e) : graph.edgeWeight(e));
+            // If a shorter path to v is found through u.
+            if (candidate < self.distance(v)) {
+                // Update distance and predecessor of v.
+                self.setLabel(v, candidate, u);
+                // Queue v (or lower its key) with its potential-adjusted priority.
+                queue.push(v, candidate + potential(v));
+                ROUTE_STATS(++counters[Stats::HeapPushes];)
+            }
+            // A node labelled by both searches closes a source-target path.
+            if (other.reached(v) && self.distance(v) + other.distance(v) < best) {
+                // Record the shorter path.
+                best = self.distance(v) + other.distance(v);
+                // Remember where the searches meet.
+                meeting = v;
+            }
+        }
+        // Keep going.
+        return true;
+    }
+
+    // Runs a forward search from source and a backward search from target until they meet for good.
+    // The two potentials must sum to the same constant at every node (zero for Dijkstra).
+    // Returns the meeting node (-1 if target is unreachable); the forward workspace holds the
+    // source side's labels and the backward workspace the target side's.
+    template <class Queue, class ForwardPotential, class BackwardPotential>
+    int runBidirectional(const CsrGraph& graph, QueryWorkspace& forward, QueryWorkspace& backward, Queue& forwardQueue, Queue& backwardQueue,
+                         int source, int target, const ForwardPotential& forwardPotential, const BackwardPotential& backwardPotential) {
+        // Start a new query on both sides.
+        forward.reset(graph.numNodes());
+        backward.reset(graph.numNodes());
+        forwardQueue.reset(graph.numNodes());
+        backwardQueue.reset(graph.numNodes());
+        // Distance from the source to itself is 0.
+        forward.setLabel(source, 0, -1);
+        // Distance from the target to itself is 0.
+        backward.setLabel(target, 0, -1);
+        // Trivial query.
+        if (source == target) return source;
+        // Seed the forward queue.
+        forwardQueue.push(source, forwardPotential(source));
+        // Seed the backward queue.
+        backwardQueue.push(target, backwardPotential(target));
+        // Last settled key on each side, starting with the seeds.
+        double forwardKey = forwardPotential(source), backwardKey = backwardPotential(target);
+        // Constant sum of the potentials, added to the meeting length in the stopping rule.
+        const double slack = forwardPotential(target) + backwardPotential(target);
+        // Length of the best path found so far.
+        double best = INF;
+        // Node where that path crosses from the forward to the backward tree.
+        int meeting = -1;
+        // Once either side runs dry, every path through its unexplored part is accounted for.
+        while (!forwardQueue.empty() && !backwardQueue.empty()) {
+            // Advance the side that is behind, which keeps the two balls about the same radius.
+            bool proceed = forwardKey <= backwardKey
+                ? step<false>(graph, forward, backward, forwardQueue, forwardPotential, forwardKey, backwardKey, slack, best, meeting)
+                : step<true>(graph, backward, forward, backwardQueue, backwardPotential, backwardKey, forwardKey, slack, best, meeting);
+            // Stop once the meeting is final.
+            if (!proceed) break;
+        }
+        // Best meeting node, if any.
+        return meeting;
+    }
+
+    // Runs the bidirectional search with the workspaces' queues of the requested kind.
+    template <class ForwardPotential, class BackwardPotential>
+    int runBidirectionalWith(QueueKind kind, const CsrGraph& graph, QueryWorkspace& forward, QueryWorkspace& backward, int source, int target,
+                             const ForwardPotential& forwardPotential, const BackwardPotential& backwardPotential) {
+        // Dispatch once per query.
+        switch (kind) {
+            // Indexed 4-ary heaps.
+            case QueueKind::Dary4:
+                return runBidirectional(graph, forward, backward, forward.daryQueue, backward.daryQueue, source, target, forwardPotential, backwardPotential);
+            // Radix heaps.
+            case QueueKind::Radix:
+                return runBidirectional(graph, forward, backward, forward.radixQueue, backward.radixQueue, source, target, forwardPotential, backwardPotential);
+            // Bucket queues quantized by the smallest positive edge weight.
+            case QueueKind::Bucket: {
+                // Configure both sides.
+                for (BucketQueue* queue : {&forward.bucketQueue, &backward.bucketQueue}) {
+                    // Size buckets to the graph's weight quantum.
+                    queue->setWidth(graph.minPositiveWeight);
+                    // The stopping rule treats popped keys as lower bounds, so pops must be exactly ordered.
+                    queue->setExactOrder(true);
+                }
+                // Run the search.
+                return runBidirectional(graph, forward, backward, forward.bucketQueue, backward.bucketQueue, source, target, forwardPotential, backwardPotential);
+            }
+            // Binary heaps with lazy deletion.
+            default:
+                return runBidirectional(graph, forward, backward, forward.binaryQueue, backward.binaryQueue, source, target, forwardPotential, backwardPotential);
+        }
+    }
+}
+
+#endif
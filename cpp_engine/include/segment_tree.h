@@ -1,21 +1,119 @@
 #ifndef SEGMENT_TREE_H
 #define SEGMENT_TREE_H
 
+#include <algorithm>
+#include <limits>
+#include <utility>
 #include <vector>
-#include <functional>
 
+// Monoids for SegmentTree: an associative combine with an identity element.
+// Sum of the values.
+struct SumMonoid {
+    using Value = double;
+    static Value identity() { return 0.0; }
+    static Value combine(Value a, Value b) { return a + b; }
+};
+// Smallest value.
+struct MinMonoid {
+    using Value = double;
+    static Value identity() { return std::numeric_limits<double>::infinity(); }
+    static Value combine(Value a, Value b) { return std::min(a, b); }
+};
+// Largest value.
+struct MaxMonoid {
+    using Value = double;
+    static Value identity() { return -std::numeric_limits<double>::infinity(); }
+    static Value combine(Value a, Value b) { return std::max(a, b); }
+};
+
+// Iterative (bottom-up) segment tree over a monoid.
+// The leaves are padded to a power of two and stored with their ancestors in one flat array:
+// node i has children 2i and 2i+1, the root is node 1 and leaf k is node capacity + k. Point
+// updates and range queries walk between a leaf and the root without recursion, O(log n) each;
+// combine is applied in index order, so the monoid need not be commutative.
+template <class Monoid>
 class SegmentTree {
 public:
-    std::vector<double> tree;
-    int n;
+    using Value = typename Monoid::Value;
+
+    // Creates a tree over n copies of the identity.
+    explicit SegmentTree(int n = 0) { assign(std::vector<Value>(n, Monoid::identity())); }
+    // Creates a tree over the values.
+    explicit SegmentTree(const std::vector<Value>& values) { assign(values); }
+
+    // Replaces all values, building the inner nodes in O(n).
+    void assign(const std::vector<Value>& values) {
+        // Number of values.
+        count = static_cast<int>(values.size());
+        // Smallest power of two that holds them.
+        capacity = 1;
+        while (capacity < count) capacity *= 2;
+        // Leaves, padded with the identity.
+        tree.assign(2 * capacity, Monoid::identity());
+        std::copy(values.begin(), values.end(), tree.begin() + capacity);
+        // Inner nodes, bottom-up.
+        for (int i = capacity - 1; i > 0; --i) tree[i] = Monoid::combine(tree[2 * i], tree[2 * i + 1]);
+    }
+    // Sets value i.
+    void update(int i, Value value) {
+        // Leaf.
+        int node = capacity + i;
+        tree[node] = value;
+        // Its ancestors.
+        for (node /= 2; node > 0; node /= 2) tree[node] = Monoid::combine(tree[2 * node], tree[2 * node + 1]);
+    }
+    // Sets many values at once (index, value); each affected inner node is recomputed only once.
+    void update(const std::vector<std::pair<int, Value>>& values) {
+        // Write the leaves and collect their parents.
+        dirty.clear();
+        for (const auto& entry : values) {
+            // Leaf.
+            tree[capacity + entry.first] = entry.second;
+            dirty.push_back((capacity + entry.first) / 2);
+        }
+        // Level by level: sorted parents make duplicates adjacent.
+        std::sort(dirty.begin(), dirty.end());
+        dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+        while (!dirty.empty() && dirty.front() > 0) {
+            // Recompute this level and move to the parents, which stay sorted.
+            size_t kept = 0;
+            for (int node : dirty) {
+                // Inner node from its children.
+                tree[node] = Monoid::combine(tree[2 * node], tree[2 * node + 1]);
+                // Its parent, unless the previous node shares it.
+                if (kept == 0 || dirty[kept - 1] != node / 2) dirty[kept++] = node / 2;
+            }
+            dirty.resize(kept);
+        }
+    }
+    // Value i.
+    Value at(int i) const { return tree[capacity + i]; }
+    // Combination of the values first..last (inclusive); the identity for an empty range.
+    Value query(int first, int last) const {
+        // Partial results from the left and right ends, combined in order at the end.
+        Value left = Monoid::identity(), right = Monoid::identity();
+        // Half-open leaf range, narrowed one level per step.
+        for (int lo = capacity + first, hi = capacity + last + 1; lo < hi; lo /= 2, hi /= 2) {
+            // A right child on the left end is fully inside; take it and step past it.
+            if (lo & 1) left = Monoid::combine(left, tree[lo++]);
+            // Likewise a left sibling just before the right end.
+            if (hi & 1) right = Monoid::combine(tree[--hi], right);
+        }
+        return Monoid::combine(left, right);
+    }
+    // Combination of all values.
+    Value total() const { return tree[1]; }
+    // Number of values.
+    int size() const { return count; }
 
-    // Constructor: builds the segment tree from an initial array of values.
-    SegmentTree(const std::vector<double>& arr);
-    void build(const std::vector<double>& arr, int node, int start, int end);
-    void update(int node, int start, int end, int idx, double val);
-    double query(int node, int start, int end, int l, int r);
-    void updateValue(int idx, double val);
-    double queryRange(int l, int r);
+private:
+    // Number of values and of leaves (a power of two).
+    int count = 0;
+    int capacity = 1;
+    // Flat tree; node 0 is unused.
+    std::vector<Value> tree;
+    // Inner nodes to recompute during a batch update.
+    std::vector<int> dirty;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,24 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "engine.h"
+#include <istream>
+#include <ostream>
+#include <string>
+
+// Long-lived request loop for the engine ("serve" mode).
+//
+// Framing: a request is one line holding a command exactly as it would be passed on the
+// command line (e.g. "shortest_path dijkstra 1 5"). Every request gets one response made of a
+// header line "<status> <length>\n" followed by exactly <length> bytes of command output.
+// Status is the exit code the one-shot CLI would have returned. The line "exit" ends the session.
+namespace Server {
+    // Executes a single request line against the engine and returns the framed response.
+    std::string handleRequest(Engine& engine, const std::string& line);
+    // Serves framed requests from an input stream (typically stdin) until EOF or "exit".
+    int serveStream(Engine& engine, std::istream& in, std::ostream& out);
+    // Serves framed requests on a Unix domain socket, one thread per connection.
+    int serveUnixSocket(Engine& engine, const std::string& socketPath);
+}
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef SHORTEST_PATH_TREE_H
+#define SHORTEST_PATH_TREE_H
+
+#include "csr_graph.h"
+#include "priority_queues.h"
+#include <cstddef>
+#include <vector>
+
+// Resident shortest path tree of one source, repaired in place after weight changes.
+//
+// Distances and parents are dense arrays over internal indices; the tree is also kept as
+// first-child / sibling lists so the subtree below a node can be walked and a node can move to
+// a new parent in O(1). Repairs follow Ramalingam and Reps: a decrease of u -> v that shortens
+// d(v) runs a Dijkstra seeded at v that only visits nodes whose distance drops; an increase of a
+// tree edge u -> v detaches the subtree of v, seeds each of its nodes with its best edge from
+// outside the subtree, and re-settles the subtree among itself. Either way the work is
+// proportional to the affected nodes and their edges, not to the graph. Topology changes
+// (new nodes or edges) renumber the frozen graph and require a rebuild.
+class ShortestPathTree {
+public:
+    // Grows the full tree of source (internal index) on graph.
+    ShortestPathTree(const CsrGraph& graph, int source);
+
+    // Repairs the tree after the weights of the edges u -> v (internal indices) changed; the graph
+    // must already carry the new weights. Returns the number of nodes whose label changed.
+    size_t edgeChanged(const CsrGraph& graph, int u, int v);
+
+    // Internal index of the source.
+    int source() const { return root; }
+    // Distance from the source to u (INF if unreachable).
+    double distance(int u) const { return dist[u]; }
+    // Parent of u in the tree (-1 for the source and unreachable nodes).
+    int parent(int u) const { return parentOf[u]; }
+    // Number of nodes reachable from the source.
+    int reachedCount() const { return reached; }
+    // External IDs of the tree path from the source to u (empty if unreachable).
+    std::vector<int> pathTo(const CsrGraph& graph, int u) const;
+
+private:
+    // Makes child the first child of parent.
+    void link(int child, int parent);
+    // Removes child from its parent's child list.
+    void unlink(int child);
+    // Lowers the label of v to d with parent p and queues it (decrease repair).
+    void lower(int v, double d, int p);
+    // Cheapest weight of the edges u -> v (INF if there is none).
+    static double edgeWeight(const CsrGraph& graph, int u, int v);
+
+    // Source node.
+    int root;
+    // Distance labels.
+    std::vector<double> dist;
+    // Tree parent of every node.
+    std::vector<int> parentOf;
+    // Child lists: first child of every node, and the doubly linked siblings of every node.
+    std::vector<int> firstChild;
+    std::vector<int> nextSibling;
+    std::vector<int> prevSibling;
+    // Parent an affected node will be linked to once it is settled (increase repair).
+    std::vector<int> pendingParent;
+    // Marks the nodes of the detached subtree (increase repair).
+    std::vector<char> detached;
+    // Nodes of the detached subtree, and the DFS stack collecting them.
+    std::vector<int> subtree;
+    std::vector<int> stack;
+    // Heap of the repairs; always drained between calls.
+    IndexedDaryHeap<4> queue;
+    // Nodes with a finite distance.
+    int reached = 0;
+    // Nodes relabelled by the repair in progress.
+    size_t changed = 0;
+};
+
+#endif
@@ -0,0 +1,191 @@
+#ifndef SPATIAL_INDEX_H
+#define SPATIAL_INDEX_H
+
+#include "csr_graph.h"
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Static R-tree bulk-loaded in Hilbert order (packed Hilbert R-tree).
+//
+// Items are sorted by the Hilbert index of their box centers and packed FANOUT to a leaf-level
+// node, then the nodes FANOUT to a parent, up to a single root; all levels live in one array,
+// leaves first, so the tree is a few flat vectors without pointers. Nearest-neighbour queries are
+// best-first: one queue holds tree nodes keyed by the distance to their box and items keyed by
+// their exact distance, and items come off it in order of distance.
+class PackedHilbertRTree {
+public:
+    // Axis-aligned bounding box.
+    struct Box {
+        double minX, minY, maxX, maxY;
+        // Squared distance from a point to the box (0 inside).
+        double distance2(double x, double y) const {
+            // Distance outside the box along each axis.
+            double dx = std::max(std::max(minX - x, x - maxX), 0.0);
+            double dy = std::max(std::max(minY - y, y - maxY), 0.0);
+            return dx * dx + dy * dy;
+        }
+    };
+
+    // Children per tree node.
+    static constexpr int FANOUT = 16;
+
+    // Builds the tree over the given boxes; returns the item order, order[slot] being the index in
+    // boxes of the item stored at leaf slot `slot`. Queries report leaf slots.
+    std::vector<int> build(const std::vector<Box>& boxes);
+    // Number of items.
+    size_t size() const { return levelStart.empty() ? 0 : levelStart[1]; }
+
+    // Up to k items closest to (x, y), as (squared distance, slot) in ascending order.
+    // distance2(slot) is the exact squared distance of an item, at least the distance to its box;
+    // items for which it returns INF (removed ones) are skipped.
+    template <class Distance>
+    void nearest(double x, double y, size_t k, const Distance& distance2, std::vector<std::pair<double, int>>& result) const;
+
+private:
+    // Boxes of every level, leaves (the items) first and the root last.
+    std::vector<Box> boxes;
+    // Offset of each level in boxes, plus the total size; level 0 is the leaves.
+    std::vector<size_t> levelStart;
+};
+
+// Finds the k closest items best-first.
+template <class Distance>
+void PackedHilbertRTree::nearest(double x, double y, size_t k, const Distance& distance2, std::vector<std::pair<double, int>>& result) const {
+    // Start over.
+    result.clear();
+    if (size() == 0 || k == 0) return;
+    // Queue entries: key, level (-1 for an item with its exact distance) and index within the level.
+    struct Entry {
+        double key;
+        int level;
+        int index;
+        // Min-queue order.
+        bool operator>(const Entry& other) const { return key > other.key; }
+    };
+    std::vector<Entry> queue;
+    queue.reserve(4 * FANOUT);
+    // Largest of the k smallest item distances queued so far (a max-heap): nothing farther can be
+    // among the k closest, so farther nodes and items are never queued.
+    std::vector<double> kept;
+    auto bound = [&]() { return kept.size() == k ? kept.front() : INF; };
+    // Start at the root.
+    int top = static_cast<int>(levelStart.size()) - 2;
+    queue.push_back({boxes[levelStart[top]].distance2(x, y), top, 0});
+    // Expand the closest entry until k items came off the queue.
+    while (!queue.empty()) {
+        // Closest entry.
+        std::pop_heap(queue.begin(), queue.end(), std::greater<Entry>());
+        Entry entry = queue.back();
+        queue.pop_back();
+        // An item: nothing left in the queue is closer.
+        if (entry.level < 0) {
+            result.push_back({entry.key, entry.index});
+            if (result.size() == k) return;
+            continue;
+        }
+        // Children of the node, one level down.
+        int level = entry.level - 1;
+        size_t begin = static_cast<size_t>(entry.index) * FANOUT;
+        size_t end = std::min(begin + FANOUT, levelStart[level + 1] - levelStart[level]);
+        for (size_t child = begin; child < end; ++child) {
+            // Items enter with their exact distance, nodes with their box distance.
+            double key = level == 0 ? distance2(static_cast<int>(child)) : boxes[levelStart[level] + child].distance2(x, y);
+            // Removed items never come back, and entries beyond the bound cannot make the result.
+            if (key == INF || key > bound()) continue;
+            // Queued items tighten the bound.
+            if (level == 0) {
+                if (kept.size() == k) { std::pop_heap(kept.begin(), kept.end()); kept.pop_back(); }
+                kept.push_back(key);
+                std::push_heap(kept.begin(), kept.end());
+            }
+            queue.push_back({key, level == 0 ? -1 : level, static_cast<int>(child)});
+            std::push_heap(queue.begin(), queue.end(), std::greater<Entry>());
+        }
+    }
+}
+
+// Nearest-node and nearest-edge lookups over the graph's coordinates.
+//
+// Nodes are points and edges are straight segments between their end nodes; the edges u->v and
+// v->u share one segment. Both are packed into static R-trees when built. Nodes and edges added
+// afterwards go to small insertion buffers that every query scans as well, and removed edges are
+// flagged, so single additions and removals never rebuild the trees; a rebuild pays off once the
+// buffers outgrow BUFFER_LIMIT (see needsRebuild).
+class SpatialIndex {
+public:
+    // Buffered nodes or segments beyond which a rebuild pays off.
+    static constexpr size_t BUFFER_LIMIT = 1024;
+
+    // A node close to the query point.
+    struct NodeMatch {
+        // External ID and coordinates of the node.
+        int id;
+        double x, y;
+        // Euclidean distance to the query point.
+        double distance;
+    };
+    // The closest point of an edge segment.
+    struct EdgeMatch {
+        // Ends of the segment (external IDs); `from` is the smaller ID unless only the opposite edge exists.
+        int from, to;
+        // Closest point on the segment and its position from `from` (0) to `to` (1).
+        double x, y, fraction;
+        // Euclidean distance to the query point.
+        double distance;
+    };
+
+    // Indexes every node and edge of a frozen graph.
+    void build(const CsrGraph& graph);
+    // Adds a node created after the build.
+    void addNode(int id, double x, double y);
+    // Adds the segment of an edge created after the build, unless its ends are joined already.
+    void addEdge(int from, double fromX, double fromY, int to, double toX, double toY);
+    // Removes the segment between two nodes; call once no edge joins them in either direction.
+    void removeEdge(int from, int to);
+    // Whether enough was added or removed since the build that rebuilding would speed up queries.
+    bool needsRebuild() const;
+
+    // Up to k nodes closest to (x, y), closest first.
+    std::vector<NodeMatch> nearestNodes(double x, double y, size_t k) const;
+    // Up to k segments closest to (x, y), closest first.
+    std::vector<EdgeMatch> nearestEdges(double x, double y, size_t k) const;
+    // Number of indexed nodes and segments.
+    size_t nodeCount() const { return nodes.size(); }
+    size_t segmentCount() const { return segments.size() - removedSegments; }
+
+private:
+    // Slot of the segment still in place between the nodes of a packed pair, or -1.
+    int findSegment(uint64_t key) const;
+
+    // An indexed node.
+    struct Point {
+        int id;
+        double x, y;
+    };
+    // An indexed segment.
+    struct Segment {
+        int from, to;
+        double ax, ay, bx, by;
+        // Set when its edges were removed.
+        bool removed;
+    };
+
+    // Nodes in tree order, then the buffered ones.
+    std::vector<Point> nodes;
+    PackedHilbertRTree nodeTree;
+    // Segments in tree order, then the buffered ones.
+    std::vector<Segment> segments;
+    PackedHilbertRTree segmentTree;
+    // Packed IDs of the ends (smaller one first) and slot of every segment in the tree, sorted.
+    std::vector<std::pair<uint64_t, int>> treeSegments;
+    // Slot of every buffered segment, by the packed IDs of its ends.
+    std::unordered_map<uint64_t, int> bufferedSegments;
+    // Segments flagged as removed.
+    size_t removedSegments = 0;
+};
+
+#endif
@@ -0,0 +1,123 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Runs a statement only in builds with instrumentation (cmake -DROUTE_ENGINE_STATS=ON, the
+// default); with it off, every counter update in the hot paths compiles to nothing.
+#ifdef ROUTE_ENGINE_STATS
+#define ROUTE_STATS(statement) statement
+#else
+#define ROUTE_STATS(statement)
+#endif
+
+// Search counters and latency histograms.
+//
+// Every thread counts into its own block of relaxed atomics, written only by that thread, so a
+// counter update is a plain load and store with no contention. Searches gather their counts in a
+// Stats::Local on the stack and publish them once when it goes out of scope. Readers sum the
+// blocks of all threads (and of threads that have exited) without stopping the writers.
+namespace Stats {
+    // Counted events.
+    enum Counter {
+        // Nodes taken off a queue and expanded.
+        NodesSettled,
+        // Edges scanned from settled nodes.
+        EdgesRelaxed,
+        // Queue insertions and key decreases.
+        HeapPushes,
+        // Queue removals, stale ones included.
+        HeapPops,
+        // Removed entries superseded by a later improvement.
+        StalePops,
+        // Path cache lookups answered and missed.
+        CacheHits,
+        CacheMisses,
+        CounterCount
+    };
+
+    // Snake-case name of a counter, as reported by the stats command.
+    const char* counterName(int counter);
+    // Whether counters are compiled in.
+    bool enabled();
+
+    // Counts of every counter.
+    struct Totals {
+        uint64_t values[CounterCount] = {};
+        // Difference to an earlier reading.
+        Totals operator-(const Totals& earlier) const;
+    };
+
+    // Counters of one thread; registered while the thread lives.
+    struct ThreadCounters {
+        std::atomic<uint64_t> values[CounterCount];
+        ThreadCounters();
+        ~ThreadCounters();
+    };
+    // Counters of the calling thread.
+    ThreadCounters& threadCounters();
+    // Adds n to a counter of the calling thread.
+    inline void add(Counter counter, uint64_t n) {
+        // Only this thread writes the block, so no read-modify-write is needed.
+        std::atomic<uint64_t>& value = threadCounters().values[counter];
+        value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+    // Sum over all threads since the last reset.
+    Totals totals();
+    // Starts counting from zero again.
+    void reset();
+
+    // Counts of one search, published to the thread's counters when it is destroyed.
+    struct Local {
+        uint64_t values[CounterCount] = {};
+        ~Local() {
+            // The thread's block, looked up once.
+            ThreadCounters& block = threadCounters();
+            // Publish the non-zero counts.
+            for (int c = 0; c < CounterCount; ++c) {
+                if (values[c]) block.values[c].store(block.values[c].load(std::memory_order_relaxed) + values[c], std::memory_order_relaxed);
+            }
+        }
+        uint64_t& operator[](Counter counter) { return values[counter]; }
+    };
+}
+
+// Latency histogram in the style of HdrHistogram: values (nanoseconds) fall into 128 linear
+// sub-buckets per power of two, so every recorded value is kept within 1% while the whole range up
+// to about an hour takes a few thousand counters. Recording is O(1); percentiles walk the buckets.
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+
+    // Records one value.
+    void record(uint64_t nanoseconds);
+    // Number of recorded values.
+    uint64_t count() const { return total; }
+    // Mean, smallest and largest value (exact).
+    double mean() const { return total ? static_cast<double>(sum) / total : 0.0; }
+    uint64_t min() const { return total ? smallest : 0; }
+    uint64_t max() const { return largest; }
+    // Value at or below which the given fraction of the values lie (within the bucket precision).
+    uint64_t percentile(double fraction) const;
+    // Forgets every value.
+    void clear();
+
+private:
+    // Bucket of a value, and the smallest value of a bucket.
+    static int bucketOf(uint64_t value);
+    static uint64_t lowerBound(int bucket);
+    // Width of a bucket.
+    static uint64_t width(int bucket);
+
+    // Count per bucket.
+    std::vector<uint64_t> counts;
+    // Number, sum and extremes of the values.
+    uint64_t total = 0;
+    uint64_t sum = 0;
+    uint64_t smallest = UINT64_MAX;
+    uint64_t largest = 0;
+};
+
+#endif
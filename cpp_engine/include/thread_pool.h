@@ -0,0 +1,69 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for data-parallel loops (preprocessing, batch queries).
+//
+// parallelFor(count, body) calls body(i, worker) for every i in [0, count) and returns when all
+// calls are done. `worker` is in [0, size()) and is stable for the duration of one call, so callers
+// can keep per-worker scratch state (e.g. one QueryWorkspace per worker) in a vector of size().
+// The calling thread takes part as worker 0. Calls from inside a body run serially on the calling
+// worker instead of deadlocking, and the first exception thrown by a body is rethrown to the caller.
+class ThreadPool {
+public:
+    // Starts a pool with the given number of workers (0 = one per hardware thread).
+    explicit ThreadPool(unsigned threads = 0);
+    // Stops and joins the workers.
+    ~ThreadPool();
+    // Not copyable.
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Number of workers, including the calling thread.
+    unsigned size() const { return static_cast<unsigned>(threads.size()) + 1; }
+    // Runs body(i, worker) for every i in [0, count).
+    void parallelFor(size_t count, const std::function<void(size_t, unsigned)>& body);
+    // Process-wide pool sized to the hardware.
+    static ThreadPool& shared();
+
+private:
+    // Background threads (workers 1..size()-1).
+    std::vector<std::thread> threads;
+    // Guards the job fields below.
+    std::mutex mutex;
+    // Signals workers that a job started or the pool is stopping.
+    std::condition_variable wake;
+    // Signals the caller that all workers left the current job.
+    std::condition_variable finished;
+    // Body of the current job.
+    const std::function<void(size_t, unsigned)>* job = nullptr;
+    // Number of items of the current job.
+    size_t jobSize = 0;
+    // Next item to hand out.
+    std::atomic<size_t> nextItem{0};
+    // Incremented for every job so workers can tell a new job from a spurious wakeup.
+    unsigned long long generation = 0;
+    // Workers still inside the current job.
+    unsigned active = 0;
+    // First exception thrown by a body.
+    std::exception_ptr failure;
+    // Set when the pool shuts down.
+    bool stopping = false;
+    // Serializes concurrent parallelFor calls from different threads.
+    std::mutex callMutex;
+
+    // Loop of background worker `worker`.
+    void workerLoop(unsigned worker);
+    // Claims and runs items of the current job until none are left.
+    void drain(unsigned worker);
+};
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef TRAVEL_TIME_H
+#define TRAVEL_TIME_H
+
+#include <string>
+#include <vector>
+
+// Point of a piecewise-linear function: value at time.
+struct Breakpoint {
+    // Time (minutes).
+    double time;
+    // Value at that time (a travel time for edge functions, an arrival time for profiles).
+    double value;
+};
+
+// Periodic piecewise-linear travel-time functions of edges.
+//
+// A function is a sorted list of breakpoints (departure time in [0, PERIOD), travel time) that
+// repeats every PERIOD (a day in minutes) and is linear between neighbouring breakpoints, the last
+// one connecting to the first of the next day. Functions must be FIFO: leaving later never means
+// arriving earlier, i.e. every slope is at least -1. This is what makes time-dependent Dijkstra
+// label-setting, and it is checked when a function is read.
+namespace TravelTime {
+    // Length of the period in minutes.
+    const double PERIOD = 1440.0;
+
+    // Sorts the breakpoints and checks them (times in [0, PERIOD), distinct; finite non-negative
+    // values; FIFO); returns false and sets error if they cannot form a function.
+    bool normalize(std::vector<Breakpoint>& points, const char*& error);
+    // Travel time when departing at t (any time; the function repeats).
+    double evaluate(const Breakpoint* points, int count, double t);
+    // Smallest travel time of the function.
+    double minimum(const Breakpoint* points, int count);
+    // Parses "HH:MM" or plain minutes (any non-negative time); false if malformed.
+    bool parseTime(const std::string& text, double& minutes);
+}
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef UNION_FIND_H
+#define UNION_FIND_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// Disjoint sets over the dense indices 0..size()-1.
+// find uses iterative path halving (no recursion, so long chains cannot overflow the stack) and
+// unite links the smaller set under the larger one; together they give near-constant amortized time.
+class DisjointSets {
+public:
+    // Creates n singletons.
+    explicit DisjointSets(int n = 0);
+
+    // Representative of the set containing x.
+    int find(int x);
+    // Merges the sets of a and b; returns false if they were already one set.
+    bool unite(int a, int b);
+
+    // Number of elements.
+    int size() const { return static_cast<int>(parent.size()); }
+    // Number of sets.
+    int count() const { return sets; }
+
+private:
+    // Parent of every element (roots point to themselves).
+    std::vector<int> parent;
+    // Number of elements below every root (meaningless for non-roots).
+    std::vector<int> sizeOf;
+    // Number of sets.
+    int sets = 0;
+};
+
+// Disjoint sets over 0..n-1 that many threads may unite and query at once.
+// unite links a root under the other with a single compare-and-swap on the root's parent, always
+// the larger index under the smaller, so links can never form a cycle and each set ends up
+// represented by its smallest index; a failed CAS means the root was linked concurrently and the
+// operation retries from the new roots (lock-free). find compresses with path halving, also by CAS;
+// a lost compression race is simply skipped, so find never retries (wait-free).
+class ConcurrentDisjointSets {
+public:
+    // Creates n singletons.
+    explicit ConcurrentDisjointSets(int n);
+
+    // Representative of the set containing x (the smallest index of the set once no unite is running).
+    int find(int x);
+    // Merges the sets of a and b; returns false if they were already one set.
+    bool unite(int a, int b);
+
+    // Number of elements.
+    int size() const { return n; }
+
+private:
+    // Number of elements.
+    int n;
+    // Parent of every element (roots point to themselves).
+    std::unique_ptr<std::atomic<int>[]> parent;
+};
+
+#endif
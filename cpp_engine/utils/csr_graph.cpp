@@ -0,0 +1,189 @@
+#include "../include/csr_graph.h"
+#include <algorithm> // For std::lower_bound
+
+// Freezes the current contents of a Graph into CSR arrays.
+CsrGraph::CsrGraph(const Graph& graph) {
+    // Number of nodes; std::map iterates IDs in ascending order, so ids ends up sorted.
+    const size_t n = graph.adj.size();
+    // Reserve node arrays.
+    ids.reserve(n);
+    xs.reserve(n);
+    ys.reserve(n);
+    firstOut.reserve(n + 1);
+    // Total number of edges.
+    size_t m = 0;
+    // Assign dense indices and copy coordinates.
+    for (const auto& entry : graph.adj) {
+        // Record the external ID.
+        ids.push_back(entry.first);
+        // Look up the node's coordinates.
+        const Node* node = graph.getNode(entry.first);
+        // Copy x (nodes created implicitly by addEdge sit at the origin).
+        xs.push_back(node ? node->x : 0.0);
+        // Copy y.
+        ys.push_back(node ? node->y : 0.0);
+        // Count the node's edges.
+        m += entry.second.size();
+    }
+    // Reserve edge arrays.
+    head.reserve(m);
+    weight.reserve(m);
+    // Fill the edge arrays node by node, keeping each node's insertion order.
+    for (const auto& entry : graph.adj) {
+        // Offset of this node's first edge.
+        firstOut.push_back(static_cast<int>(head.size()));
+        // Copy every outgoing edge.
+        for (const Edge& edge : entry.second) {
+            // Translate the target to its internal index.
+            head.push_back(internalId(edge.to));
+            // Copy the weight.
+            weight.push_back(edge.weight);
+            // Track the weight quantum.
+            if (edge.weight > 0 && edge.weight < minPositiveWeight) minPositiveWeight = edge.weight;
+            // Track the smallest weight.
+            if (edge.weight < minWeight) minWeight = edge.weight;
+        }
+    }
+    // Sentinel offset closing the last node's range.
+    firstOut.push_back(static_cast<int>(head.size()));
+    // Whether any edge has a travel-time function.
+    bool anyProfile = false;
+    for (const auto& entry : graph.adj) for (const Edge& edge : entry.second) anyProfile = anyProfile || edge.profile >= 0;
+    // Copy the functions still used by an edge, compactly and in first-use order.
+    if (anyProfile) {
+        // New index of every arena function (-1 until it is used).
+        std::vector<int> remap(graph.firstBreakpoint.size() - 1, -1);
+        // One entry per edge.
+        profile.reserve(m);
+        firstBreakpoint.push_back(0);
+        for (const auto& entry : graph.adj) {
+            // Every outgoing edge, in the same order as above.
+            for (const Edge& edge : entry.second) {
+                // Constant weight.
+                if (edge.profile < 0) { profile.push_back(-1); continue; }
+                // First use of the function: copy its breakpoints.
+                int& f = remap[edge.profile];
+                if (f < 0) {
+                    // Next function index.
+                    f = static_cast<int>(firstBreakpoint.size()) - 1;
+                    // Its breakpoints.
+                    for (int i = graph.firstBreakpoint[edge.profile]; i < graph.firstBreakpoint[edge.profile + 1]; ++i) breakpoints.push_back(graph.breakpoints[i]);
+                    firstBreakpoint.push_back(static_cast<int>(breakpoints.size()));
+                }
+                // The edge's function.
+                profile.push_back(f);
+            }
+        }
+    }
+    // Build the backward CSR by counting sort on the edge heads.
+    firstIn.assign(n + 1, 0);
+    // Count the incoming edges of every node (shifted by one for the prefix sum).
+    for (int v : head) ++firstIn[v + 1];
+    // Prefix sums turn the counts into offsets.
+    for (size_t v = 0; v < n; ++v) firstIn[v + 1] += firstIn[v];
+    // Size the backward edge arrays.
+    tail.resize(m);
+    inWeight.resize(m);
+    inEdge.resize(m);
+    // Next free slot of every node's incoming range.
+    std::vector<int> next(firstIn.begin(), firstIn.end() - 1);
+    // Scatter the forward edges in source order, so parallel edges keep their insertion order.
+    for (int u = 0; u < numNodes(); ++u) {
+        // Every outgoing edge of u is an incoming edge of its head.
+        for (int e = beginEdge(u); e < endEdge(u); ++e) {
+            // Slot in the head's incoming range.
+            int slot = next[head[e]]++;
+            // Record the source.
+            tail[slot] = u;
+            // Copy the weight.
+            inWeight[slot] = weight[e];
+            // Link back to the forward edge.
+            inEdge[slot] = e;
+        }
+    }
+}
+
+// Internal index of an external node ID, or -1 if the node does not exist.
+int CsrGraph::internalId(int id) const {
+    // Binary search in the sorted ID array.
+    auto it = std::lower_bound(ids.begin(), ids.end(), id);
+    // Return -1 if the ID is not present.
+    if (it == ids.end() || *it != id) return -1;
+    // Position in the array is the internal index.
+    return static_cast<int>(it - ids.begin());
+}
+
+// Index of the first edge u->v (internal indices), or -1 if there is none.
+int CsrGraph::findEdge(int u, int v) const {
+    // Scan u's outgoing edges.
+    for (int e = beginEdge(u); e < endEdge(u); ++e) {
+        // Return the first match.
+        if (head[e] == v) return e;
+    }
+    // No such edge.
+    return -1;
+}
+
+// Updates the weight of the first edge from->to (external IDs).
+bool CsrGraph::updateEdgeWeight(int from, int to, double newWeight, double* oldWeight) {
+    // Translate the source.
+    int u = internalId(from);
+    // Translate the target.
+    int v = internalId(to);
+    // Fail if either endpoint is unknown.
+    if (u < 0 || v < 0) return false;
+    // Locate the edge.
+    int e = findEdge(u, v);
+    // Fail if the edge does not exist.
+    if (e < 0) return false;
+    // Report the previous weight.
+    if (oldWeight) *oldWeight = weight[e];
+    // Patch the weight in place; a fixed weight replaces any travel-time function.
+    weight[e] = newWeight;
+    if (!profile.empty()) profile[e] = -1;
+    // Patch the backward copy of the same edge.
+    for (int b = beginInEdge(v); b < endInEdge(v); ++b) {
+        // The backward entry linked to this forward edge.
+        if (inEdge[b] == e) {
+            // Copy the new weight.
+            inWeight[b] = newWeight;
+            // There is exactly one.
+            break;
+        }
+    }
+    // A smaller quantum stays valid for every weight, so only ever lower it.
+    if (newWeight > 0 && newWeight < minPositiveWeight) minPositiveWeight = newWeight;
+    // Same for the smallest weight.
+    if (newWeight < minWeight) minWeight = newWeight;
+    // Indicate successful update.
+    return true;
+}
+
+// Replaces the travel-time function of the first edge from->to (external IDs).
+bool CsrGraph::setTravelTimeFunction(int from, int to, const std::vector<Breakpoint>& points) {
+    // Translate the endpoints.
+    int u = internalId(from);
+    int v = internalId(to);
+    // Fail if either endpoint is unknown.
+    if (u < 0 || v < 0) return false;
+    // Locate the edge.
+    int e = findEdge(u, v);
+    if (e < 0) return false;
+    // The first function: every other edge keeps its constant weight.
+    if (profile.empty()) {
+        profile.assign(head.size(), -1);
+        firstBreakpoint.assign(1, 0);
+    }
+    // Append the function (mapped arrays are copied before they grow); the old one is left unused.
+    for (const Breakpoint& point : points) breakpoints.push_back(point);
+    firstBreakpoint.push_back(static_cast<int>(breakpoints.size()));
+    profile[e] = static_cast<int>(firstBreakpoint.size()) - 2;
+    // Indicate successful update.
+    return true;
+}
+
+// Returns a frozen CSR copy of the graph.
+CsrGraph Graph::freeze() const {
+    // Build the CSR arrays from the current adjacency lists.
+    return CsrGraph(*this);
+}
@@ -0,0 +1,109 @@
+#include "../include/edge_profiles.h"
+#include "../include/travel_time.h"
+#include <algorithm>
+#include <cmath>
+
+// Creates an empty store.
+EdgeProfiles::EdgeProfiles(int buckets) : bucketCount(buckets) {}
+
+// Sets buckets of an edge's profile.
+void EdgeProfiles::set(int from, int to, double baseWeight, const std::vector<std::pair<int, double>>& values) {
+    // Existing profile, or a flat one at the edge's static weight.
+    auto it = profiles.find(key(from, to));
+    if (it == profiles.end()) {
+        // Every bucket at the base weight.
+        std::vector<BucketStats> flat(bucketCount, BucketStats{baseWeight, baseWeight, baseWeight});
+        it = profiles.emplace(key(from, to), SegmentTree<BucketStatsMonoid>(flat)).first;
+    }
+    // Leaves of the changed buckets.
+    std::vector<std::pair<int, BucketStats>> leaves;
+    leaves.reserve(values.size());
+    for (const auto& value : values) leaves.push_back({value.first, BucketStats{value.second, value.second, value.second}});
+    // One pass up the tree for the whole batch.
+    it->second.update(leaves);
+}
+
+// Samples a travel-time function into an edge's buckets.
+void EdgeProfiles::sample(int from, int to, const Breakpoint* points, int count) {
+    // Travel time at the middle of every bucket.
+    std::vector<BucketStats> leaves(bucketCount);
+    for (int b = 0; b < bucketCount; ++b) {
+        double value = TravelTime::evaluate(points, count, (b + 0.5) * bucketMinutes());
+        leaves[b] = BucketStats{value, value, value};
+    }
+    // Replace the profile, built bottom-up.
+    profiles[key(from, to)] = SegmentTree<BucketStatsMonoid>(leaves);
+}
+
+// Travel-time function of an edge's buckets.
+std::vector<Breakpoint> EdgeProfiles::travelTimeFunction(int from, int to) const {
+    // No profile, no function.
+    const SegmentTree<BucketStatsMonoid>* profile = find(from, to);
+    if (!profile) return {};
+    // One breakpoint per bucket, at its midpoint.
+    double width = bucketMinutes();
+    std::vector<Breakpoint> points(bucketCount);
+    for (int b = 0; b < bucketCount; ++b) points[b] = {(b + 0.5) * width, profile->at(b).min};
+    // FIFO: leaving at bucket b can never beat waiting for b + 1, so pull each value down to the
+    // next one's plus the wait. Two rounds backwards around the day reach every bucket (the chain
+    // of improvements is shorter than the day).
+    for (int step = 2 * bucketCount - 2; step >= 0; --step) {
+        int b = step % bucketCount;
+        points[b].value = std::min(points[b].value, points[(b + 1) % bucketCount].value + width);
+    }
+    return points;
+}
+
+// Profile of an edge.
+const SegmentTree<BucketStatsMonoid>* EdgeProfiles::find(int from, int to) const {
+    // Null if the edge is not profiled.
+    auto it = profiles.find(key(from, to));
+    return it == profiles.end() ? nullptr : &it->second;
+}
+
+// Aggregate over a window of the day.
+int EdgeProfiles::query(int from, int to, double startMinute, double endMinute, BucketStats& stats, int& firstBucket, int& lastBucket) const {
+    // No profile.
+    const SegmentTree<BucketStatsMonoid>* profile = find(from, to);
+    if (!profile) return 0;
+    // Buckets overlapping the window: the one holding the start up to the one holding the last minute before the end.
+    double width = bucketMinutes();
+    firstBucket = std::min(bucketCount - 1, std::max(0, static_cast<int>(std::floor(startMinute / width))));
+    lastBucket = std::min(bucketCount - 1, static_cast<int>(std::ceil(endMinute / width)) - 1);
+    // Plain window.
+    if (endMinute > startMinute) {
+        // One range.
+        stats = profile->query(firstBucket, lastBucket);
+        return lastBucket - firstBucket + 1;
+    }
+    // A wrapped window that covers its start bucket twice is the whole day.
+    if (lastBucket >= firstBucket) {
+        // Every bucket.
+        firstBucket = 0;
+        lastBucket = bucketCount - 1;
+        stats = profile->total();
+        return bucketCount;
+    }
+    // Wrapped window: to midnight, then from midnight.
+    stats = BucketStatsMonoid::combine(profile->query(firstBucket, bucketCount - 1), profile->query(0, lastBucket));
+    return bucketCount - firstBucket + lastBucket + 1;
+}
+
+// Drops an edge's profile.
+void EdgeProfiles::remove(int from, int to) {
+    // No-op if it has none.
+    profiles.erase(key(from, to));
+}
+
+// Drops every profile and changes the bucket count.
+void EdgeProfiles::reset(int buckets) {
+    // Old profiles do not fit the new buckets.
+    profiles.clear();
+    bucketCount = buckets;
+}
+
+// Parses "HH:MM" or plain minutes within the day.
+bool EdgeProfiles::parseTime(const std::string& text, double& minutes) {
+    // Any valid time up to 24:00, which is a valid window end.
+    return TravelTime::parseTime(text, minutes) && minutes <= MINUTES_PER_DAY;
+}
@@ -0,0 +1,1727 @@
+#include "../include/engine.h"
+#include "../include/algorithms.h"
+#include "../include/graph_io.h"
+#include <chrono> // For timing preprocessing
+#include <cstdint> // For the binary matrix header
+#include <iomanip> // For std::fixed and std::setprecision
+#include <sstream> // For parsing command arguments
+
+// Helper function to split string by delimiter
+std::vector<std::string> split(const std::string& s, char delimiter) {
+   // Vector to store tokens.
+   std::vector<std::string> tokens;
+   // Current token being built.
+   std::string token;
+   // String stream from input string.
+   std::istringstream tokenStream(s);
+   // Read tokens separated by delimiter.
+   while (std::getline(tokenStream, token, delimiter)) {
+      // Add token to the vector.
+      tokens.push_back(token);
+   }
+   // Return vector of tokens.
+   return tokens;
+}
+
+// Key of an edge (external from/to) in the zone link index.
+static uint64_t edgeKey(int from, int to) {
+    // High half 'from', low half 'to'.
+    return (static_cast<uint64_t>(static_cast<uint32_t>(from)) << 32) | static_cast<uint32_t>(to);
+}
+
+// Weight of the first edge from -> to (external IDs).
+bool Engine::edgeWeight(int from, int to, double& weight) {
+    // Current frozen copy.
+    const CsrGraph& frozen = frozenGraph();
+    // Internal index of the tail.
+    int u = frozen.internalId(from);
+    if (u < 0) return false;
+    // Edges keep their insertion order, so the first match is the first edge.
+    for (int e = frozen.beginEdge(u); e < frozen.endEdge(u); ++e) if (frozen.externalId(frozen.edgeHead(e)) == to) { weight = frozen.edgeWeight(e); return true; }
+    // No such edge.
+    return false;
+}
+
+// Buckets of an edge that only has a travel-time function.
+void Engine::sampleEdgeProfile(int from, int to) {
+    // Buckets already set (or sampled) win.
+    if (edgeProfiles.find(from, to)) return;
+    // Current frozen copy.
+    const CsrGraph& frozen = frozenGraph();
+    // First edge from -> to; nothing to sample without one or without a function.
+    int u = frozen.internalId(from), v = frozen.internalId(to);
+    int e = u < 0 || v < 0 ? -1 : frozen.findEdge(u, v);
+    if (e < 0 || frozen.profile.empty() || frozen.profile[e] < 0) return;
+    // Breakpoints of its function.
+    int f = frozen.profile[e];
+    edgeProfiles.sample(from, to, frozen.breakpoints.data() + frozen.firstBreakpoint[f], frozen.firstBreakpoint[f + 1] - frozen.firstBreakpoint[f]);
+}
+
+// Returns the CSR copy of the graph, refreezing it after topology changes.
+const CsrGraph& Engine::frozenGraph() {
+    // Rebuild when there is no copy yet or nodes/edges were added since it was built (a mapped copy is current).
+    if (!graphDeferred && (!csr || csrTopologyVersion != graph.topologyVersion)) {
+        // Freeze the current graph.
+        csr = std::make_unique<CsrGraph>(graph);
+        // Remember which topology it reflects.
+        csrTopologyVersion = graph.topologyVersion;
+    }
+    // Return the up-to-date copy.
+    return *csr;
+}
+
+// Returns the adjacency-list graph, rebuilding it from a mapped snapshot first if needed.
+Graph& Engine::mutableGraph() {
+    // Only a mapped snapshot leaves the graph empty.
+    if (graphDeferred) {
+        // The mapped copy holds every node and edge, in insertion order and with the current weights.
+        const CsrGraph& frozen = *csr;
+        // Version the mapped copy (and everything derived from it) is tagged with.
+        unsigned long long version = graph.topologyVersion;
+        // Nodes with their coordinates.
+        for (int u = 0; u < frozen.numNodes(); ++u) graph.addNode(frozen.ids[u], frozen.xs[u], frozen.ys[u]);
+        // Travel-time functions first, so that they keep their indices.
+        for (int f = 0; f + 1 < static_cast<int>(frozen.firstBreakpoint.size()); ++f) {
+            // Breakpoints of function f.
+            graph.addTravelTimeFunction(std::vector<Breakpoint>(frozen.breakpoints.data() + frozen.firstBreakpoint[f], frozen.breakpoints.data() + frozen.firstBreakpoint[f + 1]));
+        }
+        // Edges in CSR order, which keeps each adjacency list in its original order.
+        for (int u = 0; u < frozen.numNodes(); ++u) {
+            // Outgoing edges of u.
+            for (int e = frozen.firstOut[u]; e < frozen.firstOut[u + 1]; ++e) {
+                // Edge with its function, if it has one.
+                graph.addEdge(frozen.ids[u], frozen.ids[frozen.head[e]], frozen.weight[e], frozen.profile.empty() ? -1 : frozen.profile[e]);
+            }
+        }
+        // Same topology as before, so the mapped copy, hierarchies and landmarks stay valid.
+        graph.topologyVersion = version;
+        // The graph is complete now.
+        graphDeferred = false;
+    }
+    // Return the graph.
+    return graph;
+}
+
+// Returns the zone structure, creating it from the graph's edges on first use.
+DynamicConnectivity* Engine::zones() {
+    // Loads skip the zones until they are used.
+    if (zonesDeferred) rebuildZones();
+    // Null if no graph is loaded.
+    return zoneConnectivity.get();
+}
+
+// Rebuilds the zones from the graph's edges alone.
+void Engine::rebuildZones() {
+    // Graph to split (the mapped copy of a snapshot is current as well).
+    const CsrGraph& frozen = frozenGraph();
+    // One link per edge, spanning forest found on all cores.
+    std::vector<int> handles;
+    zoneConnectivity = std::make_unique<DynamicConnectivity>(frozen, handles);
+    // Index the links by edge so that removals can cut them.
+    zoneEdgeLinks.clear();
+    zoneEdgeLinks.reserve(frozen.numEdges());
+    for (int u = 0; u < frozen.numNodes(); ++u) {
+        // Outgoing edges, in adjacency order.
+        for (int e = frozen.beginEdge(u); e < frozen.endEdge(u); ++e) zoneEdgeLinks[edgeKey(frozen.externalId(u), frozen.externalId(frozen.edgeHead(e)))].push_back(handles[e]);
+    }
+    // Created.
+    zonesDeferred = false;
+}
+
+// Whether a node exists, without rebuilding a mapped graph.
+bool Engine::hasNode(int id) {
+    // The mapped copy resolves IDs by binary search over its sorted ID array.
+    return graphDeferred ? csr->internalId(id) >= 0 : graph.nodeExists(id);
+}
+
+// Returns the contraction hierarchy of the current graph, contracting it if there is none.
+const ContractionHierarchy& Engine::hierarchy() {
+    // Recontract when there is no hierarchy or nodes/edges were added since it was built.
+    if (!ch || chTopologyVersion != graph.topologyVersion) {
+        // Contract the frozen graph on all cores.
+        ch = std::make_unique<ContractionHierarchy>(ContractionHierarchy::build(frozenGraph()));
+        // Remember which topology it reflects.
+        chTopologyVersion = graph.topologyVersion;
+    }
+    // Return the up-to-date hierarchy.
+    return *ch;
+}
+
+// Returns the spatial index of the current graph.
+const SpatialIndex& Engine::spatialIndex() {
+    // Rebuild when there is none, a change it did not follow happened, or its buffers grew too large.
+    if (!spatial || spatialTopologyVersion != graph.topologyVersion || spatial->needsRebuild()) {
+        // Pack the frozen graph's nodes and edges.
+        const CsrGraph& frozen = frozenGraph();
+        if (!spatial) spatial = std::make_unique<SpatialIndex>();
+        spatial->build(frozen);
+        // Remember which topology it reflects.
+        spatialTopologyVersion = graph.topologyVersion;
+    }
+    // Return the up-to-date index.
+    return *spatial;
+}
+
+// Returns the CCH of the current graph customized with the current weights.
+const CustomizableCH& Engine::customizedCch() {
+    // The CCH only depends on the topology; rebuild it when there is none or nodes/edges were added.
+    if (!cch || cchTopologyVersion != graph.topologyVersion) {
+        // Nested dissection order and chordal supergraph of the frozen graph.
+        cch = std::make_unique<CustomizableCH>(CustomizableCH::build(frozenGraph()));
+        // Apply the weights on all cores.
+        cch->customize(frozenGraph());
+        // Remember which topology it reflects.
+        cchTopologyVersion = graph.topologyVersion;
+        // Every pending change is included.
+        cchPending.clear();
+    } else if (!cchPending.empty()) {
+        // A few changes only touch the edges above them; many are cheaper as one parallel pass.
+        if (cchPending.size() * 64 < static_cast<size_t>(cch->numEdges())) cch->customizeEdges(frozenGraph(), cchPending);
+        // Full customization.
+        else cch->customize(frozenGraph());
+        // All changes applied.
+        cchPending.clear();
+    }
+    // Return the customized CCH.
+    return *cch;
+}
+
+// Returns the CRP overlay of the current graph customized with the current weights.
+const CrpOverlay& Engine::customizedCrp() {
+    // The partition only depends on the topology; rebuild it when there is none or nodes/edges were added.
+    if (!crp || crpTopologyVersion != graph.topologyVersion) {
+        // Partition and find the boundary nodes.
+        crp = std::make_unique<CrpOverlay>(CrpOverlay::build(frozenGraph(), crpCellSizes));
+        // Compute every clique.
+        crp->customize(frozenGraph());
+        // Remember which topology it reflects.
+        crpTopologyVersion = graph.topologyVersion;
+        // Nothing left to apply.
+        crpPending.clear();
+    } else if (!crpPending.empty()) {
+        // Only the cells containing a changed edge are recomputed.
+        crp->customizeEdges(frozenGraph(), crpPending);
+        // All applied.
+        crpPending.clear();
+    }
+    // Return the customized overlay.
+    return *crp;
+}
+
+// Returns up-to-date landmark tables, selecting landmarks if there are none.
+const Landmarks& Engine::landmarkTables() {
+    // Tables computed for an older topology or before a weight decrease are no longer valid bounds.
+    bool outdated = landmarks && (landmarksStale || landmarksTopologyVersion != graph.topologyVersion);
+    // Recompute the tables for the same landmarks; select new ones if there are none or one vanished.
+    if (!landmarks || (outdated && !landmarks->refresh(frozenGraph()))) {
+        // Select landmarks with the current settings.
+        landmarks = std::make_unique<Landmarks>(Landmarks::select(frozenGraph(), landmarkCount, landmarkSelection));
+    }
+    // The tables now match the graph.
+    landmarksTopologyVersion = graph.topologyVersion;
+    // No decrease since.
+    landmarksStale = false;
+    // Return the tables.
+    return *landmarks;
+}
+
+// Returns the maintained tree of a source, regrowing the trees after topology changes.
+const ShortestPathTree* Engine::maintainedTree(int id) {
+    // Not maintained.
+    auto it = maintainedTrees.find(id);
+    if (it == maintainedTrees.end()) return nullptr;
+    // New nodes or edges renumber the frozen graph; regrow every tree on it.
+    if (maintainedTopologyVersion != graph.topologyVersion) {
+        // Current frozen graph.
+        const CsrGraph& frozen = frozenGraph();
+        // Every maintained source still exists (nodes are never removed).
+        for (auto& entry : maintainedTrees) entry.second = std::make_unique<ShortestPathTree>(frozen, frozen.internalId(entry.first));
+        // They match the topology now.
+        maintainedTopologyVersion = graph.topologyVersion;
+    }
+    // Return the tree.
+    return it->second.get();
+}
+
+// Executes a single command against the resident graph.
+int Engine::execute(const std::vector<std::string>& args, std::ostream& out, std::ostream& err) {
+    // An empty command is a usage error.
+    if (args.empty()) {
+        // Print usage instructions.
+        printUsage(err);
+        // Return error code.
+        return 1;
+    }
+    // Counters before the command, for its trace (summed over all threads, since commands run one at a time).
+    Stats::Totals before;
+    if (traceCommands) before = Stats::totals();
+    // Run the command on the clock.
+    auto begin = std::chrono::steady_clock::now();
+    int status = executeCommand(args, out, err);
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count();
+    // Only successful commands get a histogram, so unknown command names never create one.
+    if (status == 0) commandLatency[args[0]].record(static_cast<uint64_t>(elapsed));
+    // Trace of the command, except for the commands that manage tracing and statistics.
+    if (traceCommands && args[0] != "trace" && args[0] != "stats") {
+        // Work done during the command.
+        Stats::Totals work = Stats::totals() - before;
+        // One line: name, time, counters.
+        out << "Trace: " << args[0] << " " << std::fixed << std::setprecision(3) << elapsed / 1000.0 << " us";
+        for (int c = 0; c < Stats::CounterCount; ++c) out << ", " << Stats::counterName(c) << " " << work.values[c];
+        out << std::endl;
+    }
+    // Return the command's status.
+    return status;
+}
+
+// Executes one command.
+int Engine::executeCommand(const std::vector<std::string>& args, std::ostream& out, std::ostream& err) {
+    // Command is the first argument (execute rejects empty commands).
+    const std::string& command = args[0];
+
+    // Command to load a graph from a JSON file or a binary snapshot.
+    if (command == "load_graph" && args.size() > 1) {
+        // The mutation counter keeps counting across reloads, so versions handed out for the old graph stay below every new one.
+        graphBaseVersion = graph.version;
+        // Start from an empty graph so that a resident engine can be reloaded.
+        graph = Graph();
+        graph.version = graphBaseVersion;
+        // Nothing is deferred for the new graph yet.
+        graphDeferred = false;
+        zonesDeferred = false;
+        // Drop the frozen copy of the previous graph.
+        csr.reset();
+        // Drop the hierarchy of the previous graph.
+        ch.reset();
+        // Drop the CCH of the previous graph.
+        cch.reset();
+        cchPending.clear();
+        // Drop the CRP overlay of the previous graph.
+        crp.reset();
+        crpPending.clear();
+        // Drop the landmarks of the previous graph.
+        landmarks.reset();
+        // Stop maintaining the sources of the previous graph.
+        maintainedTrees.clear();
+        // Drop the cached answers; only answers computed for the new graph are accepted from now on.
+        pathCache.clear(graphBaseVersion);
+        // Drop the travel-time profiles of the previous graph.
+        edgeProfiles.clear();
+        // Error message from the reader.
+        std::string error;
+        // Snapshots are mapped straight into the frozen copy; no parsing and no adjacency lists.
+        if (GraphIO::isSnapshot(args[1])) {
+            // Graph viewing the mapped file.
+            auto mapped = std::make_unique<CsrGraph>();
+            // Map and validate the file.
+            if (!GraphIO::loadSnapshot(args[1], *mapped, error)) {
+                // No zones for a failed load.
+                zoneConnectivity.reset();
+                // Print the error.
+                out << "Error: " << error << std::endl;
+                // Return error code.
+                return 1;
+            }
+            // Queries run on the mapped copy.
+            csr = std::move(mapped);
+            // It reflects the (empty) graph's version until the adjacency lists are rebuilt from it.
+            csrTopologyVersion = graph.topologyVersion;
+            graphDeferred = true;
+            // Zones are created on first use.
+            zoneConnectivity.reset();
+            zonesDeferred = true;
+            // Print success message.
+            out << "Graph loaded successfully from " << args[1] << std::endl;
+        }
+        // Load graph from specified file path.
+        else if (GraphIO::loadGraphFromJson(args[1], graph, error)) {
+            // Print success message.
+            out << "Graph loaded successfully from " << args[1] << std::endl;
+            // Zones are created from the edges on first use.
+            zoneConnectivity.reset();
+            zonesDeferred = true;
+        } else {
+            // Discard whatever was read before the error.
+            graph = Graph();
+            graph.version = graphBaseVersion;
+            // No zones without a graph.
+            zoneConnectivity.reset();
+            // Print error message with the reason and position.
+            out << "Error: Could not load graph from " << args[1] << ": " << error << std::endl;
+            // Return error code.
+            return 1;
+        }
+    }
+    // Command to add a node.
+    else if (command == "add_node" && args.size() >= 2) {
+        // Parse node ID.
+        int id = std::stoi(args[1]);
+        // Default x coordinate.
+        double x = 0.0, y = 0.0;
+        // If x coordinate is provided.
+        if (args.size() >= 3) x = std::stod(args[2]);
+        // If y coordinate is provided.
+        if (args.size() >= 4) y = std::stod(args[3]);
+        // Graph to change.
+        Graph& editable = mutableGraph();
+        // Whether the spatial index followed every change so far, and whether the node is new.
+        bool spatialCurrent = spatial && spatialTopologyVersion == editable.topologyVersion;
+        bool existed = editable.nodeExists(id);
+        // Add node to the graph.
+        editable.addNode(id, x, y);
+        // New nodes start as their own zone.
+        if (zoneConnectivity) zoneConnectivity->addNode(id);
+        // A new node joins the spatial index; a moved one leaves it stale until the next rebuild.
+        if (spatialCurrent && !existed) {
+            spatial->addNode(id, x, y);
+            spatialTopologyVersion = graph.topologyVersion;
+        }
+        // Print success message.
+        out << "Node " << id << " added." << std::endl;
+    }
+    // Command to add an edge.
+    else if (command == "add_edge" && args.size() == 4) {
+        // Parse 'from' node ID.
+        int from = std::stoi(args[1]);
+        // Parse 'to' node ID.
+        int to = std::stoi(args[2]);
+        // Parse edge weight.
+        double weight = std::stod(args[3]);
+        // Graph to change.
+        Graph& editable = mutableGraph();
+        // Whether the spatial index followed every change so far, and which ends are created with the edge.
+        bool spatialCurrent = spatial && spatialTopologyVersion == editable.topologyVersion;
+        bool fromExisted = editable.nodeExists(from), toExisted = editable.nodeExists(to);
+        // Add edge to the graph.
+        editable.addEdge(from, to, weight);
+        // Its segment (and any new end, at the origin) joins the spatial index.
+        if (spatialCurrent) {
+            if (!fromExisted) spatial->addNode(from, 0.0, 0.0);
+            if (!toExisted && to != from) spatial->addNode(to, 0.0, 0.0);
+            const Node* a = graph.getNode(from);
+            const Node* b = graph.getNode(to);
+            spatial->addEdge(from, a->x, a->y, to, b->x, b->y);
+            spatialTopologyVersion = graph.topologyVersion;
+        }
+        // A new edge can only shorten paths (or connect pairs), like a decrease from infinity.
+        pathCache.edgeAdded(from, to);
+        // It joins the zones of its ends.
+        if (zoneConnectivity) zoneEdgeLinks[edgeKey(from, to)].push_back(zoneConnectivity->link(from, to));
+        // Print success message.
+        out << "Edge from " << from << " to " << to << " with weight " << weight << " added." << std::endl;
+    }
+    // Command to remove (close) an edge.
+    else if (command == "remove_edge" && args.size() == 3) {
+        // Parse 'from' node ID.
+        int from = std::stoi(args[1]);
+        // Parse 'to' node ID.
+        int to = std::stoi(args[2]);
+        // Graph to change.
+        Graph& editable = mutableGraph();
+        // Whether the spatial index followed every change so far.
+        bool spatialCurrent = spatial && spatialTopologyVersion == editable.topologyVersion;
+        // Remove the first such edge from the adjacency lists (the frozen copy is rebuilt on the next query).
+        if (!editable.removeEdge(from, to)) {
+            // Print error if edge not found.
+            out << "Error: Edge from " << from << " to " << to << " not found for removal." << std::endl;
+            // Return error code.
+            return 1;
+        }
+        // Cached answers through the edge are wrong now, like after an increase to infinity.
+        pathCache.edgeIncreased(from, to);
+        // Its zone link goes too; the zone splits unless another path still connects the ends.
+        if (zoneConnectivity) {
+            // Links of the parallel edges; any one of them stands for the removed edge.
+            auto it = zoneEdgeLinks.find(edgeKey(from, to));
+            if (it != zoneEdgeLinks.end() && !it->second.empty()) {
+                zoneConnectivity->cut(it->second.back());
+                it->second.pop_back();
+            }
+        }
+        // The segment goes once no edge joins the ends in either direction.
+        if (spatialCurrent) {
+            bool joined = false;
+            for (const Edge& edge : graph.getEdges(from)) joined = joined || edge.to == to;
+            for (const Edge& edge : graph.getEdges(to)) joined = joined || edge.to == from;
+            if (!joined) spatial->removeEdge(from, to);
+            spatialTopologyVersion = graph.topologyVersion;
+        }
+        // The profile goes with the edge; a remaining parallel edge is sampled from its own function on demand.
+        edgeProfiles.remove(from, to);
+        // Print success message.
+        out << "Edge from " << from << " to " << to << " removed." << std::endl;
+    }
+    // Command to find the earliest arrival over the travel-time functions: shortest_path td_dijkstra <start> <end> <departure_time>.
+    else if (command == "shortest_path" && args.size() == 5 && args[1] == "td_dijkstra") {
+        // Parse start node ID.
+        int start = std::stoi(args[2]);
+        // Parse end node ID.
+        int end = std::stoi(args[3]);
+        // Departure in minutes ("HH:MM" or plain minutes; later days continue past 24:00).
+        double departure = 0.0;
+        if (!TravelTime::parseTime(args[4], departure)) {
+            // Print error for malformed times.
+            out << "Error: Malformed departure time " << args[4] << ". Use HH:MM or minutes." << std::endl;
+            // Return error code.
+            return 1;
+        }
+        // Answers depend on the departure, so they bypass the path cache.
+        double arrival = 0;
+        std::vector<int> path = Algorithms::timeDependentDijkstra(frozenGraph(), workspace, start, end, departure, arrival);
+        // If a path is found.
+        if (!path.empty()) {
+            // Print path found message.
+            out << "Path: ";
+            // Iterate through nodes in the path.
+            for (size_t i = 0; i < path.size(); ++i) {
+                // Print node ID.
+                out << path[i] << (i == path.size() - 1 ? "" : " -> ");
+            }
+            // Set output precision for times.
+            out << std::fixed << std::setprecision(2);
+            // Print the travel time and the arrival time.
+            out << "\nWeight: " << arrival - departure << "\nArrival: " << arrival << std::endl;
+        } else {
+            // Print message if no path found.
+            out << "No path found from " << start << " to " << end << "." << std::endl;
+        }
+    }
+    // Command to find the shortest path.
+    else if (command == "shortest_path" && (args.size() == 4 || args.size() == 5)) {
+        // Algorithm type (dijkstra, astar, alt, bidijkstra, biastar, ch, cch or crp).
+        const std::string& algo_type = args[1];
+        // Parsed algorithm.
+        PathAlgorithm algorithm;
+        // Reject unknown algorithms.
+        if (!parsePathAlgorithm(algo_type, algorithm)) {
+            // Print error for unknown algorithm.
+            out << "Error: Unknown algorithm " << algo_type << ". Use 'dijkstra', 'astar', 'alt', 'bidijkstra', 'biastar', 'ch', 'cch', 'crp' or 'td_dijkstra'." << std::endl;
+            // Return error code.
+            return 1;
+        }
+        // Parse start node ID.
+        int start = std::stoi(args[2]);
+        // Parse end node ID.
+        int end = std::stoi(args[3]);
+        // Priority queue policy (optional fifth argument).
+        QueueKind queue = QueueKind::Dary4;
+        // Reject unknown queue names.
+        if (args.size() == 5 && !parseQueueKind(args[4], queue)) {
+            // Print error for unknown queue.
+            out << "Error: Unknown queue " << args[4] << ". Use 'binary', 'dary4', 'radix' or 'bucket'." << std::endl;
+            // Return error code.
+            return 1;
+        }
+        // Vector to store the path.
+        std::vector<int> path;
+        // Variable to store path weight.
+        double pathWeight = 0;
+
+        // Cheapened or added edges may have improved cached answers; sort them out before looking one up.
+        if (pathCache.hasPending()) pathCache.resolvePending(frozenGraph(), workspace, reverseWorkspace);
+        // Compute the path unless it is cached.
+        if (!pathCache.lookup(algorithm, start, end, path, pathWeight)) {
+            // Run the requested algorithm.
+            switch (algorithm) {
+                // Dijkstra.
+                case PathAlgorithm::Dijkstra:
+                    // Compute shortest path using Dijkstra.
+                    path = Algorithms::dijkstra(frozenGraph(), workspace, start, end, pathWeight, queue);
+                    break;
+                // A*.
+                case PathAlgorithm::AStar:
+                    // Compute shortest path using A*.
+                    path = Algorithms::aStar(frozenGraph(), workspace, start, end, pathWeight, queue);
+                    break;
+                // Bidirectional Dijkstra.
+                case PathAlgorithm::BiDijkstra:
+                    // Compute shortest path by searching from both ends.
+                    path = Algorithms::bidirectionalDijkstra(frozenGraph(), workspace, reverseWorkspace, start, end, pathWeight, queue);
+                    break;
+                // Bidirectional A*.
+                case PathAlgorithm::BiAStar:
+                    // Compute shortest path by bidirectional A* with average potentials.
+                    path = Algorithms::bidirectionalAStar(frozenGraph(), workspace, reverseWorkspace, start, end, pathWeight, queue);
+                    break;
+                // Contraction hierarchy query (runs on its own heap, the queue option does not apply).
+                case PathAlgorithm::CH: {
+                    // Hierarchy first, since building it may refreeze the graph.
+                    const ContractionHierarchy& hierarchyRef = hierarchy();
+                    // Compute shortest path on the hierarchy and unpack its shortcuts.
+                    path = Algorithms::contractionHierarchyQuery(frozenGraph(), hierarchyRef, workspace, reverseWorkspace, start, end, pathWeight);
+                    break;
+                }
+                // Customizable contraction hierarchy query (no priority queue either).
+                case PathAlgorithm::CCH: {
+                    // Customize first, since building the CCH may refreeze the graph.
+                    const CustomizableCH& customized = customizedCch();
+                    // Walk the elimination tree and unpack the path.
+                    path = Algorithms::customizableCHQuery(frozenGraph(), customized, workspace, reverseWorkspace, start, end, pathWeight);
+                    break;
+                }
+                // Multilevel Dijkstra on the CRP overlay (on its own heap).
+                case PathAlgorithm::CRP: {
+                    // Customize first, since building the overlay may refreeze the graph.
+                    const CrpOverlay& overlay = customizedCrp();
+                    // Search the overlay and unpack its clique arcs.
+                    path = Algorithms::crpQuery(frozenGraph(), overlay, workspace, start, end, pathWeight);
+                    break;
+                }
+                // A* with landmark (ALT) potentials.
+                case PathAlgorithm::Alt: {
+                    // Tables first, since refreshing them may refreeze the graph.
+                    const Landmarks& tables = landmarkTables();
+                    // Compute shortest path guided by the landmark lower bounds.
+                    path = Algorithms::landmarkAStar(frozenGraph(), tables, workspace, start, end, pathWeight, queue);
+                    break;
+                }
+            }
+            // Remember the answer for repeated queries.
+            pathCache.insert(algorithm, start, end, path, pathWeight, graph.version);
+        }
+
+        // If a path is found.
+        if (!path.empty()) {
+            // Print path found message.
+            out << "Path: ";
+            // Iterate through nodes in the path.
+            for (size_t i = 0; i < path.size(); ++i) {
+                // Print node ID.
+                out << path[i] << (i == path.size() - 1 ? "" : " -> ");
+            }
+            // Set output precision for weight.
+            out << std::fixed << std::setprecision(2);
+            // Print path weight.
+            out << "\nWeight: " << pathWeight << std::endl;
+        } else {
+            // Print message if no path found.
+            out << "No path found from " << start << " to " << end << "." << std::endl;
+        }
+    }
+    // Command to answer many queries at once on all cores: shortest_path_batch <algorithm> <s:t[:algorithm],...> [paths|weights] [queue].
+    else if (command == "shortest_path_batch" && args.size() >= 3 && args.size() <= 5) {
+        // Algorithm of queries that do not name one.
+        PathAlgorithm defaultAlgorithm;
+        // Reject unknown algorithms.
+        if (!parsePathAlgorithm(args[1], defaultAlgorithm)) {
+            // Print error for unknown algorithm.
+            out << "Error: Unknown algorithm " << args[1] << ". Use 'dijkstra', 'astar', 'alt', 'bidijkstra', 'biastar', 'ch', 'cch' or 'crp'." << std::endl;
+            // Return error code.
+            return 1;
+        }
+        // Output detail.
+        std::string detail = args.size() > 3 ? args[3] : "paths";
+        // Reject unknown details.
+        if (detail != "paths" && detail != "weights") {
+            // Print error for unknown detail.
+            out << "Error: Unknown output " << detail << ". Use 'paths' or 'weights'." << std::endl;
+            // Return error code.
+            return 1;
+        }
+        // Priority queue policy for the queue-based algorithms.
+        QueueKind queue = QueueKind::Dary4;
+        // Reject unknown queue names.
+        if (args.size() == 5 && !parseQueueKind(args[4], queue)) {
+            // Print error for unknown queue.
+            out << "Error: Unknown queue " << args[4] << ". Use 'binary', 'dary4', 'radix' or 'bucket'." << std::endl;
+            // Return error code.
+            return 1;
+        }
+        // Parsed queries.
+        std::vector<PathQuery> queries;
+        // Every comma-separated source:target[:algorithm] tuple.
+        for (const std::string& token : split(args[2], ',')) {
+            // Skip empty tokens (e.g. a trailing comma).
+            if (token.empty()) continue;
+            // Fields of the tuple.
+            std::vector<std::string> fields = split(token, ':');
+            // Two or three fields.
+            if (fields.size() < 2 || fields.size() > 3) { out << "Error: Malformed query " << token << ". Use <source>:<target>[:<algorithm>]." << std::endl; return 1; }
+            // Endpoints and algorithm.
+            PathQuery query{std::stoi(fields[0]), std::stoi(fields[1]), defaultAlgorithm};
+            // Reject unknown per-query algorithms.
+            if (fields.size() == 3 && !parsePathAlgorithm(fields[2], query.algorithm)) { out << "Error: Unknown algorithm " << fields[2] << " in query " << token << "." << std::endl; return 1; }
+            // Keep it.
+            queries.push_back(query);
+        }
+        // Speedup structures the batch needs, prepared up front so workers only read them.
+        PathIndexes indexes;
+        // Prepare each one at most once (any of these may refreeze the graph, so they come before frozenGraph()).
+        for (const PathQuery& query : queries) {
+            // Landmark tables for ALT.
+            if (query.algorithm == PathAlgorithm::Alt && !indexes.landmarks) indexes.landmarks = &landmarkTables();
+            // Contraction hierarchy.
+            if (query.algorithm == PathAlgorithm::CH && !indexes.ch) indexes.ch = &hierarchy();
+            // Customized CCH.
+            if (query.algorithm == PathAlgorithm::CCH && !indexes.cch) indexes.cch = &customizedCch();
+            // Customized CRP overlay.
+            if (query.algorithm == PathAlgorithm::CRP && !indexes.crp) indexes.crp = &customizedCrp();
+        }
+        // Whether paths are written.
+        const bool withPaths = detail == "paths";
+        // Round-trip precision.
+        out << std::defaultfloat << std::setprecision(17);
+        // Open the document.
+        out << "{\"results\": [";
+        // Write each block as soon as it is done; one result per line, tagged with its query index.
+        Algorithms::shortestPathBatch(frozenGraph(), indexes, queries, withPaths, [&](size_t first, const std::vector<PathResult>& results) {
+            // Every result of the block.
+            for (size_t i = 0; i < results.size(); ++i) {
+                // Query it answers.
+                const PathQuery& query = queries[first + i];
+                // Separator and tag.
+                out << (first + i ? ",\n" : "\n") << "{\"id\": " << first + i << ", \"source\": " << query.source << ", \"target\": " << query.target
+                    << ", \"algorithm\": \"" << pathAlgorithmName(query.algorithm) << "\", \"weight\": ";
+                // Weight, or null if unreachable.
+                if (results[i].weight == INF) out << "null"; else out << results[i].weight;
+                // Path nodes.
+                if (withPaths) {
+                    // Open the list.
+                    out << ", \"path\": [";
+                    // Every node.
+                    for (size_t k = 0; k < results[i].path.size(); ++k) out << (k ? ", " : "") << results[i].path[k];
+                    // Close it.
+                    out << "]";
+                }
+                // Close the result.
+                out << "}";
+            }
+        }, queue);
+        // Close the document.
+        out << "\n]}" << std::endl;
+    }
+    // Command to rank alternative routes: k_shortest_paths <start_id> <end_id> <k>.
+    else if (command == "k_shortest_paths" && args.size() == 4) {
+        // Parse start node ID.
+        int start = std::stoi(args[1]);
+        // Parse end node ID.
+        int end = std::stoi(args[2]);
+        // Parse the number of paths.
+        int k = std::stoi(args[3]);
+        // At least one path must be asked for.
+        if (k < 1) {
+            // Print error for a bad count.
+            out << "Error: k must be at least 1." << std::endl;
+            // Return error code.
+            return 1;
+        }
+        // Ranked loopless paths, searched with the engine's forward and reverse workspaces.
+        std::vector<PathResult> paths = Algorithms::kShortestPaths(frozenGraph(), workspace, reverseWorkspace, start, end, k);
+        // Round-trip precision.
+        out << std::defaultfloat << std::setprecision(17);
+        // Open the document.
+        out << "{\"source\": " << start << ", \"target\": " << end << ", \"paths\": [";
+        // One path per line, shortest first.
+        for (size_t r = 0; r < paths.size(); ++r) {
+            // Separator, rank and weight.
+            out << (r ? ",\n" : "\n") << "{\"rank\": " << r + 1 << ", \"weight\": " << paths[r].weight << ", \"path\": [";
+            // Every node.
+            for (size_t i = 0; i < paths[r].path.size(); ++i) out << (i ? ", " : "") << paths[r].path[i];
+            // Close the path.
+            out << "]}";
+        }
+        // Close the document.
+        out << "\n]}" << std::endl;
+    }
+    // Command to update edge weight (simulates traffic update).
+    else if (command == "update_edge_weight" && args.size() == 4) {
+        // Parse 'from' node ID.
+        int from = std::stoi(args[1]);
+        // Parse 'to' node ID.
+        int to = std::stoi(args[2]);
+        // Parse new weight.
+        double new_weight = std::stod(args[3]);
+        // Weight before the update.
+        double old_weight = 0;
+        // Update edge weight in the graph, or only in the mapped copy while there are no adjacency lists.
+        if (graphDeferred ? csr->updateEdgeWeight(from, to, new_weight, &old_weight) : graph.updateEdgeWeight(from, to, new_weight, &old_weight)) {
+            // Patch the frozen copy in place; weight changes never require refreezing (mapped pages are copied on write).
+            if (csr && !graphDeferred) csr->updateEdgeWeight(from, to, new_weight);
+            // The hierarchy depends on every weight; it is recontracted on the next CH query.
+            ch.reset();
+            // The CCH keeps its topology; the edge is re-customized before the next CCH query.
+            if (cch && cchTopologyVersion == graph.topologyVersion) cchPending.push_back({csr->internalId(from), csr->internalId(to)});
+            // So does the overlay; only the cells containing the edge are recomputed.
+            if (crp && crpTopologyVersion == graph.topologyVersion) crpPending.push_back({csr->internalId(from), csr->internalId(to)});
+            // The edge lost its travel-time function, so its buckets go too.
+            edgeProfiles.remove(from, to);
+            // Landmark bounds survive increases; a decrease triggers a refresh before the next ALT query.
+            if (new_weight < old_weight) landmarksStale = true;
+            // Cached answers through the edge are wrong now; a decrease may also improve others.
+            if (new_weight > old_weight) pathCache.edgeIncreased(from, to);
+            else if (new_weight < old_weight) pathCache.edgeDecreased(from, to);
+            // Print success message.
+            out << "Weight of edge from " << from << " to " << to << " updated to " << new_weight << std::endl;
+            // Repair the maintained trees in place while they match the frozen copy; otherwise they are regrown on next use.
+            if (!maintainedTrees.empty() && csr && csrTopologyVersion == graph.topologyVersion && maintainedTopologyVersion == graph.topologyVersion) {
+                // Nodes relabelled over all trees.
+                size_t relabelled = 0;
+                // Each tree only visits the nodes whose distance changes.
+                for (auto& entry : maintainedTrees) relabelled += entry.second->edgeChanged(*csr, csr->internalId(from), csr->internalId(to));
+                // Report the repair.
+                out << "Repaired " << maintainedTrees.size() << " maintained shortest path tree(s), " << relabelled << " node(s) relabelled." << std::endl;
+            }
+        } else {
+            // Print error if edge not found.
+            out << "Error: Edge from " << from << " to " << to << " not found for update." << std::endl;
+        }
+    }
+    // Command to (re)build the contraction hierarchy now instead of on the first CH query.
+    else if (command == "build_ch" && args.size() == 1) {
+        // Force a fresh contraction.
+        ch.reset();
+        // Start the clock.
+        auto begin = std::chrono::steady_clock::now();
+        // Contract the graph.
+        const ContractionHierarchy& built = hierarchy();
+        // Elapsed time in milliseconds.
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+        // Print a summary.
+        out << "Contraction hierarchy built: " << built.numNodes() << " nodes, " << built.numShortcuts() << " shortcuts in "
+            << std::fixed << std::setprecision(1) << ms << " ms." << std::endl;
+    }
+    // Command to (re)build the customizable contraction hierarchy now instead of on the first CCH query.
+    else if (command == "build_cch" && args.size() == 1) {
+        // Force a fresh build.
+        cch.reset();
+        // Start the clock.
+        auto begin = std::chrono::steady_clock::now();
+        // Metric-independent preprocessing.
+        cch = std::make_unique<CustomizableCH>(CustomizableCH::build(frozenGraph()));
+        // Time of the preprocessing.
+        auto built = std::chrono::steady_clock::now();
+        // Apply the weights.
+        cch->customize(frozenGraph());
+        // Remember which topology it reflects.
+        cchTopologyVersion = graph.topologyVersion;
+        cchPending.clear();
+        // Elapsed times in milliseconds.
+        double buildMs = std::chrono::duration<double, std::milli>(built - begin).count();
+        double customizeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - built).count();
+        // Print a summary.
+        out << "CCH built: " << cch->numNodes() << " nodes, " << cch->numEdges() << " edges, " << cch->numTriangles() << " triangles in "
+            << std::fixed << std::setprecision(1) << buildMs << " ms, customized in " << customizeMs << " ms." << std::endl;
+    }
+    // Command to rerun the full customization of the CCH with the current weights.
+    else if (command == "customize_cch" && args.size() == 1) {
+        // Build first if needed, so only the customization is timed.
+        customizedCch();
+        // Start the clock.
+        auto begin = std::chrono::steady_clock::now();
+        // Customize on all cores.
+        cch->customize(frozenGraph());
+        // Elapsed time in milliseconds.
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+        // Print a summary.
+        out << "CCH customized: " << cch->numEdges() << " edges in " << std::fixed << std::setprecision(1) << ms << " ms." << std::endl;
+    }
+    // Command to (re)partition the graph and build the CRP overlay now, optionally with other cell sizes: build_crp [size,size,...].
+    else if (command == "build_crp" && (args.size() == 1 || args.size() == 2)) {
+        // New cell sizes, smallest first.
+        if (args.size() == 2) {
+            // Parse the list.
+            std::vector<int> sizes;
+            for (const std::string& token : split(args[1], ',')) if (!token.empty()) sizes.push_back(std::stoi(token));
+            // Levels must grow strictly.
+            bool valid = !sizes.empty() && sizes[0] > 0;
+            for (size_t i = 1; i < sizes.size(); ++i) valid = valid && sizes[i] > sizes[i - 1];
+            if (!valid) {
+                // Print error for an unusable list.
+                out << "Error: Cell sizes must be positive and strictly increasing." << std::endl;
+                // Return error code.
+                return 1;
+            }
+            // Keep them for later rebuilds too.
+            crpCellSizes = sizes;
+        }
+        // Start the clock.
+        auto begin = std::chrono::steady_clock::now();
+        // Partition and find the boundary nodes.
+        crp = std::make_unique<CrpOverlay>(CrpOverlay::build(frozenGraph(), crpCellSizes));
+        // Time of the preprocessing.
+        auto built = std::chrono::steady_clock::now();
+        // Apply the weights.
+        crp->customize(frozenGraph());
+        // Remember which topology it reflects.
+        crpTopologyVersion = graph.topologyVersion;
+        crpPending.clear();
+        // Elapsed times in milliseconds.
+        double buildMs = std::chrono::duration<double, std::milli>(built - begin).count();
+        double customizeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - built).count();
+        // Print a summary with the cells and boundary nodes of every level.
+        out << "CRP overlay built: " << crp->numNodes() << " nodes, " << crp->numLevels() << " level(s)";
+        for (int l = 0; l < crp->numLevels(); ++l) {
+            out << (l ? ", " : " (") << crp->levels[l].numCells() << " cells of up to " << crp->cellSizes[l] << " nodes with "
+                << crp->levels[l].boundary.size() << " boundary nodes" << (l + 1 == crp->numLevels() ? ")" : "");
+        }
+        out << ", " << crp->numEntries() << " clique entries in " << std::fixed << std::setprecision(1) << buildMs << " ms, customized in " << customizeMs << " ms." << std::endl;
+    }
+    // Command to rerun the full customization of the CRP overlay with the current weights.
+    else if (command == "customize_crp" && args.size() == 1) {
+        // Build first if needed, so only the customization is timed.
+        customizedCrp();
+        // Start the clock.
+        auto begin = std::chrono::steady_clock::now();
+        // Customize on all cores.
+        crp->customize(frozenGraph());
+        // Elapsed time in milliseconds.
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+        // Print a summary.
+        out << "CRP overlay customized: " << crp->numEntries() << " clique entries in " << std::fixed << std::setprecision(1) << ms << " ms." << std::endl;
+    }
+    // Command to save the contraction hierarchy (building it if needed).
+    else if (command == "save_ch" && args.size() == 2) {
+        // Error message from the writer.
+        std::string error;
+        // Write the hierarchy.
+        if (!hierarchy().save(args[1], error)) {
+            // Print the error.
+            out << "Error: " << error << std::endl;
+            // Return error code.
+            return 1;
+        }
+        // Print success message.
+        out << "Contraction hierarchy saved to " << args[1] << std::endl;
+    }
+    // Command to load a contraction hierarchy saved for the current graph.
+    else if (command == "load_ch" && args.size() == 2) {
+        // Hierarchy read from the file.
+        auto loaded = std::make_unique<ContractionHierarchy>();
+        // Error message from the reader.
+        std::string error;
+        // Read the file.
+        if (!loaded->load(args[1], error)) {
+            // Print the error.
+            out << "Error: " << error << std::endl;
+            // Return error code.
+            return 1;
+        }
+        // A hierarchy of another graph (or other weights) would return wrong paths.
+        if (loaded->fingerprint != ContractionHierarchy::fingerprintOf(frozenGraph())) {
+            // Print the error.
+            out << "Error: Contraction hierarchy in " << args[1] << " does not match the loaded graph." << std::endl;
+            // Return error code.
+            return 1;
+        }
+        // Adopt it.
+        ch = std::move(loaded);
+        // It reflects the current topology.
+        chTopologyVersion = graph.topologyVersion;
+        // Print success message.
+        out << "Contraction hierarchy loaded from " << args[1] << std::endl;
+    }
+    // Command to select landmarks for ALT queries: build_landmarks [count] [farthest|avoid].
+    else if (command == "build_landmarks" && args.size() <= 3) {
+        // Number of landmarks.
+        int count = args.size() >= 2 ? std::stoi(args[1]) : landmarkCount;
+        // Selection strategy.
+        LandmarkSelection selection = landmarkSelection;
+        // Reject unknown strategies.
+        if (args.size() == 3 && !parseLandmarkSelection(args[2], selection)) {
+            // Print error for unknown strategy.
+            out << "Error: Unknown landmark selection " << args[2] << ". Use 'farthest' or 'avoid'." << std::endl;
+            // Return error code.
+            return 1;
+        }
+        // At least one landmark.
+        if (count < 1) {
+            // Print error for invalid count.
+            out << "Error: Landmark count must be positive." << std::endl;
+            // Return error code.
+            return 1;
+        }
+        // Keep the settings for implicit reselection.
+        landmarkCount = count;
+        landmarkSelection = selection;
+        // Start the clock.
+        auto begin = std::chrono::steady_clock::now();
+        // Select from scratch.
+        landmarks.reset();
+        // Select and compute the tables.
+        const Landmarks& tables = landmarkTables();
+        // Elapsed time in milliseconds.
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+        // Print a summary.
+        out << "Selected " << tables.count() << " landmarks in " << std::fixed << std::setprecision(1) << ms << " ms:";
+        // List them.
+        for (int id : tables.ids) out << " " << id;
+        // End the line.
+        out << std::endl;
+    }
+    // Command to get all-pairs shortest paths using Floyd-Warshall.
+    else if (command == "get_all_pairs_shortest_paths" && args.size() <= 2) {
+        // Matrix precision (double unless "float" is requested).
+        std::string precision = args.size() == 2 ? args[1] : "double";
+        // Reject unknown precisions.
+        if (precision != "double" && precision != "float") {
+            // Print error for unknown precision.
+            out << "Error: Unknown precision " << precision << ". Use 'double' or 'float'." << std::endl;
+            // Return error code.
+            return 1;
+        }
+        // Prints every cell of a matrix in either precision.
+        auto printMatrix = [&out](const auto& matrix) {
+            // Print distances header.
+            out << "All-pairs shortest paths (Floyd-Warshall):\n";
+            // Set output precision.
+            out << std::fixed << std::setprecision(2);
+            // Iterate through source nodes (ascending IDs).
+            for (int u = 0; u < matrix.size(); ++u) {
+                // Iterate through destination nodes.
+                for (int v = 0; v < matrix.size(); ++v) {
+                    // Print path information.
+                    out << "From " << matrix.ids[u] << " to " << matrix.ids[v] << ": ";
+                    // If distance is infinity.
+                    if (matrix.distance(u, v) == INF) {
+                        // Print infinity symbol.
+                        out << "INF\n";
+                    } else {
+                        // Print distance.
+                        out << static_cast<double>(matrix.distance(u, v)) << "\n";
+                    }
+                }
+            }
+        };
+        // Compute all-pairs shortest paths on the dense matrix and print them.
+        if (precision == "float") printMatrix(Algorithms::floydWarshallMatrix<float>(frozenGraph()));
+        else printMatrix(Algorithms::floydWarshallMatrix<double>(frozenGraph()));
+    }
+    // Command to compute a distance table between comma-separated source and target ID lists.
+    else if (command == "distance_matrix" && args.size() >= 3 && args.size() <= 5) {
+        // Parses a comma-separated ID list.
+        auto parseIds = [](const std::string& list) {
+            // Parsed IDs.
+            std::vector<int> ids;
+            // Every non-empty token.
+            for (const std::string& token : split(list, ',')) if (!token.empty()) ids.push_back(std::stoi(token));
+            // Return them.
+            return ids;
+        };
+        // Source and target IDs.
+        std::vector<int> sources = parseIds(args[1]), targets = parseIds(args[2]);
+        // Search method (auto uses an up-to-date hierarchy if one exists, else one-to-many Dijkstra).
+        std::string method = args.size() > 3 ? args[3] : "auto";
+        // Output format.
+        std::string format = args.size() > 4 ? args[4] : "json";
+        // Reject unknown methods.
+        if (method != "auto" && method != "dijkstra" && method != "ch" && method != "cch") {
+            // Print error for unknown method.
+            out << "Error: Unknown method " << method << ". Use 'auto', 'dijkstra', 'ch' or 'cch'." << std::endl;
+            // Return error code.
+            return 1;
+        }
+        // Reject unknown formats.
+        if (format != "json" && format != "binary") {
+            // Print error for unknown format.
+            out << "Error: Unknown format " << format << ". Use 'json' or 'binary'." << std::endl;
+            // Return error code.
+            return 1;
+        }
+        // Every ID has to exist.
+        for (const std::vector<int>* list : {&sources, &targets}) {
+            // Check each one.
+            for (int id : *list) {
+                // Report the first unknown node.
+                if (!hasNode(id)) { out << "Error: Node " << id << " not found." << std::endl; return 1; }
+            }
+        }
+        // Resolve auto to whichever hierarchy is current; neither is built just for this.
+        if (method == "auto") method = ch && chTopologyVersion == graph.topologyVersion ? "ch"
+                                     : cch && cchTopologyVersion == graph.topologyVersion ? "cch" : "dijkstra";
+        // Row-major distances.
+        std::vector<double> table;
+        // Bucket-based many-to-many on the contraction hierarchy.
+        if (method == "ch") {
+            // Hierarchy first, since building it may refreeze the graph.
+            const ContractionHierarchy& hierarchyRef = hierarchy();
+            // Compute the table.
+            table = Algorithms::distanceTable(frozenGraph(), hierarchyRef, sources, targets);
+        // Bucket-based many-to-many on the customizable hierarchy.
+        } else if (method == "cch") {
+            // Customize first, since building the CCH may refreeze the graph.
+            const CustomizableCH& customized = customizedCch();
+            // Compute the table.
+            table = Algorithms::distanceTable(frozenGraph(), customized, sources, targets);
+        // One-to-many Dijkstra per source.
+        } else {
+            // Compute the table.
+            table = Algorithms::distanceTable(frozenGraph(), sources, targets);
+        }
+        // Binary: "DRDM", uint32 rows, uint32 columns, then row-major native-endian doubles (INF if unreachable).
+        if (format == "binary") {
+            // Dimensions.
+            uint32_t dimensions[2] = {static_cast<uint32_t>(sources.size()), static_cast<uint32_t>(targets.size())};
+            // Magic.
+            out.write("DRDM", 4);
+            // Header.
+            out.write(reinterpret_cast<const char*>(dimensions), sizeof(dimensions));
+            // Payload.
+            out.write(reinterpret_cast<const char*>(table.data()), static_cast<std::streamsize>(table.size() * sizeof(double)));
+        } else {
+            // Round-trip precision.
+            out << std::defaultfloat << std::setprecision(17);
+            // Header fields.
+            out << "{\"method\": \"" << method << "\", \"sources\": [";
+            // Source IDs.
+            for (size_t i = 0; i < sources.size(); ++i) out << (i ? ", " : "") << sources[i];
+            // Target IDs.
+            out << "], \"targets\": [";
+            for (size_t i = 0; i < targets.size(); ++i) out << (i ? ", " : "") << targets[i];
+            // Rows of the matrix; unreachable targets are null.
+            out << "], \"distances\": [";
+            // Row by row.
+            for (size_t row = 0; row < sources.size(); ++row) {
+                // Open the row.
+                out << (row ? ", [" : "[");
+                // Cell by cell.
+                for (size_t column = 0; column < targets.size(); ++column) {
+                    // Distance of the cell.
+                    double d = table[row * targets.size() + column];
+                    // Separator.
+                    if (column) out << ", ";
+                    // Value or null.
+                    if (d == INF) out << "null"; else out << d;
+                }
+                // Close the row.
+                out << "]";
+            }
+            // Close the document.
+            out << "]}" << std::endl;
+        }
+    }
+    // Command to find the set (representative) of a node in Union-Find.
+    else if (command == "find_set" && args.size() == 2) {
+        // Zones only exist for a loaded graph.
+        if (!zones()) { out << "Error: Graph not loaded, zones not initialized." << std::endl; return 1; }
+        // Parse node ID.
+        int node_id = std::stoi(args[1]);
+        // If node does not exist in graph (and thus UF).
+        if (!hasNode(node_id)) {
+            // Print error.
+            out << "Error: Node " << node_id << " not found in graph." << std::endl;
+            // Return error code.
+            return 1;
+        }
+        // Print the representative of the set.
+        out << "Set for node " << node_id << ": " << zoneConnectivity->representative(node_id) << std::endl;
+    }
+    // Command to unite the sets of two nodes in Union-Find.
+    else if (command == "unite_sets" && args.size() == 3) {
+        // Zones only exist for a loaded graph.
+        if (!zones()) { out << "Error: Graph not loaded, zones not initialized." << std::endl; return 1; }
+        // Parse first node ID.
+        int node_id1 = std::stoi(args[1]);
+        // Parse second node ID.
+        int node_id2 = std::stoi(args[2]);
+        // If either node does not exist in graph.
+        if (!hasNode(node_id1) || !hasNode(node_id2)) {
+            // Print error.
+            out << "Error: One or both nodes not found in graph for unite operation." << std::endl;
+            // Return error code.
+            return 1;
+        }
+        // Link the zones (the link outlives edge removals).
+        zoneConnectivity->link(node_id1, node_id2);
+        // Print success message.
+        out << "United sets containing node " << node_id1 << " and " << node_id2 << "." << std::endl;
+        // Print new representatives for verification.
+        out << "New set for node " << node_id1 << ": " << zoneConnectivity->representative(node_id1) << std::endl;
+        // Print new representative for node2.
+        out << "New set for node " << node_id2 << ": " << zoneConnectivity->representative(node_id2) << std::endl;
+    }
+    // Command to unite many pairs of zones at once: unite_batch <a:b,a:b,...>.
+    else if (command == "unite_batch" && args.size() == 2) {
+        // Zones only exist for a loaded graph.
+        if (!zones()) { out << "Error: Graph not loaded, zones not initialized." << std::endl; return 1; }
+        // Parsed pairs.
+        std::vector<std::pair<int, int>> pairs;
+        // Every comma-separated a:b pair.
+        for (const std::string& token : split(args[1], ',')) {
+            // Skip empty tokens (e.g. a trailing comma).
+            if (token.empty()) continue;
+            // Both IDs.
+            std::vector<std::string> fields = split(token, ':');
+            // Exactly two fields.
+            if (fields.size() != 2) { out << "Error: Malformed pair " << token << ". Use <node_id>:<node_id>." << std::endl; return 1; }
+            // Parse them.
+            std::pair<int, int> pair(std::stoi(fields[0]), std::stoi(fields[1]));
+            // Both nodes must exist.
+            if (!hasNode(pair.first) || !hasNode(pair.second)) { out << "Error: One or both nodes of pair " << token << " not found in graph." << std::endl; return 1; }
+            // Keep it.
+            pairs.push_back(pair);
+        }
+        // Link them, deciding the spanning forest links of large batches in parallel.
+        zoneConnectivity->linkBatch(pairs);
+        // Print success message.
+        out << "United " << pairs.size() << " pairs; " << zoneConnectivity->count() << " zones." << std::endl;
+    }
+    // Command to check whether two nodes share a zone.
+    else if (command == "connected" && args.size() == 3) {
+        // Zones only exist for a loaded graph.
+        if (!zones()) { out << "Error: Graph not loaded, zones not initialized." << std::endl; return 1; }
+        // Parse both node IDs.
+        int node_id1 = std::stoi(args[1]);
+        int node_id2 = std::stoi(args[2]);
+        // Both nodes must exist.
+        if (!hasNode(node_id1) || !hasNode(node_id2)) {
+            // Print error.
+            out << "Error: One or both nodes not found in graph." << std::endl;
+            // Return error code.
+            return 1;
+        }
+        // Print the answer.
+        out << "Nodes " << node_id1 << " and " << node_id2 << (zoneConnectivity->connected(node_id1, node_id2) ? " are" : " are not") << " connected." << std::endl;
+    }
+    // Command to recompute the zones as the graph's connected components: components_of_graph [labels|summary].
+    else if (command == "components_of_graph" && args.size() <= 2) {
+        // Output detail.
+        std::string detail = args.size() > 1 ? args[1] : "labels";
+        // Reject unknown details.
+        if (detail != "labels" && detail != "summary") {
+            // Print error for unknown detail.
+            out << "Error: Unknown output " << detail << ". Use 'labels' or 'summary'." << std::endl;
+            // Return error code.
+            return 1;
+        }
+        // Zones only exist for a loaded graph.
+        if (!zones()) { out << "Error: Graph not loaded, zones not initialized." << std::endl; return 1; }
+        // Graph to split.
+        const CsrGraph& frozen = frozenGraph();
+        // Start the clock.
+        auto begin = std::chrono::steady_clock::now();
+        // The components become the zones (manual unions are discarded).
+        rebuildZones();
+        // Elapsed time in milliseconds.
+        double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+        // Summary.
+        out << std::defaultfloat << std::setprecision(6) << "{\"components\": " << zoneConnectivity->count() << ", \"milliseconds\": " << elapsed;
+        // Zone of every node, as parallel arrays (the zone is the smallest node ID of the component).
+        if (detail == "labels") {
+            // Node IDs.
+            out << ", \"nodes\": [";
+            for (int u = 0; u < frozen.numNodes(); ++u) out << (u ? ", " : "") << frozen.externalId(u);
+            // Their zones.
+            out << "], \"zones\": [";
+            for (int u = 0; u < frozen.numNodes(); ++u) out << (u ? ", " : "") << zoneConnectivity->representative(frozen.externalId(u));
+            out << "]";
+        }
+        // Close the document.
+        out << "}" << std::endl;
+    }
+    // Command to dump the current graph to JSON (stdout).
+    else if (command == "dump_graph_json" && args.size() % 2 == 1) {
+        // Everything unless options narrow it down.
+        GraphIO::JsonExportOptions options;
+        // Options come as keyword/value groups.
+        for (size_t i = 1; i < args.size(); i += 2) {
+            // Viewport: bbox <min_x>,<min_y>,<max_x>,<max_y>.
+            if (args[i] == "bbox") {
+                // Corner coordinates.
+                std::vector<std::string> corners = split(args[i + 1], ',');
+                // Exactly four numbers.
+                if (corners.size() != 4) { out << "Error: bbox takes <min_x>,<min_y>,<max_x>,<max_y>." << std::endl; return 1; }
+                // Clip to the box.
+                options.clip = true;
+                options.minX = std::stod(corners[0]);
+                options.minY = std::stod(corners[1]);
+                options.maxX = std::stod(corners[2]);
+                options.maxY = std::stod(corners[3]);
+            // Delta: since <version> from a previous dump.
+            } else if (args[i] == "since") {
+                // Version the caller already has.
+                options.since = std::stoull(args[i + 1]);
+            } else {
+                // Print error for unknown option.
+                out << "Error: Unknown option " << args[i] << ". Use 'bbox' or 'since'." << std::endl;
+                // Return error code.
+                return 1;
+            }
+        }
+        // A version from before the current graph was loaded or the last edge removal (or from the future) cannot be patched up; send everything.
+        if (options.since <= graphBaseVersion || options.since < graph.removalVersion || options.since > graph.version) options.since = 0;
+        // Stream the graph.
+        GraphIO::writeGraphJson(mutableGraph(), out, options);
+    }
+    // Command to write the frozen graph as a binary snapshot for fast reloads.
+    else if (command == "save_snapshot" && args.size() == 2) {
+        // Error message from the writer.
+        std::string error;
+        // Graph to write.
+        const CsrGraph& frozen = frozenGraph();
+        // Write the file.
+        if (!GraphIO::saveSnapshot(frozen, args[1], error)) {
+            // Print the error.
+            out << "Error: " << error << std::endl;
+            // Return error code.
+            return 1;
+        }
+        // Print success message.
+        out << "Graph snapshot saved to " << args[1] << " (" << frozen.numNodes() << " nodes, " << frozen.numEdges() << " edges)." << std::endl;
+    }
+    // Command to keep a source's shortest path tree resident and repair it on every weight update.
+    else if (command == "maintain_source" && args.size() == 2) {
+        // Source node ID.
+        int source = std::stoi(args[1]);
+        // The source must exist.
+        if (!hasNode(source)) {
+            // Print error for unknown node.
+            out << "Error: Node " << source << " not found." << std::endl;
+            // Return error code.
+            return 1;
+        }
+        // Bring the existing trees up to date first, so that all of them refer to the same frozen graph.
+        if (!maintainedTrees.empty()) maintainedTree(maintainedTrees.begin()->first);
+        // The first tree sets the topology.
+        else maintainedTopologyVersion = graph.topologyVersion;
+        // Grow the tree (again, if the source was already maintained).
+        const CsrGraph& frozen = frozenGraph();
+        auto& tree = maintainedTrees[source];
+        tree = std::make_unique<ShortestPathTree>(frozen, frozen.internalId(source));
+        // Print success message.
+        out << "Maintaining shortest path tree from " << source << " (" << tree->reachedCount() << " nodes reachable)." << std::endl;
+    }
+    // Command to stop maintaining a source.
+    else if (command == "drop_source" && args.size() == 2) {
+        // Source node ID.
+        int source = std::stoi(args[1]);
+        // Forget its tree.
+        if (!maintainedTrees.erase(source)) {
+            // Print error if it was not maintained.
+            out << "Error: Source " << source << " is not maintained." << std::endl;
+            // Return error code.
+            return 1;
+        }
+        // Print success message.
+        out << "Stopped maintaining shortest path tree from " << source << "." << std::endl;
+    }
+    // Command to read a maintained tree: source_tree <source> [target].
+    else if (command == "source_tree" && (args.size() == 2 || args.size() == 3)) {
+        // Source node ID.
+        int source = std::stoi(args[1]);
+        // Its tree, up to date.
+        const ShortestPathTree* tree = maintainedTree(source);
+        // Not maintained.
+        if (!tree) {
+            // Print error if it was not maintained.
+            out << "Error: Source " << source << " is not maintained. Use 'maintain_source " << source << "' first." << std::endl;
+            // Return error code.
+            return 1;
+        }
+        // Graph the tree's indices refer to.
+        const CsrGraph& frozen = frozenGraph();
+        // Round-trip precision.
+        out << std::defaultfloat << std::setprecision(17);
+        // One target: its distance and tree path.
+        if (args.size() == 3) {
+            // Target node ID and index.
+            int target = std::stoi(args[2]);
+            int t = frozen.internalId(target);
+            // Distance, or INF for unknown and unreachable targets.
+            double distance = t < 0 ? INF : tree->distance(t);
+            // Weight, or null if unreachable.
+            out << "{\"source\": " << source << ", \"target\": " << target << ", \"weight\": ";
+            if (distance == INF) out << "null"; else out << distance;
+            // Path nodes.
+            out << ", \"path\": [";
+            if (distance != INF) {
+                // Walk the tree.
+                std::vector<int> path = tree->pathTo(frozen, t);
+                for (size_t i = 0; i < path.size(); ++i) out << (i ? ", " : "") << path[i];
+            }
+            // Close the document.
+            out << "]}" << std::endl;
+        } else {
+            // Every reachable node with its distance and parent.
+            out << "{\"source\": " << source << ", \"reached\": " << tree->reachedCount() << ", \"nodes\": [";
+            // Nodes written so far.
+            int written = 0;
+            for (int u = 0; u < frozen.numNodes(); ++u) {
+                // Unreachable.
+                if (tree->distance(u) == INF) continue;
+                // Node, distance and parent (null for the source).
+                out << (written++ ? ",\n" : "\n") << "{\"id\": " << frozen.externalId(u) << ", \"distance\": " << tree->distance(u) << ", \"parent\": ";
+                if (tree->parent(u) < 0) out << "null"; else out << frozen.externalId(tree->parent(u));
+                out << "}";
+            }
+            // Close the document.
+            out << "\n]}" << std::endl;
+        }
+    }
+    // Command to inspect or manage the shortest_path cache: path_cache [stats|clear|capacity <n>].
+    else if (command == "path_cache" && args.size() <= 3) {
+        // Subcommand.
+        std::string action = args.size() > 1 ? args[1] : "stats";
+        // Drop every entry.
+        if (action == "clear" && args.size() == 2) pathCache.clear();
+        // Resize (which also drops every entry); 0 turns caching off.
+        else if (action == "capacity" && args.size() == 3) {
+            // Requested capacity.
+            long long capacity = std::stoll(args[2]);
+            // Reject negative sizes.
+            if (capacity < 0) {
+                // Print error for a negative capacity.
+                out << "Error: Cache capacity must not be negative." << std::endl;
+                // Return error code.
+                return 1;
+            }
+            // Apply it.
+            pathCache.setCapacity(static_cast<size_t>(capacity));
+        }
+        // Anything but stats is unknown.
+        else if (action != "stats" || args.size() > 2) {
+            // Print error for unknown subcommand.
+            out << "Error: Unknown path_cache action. Use 'stats', 'clear' or 'capacity <n>'." << std::endl;
+            // Return error code.
+            return 1;
+        }
+        // Counters.
+        const PathCache::Stats& stats = pathCache.stats();
+        // Lookups so far.
+        uint64_t lookups = stats.hits + stats.misses;
+        // Print them as one JSON object.
+        out << "{\"capacity\": " << pathCache.capacity() << ", \"size\": " << pathCache.size() << ", \"hits\": " << stats.hits
+            << ", \"misses\": " << stats.misses << ", \"hit_rate\": " << std::defaultfloat << std::setprecision(6)
+            << (lookups ? static_cast<double>(stats.hits) / static_cast<double>(lookups) : 0.0) << ", \"insertions\": " << stats.insertions
+            << ", \"evictions\": " << stats.evictions << ", \"invalidations\": " << stats.invalidations << ", \"flushes\": " << stats.flushes << "}" << std::endl;
+    }
+    // Command to snap a point to the closest node: nearest_node <x> <y>.
+    else if (command == "nearest_node" && args.size() == 3) {
+        // Parse the point.
+        double x = std::stod(args[1]);
+        double y = std::stod(args[2]);
+        // Closest node.
+        std::vector<SpatialIndex::NodeMatch> matches = spatialIndex().nearestNodes(x, y, 1);
+        if (matches.empty()) {
+            // Print error for a graph without nodes.
+            out << "Error: The graph has no nodes." << std::endl;
+            // Return error code.
+            return 1;
+        }
+        // Print it as one JSON object.
+        const SpatialIndex::NodeMatch& match = matches.front();
+        out << std::defaultfloat << std::setprecision(17) << "{\"id\": " << match.id << ", \"x\": " << match.x << ", \"y\": " << match.y
+            << ", \"distance\": " << match.distance << "}" << std::endl;
+    }
+    // Command to list the closest nodes or edges: k_nearest <x> <y> <k> [nodes|edges].
+    else if (command == "k_nearest" && (args.size() == 4 || (args.size() == 5 && (args[4] == "nodes" || args[4] == "edges")))) {
+        // Parse the point and the count.
+        double x = std::stod(args[1]);
+        double y = std::stod(args[2]);
+        int k = std::stoi(args[3]);
+        if (k < 1) {
+            // Print error for an empty request.
+            out << "Error: k must be at least 1." << std::endl;
+            // Return error code.
+            return 1;
+        }
+        // Print the matches as a JSON array, closest first.
+        out << std::defaultfloat << std::setprecision(17) << "[";
+        if (args.size() == 5 && args[4] == "edges") {
+            // Closest points on the edges' segments.
+            std::vector<SpatialIndex::EdgeMatch> matches = spatialIndex().nearestEdges(x, y, static_cast<size_t>(k));
+            for (size_t i = 0; i < matches.size(); ++i) {
+                const SpatialIndex::EdgeMatch& match = matches[i];
+                out << (i ? ", " : "") << "{\"from\": " << match.from << ", \"to\": " << match.to << ", \"x\": " << match.x << ", \"y\": " << match.y
+                    << ", \"fraction\": " << match.fraction << ", \"distance\": " << match.distance << "}";
+            }
+        } else {
+            // Closest nodes.
+            std::vector<SpatialIndex::NodeMatch> matches = spatialIndex().nearestNodes(x, y, static_cast<size_t>(k));
+            for (size_t i = 0; i < matches.size(); ++i) {
+                const SpatialIndex::NodeMatch& match = matches[i];
+                out << (i ? ", " : "") << "{\"id\": " << match.id << ", \"x\": " << match.x << ", \"y\": " << match.y << ", \"distance\": " << match.distance << "}";
+            }
+        }
+        out << "]" << std::endl;
+    }
+    // Command to route between two points snapped onto their closest edges: route_coords <x1> <y1> <x2> <y2>.
+    else if (command == "route_coords" && args.size() == 5) {
+        // Parse both points.
+        double x1 = std::stod(args[1]), y1 = std::stod(args[2]);
+        double x2 = std::stod(args[3]), y2 = std::stod(args[4]);
+        // Snap both onto the closest segment.
+        const SpatialIndex& index = spatialIndex();
+        std::vector<SpatialIndex::EdgeMatch> from = index.nearestEdges(x1, y1, 1);
+        std::vector<SpatialIndex::EdgeMatch> to = index.nearestEdges(x2, y2, 1);
+        if (from.empty() || to.empty()) {
+            // Print error for a graph without edges.
+            out << "Error: The graph has no edges to snap to." << std::endl;
+            // Return error code.
+            return 1;
+        }
+        // Segments' ends, the edges along them and their weights (INF where an edge is missing).
+        const SpatialIndex::EdgeMatch& source = from.front();
+        const SpatialIndex::EdgeMatch& target = to.front();
+        const CsrGraph& frozen = frozenGraph();
+        auto weightOf = [&](int a, int b) {
+            int e = frozen.findEdge(frozen.internalId(a), frozen.internalId(b));
+            return e < 0 ? INF : frozen.edgeWeight(e);
+        };
+        double sourceForward = weightOf(source.from, source.to), sourceBackward = weightOf(source.to, source.from);
+        double targetForward = weightOf(target.from, target.to), targetBackward = weightOf(target.to, target.from);
+        // Leave the source point along either edge of its segment, paying the rest of the edge.
+        std::vector<Algorithms::SearchSeed> sources, targets;
+        if (sourceForward < INF) sources.push_back({source.to, (1.0 - source.fraction) * sourceForward});
+        if (sourceBackward < INF) sources.push_back({source.from, source.fraction * sourceBackward});
+        // Enter the target point along either edge of its segment, paying the part up to it.
+        if (targetForward < INF) targets.push_back({target.from, target.fraction * targetForward});
+        if (targetBackward < INF) targets.push_back({target.to, (1.0 - target.fraction) * targetBackward});
+        // Route between the edges' ends.
+        double pathWeight = INF;
+        std::vector<int> path = Algorithms::dijkstra(frozen, workspace, sources, targets, pathWeight);
+        // Both points on one segment can also be joined directly along one of its edges.
+        if (source.from == target.from && source.to == target.to) {
+            // Forward along from -> to.
+            if (sourceForward < INF && target.fraction >= source.fraction && (target.fraction - source.fraction) * sourceForward < pathWeight) {
+                pathWeight = (target.fraction - source.fraction) * sourceForward;
+                path = {source.from, source.to};
+            }
+            // Backward along to -> from.
+            if (sourceBackward < INF && target.fraction <= source.fraction && (source.fraction - target.fraction) * sourceBackward < pathWeight) {
+                pathWeight = (source.fraction - target.fraction) * sourceBackward;
+                path = {source.to, source.from};
+            }
+        }
+        // Print where both points were snapped to.
+        out << std::defaultfloat << std::setprecision(17);
+        out << "Source: " << source.from << " -> " << source.to << " at (" << source.x << ", " << source.y << "), fraction " << source.fraction
+            << ", distance " << source.distance << "\n";
+        out << "Target: " << target.from << " -> " << target.to << " at (" << target.x << ", " << target.y << "), fraction " << target.fraction
+            << ", distance " << target.distance << std::endl;
+        // If a path is found.
+        if (!path.empty()) {
+            // Nodes passed, in order.
+            out << "Path: ";
+            for (size_t i = 0; i < path.size(); ++i) out << path[i] << (i == path.size() - 1 ? "" : " -> ");
+            // Weight including the partial edges at both ends.
+            out << std::fixed << std::setprecision(2) << "\nWeight: " << pathWeight << std::endl;
+        } else {
+            // Print message if no path found.
+            out << "No path found between the snapped points." << std::endl;
+        }
+    }
+    // Command to report search counters and command latencies, or reset them: stats [reset].
+    else if (command == "stats" && args.size() <= 2) {
+        // Start over.
+        if (args.size() == 2 && args[1] == "reset") {
+            // Counters and histograms.
+            Stats::reset();
+            commandLatency.clear();
+            // Print success message.
+            out << "Statistics reset." << std::endl;
+            return 0;
+        }
+        // Anything but reset is unknown.
+        if (args.size() == 2) {
+            // Print error for unknown subcommand.
+            out << "Error: Unknown stats action. Use 'stats' or 'stats reset'." << std::endl;
+            // Return error code.
+            return 1;
+        }
+        // Counters since the last reset (zero if compiled out).
+        Stats::Totals totals = Stats::totals();
+        out << "{\"counters_enabled\": " << (Stats::enabled() ? "true" : "false") << ", \"counters\": {";
+        for (int c = 0; c < Stats::CounterCount; ++c) out << (c ? ", \"" : "\"") << Stats::counterName(c) << "\": " << totals.values[c];
+        // Latency percentiles of every command, in microseconds.
+        out << "}, \"commands\": {" << std::fixed << std::setprecision(3);
+        bool first = true;
+        for (const auto& entry : commandLatency) {
+            // One object per command.
+            const LatencyHistogram& histogram = entry.second;
+            out << (first ? "\"" : ", \"") << entry.first << "\": {\"count\": " << histogram.count() << ", \"mean_us\": " << histogram.mean() / 1000.0
+                << ", \"min_us\": " << histogram.min() / 1000.0 << ", \"p50_us\": " << histogram.percentile(0.5) / 1000.0
+                << ", \"p90_us\": " << histogram.percentile(0.9) / 1000.0 << ", \"p99_us\": " << histogram.percentile(0.99) / 1000.0
+                << ", \"p999_us\": " << histogram.percentile(0.999) / 1000.0 << ", \"max_us\": " << histogram.max() / 1000.0 << "}";
+            first = false;
+        }
+        out << "}}" << std::endl;
+    }
+    // Command to switch per-command traces on or off: trace <on|off>.
+    else if (command == "trace" && args.size() == 2 && (args[1] == "on" || args[1] == "off")) {
+        // Apply it.
+        traceCommands = args[1] == "on";
+        // Print success message.
+        out << "Command tracing " << (traceCommands ? "enabled" : "disabled") << "." << std::endl;
+    }
+    // Command to set travel times of an edge's time buckets: set_profile <from> <to> <bucket:time,bucket:time,...>.
+    else if (command == "set_profile" && args.size() == 4) {
+        // Parse the edge's ends.
+        int from = std::stoi(args[1]);
+        int to = std::stoi(args[2]);
+        // Static weight of the (first) edge, the starting value of every bucket.
+        double weight = 0.0;
+        if (!edgeWeight(from, to, weight)) {
+            // Print error if edge not found.
+            out << "Error: Edge from " << from << " to " << to << " not found." << std::endl;
+            // Return error code.
+            return 1;
+        }
+        // Parsed bucket values.
+        std::vector<std::pair<int, double>> values;
+        // Every comma-separated bucket:time pair.
+        for (const std::string& token : split(args[3], ',')) {
+            // Skip empty tokens (e.g. a trailing comma).
+            if (token.empty()) continue;
+            // Bucket and travel time.
+            std::vector<std::string> fields = split(token, ':');
+            // Exactly two fields.
+            if (fields.size() != 2) { out << "Error: Malformed bucket " << token << ". Use <bucket>:<travel_time>." << std::endl; return 1; }
+            // Parse them.
+            std::pair<int, double> value(std::stoi(fields[0]), std::stod(fields[1]));
+            // Bucket within the day and a usable travel time.
+            if (value.first < 0 || value.first >= edgeProfiles.buckets()) { out << "Error: Bucket " << value.first << " out of range 0.." << edgeProfiles.buckets() - 1 << "." << std::endl; return 1; }
+            if (!(value.second >= 0.0)) { out << "Error: Travel time of bucket " << value.first << " must not be negative." << std::endl; return 1; }
+            // Keep it.
+            values.push_back(value);
+        }
+        // An edge with a travel-time function starts from it rather than flat.
+        sampleEdgeProfile(from, to);
+        // Write them in one batch.
+        edgeProfiles.set(from, to, weight, values);
+        // Rebuild the edge's function from its buckets, so time-dependent searches see them.
+        std::vector<Breakpoint> points = edgeProfiles.travelTimeFunction(from, to);
+        // Set it in the graph, or only in the mapped copy while there are no adjacency lists (like weight updates).
+        if (graphDeferred) csr->setTravelTimeFunction(from, to, points);
+        else {
+            graph.setTravelTimeFunction(from, to, graph.addTravelTimeFunction(points));
+            // Patch the frozen copy in place while it matches the graph; otherwise it is refrozen on next use.
+            if (csr && csrTopologyVersion == graph.topologyVersion) csr->setTravelTimeFunction(from, to, points);
+        }
+        // Print success message.
+        out << "Profile of edge from " << from << " to " << to << ": " << values.size() << " bucket(s) set." << std::endl;
+    }
+    // Command to aggregate an edge's profile over a window of the day: profile_query <from> <to> [<start> <end>] (times as HH:MM).
+    else if (command == "profile_query" && (args.size() == 3 || args.size() == 5)) {
+        // Parse the edge's ends.
+        int from = std::stoi(args[1]);
+        int to = std::stoi(args[2]);
+        // Window; the whole day by default.
+        double start = 0.0, end = EdgeProfiles::MINUTES_PER_DAY;
+        if (args.size() == 5 && (!EdgeProfiles::parseTime(args[3], start) || !EdgeProfiles::parseTime(args[4], end))) {
+            // Print error for malformed times.
+            out << "Error: Malformed time window " << args[3] << " " << args[4] << ". Use HH:MM." << std::endl;
+            // Return error code.
+            return 1;
+        }
+        // Edges with only a travel-time function report it sampled into buckets.
+        sampleEdgeProfile(from, to);
+        // Aggregate of the window's buckets.
+        BucketStats stats;
+        int first = 0, last = 0;
+        int buckets = edgeProfiles.query(from, to, start, end, stats, first, last);
+        // Edges without a profile have nothing to report.
+        if (buckets == 0) {
+            // Print error for an unprofiled edge.
+            out << "Error: Edge from " << from << " to " << to << " has no profile." << std::endl;
+            // Return error code.
+            return 1;
+        }
+        // Print it as one JSON object.
+        out << std::defaultfloat << std::setprecision(10) << "{\"from\": " << from << ", \"to\": " << to << ", \"first_bucket\": " << first
+            << ", \"last_bucket\": " << last << ", \"buckets\": " << buckets << ", \"bucket_minutes\": " << edgeProfiles.bucketMinutes()
+            << ", \"min\": " << stats.min << ", \"max\": " << stats.max << ", \"mean\": " << stats.sum / buckets << "}" << std::endl;
+    }
+    // Command to change the number of time buckets per day (drops every profile; edges keep their travel-time functions, which are sampled again on demand): profile_buckets <n>.
+    else if (command == "profile_buckets" && args.size() == 2) {
+        // Requested count.
+        int buckets = std::stoi(args[1]);
+        // At least one bucket, at most one per minute.
+        if (buckets < 1 || buckets > static_cast<int>(EdgeProfiles::MINUTES_PER_DAY)) {
+            // Print error for an unusable count.
+            out << "Error: Bucket count must be between 1 and " << static_cast<int>(EdgeProfiles::MINUTES_PER_DAY) << "." << std::endl;
+            // Return error code.
+            return 1;
+        }
+        // Apply it.
+        edgeProfiles.reset(buckets);
+        // Print success message.
+        out << "Profiles use " << buckets << " bucket(s) of " << std::defaultfloat << edgeProfiles.bucketMinutes() << " minute(s)." << std::endl;
+    }
+    // Command to compute the arrival-time function for a departure window: td_profile <start> <end> <from> <to>.
+    else if (command == "td_profile" && args.size() == 5) {
+        // Parse start node ID.
+        int start = std::stoi(args[1]);
+        // Parse end node ID.
+        int end = std::stoi(args[2]);
+        // Departure window in minutes.
+        double from = 0.0, to = 0.0;
+        if (!TravelTime::parseTime(args[3], from) || !TravelTime::parseTime(args[4], to) || to <= from) {
+            // Print error for malformed or empty windows.
+            out << "Error: Malformed departure window " << args[3] << " " << args[4] << ". Use HH:MM or minutes, start before end." << std::endl;
+            // Return error code.
+            return 1;
+        }
+        // Arrival time as a function of the departure.
+        std::vector<Breakpoint> profile = Algorithms::timeDependentProfile(frozenGraph(), workspace, start, end, from, to);
+        // Unreachable target.
+        if (profile.empty()) {
+            // Print message if no path found.
+            out << "No path found from " << start << " to " << end << "." << std::endl;
+            return 0;
+        }
+        // Travel times are linear between breakpoints, so their extremes lie on them.
+        double fastest = INF, slowest = 0.0;
+        for (const Breakpoint& point : profile) { fastest = std::min(fastest, point.value - point.time); slowest = std::max(slowest, point.value - point.time); }
+        // Print it as one JSON object.
+        out << std::defaultfloat << std::setprecision(10) << "{\"source\": " << start << ", \"target\": " << end << ", \"from\": " << from << ", \"to\": " << to
+            << ", \"breakpoints\": [";
+        for (size_t i = 0; i < profile.size(); ++i) out << (i ? ", [" : "[") << profile[i].time << ", " << profile[i].value << "]";
+        out << "], \"min_travel_time\": " << fastest << ", \"max_travel_time\": " << slowest << "}" << std::endl;
+    }
+    // Handle unknown commands.
+    else {
+        // Print usage instructions.
+        printUsage(err);
+        // Return error code.
+        return 1;
+    }
+    // Return success code.
+    return 0;
+}
+
+// Prints the command reference.
+void Engine::printUsage(std::ostream& err) {
+    // Print usage instructions.
+    err << "Usage:\n"
+        << "  dynamic_route_optimizer load_graph <filepath.json|filepath.snap>\n"
+        << "  dynamic_route_optimizer add_node <id> [x] [y]\n"
+        << "  dynamic_route_optimizer add_edge <from_id> <to_id> <weight>\n"
+        << "  dynamic_route_optimizer shortest_path <dijkstra|astar|alt|bidijkstra|biastar|ch|cch|crp> <start_id> <end_id> [binary|dary4|radix|bucket]\n"
+        << "  dynamic_route_optimizer shortest_path td_dijkstra <start_id> <end_id> <departure HH:MM>\n"
+        << "  dynamic_route_optimizer td_profile <start_id> <end_id> <HH:MM> <HH:MM>\n"
+        << "  dynamic_route_optimizer shortest_path_batch <dijkstra|astar|alt|bidijkstra|biastar|ch|cch|crp> <s:t[:algorithm],...> [paths|weights] [binary|dary4|radix|bucket]\n"
+        << "  dynamic_route_optimizer k_shortest_paths <start_id> <end_id> <k>\n"
+        << "  dynamic_route_optimizer update_edge_weight <from_id> <to_id> <new_weight>\n"
+        << "  dynamic_route_optimizer remove_edge <from_id> <to_id>\n"
+        << "  dynamic_route_optimizer set_profile <from_id> <to_id> <bucket:travel_time,...>\n"
+        << "  dynamic_route_optimizer profile_query <from_id> <to_id> [<HH:MM> <HH:MM>]\n"
+        << "  dynamic_route_optimizer profile_buckets <n>\n"
+        << "  dynamic_route_optimizer build_landmarks [count] [farthest|avoid]\n"
+        << "  dynamic_route_optimizer build_ch\n"
+        << "  dynamic_route_optimizer build_cch\n"
+        << "  dynamic_route_optimizer customize_cch\n"
+        << "  dynamic_route_optimizer build_crp [size,size,...]\n"
+        << "  dynamic_route_optimizer customize_crp\n"
+        << "  dynamic_route_optimizer save_ch <filepath.ch>\n"
+        << "  dynamic_route_optimizer load_ch <filepath.ch>\n"
+        << "  dynamic_route_optimizer get_all_pairs_shortest_paths [double|float]\n"
+        << "  dynamic_route_optimizer distance_matrix <id,id,...> <id,id,...> [auto|dijkstra|ch|cch] [json|binary]\n"
+        << "  dynamic_route_optimizer find_set <node_id>\n"
+        << "  dynamic_route_optimizer unite_sets <node_id1> <node_id2>\n"
+        << "  dynamic_route_optimizer unite_batch <id:id,id:id,...>\n"
+        << "  dynamic_route_optimizer connected <node_id1> <node_id2>\n"
+        << "  dynamic_route_optimizer components_of_graph [labels|summary]\n"
+        << "  dynamic_route_optimizer dump_graph_json [bbox <min_x>,<min_y>,<max_x>,<max_y>] [since <version>]\n"
+        << "  dynamic_route_optimizer save_snapshot <filepath.snap>\n"
+        << "  dynamic_route_optimizer path_cache [stats|clear|capacity <n>]\n"
+        << "  dynamic_route_optimizer maintain_source <source_id>\n"
+        << "  dynamic_route_optimizer drop_source <source_id>\n"
+        << "  dynamic_route_optimizer source_tree <source_id> [target_id]\n"
+        << "  dynamic_route_optimizer nearest_node <x> <y>\n"
+        << "  dynamic_route_optimizer k_nearest <x> <y> <k> [nodes|edges]\n"
+        << "  dynamic_route_optimizer route_coords <x1> <y1> <x2> <y2>\n"
+        << "  dynamic_route_optimizer stats [reset]\n"
+        << "  dynamic_route_optimizer trace <on|off>\n"
+        << "  dynamic_route_optimizer serve [--socket <path>] [filepath.json]\n"
+        << "If no arguments, runs in interactive mode." << std::endl;
+}
@@ -3,44 +3,108 @@
 
 // Adds a node to the graph.
 void Graph::addNode(int id, double x, double y) {
+    // Node set or coordinates change, so frozen copies are stale.
+    ++topologyVersion;
+    // Stamp of this change.
+    ++version;
     // If the node doesn't already exist in the adjacency list, add it.
     if (adj.find(id) == adj.end()) {
         // Initialize an empty vector of edges for the new node.
         adj[id] = std::vector<Edge>();
+        // Initialize an empty vector of incoming edges as well.
+        radj[id] = std::vector<Edge>();
     }
     // If the node doesn't already exist in the nodes map, add it.
     if (nodes.find(id) == nodes.end()) {
         // Store the node's properties.
-        nodes[id] = {id, x, y};
+        nodes[id] = {id, x, y, version};
     } else {
         // Update coordinates if node already exists (optional behavior)
         nodes[id].x = x;
         // Update y coordinate
         nodes[id].y = y;
+        // Record the change.
+        nodes[id].version = version;
     }
 }
 
 // Adds a directed edge to the graph from 'from' node to 'to' node with a given weight.
-void Graph::addEdge(int from, int to, double weight) {
+void Graph::addEdge(int from, int to, double weight, int profile) {
     // Ensure 'from' node exists, or add it.
     if (!nodeExists(from)) addNode(from);
     // Ensure 'to' node exists, or add it.
     if (!nodeExists(to)) addNode(to);
+    // Stamp of this change.
+    ++version;
     // Add the edge to the adjacency list of the 'from' node.
     // Node coordinates are not directly part of Edge here, but could be looked up from graph.nodes if needed.
-    adj[from].push_back({to, weight, 0.0, 0.0}); // x, y in Edge are placeholders for this example
+    adj[from].push_back({to, weight, 0.0, 0.0, version, profile}); // x, y in Edge are placeholders for this example
+    // Mirror the edge in the reverse index of the 'to' node.
+    radj[to].push_back({from, weight, 0.0, 0.0, version, profile});
+    // Edge set changed, so frozen copies are stale.
+    ++topologyVersion;
+}
+
+// Appends a travel-time function to the arena.
+int Graph::addTravelTimeFunction(const std::vector<Breakpoint>& points) {
+    // Its breakpoints.
+    breakpoints.insert(breakpoints.end(), points.begin(), points.end());
+    // Close its range.
+    firstBreakpoint.push_back(static_cast<int>(breakpoints.size()));
+    // Index of the function.
+    return static_cast<int>(firstBreakpoint.size()) - 2;
+}
+
+// Replaces the travel-time function of an existing edge.
+bool Graph::setTravelTimeFunction(int from, int to, int function) {
+    // Check if the 'from' node exists.
+    if (!adj.count(from)) return false;
+    // The first edge to 'to', as for weight updates.
+    for (Edge& edge : adj[from]) {
+        // Not this one.
+        if (edge.to != to) continue;
+        // Set the function and record the change.
+        edge.profile = function;
+        edge.version = ++version;
+        // Keep the matching reverse entry in sync.
+        for (Edge& incoming : radj[to]) {
+            // The reverse entry points back at 'from'.
+            if (incoming.to == from) { incoming.profile = function; incoming.version = version; break; }
+        }
+        // Indicate successful update.
+        return true;
+    }
+    // Indicate failure if the edge was not found.
+    return false;
 }
 
 // Updates the weight of an existing edge.
-bool Graph::updateEdgeWeight(int from, int to, double newWeight) {
+bool Graph::updateEdgeWeight(int from, int to, double newWeight, double* oldWeight) {
     // Check if the 'from' node exists.
     if (adj.count(from)) {
         // Iterate through edges of the 'from' node.
         for (Edge& edge : adj[from]) {
             // If the destination node matches, update the weight.
             if (edge.to == to) {
-                // Set the new weight for the edge.
+                // Report the previous weight if requested.
+                if (oldWeight) *oldWeight = edge.weight;
+                // Set the new weight for the edge; a fixed weight replaces any travel-time function.
                 edge.weight = newWeight;
+                edge.profile = -1;
+                // Record the change.
+                edge.version = ++version;
+                // Keep the matching reverse entry (the first one, as parallel edges are added in order) in sync.
+                for (Edge& incoming : radj[to]) {
+                    // The reverse entry points back at 'from'.
+                    if (incoming.to == from) {
+                        // Copy the new weight.
+                        incoming.weight = newWeight;
+                        incoming.profile = -1;
+                        incoming.version = version;
+                        // Only the first parallel edge is updated.
+                        break;
+                    }
+                }
                 // Indicate successful update.
                 return true;
             }
@@ -50,6 +114,36 @@ bool Graph::updateEdgeWeight(int from, int to, double newWeight) {
     return false;
 }
 
+// Removes the first edge from->to.
+bool Graph::removeEdge(int from, int to, double* weight) {
+    // Check if the 'from' node has edges.
+    auto it = adj.find(from);
+    if (it == adj.end()) return false;
+    // Find the first edge to 'to'.
+    std::vector<Edge>& edges = it->second;
+    for (size_t i = 0; i < edges.size(); ++i) {
+        // Not this one.
+        if (edges[i].to != to) continue;
+        // Report its weight if requested.
+        if (weight) *weight = edges[i].weight;
+        // Erase it, keeping the order of the others.
+        edges.erase(edges.begin() + i);
+        // Drop the matching reverse entry (the first one, as for weight updates).
+        std::vector<Edge>& incoming = radj[to];
+        for (size_t j = 0; j < incoming.size(); ++j) {
+            // The reverse entry points back at 'from'.
+            if (incoming[j].to == from) { incoming.erase(incoming.begin() + j); break; }
+        }
+        // Record the change; the topology is different now.
+        removalVersion = ++version;
+        ++topologyVersion;
+        // Indicate successful removal.
+        return true;
+    }
+    // Indicate failure if the edge was not found.
+    return false;
+}
+
 
 // Returns the list of edges for a given node.
 const std::vector<Edge>& Graph::getEdges(int nodeId) const {
@@ -64,6 +158,19 @@ const std::vector<Edge>& Graph::getEdges(int nodeId) const {
     throw std::out_of_range("Node not found in graph");
 }
 
+// Returns the list of incoming edges for a given node.
+const std::vector<Edge>& Graph::getIncomingEdges(int nodeId) const {
+    // Attempt to find the node in the reverse adjacency list.
+    auto it = radj.find(nodeId);
+    // If node is found, return its incoming edges.
+    if (it != radj.end()) {
+        // Return the vector of incoming edges.
+        return it->second;
+    }
+    // Throw an exception if the node is not found.
+    throw std::out_of_range("Node not found in graph");
+}
+
 // Returns all node IDs in the graph.
 std::vector<int> Graph::getAllNodeIds() const {
     // Initialize a vector to store node IDs.
@@ -1,226 +1,333 @@
 #include "../include/graph_io.h"
 #include "../include/graph.h" // Ensure Graph is fully defined
-#include <fstream>
+#include "../include/json_reader.h"
+#include "../include/mapped_file.h"
+#include <charconv>
+#include <cmath>
+#include <cstring>
 #include <sstream>
+#include <string_view>
 #include <vector>
-#include <stdexcept> // For runtime_error
 
-// For this example, we'll use a very simple JSON structure.
-// A proper JSON library (like nlohmann/json or RapidJSON) is highly recommended for robust parsing.
-// This is a manual, fragile parser for demonstration only.
-
-// Helper to trim whitespace
-std::string trim(const std::string& str) {
-    // Find the first non-whitespace character.
-    const auto strBegin = str.find_first_not_of(" \t\n\r");
-    // If no non-whitespace character is found, return an empty string.
-    if (strBegin == std::string::npos) return "";
-    // Find the last non-whitespace character.
-    const auto strEnd = str.find_last_not_of(" \t\n\r");
-    // Calculate the range of non-whitespace characters.
-    const auto strRange = strEnd - strBegin + 1;
-    // Return the substring containing only non-whitespace characters.
-    return str.substr(strBegin, strRange);
-}
-
-
-// Loads a graph from a JSON file (simplified custom parser).
-bool GraphIO::loadGraphFromJson(const std::string& filepath, Graph& graph) {
-    // Open the file for reading.
-    std::ifstream file(filepath);
-    // If the file cannot be opened, return false.
-    if (!file.is_open()) {
-        // Indicate failure.
-        return false;
+namespace {
+    // Reads one node object; "id" is required, "x" and "y" default to 0, other fields are ignored.
+    bool readNode(JsonReader& reader, Graph& graph) {
+        // Fields of the node.
+        int id = 0;
+        double x = 0.0, y = 0.0;
+        // Whether the ID was present.
+        bool hasId = false;
+        // Opening brace.
+        if (!reader.expect('{')) return false;
+        // Fields in any order.
+        if (!reader.consume('}')) {
+            // Every key-value pair.
+            do {
+                // Field name.
+                std::string_view key;
+                if (!reader.readKey(key)) return false;
+                // Known fields are parsed, others skipped.
+                bool ok = key == "id" ? (hasId = true, reader.readInt(id))
+                        : key == "x" ? reader.readDouble(x)
+                        : key == "y" ? reader.readDouble(y)
+                        : reader.skipValue();
+                // Stop at the first error.
+                if (!ok) return false;
+            } while (reader.consume(','));
+            // Closing brace.
+            if (!reader.expect('}')) return false;
+        }
+        // A node needs an ID.
+        if (!hasId) return reader.fail("node without \"id\"");
+        // Add it.
+        graph.addNode(id, x, y);
+        return true;
     }
 
-    // String to hold each line from the file.
-    std::string line;
-    // Current parsing state (nodes or edges).
-    std::string current_section; // "nodes" or "edges"
-
-    // Read the file line by line.
-    while (std::getline(file, line)) {
-        // Trim whitespace from the current line.
-        line = trim(line);
-        // Skip empty lines or lines that are just brackets/braces.
-        if (line.empty() || line == "{" || line == "}" || line == "[" || line == "]") continue;
+    // Reads a travel-time function: an array of [departure minute, travel time] pairs.
+    bool readProfile(JsonReader& reader, std::vector<Breakpoint>& points) {
+        // Opening bracket.
+        if (!reader.expect('[')) return false;
+        // An empty function is rejected by the caller.
+        if (reader.consume(']')) return true;
+        // Pairs separated by commas.
+        do {
+            // One breakpoint.
+            Breakpoint point;
+            if (!reader.expect('[') || !reader.readDouble(point.time) || !reader.expect(',') || !reader.readDouble(point.value) || !reader.expect(']')) return false;
+            points.push_back(point);
+        } while (reader.consume(','));
+        // Closing bracket.
+        return reader.expect(']');
+    }
 
-        // Check for section headers (e.g., "nodes": [).
-        if (line.find("\"nodes\"") != std::string::npos) {
-            // Set current section to nodes.
-            current_section = "nodes";
-            // Continue to the next line.
-            continue;
-        } else if (line.find("\"edges\"") != std::string::npos) {
-            // Set current section to edges.
-            current_section = "edges";
-            // Continue to the next line.
-            continue;
+    // Reads one edge object; "from", "to" and "weight" are required unless a "profile" (travel-time
+    // function) gives the weight, other fields are ignored.
+    bool readEdge(JsonReader& reader, Graph& graph) {
+        // Fields of the edge.
+        int from = 0, to = 0;
+        double weight = 0.0;
+        // Breakpoints of the travel-time function, if any.
+        std::vector<Breakpoint> points;
+        bool hasProfile = false;
+        // Which required fields were present (bit 0 from, bit 1 to, bit 2 weight).
+        int present = 0;
+        // Opening brace.
+        if (!reader.expect('{')) return false;
+        // Fields in any order.
+        if (!reader.consume('}')) {
+            // Every key-value pair.
+            do {
+                // Field name.
+                std::string_view key;
+                if (!reader.readKey(key)) return false;
+                // Known fields are parsed, others skipped.
+                bool ok = key == "from" ? (present |= 1, reader.readInt(from))
+                        : key == "to" ? (present |= 2, reader.readInt(to))
+                        : key == "weight" ? (present |= 4, reader.readDouble(weight))
+                        : key == "profile" ? (hasProfile = true, readProfile(reader, points))
+                        : reader.skipValue();
+                // Stop at the first error.
+                if (!ok) return false;
+            } while (reader.consume(','));
+            // Closing brace.
+            if (!reader.expect('}')) return false;
         }
-        
-        // Process based on current section.
-        if (current_section == "nodes") {
-            // Example node format: { "id": 1, "x": 10.0, "y": 20.0 }
-            // This is a very fragile parser.
-            // Find "id":
-            size_t id_pos = line.find("\"id\":");
-            // Find "x":
-            size_t x_pos = line.find("\"x\":");
-            // Find "y":
-            size_t y_pos = line.find("\"y\":");
-            // If "id" tag is found.
-            if (id_pos != std::string::npos) {
-                // Initialize node properties.
-                int id = 0;
-                // Initialize x coordinate.
-                double x = 0.0;
-                // Initialize y coordinate.
-                double y = 0.0;
-                // Create a string stream from the line.
-                std::string temp;
-                // Substring after "id": .
-                temp = line.substr(id_pos + 5);
-                // Find comma after id value.
-                size_t comma_pos = temp.find(',');
-                // Extract id value.
-                id = std::stoi(trim(temp.substr(0, comma_pos)));
+        // An edge needs both ends and a weight or a function.
+        if ((present & 3) != 3 || !(present & 4 || hasProfile)) return reader.fail("edge without \"from\", \"to\" or \"weight\"");
+        // Static edge.
+        if (!hasProfile) { graph.addEdge(from, to, weight); return true; }
+        // Sort and check the function.
+        const char* error = nullptr;
+        if (!TravelTime::normalize(points, error)) return reader.fail(error);
+        // The static weight defaults to the fastest travel time, a lower bound for every departure.
+        if (!(present & 4)) weight = TravelTime::minimum(points.data(), static_cast<int>(points.size()));
+        // Add it (missing end nodes are created without coordinates).
+        graph.addEdge(from, to, weight, graph.addTravelTimeFunction(points));
+        return true;
+    }
 
-                // If "x" tag is found.
-                if (x_pos != std::string::npos) {
-                    // Substring after "x": .
-                    temp = line.substr(x_pos + 4);
-                    // Find comma after x value.
-                    comma_pos = temp.find(',');
-                    // Extract x value.
-                    x = std::stod(trim(temp.substr(0, comma_pos)));
-                }
-                // If "y" tag is found.
-                if (y_pos != std::string::npos) {
-                    // Substring after "y": .
-                    temp = line.substr(y_pos + 4);
-                    // Find closing brace after y value.
-                    size_t brace_pos = temp.find('}');
-                    // Extract y value.
-                    y = std::stod(trim(temp.substr(0, brace_pos)));
-                }
-                // Add the parsed node to the graph.
-                graph.addNode(id, x, y);
-            }
-        } else if (current_section == "edges") {
-            // Example edge format: { "from": 1, "to": 2, "weight": 5.0 }
-            // Find "from":
-            size_t from_pos = line.find("\"from\":");
-            // Find "to":
-            size_t to_pos = line.find("\"to\":");
-            // Find "weight":
-            size_t weight_pos = line.find("\"weight\":");
+    // Reads an array of node or edge objects.
+    bool readArray(JsonReader& reader, Graph& graph, bool (*readItem)(JsonReader&, Graph&)) {
+        // Opening bracket.
+        if (!reader.expect('[')) return false;
+        // Empty array.
+        if (reader.consume(']')) return true;
+        // Items separated by commas.
+        do {
+            // Stop at the first error.
+            if (!readItem(reader, graph)) return false;
+        } while (reader.consume(','));
+        // Closing bracket.
+        return reader.expect(']');
+    }
 
-            // If all tags are found.
-            if (from_pos != std::string::npos && to_pos != std::string::npos && weight_pos != std::string::npos) {
-                // Initialize 'from' node ID.
-                int from_node, to_node;
-                // Initialize edge weight.
-                double weight;
-                // Temporary string for parsing.
-                std::string temp;
-                // Substring after "from": .
-                temp = line.substr(from_pos + 7);
-                // Find comma after from_node value.
-                size_t comma_pos = temp.find(',');
-                // Extract from_node value.
-                from_node = std::stoi(trim(temp.substr(0, comma_pos)));
+    // Reads the top-level object: "nodes" and "edges" arrays in any order, other keys ignored.
+    bool readGraph(JsonReader& reader, Graph& graph) {
+        // Opening brace.
+        if (!reader.expect('{')) return false;
+        // Empty document object.
+        if (reader.consume('}')) return reader.finish();
+        // Every key-value pair.
+        do {
+            // Section name.
+            std::string_view key;
+            if (!reader.readKey(key)) return false;
+            // Parse the graph sections, skip anything else.
+            bool ok = key == "nodes" ? readArray(reader, graph, readNode)
+                    : key == "edges" ? readArray(reader, graph, readEdge)
+                    : reader.skipValue();
+            // Stop at the first error.
+            if (!ok) return false;
+        } while (reader.consume(','));
+        // Closing brace, then nothing but whitespace.
+        return reader.expect('}') && reader.finish();
+    }
+}
 
-                // Substring after "to": .
-                temp = line.substr(to_pos + 5); // Check "to": length carefully
-                // Find comma after to_node value.
-                comma_pos = temp.find(',');
-                // Extract to_node value.
-                to_node = std::stoi(trim(temp.substr(0, comma_pos)));
-                
-                // Substring after "weight": .
-                temp = line.substr(weight_pos + 9);
-                // Find closing brace after weight value.
-                size_t brace_pos = temp.find('}');
-                // Extract weight value.
-                weight = std::stod(trim(temp.substr(0, brace_pos)));
-                
-                // Add the parsed edge to the graph.
-                graph.addEdge(from_node, to_node, weight);
-            }
-        }
+// Loads a graph from a JSON file.
+bool GraphIO::loadGraphFromJson(const std::string& filepath, Graph& graph, std::string& error) {
+    // Map the file; the reader streams through it front to back.
+    MappedFile file;
+    // Report unreadable files.
+    if (!file.open(filepath, error)) return false;
+    // Parser over the whole file.
+    JsonReader reader(file.data(), file.size());
+    // Parse straight into the graph.
+    if (!readGraph(reader, graph)) {
+        // Position and reason of the first error.
+        error = std::string(reader.error()) + " at byte " + std::to_string(reader.offset());
+        return false;
     }
-    // Close the file.
-    file.close();
-    // Indicate successful loading.
+    // Success.
     return true;
 }
 
-// Saves a graph to a JSON string (could be adapted to save to file).
-std::string GraphIO::saveGraphToJson(const Graph& graph) {
-    // Initialize a string stream to build the JSON string.
-    std::stringstream ss;
-    // Start JSON object.
-    ss << "{\n";
-    // Start "nodes" array.
-    ss << "  \"nodes\": [\n";
-    // Get all node IDs from the graph.
-    auto nodeIds = graph.getAllNodeIds();
-    // Iterate through node IDs to serialize nodes.
-    for (size_t i = 0; i < nodeIds.size(); ++i) {
-        // Get the current node ID.
-        int id = nodeIds[i];
-        // Get the Node object.
-        const Node* node_ptr = graph.getNode(id);
-        // Start node object.
-        ss << "    { \"id\": " << id;
-        // If node details (coordinates) are available.
-        if (node_ptr) {
-            // Add x coordinate to JSON.
-            ss << ", \"x\": " << node_ptr->x;
-            // Add y coordinate to JSON.
-            ss << ", \"y\": " << node_ptr->y;
+// Loads a graph from a JSON file, discarding the error message.
+bool GraphIO::loadGraphFromJson(const std::string& filepath, Graph& graph) {
+    // Error message, unused.
+    std::string error;
+    // Load the file.
+    return loadGraphFromJson(filepath, graph, error);
+}
+
+namespace {
+    // Formats JSON into a fixed buffer and hands it to the stream whenever the buffer fills up, so
+    // exporting never holds more than one buffer of text regardless of the graph size.
+    class JsonWriter {
+    public:
+        // Writes to out.
+        explicit JsonWriter(std::ostream& out) : out(out) {}
+        // Hands over whatever is left.
+        ~JsonWriter() { flush(); }
+
+        // Appends raw text.
+        void text(const char* data, size_t length) {
+            // Make room (text longer than the buffer goes straight through).
+            if (used + length > sizeof(buffer)) { flush(); if (length > sizeof(buffer)) { out.write(data, static_cast<std::streamsize>(length)); return; } }
+            // Copy it in.
+            std::memcpy(buffer + used, data, length);
+            used += length;
+        }
+        // Appends a NUL-terminated string.
+        void text(const char* data) { text(data, std::strlen(data)); }
+        // Appends an integer.
+        template <typename Integer> void integer(Integer value) {
+            // Room for any 64-bit value.
+            reserve(24);
+            // Format in place.
+            used = static_cast<size_t>(std::to_chars(buffer + used, buffer + sizeof(buffer), value).ptr - buffer);
         }
-        // End node object.
-        ss << " }";
-        // If not the last node, add a comma.
-        if (i < nodeIds.size() - 1) {
-            // Add comma separator.
-            ss << ",";
+        // Appends a double in its shortest round-trip form; JSON has no infinities, so they become null.
+        void number(double value) {
+            // Not representable in JSON.
+            if (!std::isfinite(value)) { text("null"); return; }
+            // Room for any double.
+            reserve(32);
+            // Format in place.
+            used = static_cast<size_t>(std::to_chars(buffer + used, buffer + sizeof(buffer), value).ptr - buffer);
         }
-        // Add newline.
-        ss << "\n";
+
+    private:
+        // Makes sure length more bytes fit.
+        void reserve(size_t length) { if (used + length > sizeof(buffer)) flush(); }
+        // Writes the buffered bytes to the stream.
+        void flush() { out.write(buffer, static_cast<std::streamsize>(used)); used = 0; }
+
+        // Destination.
+        std::ostream& out;
+        // Pending text.
+        char buffer[1 << 16];
+        // Bytes of buffer in use.
+        size_t used = 0;
+    };
+}
+
+// Streams the selected part of the graph as JSON.
+void GraphIO::writeGraphJson(const Graph& graph, std::ostream& out, const JsonExportOptions& options) {
+    // Whether a node passes the bounding box.
+    auto inside = [&options](const Node& node) {
+        // Everything passes without a box.
+        return !options.clip || (node.x >= options.minX && node.x <= options.maxX && node.y >= options.minY && node.y <= options.maxY);
+    };
+    // Whether a change stamp passes the delta filter.
+    auto changed = [&options](unsigned long long version) { return options.since == 0 || version > options.since; };
+    // Buffered output.
+    JsonWriter writer(out);
+    // Header: the version to pass as `since` next time, and whether this replaces everything.
+    writer.text("{\n  \"version\": ");
+    writer.integer(graph.version);
+    writer.text(options.since == 0 ? ",\n  \"full\": true,\n  \"nodes\": [\n" : ",\n  \"full\": false,\n  \"nodes\": [\n");
+    // Separator state of the current array.
+    bool first = true;
+    // Nodes in ID order.
+    for (const auto& entry : graph.nodes) {
+        // The node.
+        const Node& node = entry.second;
+        // Apply both filters.
+        if (!changed(node.version) || !inside(node)) continue;
+        // Separator.
+        if (!first) writer.text(",\n");
+        first = false;
+        // Node object.
+        writer.text("    { \"id\": ");
+        writer.integer(node.id);
+        writer.text(", \"x\": ");
+        writer.number(node.x);
+        writer.text(", \"y\": ");
+        writer.number(node.y);
+        writer.text(" }");
     }
-    // End "nodes" array.
-    ss << "  ],\n";
-    // Start "edges" array.
-    ss << "  \"edges\": [\n";
-    // Flag to track if it's the first edge (for comma handling).
-    bool firstEdge = true;
-    // Iterate through all nodes to get their edges.
-    for (int from_id : nodeIds) {
-        // Check if the node exists and has outgoing edges.
-        if (graph.adj.count(from_id)) {
-            // For each edge starting from from_id.
-            for (const auto& edge : graph.getEdges(from_id)) {
-                // If not the first edge, add a comma.
-                if (!firstEdge) {
-                    // Add comma separator.
-                    ss << ",\n";
+    // Close the nodes, open the edges.
+    writer.text(first ? "  ],\n  \"edges\": [\n" : "\n  ],\n  \"edges\": [\n");
+    // Reset the separator.
+    first = true;
+    // Outgoing edges of every node, in ID order.
+    for (const auto& entry : graph.adj) {
+        // Source node; with a box, edges need both ends inside.
+        auto source = graph.nodes.find(entry.first);
+        // Skip sources outside the box.
+        if (options.clip && (source == graph.nodes.end() || !inside(source->second))) continue;
+        // Every edge.
+        for (size_t i = 0; i < entry.second.size(); ++i) {
+            // The edge.
+            const Edge& edge = entry.second[i];
+            // Delta filter.
+            if (!changed(edge.version)) continue;
+            // Target must be inside the box too.
+            if (options.clip) {
+                // Target node.
+                auto target = graph.nodes.find(edge.to);
+                // Skip edges leaving the box.
+                if (target == graph.nodes.end() || !inside(target->second)) continue;
+            }
+            // Separator.
+            if (!first) writer.text(",\n");
+            first = false;
+            // Edge object.
+            writer.text("    { \"from\": ");
+            writer.integer(entry.first);
+            writer.text(", \"to\": ");
+            writer.integer(edge.to);
+            writer.text(", \"weight\": ");
+            writer.number(edge.weight);
+            // Position among earlier edges to the same target; parallel edges keep their order until a
+            // removal, which forces a full export, so (from, to, parallel) identifies an edge across deltas.
+            int parallel = 0;
+            for (size_t j = 0; j < i; ++j) parallel += entry.second[j].to == edge.to;
+            // Only parallel edges carry it.
+            if (parallel > 0) {
+                writer.text(", \"parallel\": ");
+                writer.integer(parallel);
+            }
+            // Travel-time function, if the edge has one.
+            if (edge.profile >= 0) {
+                // Breakpoints as [departure, travel time] pairs.
+                writer.text(", \"profile\": [");
+                for (int i = graph.firstBreakpoint[edge.profile]; i < graph.firstBreakpoint[edge.profile + 1]; ++i) {
+                    // Separator.
+                    if (i > graph.firstBreakpoint[edge.profile]) writer.text(", ");
+                    writer.text("[");
+                    writer.number(graph.breakpoints[i].time);
+                    writer.text(", ");
+                    writer.number(graph.breakpoints[i].value);
+                    writer.text("]");
                 }
-                // Start edge object.
-                ss << "    { \"from\": " << from_id << ", \"to\": " << edge.to << ", \"weight\": " << edge.weight << " }";
-                // Set firstEdge to false after processing the first edge.
-                firstEdge = false;
+                writer.text("]");
             }
+            writer.text(" }");
         }
     }
-    // Add newline if any edges were written.
-    if(!firstEdge) ss << "\n";
-    // End "edges" array.
-    ss << "  ]\n";
-    // End JSON object.
-    ss << "}\n";
+    // Close the edges and the document.
+    writer.text(first ? "  ]\n}\n" : "\n  ]\n}\n");
+}
+
+// Saves a graph to a JSON string.
+std::string GraphIO::saveGraphToJson(const Graph& graph) {
+    // Collect the streamed document.
+    std::ostringstream ss;
+    // Write everything.
+    writeGraphJson(graph, ss);
     // Return the JSON string.
     return ss.str();
-}
\ No newline at end of file
+}
@@ -0,0 +1,282 @@
+#include "../include/graph_io.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <type_traits>
+
+namespace {
+    // File signature of graph snapshots.
+    const char SNAPSHOT_MAGIC[8] = {'D', 'R', 'O', 'S', 'N', 'A', 'P', '\0'};
+    // Format version; bumped on any layout change.
+    const uint32_t SNAPSHOT_VERSION = 2;
+    // Written in native byte order; reads back differently on a machine with another order.
+    const uint32_t BYTE_ORDER_MARK = 0x01020304;
+    // Sections start at multiples of this (a cache line), so every array is aligned in the mapping.
+    const uint64_t SECTION_ALIGNMENT = 64;
+    // Arrays of a CsrGraph, in file order.
+    enum Section { FIRST_OUT, HEAD, WEIGHT, FIRST_IN, TAIL, IN_WEIGHT, IN_EDGE, XS, YS, IDS, PROFILE, FIRST_BREAKPOINT, BREAKPOINTS, SECTION_COUNT };
+
+    // Location and checksum of one array.
+    struct SnapshotSection {
+        // Byte offset from the start of the file.
+        uint64_t offset;
+        // Length in bytes.
+        uint64_t bytes;
+        // Checksum of the bytes.
+        uint64_t checksum;
+    };
+
+    // Fixed-size file header; every field is 8-byte sized or paired, so the struct has no padding.
+    struct SnapshotHeader {
+        // SNAPSHOT_MAGIC.
+        char magic[8];
+        // SNAPSHOT_VERSION.
+        uint32_t version;
+        // BYTE_ORDER_MARK.
+        uint32_t byteOrder;
+        // Node and edge counts.
+        uint64_t numNodes;
+        uint64_t numEdges;
+        // Travel-time function and breakpoint counts (0 for a graph without functions).
+        uint64_t numFunctions;
+        uint64_t numBreakpoints;
+        // CsrGraph::minPositiveWeight and CsrGraph::minWeight.
+        double minPositiveWeight;
+        double minWeight;
+        // Every array of the graph.
+        SnapshotSection sections[SECTION_COUNT];
+        // Checksum of all header bytes before this field.
+        uint64_t headerChecksum;
+    };
+    // The header is written and read as raw bytes.
+    static_assert(std::is_trivially_copyable<SnapshotHeader>::value, "snapshot header must be raw bytes");
+    static_assert(sizeof(SnapshotHeader) == 48 + 16 + sizeof(SnapshotSection) * SECTION_COUNT + 8, "snapshot header must not be padded");
+
+    // FNV-1a over 64-bit words (bytes for the tail), fast enough to verify a snapshot at memory speed.
+    uint64_t checksum(const void* data, size_t size, uint64_t hash = 1469598103934665603ULL) {
+        // Bytes to hash.
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        // Whole words.
+        size_t i = 0;
+        // Mix in eight bytes at a time.
+        for (; i + 8 <= size; i += 8) {
+            // Unaligned-safe load.
+            uint64_t word;
+            std::memcpy(&word, bytes + i, sizeof(word));
+            // Mix it in.
+            hash = (hash ^ word) * 1099511628211ULL;
+        }
+        // Remaining bytes.
+        for (; i < size; ++i) hash = (hash ^ bytes[i]) * 1099511628211ULL;
+        // Return the hash.
+        return hash;
+    }
+
+    // Element size of every section.
+    size_t elementSize(int section) {
+        // Breakpoints are (time, value) pairs of doubles.
+        if (section == BREAKPOINTS) return sizeof(Breakpoint);
+        // Weights and coordinates are doubles, everything else int32.
+        return section == WEIGHT || section == IN_WEIGHT || section == XS || section == YS ? sizeof(double) : sizeof(int32_t);
+    }
+
+    // Expected element count of every section.
+    uint64_t elementCount(int section, const SnapshotHeader& header) {
+        // Counts.
+        uint64_t n = header.numNodes, m = header.numEdges, f = header.numFunctions;
+        // Offsets have a sentinel, node arrays one entry per node, the function arrays are empty
+        // without functions, and the rest have one entry per edge.
+        switch (section) {
+            case FIRST_OUT: case FIRST_IN: return n + 1;
+            case XS: case YS: case IDS: return n;
+            case PROFILE: return f ? m : 0;
+            case FIRST_BREAKPOINT: return f ? f + 1 : 0;
+            case BREAKPOINTS: return header.numBreakpoints;
+            default: return m;
+        }
+    }
+    // The breakpoint section is written and mapped as raw pairs of doubles.
+    static_assert(sizeof(Breakpoint) == 2 * sizeof(double), "breakpoints must not be padded");
+}
+
+// Writes a frozen graph as a binary snapshot.
+bool GraphIO::saveSnapshot(const CsrGraph& graph, const std::string& filepath, std::string& error) {
+    // Raw bytes of every section, in file order.
+    const void* arrays[SECTION_COUNT] = {graph.firstOut.data(), graph.head.data(), graph.weight.data(), graph.firstIn.data(), graph.tail.data(),
+                                         graph.inWeight.data(), graph.inEdge.data(), graph.xs.data(), graph.ys.data(), graph.ids.data(),
+                                         graph.profile.data(), graph.firstBreakpoint.data(), graph.breakpoints.data()};
+    // Header, completed while the sections are laid out.
+    SnapshotHeader header;
+    // Start from zeros so unused bytes are deterministic.
+    std::memset(&header, 0, sizeof(header));
+    // Identification.
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.version = SNAPSHOT_VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    // Counts.
+    header.numNodes = static_cast<uint64_t>(graph.numNodes());
+    header.numEdges = static_cast<uint64_t>(graph.numEdges());
+    header.numFunctions = graph.firstBreakpoint.empty() ? 0 : static_cast<uint64_t>(graph.firstBreakpoint.size() - 1);
+    header.numBreakpoints = static_cast<uint64_t>(graph.breakpoints.size());
+    // Weight bounds.
+    header.minPositiveWeight = graph.minPositiveWeight;
+    header.minWeight = graph.minWeight;
+    // Sections follow the header, each aligned.
+    uint64_t offset = sizeof(SnapshotHeader);
+    // Lay out and checksum every section.
+    for (int s = 0; s < SECTION_COUNT; ++s) {
+        // Align the start.
+        offset = (offset + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+        // Section entry.
+        SnapshotSection& section = header.sections[s];
+        // Position and length.
+        section.offset = offset;
+        section.bytes = elementCount(s, header) * elementSize(s);
+        // Checksum of the contents.
+        section.checksum = checksum(arrays[s], section.bytes);
+        // Next free byte.
+        offset += section.bytes;
+    }
+    // Seal the header.
+    header.headerChecksum = checksum(&header, offsetof(SnapshotHeader, headerChecksum));
+    // Write the file.
+    std::ofstream file(filepath, std::ios::binary | std::ios::trunc);
+    // Report unopenable paths.
+    if (!file) { error = "Could not open " + filepath + " for writing."; return false; }
+    // Header first.
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    // Bytes written so far.
+    uint64_t written = sizeof(header);
+    // Zero bytes for the alignment gaps.
+    const char padding[SECTION_ALIGNMENT] = {};
+    // Sections in order, straight from the arrays.
+    for (int s = 0; s < SECTION_COUNT; ++s) {
+        // Pad up to the section start.
+        file.write(padding, static_cast<std::streamsize>(header.sections[s].offset - written));
+        // Contents.
+        file.write(static_cast<const char*>(arrays[s]), static_cast<std::streamsize>(header.sections[s].bytes));
+        // Advance.
+        written = header.sections[s].offset + header.sections[s].bytes;
+    }
+    // Report write failures.
+    if (!file) { error = "Could not write " + filepath + "."; return false; }
+    // Success.
+    return true;
+}
+
+// Checks whether a file starts with the snapshot signature.
+bool GraphIO::isSnapshot(const std::string& filepath) {
+    // Open the file.
+    std::ifstream file(filepath, std::ios::binary);
+    // Read the signature.
+    char magic[sizeof(SNAPSHOT_MAGIC)] = {};
+    file.read(magic, sizeof(magic));
+    // Compare it.
+    return file && std::memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) == 0;
+}
+
+// Maps a snapshot and points the graph's arrays into it.
+bool GraphIO::loadSnapshot(const std::string& filepath, CsrGraph& graph, std::string& error) {
+    // Map the file.
+    auto mapping = std::make_shared<MappedFile>();
+    // Report unreadable files.
+    if (!mapping->open(filepath, error)) { error = "Could not open " + filepath + " (" + error + ")."; return false; }
+    // Header copy (the mapping start is page aligned, but copying avoids relying on it).
+    SnapshotHeader header;
+    // Too short to hold a header, or not a snapshot.
+    if (mapping->size() < sizeof(header) || std::memcmp(mapping->data(), SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) {
+        // Not a snapshot file.
+        error = filepath + " is not a graph snapshot.";
+        return false;
+    }
+    // Read the header.
+    std::memcpy(&header, mapping->data(), sizeof(header));
+    // Reject other versions and byte orders.
+    if (header.version != SNAPSHOT_VERSION || header.byteOrder != BYTE_ORDER_MARK) {
+        // Incompatible file.
+        error = filepath + " has an unsupported snapshot version or byte order.";
+        return false;
+    }
+    // Verify the header before trusting any field.
+    if (checksum(&header, offsetof(SnapshotHeader, headerChecksum)) != header.headerChecksum) { error = filepath + " is corrupted (header checksum mismatch)."; return false; }
+    // Internal indices are ints.
+    if (header.numNodes >= INT32_MAX || header.numEdges >= INT32_MAX || header.numFunctions >= INT32_MAX || header.numBreakpoints >= INT32_MAX) { error = filepath + " is too large for 32-bit indices."; return false; }
+    // Functions come with breakpoints and vice versa.
+    if ((header.numFunctions == 0) != (header.numBreakpoints == 0)) { error = filepath + " is corrupted (inconsistent travel-time functions)."; return false; }
+    // Validate every section against the file and the counts.
+    for (int s = 0; s < SECTION_COUNT; ++s) {
+        // Section entry.
+        const SnapshotSection& section = header.sections[s];
+        // Bounds, size and alignment.
+        bool valid = section.offset % SECTION_ALIGNMENT == 0 && section.offset <= mapping->size() && section.bytes <= mapping->size() - section.offset
+                     && section.bytes == elementCount(s, header) * elementSize(s);
+        // Report malformed layouts.
+        if (!valid) { error = filepath + " is corrupted (bad section layout)."; return false; }
+        // Contents (reads every page once, sequentially).
+        if (checksum(mapping->data() + section.offset, section.bytes) != section.checksum) { error = filepath + " is corrupted (section checksum mismatch)."; return false; }
+    }
+    // Start of a section as a typed pointer.
+    auto at = [&](int s) { return mapping->data() + header.sections[s].offset; };
+    // Counts.
+    const size_t n = static_cast<size_t>(header.numNodes), m = static_cast<size_t>(header.numEdges);
+    // Point every array into the mapping.
+    graph.firstOut.view(reinterpret_cast<int*>(at(FIRST_OUT)), n + 1);
+    graph.head.view(reinterpret_cast<int*>(at(HEAD)), m);
+    graph.weight.view(reinterpret_cast<double*>(at(WEIGHT)), m);
+    graph.firstIn.view(reinterpret_cast<int*>(at(FIRST_IN)), n + 1);
+    graph.tail.view(reinterpret_cast<int*>(at(TAIL)), m);
+    graph.inWeight.view(reinterpret_cast<double*>(at(IN_WEIGHT)), m);
+    graph.inEdge.view(reinterpret_cast<int*>(at(IN_EDGE)), m);
+    graph.xs.view(reinterpret_cast<double*>(at(XS)), n);
+    graph.ys.view(reinterpret_cast<double*>(at(YS)), n);
+    graph.ids.view(reinterpret_cast<int*>(at(IDS)), n);
+    // Travel-time functions, if any.
+    const size_t f = static_cast<size_t>(header.numFunctions);
+    if (f) {
+        // Function of every edge, offsets and breakpoints.
+        graph.profile.view(reinterpret_cast<int*>(at(PROFILE)), m);
+        graph.firstBreakpoint.view(reinterpret_cast<int*>(at(FIRST_BREAKPOINT)), f + 1);
+        graph.breakpoints.view(reinterpret_cast<Breakpoint*>(at(BREAKPOINTS)), static_cast<size_t>(header.numBreakpoints));
+    }
+    // Weight bounds.
+    graph.minPositiveWeight = header.minPositiveWeight;
+    graph.minWeight = header.minWeight;
+    // Keep the mapping alive as long as the graph.
+    graph.mapping = std::move(mapping);
+    // Offsets must close both edge ranges.
+    if (graph.firstOut[0] != 0 || graph.firstOut[n] != static_cast<int>(m) || graph.firstIn[0] != 0 || graph.firstIn[n] != static_cast<int>(m)) {
+        // Report the inconsistency.
+        error = filepath + " is corrupted (inconsistent offsets).";
+        return false;
+    }
+    // Every index the queries follow must stay in range, so a checksummed but malformed file fails here
+    // instead of reading out of bounds later. Offsets never decrease.
+    bool indexed = true;
+    for (size_t v = 0; indexed && v < n; ++v) indexed = graph.firstOut[v] <= graph.firstOut[v + 1] && graph.firstIn[v] <= graph.firstIn[v + 1];
+    // Edge heads and tails are nodes.
+    for (size_t e = 0; indexed && e < m; ++e) indexed = graph.head[e] >= 0 && graph.head[e] < static_cast<int>(n) && graph.tail[e] >= 0 && graph.tail[e] < static_cast<int>(n);
+    // Every incoming entry names an edge into its own node.
+    for (size_t v = 0; indexed && v < n; ++v) {
+        for (int b = graph.firstIn[v]; indexed && b < graph.firstIn[v + 1]; ++b) {
+            indexed = graph.inEdge[b] >= 0 && graph.inEdge[b] < static_cast<int>(m) && graph.head[graph.inEdge[b]] == static_cast<int>(v);
+        }
+    }
+    // IDs are sorted strictly, as internalId's binary search expects.
+    for (size_t v = 1; indexed && v < n; ++v) indexed = graph.ids[v - 1] < graph.ids[v];
+    // Report the inconsistency.
+    if (!indexed) { error = filepath + " is corrupted (edge or node index out of range)."; return false; }
+    // Function offsets must close the breakpoints, and every edge must name a function or -1.
+    if (f) {
+        // Offsets.
+        bool valid = graph.firstBreakpoint[0] == 0 && graph.firstBreakpoint[f] == static_cast<int>(header.numBreakpoints);
+        for (size_t i = 0; valid && i < f; ++i) valid = graph.firstBreakpoint[i] < graph.firstBreakpoint[i + 1];
+        // Edge references.
+        for (size_t e = 0; valid && e < m; ++e) valid = graph.profile[e] >= -1 && graph.profile[e] < static_cast<int>(f);
+        // Report the inconsistency.
+        if (!valid) { error = filepath + " is corrupted (inconsistent travel-time functions)."; return false; }
+    }
+    // Success.
+    return true;
+}
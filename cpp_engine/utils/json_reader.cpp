@@ -0,0 +1,218 @@
+#include "../include/json_reader.h"
+#include <charconv>
+#include <cstring>
+
+namespace {
+    // Nesting limit of skipValue, so hostile inputs cannot exhaust the stack.
+    const int MAX_DEPTH = 256;
+
+    // Whether c may appear inside a JSON number.
+    inline bool isNumberChar(char c) {
+        // Digits, sign, decimal point and exponent.
+        return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+    }
+}
+
+// Reads the size bytes at data.
+JsonReader::JsonReader(const char* data, size_t size) : begin(data), position(data), end(data + size) {}
+
+// Advances past JSON whitespace.
+void JsonReader::skipWhitespace() {
+    // Space, tab, line feed and carriage return are the only whitespace JSON allows.
+    while (position < end && (*position == ' ' || *position == '\n' || *position == '\r' || *position == '\t')) ++position;
+}
+
+// Kind of the next value.
+JsonReader::Token JsonReader::peek() {
+    // Tokens may be separated by any amount of whitespace.
+    skipWhitespace();
+    // Nothing left.
+    if (position == end) return Token::End;
+    // Classify by the first character.
+    switch (*position) {
+        case '{': return Token::Object;
+        case '[': return Token::Array;
+        case '"': return Token::String;
+        case 't': case 'f': case 'n': return Token::Literal;
+        default: return *position == '-' || (*position >= '0' && *position <= '9') ? Token::Number : Token::Invalid;
+    }
+}
+
+// Consumes the punctuation character c, or fails.
+bool JsonReader::expect(char c) {
+    // Present: consume it.
+    if (consume(c)) return true;
+    // Name the missing character in the message.
+    switch (c) {
+        case '{': return fail("expected '{'");
+        case '}': return fail("expected ',' or '}'");
+        case '[': return fail("expected '['");
+        case ']': return fail("expected ',' or ']'");
+        case ':': return fail("expected ':'");
+        default: return fail("unexpected character");
+    }
+}
+
+// Consumes c if it is the next character.
+bool JsonReader::consume(char c) {
+    // Skip whitespace first.
+    skipWhitespace();
+    // Not there (or an error already stopped the parse).
+    if (message || position == end || *position != c) return false;
+    // Consume it.
+    ++position;
+    return true;
+}
+
+// Reads a string without its quotes.
+bool JsonReader::readString(std::string_view& value) {
+    // Must start with a quote.
+    if (peek() != Token::String) return fail("expected string");
+    // First character of the contents.
+    const char* start = ++position;
+    // Find the closing quote; memchr skips plain runs quickly.
+    while (true) {
+        // Next quote or backslash.
+        const char* quote = static_cast<const char*>(std::memchr(position, '"', static_cast<size_t>(end - position)));
+        // Unterminated string.
+        if (!quote) { position = start - 1; return fail("unterminated string"); }
+        // Count the backslashes right before it; an odd number escapes it.
+        const char* back = quote;
+        while (back > start && back[-1] == '\\') --back;
+        // Continue past an escaped quote.
+        position = quote + 1;
+        // Unescaped: the string ends here.
+        if ((quote - back) % 2 == 0) break;
+    }
+    // Contents between the quotes.
+    value = std::string_view(start, static_cast<size_t>(position - 1 - start));
+    // Success.
+    return true;
+}
+
+// Reads an object key and the colon after it.
+bool JsonReader::readKey(std::string_view& key) {
+    // Key string, then the separator.
+    return readString(key) && expect(':');
+}
+
+// Extent of the number starting at the current position.
+const char* JsonReader::scanNumber() {
+    // Last character that can belong to the number.
+    const char* last = position;
+    // Take every number character; from_chars validates the exact syntax.
+    while (last < end && isNumberChar(*last)) ++last;
+    // One past the number.
+    return last;
+}
+
+// Reads a number that fits an int.
+bool JsonReader::readInt(int& value) {
+    // Must start like a number.
+    if (peek() != Token::Number) return fail("expected number");
+    // End of the number's characters.
+    const char* last = scanNumber();
+    // Parse the whole span as a decimal integer.
+    auto result = std::from_chars(position, last, value);
+    // Overflow.
+    if (result.ec == std::errc::result_out_of_range) return fail("integer out of range");
+    // Fraction, exponent or malformed digits.
+    if (result.ec != std::errc() || result.ptr != last) return fail("expected integer");
+    // Consume it.
+    position = last;
+    return true;
+}
+
+// Reads any number.
+bool JsonReader::readDouble(double& value) {
+    // Must start like a number (from_chars alone would also accept "inf" and "nan").
+    if (peek() != Token::Number) return fail("expected number");
+    // End of the number's characters.
+    const char* last = scanNumber();
+    // Parse the whole span.
+    auto result = std::from_chars(position, last, value);
+    // Malformed or out of range.
+    if (result.ec != std::errc() || result.ptr != last) return fail("invalid number");
+    // Consume it.
+    position = last;
+    return true;
+}
+
+// Skips one complete value of any kind.
+bool JsonReader::skipValue() {
+    // Start at the top level.
+    return skipValue(0);
+}
+
+// Skips a value nested depth levels deep.
+bool JsonReader::skipValue(int depth) {
+    // Refuse pathological nesting.
+    if (depth > MAX_DEPTH) return fail("nesting too deep");
+    // Dispatch on the kind of value.
+    switch (peek()) {
+        case Token::Object: {
+            // Opening brace.
+            ++position;
+            // Empty object.
+            if (consume('}')) return true;
+            // Key-value pairs.
+            do {
+                // Key and value.
+                std::string_view key;
+                if (!readKey(key) || !skipValue(depth + 1)) return false;
+            } while (consume(','));
+            // Closing brace.
+            return expect('}');
+        }
+        case Token::Array: {
+            // Opening bracket.
+            ++position;
+            // Empty array.
+            if (consume(']')) return true;
+            // Elements.
+            do {
+                // Element.
+                if (!skipValue(depth + 1)) return false;
+            } while (consume(','));
+            // Closing bracket.
+            return expect(']');
+        }
+        case Token::String: {
+            // Contents are not needed.
+            std::string_view ignored;
+            return readString(ignored);
+        }
+        case Token::Number: {
+            // Validated like any other number.
+            double ignored;
+            return readDouble(ignored);
+        }
+        case Token::Literal: {
+            // true, false or null.
+            for (const char* literal : {"true", "false", "null"}) {
+                // Length of the literal.
+                size_t length = std::strlen(literal);
+                // Match it in full.
+                if (static_cast<size_t>(end - position) >= length && std::memcmp(position, literal, length) == 0) { position += length; return true; }
+            }
+            // Something else starting with t, f or n.
+            return fail("invalid literal");
+        }
+        case Token::End: return fail("unexpected end of input");
+        default: return fail("unexpected character");
+    }
+}
+
+// Checks that only whitespace remains.
+bool JsonReader::finish() {
+    // Trailing whitespace is fine, anything else is not.
+    return message ? false : peek() == Token::End || fail("unexpected data after the document");
+}
+
+// Records the first error at the current position.
+bool JsonReader::fail(const char* text) {
+    // Keep the first error; later ones are consequences of it.
+    if (!message) message = text;
+    // Convenient for `return fail(...)`.
+    return false;
+}
@@ -0,0 +1,65 @@
+#include "../include/mapped_file.h"
+#include <fstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Unmaps the file.
+MappedFile::~MappedFile() {
+    // Nothing to release.
+    if (!bytes) return;
+#ifndef _WIN32
+    // Release the mapping.
+    if (mapped) { munmap(bytes, length); return; }
+#endif
+    // Release the heap copy.
+    delete[] bytes;
+}
+
+// Maps a whole file; returns false and sets error on failure.
+bool MappedFile::open(const std::string& filepath, std::string& error) {
+#ifndef _WIN32
+    // Open the file.
+    int fd = ::open(filepath.c_str(), O_RDONLY);
+    // Fail if it cannot be opened.
+    if (fd < 0) { error = "cannot open " + filepath; return false; }
+    // File status for the size.
+    struct stat status;
+    // Fail if it cannot be queried.
+    if (fstat(fd, &status) != 0 || status.st_size <= 0) { close(fd); error = "cannot read " + filepath; return false; }
+    // Map the whole file privately: writes stay in this process.
+    void* address = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    // The mapping keeps the file alive on its own.
+    close(fd);
+    // Fail if mapping failed.
+    if (address == MAP_FAILED) { error = "cannot map " + filepath; return false; }
+    // Record the mapping.
+    bytes = static_cast<char*>(address);
+    length = static_cast<size_t>(status.st_size);
+    mapped = true;
+    // Success.
+    return true;
+#else
+    // Open the file at its end to learn the size.
+    std::ifstream file(filepath, std::ios::binary | std::ios::ate);
+    // Fail if it cannot be opened.
+    if (!file) { error = "cannot open " + filepath; return false; }
+    // Size of the file.
+    std::streamoff size = file.tellg();
+    // Fail on empty files.
+    if (size <= 0) { error = "cannot read " + filepath; return false; }
+    // Read everything into a heap buffer.
+    bytes = new char[static_cast<size_t>(size)];
+    length = static_cast<size_t>(size);
+    // Rewind.
+    file.seekg(0);
+    // Read the contents.
+    if (!file.read(bytes, size)) { error = "cannot read " + filepath; return false; }
+    // Success.
+    return true;
+#endif
+}
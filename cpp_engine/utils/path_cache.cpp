@@ -0,0 +1,306 @@
+#include "../include/path_cache.h"
+#include "../include/stats.h"
+#include <algorithm>
+
+namespace {
+    // Relative slack of the improvement test, so rounding never keeps an entry a decrease did improve.
+    const double IMPROVEMENT_SLACK = 1e-12;
+
+    // Bounded one-to-many search from root over outgoing (or, if backward, incoming) edges.
+    // Stops once every node of the sorted list `wanted` is settled or the next key reaches radius,
+    // and returns the frontier: every label not above it is exact.
+    double boundedSearch(const CsrGraph& graph, QueryWorkspace& workspace, int root, bool backward, const std::vector<int>& wanted, double radius) {
+        // Queue of this search.
+        IndexedDaryHeap<4>& queue = workspace.daryQueue;
+        // Fresh labels and queue.
+        workspace.reset(graph.numNodes());
+        queue.reset(graph.numNodes());
+        // Start at the root.
+        workspace.setLabel(root, 0.0, -1);
+        queue.push(root, 0.0);
+        // Wanted nodes not settled yet.
+        size_t remaining = wanted.size();
+        // Settle nodes in distance order.
+        while (!queue.empty()) {
+            // Closest unsettled node.
+            std::pair<double, int> top = queue.pop();
+            // Nothing closer than the radius is left.
+            if (top.first >= radius) return top.first;
+            // All wanted nodes are settled; labels up to this key are final.
+            if (std::binary_search(wanted.begin(), wanted.end(), top.second) && --remaining == 0) return top.first;
+            // Relax the edges of the node in the search direction.
+            int u = top.second;
+            int begin = backward ? graph.beginInEdge(u) : graph.beginEdge(u);
+            int end = backward ? graph.endInEdge(u) : graph.endEdge(u);
+            for (int e = begin; e < end; ++e) {
+                // Neighbor and tentative distance.
+                int v = backward ? graph.inEdgeTail(e) : graph.edgeHead(e);
+                double d = top.first + (backward ? graph.inEdgeWeight(e) : graph.edgeWeight(e));
+                // Improve it.
+                if (d < workspace.distance(v)) { workspace.setLabel(v, d, u); queue.push(v, d); }
+            }
+        }
+        // Exhausted: every label is exact.
+        return INF;
+    }
+
+    // Exact distance label of u from a bounded search, or INF if it is unknown or not final.
+    double exactDistance(const CsrGraph& graph, const QueryWorkspace& workspace, int id, double frontier) {
+        // Internal index (-1 for nodes that do not exist).
+        int u = graph.internalId(id);
+        // Labels up to the frontier are final.
+        double d = u < 0 ? INF : workspace.distance(u);
+        return d <= frontier ? d : INF;
+    }
+}
+
+// Creates a cache holding up to capacity entries.
+PathCache::PathCache(size_t capacity) {
+    // Allocate the slots.
+    setCapacity(capacity);
+}
+
+// Copies a cached answer; false on a miss.
+bool PathCache::lookup(PathAlgorithm algorithm, int source, int target, std::vector<int>& path, double& weight) {
+    // Find the key.
+    auto it = index.find(key(algorithm, source, target));
+    // Not cached.
+    if (it == index.end() || slots[it->second].version < minimumVersion) {
+        // Count the miss.
+        ++counters.misses;
+        ROUTE_STATS(::Stats::add(::Stats::CacheMisses, 1);)
+        return false;
+    }
+    // The entry earns a second chance against the CLOCK hand.
+    Entry& entry = slots[it->second];
+    entry.referenced = true;
+    // Copy the answer.
+    path = entry.path;
+    weight = entry.weight;
+    // Count the hit.
+    ++counters.hits;
+    ROUTE_STATS(::Stats::add(::Stats::CacheHits, 1);)
+    return true;
+}
+
+// Stores an answer computed at the given graph version.
+void PathCache::insert(PathAlgorithm algorithm, int source, int target, const std::vector<int>& path, double weight, unsigned long long version) {
+    // Caching disabled, or the answer predates the last flush.
+    if (slots.empty() || version < minimumVersion) return;
+    // Replace an existing entry for the key.
+    auto it = index.find(key(algorithm, source, target));
+    if (it != index.end()) release(it->second);
+    // Slot for the entry.
+    int slot = acquireSlot();
+    Entry& entry = slots[slot];
+    // Fill it.
+    entry.algorithm = algorithm;
+    entry.source = source;
+    entry.target = target;
+    entry.weight = weight;
+    entry.path = path;
+    entry.version = version;
+    entry.stamp = nextStamp++;
+    entry.referenced = false;
+    entry.live = true;
+    // Make it findable.
+    index[key(algorithm, source, target)] = slot;
+    // Register it with every edge of its path.
+    for (size_t i = 0; i + 1 < path.size(); ++i) uses[pack(path[i], path[i + 1])].push_back({slot, entry.stamp});
+    // Account for the references.
+    size_t edges = path.empty() ? 0 : path.size() - 1;
+    useCount += edges;
+    liveUseCount += edges;
+    // Count it.
+    ++counters.insertions;
+    // Evicted entries leave stale references behind; drop them once they dominate the index.
+    if (useCount > 2 * liveUseCount + 4096) compactUses();
+}
+
+// Evicts every entry whose path uses from -> to.
+void PathCache::edgeIncreased(int from, int to) {
+    // Nothing else can get shorter.
+    evictUsers(from, to);
+}
+
+// Evicts the entries using from -> to and queues the search for entries it could shorten.
+void PathCache::edgeDecreased(int from, int to) {
+    // Entries using the edge now have a wrong weight.
+    evictUsers(from, to);
+    // The rest need the updated graph; resolved before the next lookup.
+    if (!index.empty()) pending.push_back(pack(from, to));
+}
+
+// Evicts the entries using from -> to (a parallel edge) and queues the search for entries the new edge could shorten or connect.
+void PathCache::edgeAdded(int from, int to) {
+    // Entries using a parallel edge may have a wrong weight.
+    evictUsers(from, to);
+    // The rest need the updated graph; resolved before the next lookup.
+    if (!index.empty()) pendingAdded.push_back(pack(from, to));
+}
+
+// Resolves queued changes against the current graph.
+void PathCache::resolvePending(const CsrGraph& graph, QueryWorkspace& forward, QueryWorkspace& backward) {
+    // Each edge is resolved once, however often it changed; an added edge that also got cheaper counts as added.
+    std::sort(pendingAdded.begin(), pendingAdded.end());
+    pendingAdded.erase(std::unique(pendingAdded.begin(), pendingAdded.end()), pendingAdded.end());
+    std::vector<std::pair<uint64_t, bool>> changed;
+    for (uint64_t edge : pendingAdded) changed.push_back({edge, true});
+    for (uint64_t edge : pending) if (!std::binary_search(pendingAdded.begin(), pendingAdded.end(), edge)) changed.push_back({edge, false});
+    std::sort(changed.begin(), changed.end());
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+    // Every changed edge.
+    for (const std::pair<uint64_t, bool>& change : changed) {
+        // Nothing left to invalidate.
+        if (index.empty()) break;
+        // The edge, and whether it is new (only then can it connect a pair cached as unreachable).
+        uint64_t edge = change.first;
+        bool added = change.second;
+        // Endpoints of the edge.
+        int u = graph.internalId(static_cast<int>(static_cast<uint32_t>(edge >> 32)));
+        int v = graph.internalId(static_cast<int>(static_cast<uint32_t>(edge)));
+        // The edge no longer exists.
+        if (u < 0 || v < 0) continue;
+        // Cheapest of the parallel edges u -> v.
+        double w = INF;
+        for (int e = graph.beginEdge(u); e < graph.endEdge(u); ++e) if (graph.edgeHead(e) == v) w = std::min(w, graph.edgeWeight(e));
+        // Longest cached weight the edge can improve (INF for a new edge if some pair is cached as unreachable), and the cached endpoints.
+        double longest = 0.0;
+        std::vector<int> sources, targets;
+        for (const Entry& entry : slots) {
+            // Free slot, or an unreachable pair a cheaper edge cannot connect.
+            if (!entry.live || (entry.weight == INF && !added)) continue;
+            // Track the bound.
+            longest = std::max(longest, entry.weight);
+            // Endpoints that exist in the graph.
+            int s = graph.internalId(entry.source), t = graph.internalId(entry.target);
+            if (s >= 0) sources.push_back(s);
+            if (t >= 0) targets.push_back(t);
+        }
+        // No cached path is long enough to be shortened through the edge.
+        if (w >= longest) continue;
+        // Distinct endpoints, sorted for the membership tests of the searches.
+        std::sort(sources.begin(), sources.end());
+        sources.erase(std::unique(sources.begin(), sources.end()), sources.end());
+        std::sort(targets.begin(), targets.end());
+        targets.erase(std::unique(targets.begin(), targets.end()), targets.end());
+        // A path through the edge costs at least w, so nothing beyond longest - w matters on either side.
+        double radius = longest - w;
+        // d(s, u) for every cached source, and d(v, t) for every cached target.
+        double backwardFrontier = boundedSearch(graph, backward, u, true, sources, radius);
+        double forwardFrontier = boundedSearch(graph, forward, v, false, targets, radius);
+        // Evict every entry the edge can improve (ties included).
+        for (size_t slot = 0; slot < slots.size(); ++slot) {
+            // Free slot.
+            const Entry& entry = slots[slot];
+            if (!entry.live || (entry.weight == INF && !added)) continue;
+            // Best path through the edge.
+            double through = exactDistance(graph, backward, entry.source, backwardFrontier) + w + exactDistance(graph, forward, entry.target, forwardFrontier);
+            // Not better than the cached answer (an unreachable pair stays unreachable if the edge cannot connect it).
+            if (through == INF || through > entry.weight * (1.0 + IMPROVEMENT_SLACK)) continue;
+            // Drop it.
+            release(static_cast<int>(slot));
+            ++counters.invalidations;
+        }
+    }
+    // All resolved.
+    pending.clear();
+    pendingAdded.clear();
+}
+
+// Drops every entry.
+void PathCache::clear(unsigned long long minVersion) {
+    // Count the dropped entries.
+    counters.flushes += index.size();
+    // Free every slot.
+    for (size_t slot = 0; slot < slots.size(); ++slot) slots[slot] = Entry();
+    freeSlots.clear();
+    for (size_t slot = slots.size(); slot-- > 0;) freeSlots.push_back(static_cast<int>(slot));
+    // Empty the indexes.
+    index.clear();
+    uses.clear();
+    useCount = liveUseCount = 0;
+    pending.clear();
+    pendingAdded.clear();
+    hand = 0;
+    // Older answers are refused from now on.
+    minimumVersion = std::max(minimumVersion, minVersion);
+}
+
+// Changes the capacity, dropping every entry.
+void PathCache::setCapacity(size_t capacity) {
+    // New slot array.
+    slots.assign(capacity, Entry());
+    // All of it free.
+    clear(minimumVersion);
+}
+
+// Frees a slot.
+void PathCache::release(int slot) {
+    // The entry.
+    Entry& entry = slots[slot];
+    // Forget the key.
+    index.erase(key(entry.algorithm, entry.source, entry.target));
+    // Its reverse index references are stale now.
+    liveUseCount -= entry.path.empty() ? 0 : entry.path.size() - 1;
+    // Free the memory and the slot.
+    entry = Entry();
+    freeSlots.push_back(slot);
+}
+
+// Evicts every entry whose path uses from -> to.
+void PathCache::evictUsers(int from, int to) {
+    // Entries registered with the edge.
+    auto it = uses.find(pack(from, to));
+    if (it == uses.end()) return;
+    // Release the ones still live (the stamp tells a current occupant from an earlier one).
+    for (const Use& use : it->second) {
+        // Stale reference.
+        if (!slots[use.slot].live || slots[use.slot].stamp != use.stamp) continue;
+        // Drop it.
+        release(use.slot);
+        ++counters.invalidations;
+    }
+    // No entry uses the edge any more.
+    useCount -= it->second.size();
+    uses.erase(it);
+}
+
+// Slot for a new entry.
+int PathCache::acquireSlot() {
+    // A free slot, if any.
+    if (!freeSlots.empty()) {
+        int slot = freeSlots.back();
+        freeSlots.pop_back();
+        return slot;
+    }
+    // Sweep: referenced entries lose their bit, the first unreferenced one is the victim.
+    while (slots[hand].referenced) {
+        // Second chance used up.
+        slots[hand].referenced = false;
+        hand = (hand + 1) % slots.size();
+    }
+    // Evict the victim.
+    int victim = static_cast<int>(hand);
+    hand = (hand + 1) % slots.size();
+    release(victim);
+    ++counters.evictions;
+    // release() returned it to the free list.
+    freeSlots.pop_back();
+    return victim;
+}
+
+// Rebuilds the reverse index without stale references.
+void PathCache::compactUses() {
+    // Keep live references only.
+    for (auto it = uses.begin(); it != uses.end();) {
+        // References of this edge.
+        std::vector<Use>& list = it->second;
+        // Drop the stale ones.
+        useCount -= list.size();
+        list.erase(std::remove_if(list.begin(), list.end(), [&](const Use& use) { return !slots[use.slot].live || slots[use.slot].stamp != use.stamp; }), list.end());
+        useCount += list.size();
+        // Drop edges without users.
+        if (list.empty()) it = uses.erase(it); else ++it;
+    }
+}
@@ -0,0 +1,30 @@
+#include "../include/query_workspace.h"
+#include <algorithm> // For std::fill
+
+// Creates a workspace sized for a graph with the given number of nodes.
+QueryWorkspace::QueryWorkspace(int numNodes) {
+    // Allocate the label arrays up front.
+    reset(numNodes);
+}
+
+// Starts a new query, invalidating all labels in O(1).
+void QueryWorkspace::reset(int numNodes) {
+    // Grow the label arrays if the graph gained nodes; new slots start with a stale stamp.
+    if (numNodes > capacity()) {
+        // Distance labels.
+        dist.resize(numNodes, INF);
+        // Parent labels.
+        parentOf.resize(numNodes, -1);
+        // Stamps (0 is never a live epoch).
+        stamp.resize(numNodes, 0);
+    }
+    // Move to the next epoch; all existing labels become stale.
+    ++epoch;
+    // After 2^32 queries the counter wraps; clear the stamps once so no old label can come back.
+    if (epoch == 0) {
+        // Reset every stamp.
+        std::fill(stamp.begin(), stamp.end(), 0);
+        // Restart at the first live epoch.
+        epoch = 1;
+    }
+}
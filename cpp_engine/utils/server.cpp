@@ -0,0 +1,188 @@
+#include "../include/server.h"
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+// Serializes access to the engine; socket connections are served on separate threads.
+static std::mutex engineMutex;
+
+// Executes a single request line against the engine and returns the framed response.
+std::string Server::handleRequest(Engine& engine, const std::string& line) {
+    // Buffer collecting everything the command prints.
+    std::ostringstream body;
+    // Exit status of the command.
+    int status = 0;
+    // Strip a trailing carriage return sent by line-oriented clients.
+    std::string request = (!line.empty() && line.back() == '\r') ? line.substr(0, line.size() - 1) : line;
+    // Malformed arguments (e.g. a non-numeric ID) must not take the server down.
+    try {
+        // Run the command with both output streams captured into the response body.
+        status = engine.execute(split(request, ' '), body, body);
+    } catch (const std::exception& e) {
+        // Report the failure as a regular error response.
+        body << "Error: " << e.what() << "\n";
+        // Use the same exit status as any other failed command.
+        status = 1;
+    }
+    // Payload of the response.
+    const std::string payload = body.str();
+    // Prefix the payload with its header line.
+    return std::to_string(status) + " " + std::to_string(payload.size()) + "\n" + payload;
+}
+
+// Serves framed requests from an input stream until EOF or "exit".
+int Server::serveStream(Engine& engine, std::istream& in, std::ostream& out) {
+    // Current request line.
+    std::string line;
+    // Read one request per line.
+    while (std::getline(in, line)) {
+        // Stop serving on explicit exit.
+        if (line == "exit" || line == "exit\r") break;
+        // Write the framed response.
+        out << handleRequest(engine, line);
+        // Flush so the client sees the response immediately.
+        out.flush();
+    }
+    // Clean shutdown.
+    return 0;
+}
+
+#ifndef _WIN32
+// Writes the whole buffer to a socket, retrying on short writes.
+static bool writeAll(int fd, const std::string& data) {
+    // Number of bytes written so far.
+    size_t written = 0;
+    // Keep writing until everything is sent.
+    while (written < data.size()) {
+        // MSG_NOSIGNAL keeps a disconnected client from raising SIGPIPE.
+        ssize_t n = send(fd, data.data() + written, data.size() - written, MSG_NOSIGNAL);
+        // Give up on error.
+        if (n <= 0) return false;
+        // Advance past the written bytes.
+        written += static_cast<size_t>(n);
+    }
+    // Everything was sent.
+    return true;
+}
+
+// Serves one socket connection until the client disconnects or sends "exit".
+static void serveConnection(Engine& engine, int clientFd) {
+    // Bytes received but not yet consumed as a full line.
+    std::string pending;
+    // Fixed receive buffer.
+    char buffer[65536];
+    // Whether the client asked to close the session.
+    bool done = false;
+    // Read until EOF.
+    while (!done) {
+        // Receive the next chunk.
+        ssize_t n = recv(clientFd, buffer, sizeof(buffer), 0);
+        // Stop on EOF or error.
+        if (n <= 0) break;
+        // Append the chunk to the pending bytes.
+        pending.append(buffer, static_cast<size_t>(n));
+        // Start of the next unconsumed line.
+        size_t start = 0;
+        // Position of the next newline.
+        size_t newline;
+        // Handle every complete line in the buffer.
+        while ((newline = pending.find('\n', start)) != std::string::npos) {
+            // Extract the request line.
+            std::string line = pending.substr(start, newline - start);
+            // Move past the newline.
+            start = newline + 1;
+            // Stop serving this client on explicit exit.
+            if (line == "exit" || line == "exit\r") { done = true; break; }
+            // Response for this request.
+            std::string response;
+            {
+                // Only one command touches the engine at a time.
+                std::lock_guard<std::mutex> lock(engineMutex);
+                // Execute the request.
+                response = Server::handleRequest(engine, line);
+            }
+            // Send it back; drop the connection if the client went away.
+            if (!writeAll(clientFd, response)) { done = true; break; }
+        }
+        // Discard consumed bytes.
+        pending.erase(0, start);
+    }
+    // Close the connection.
+    close(clientFd);
+}
+#endif
+
+// Serves framed requests on a Unix domain socket.
+int Server::serveUnixSocket(Engine& engine, const std::string& socketPath) {
+#ifdef _WIN32
+    // Unix domain sockets are not available on this platform.
+    std::cerr << "Error: --socket is not supported on this platform." << std::endl;
+    // Return error code.
+    return 1;
+#else
+    // Create the listening socket.
+    int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    // Report failure to create the socket.
+    if (listenFd < 0) {
+        // Print error message.
+        std::cerr << "Error: Could not create socket: " << std::strerror(errno) << std::endl;
+        // Return error code.
+        return 1;
+    }
+    // Socket address.
+    sockaddr_un addr{};
+    // Unix domain family.
+    addr.sun_family = AF_UNIX;
+    // Reject paths that do not fit into sun_path.
+    if (socketPath.size() >= sizeof(addr.sun_path)) {
+        // Print error message.
+        std::cerr << "Error: Socket path too long: " << socketPath << std::endl;
+        // Release the socket.
+        close(listenFd);
+        // Return error code.
+        return 1;
+    }
+    // Copy the path into the address.
+    std::strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+    // Remove a stale socket file from a previous run.
+    unlink(socketPath.c_str());
+    // Bind and listen.
+    if (bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || listen(listenFd, 16) < 0) {
+        // Print error message.
+        std::cerr << "Error: Could not listen on " << socketPath << ": " << std::strerror(errno) << std::endl;
+        // Release the socket.
+        close(listenFd);
+        // Return error code.
+        return 1;
+    }
+    // Announce readiness on stderr (stdout is left untouched).
+    std::cerr << "Serving on " << socketPath << std::endl;
+    // Accept connections forever.
+    while (true) {
+        // Wait for the next client.
+        int clientFd = accept(listenFd, nullptr, nullptr);
+        // Retry on transient errors.
+        if (clientFd < 0) {
+            // Interrupted system calls are harmless.
+            if (errno == EINTR) continue;
+            // Anything else is fatal.
+            break;
+        }
+        // Serve the client on its own thread so one idle connection does not block others.
+        std::thread(serveConnection, std::ref(engine), clientFd).detach();
+    }
+    // Release the listening socket.
+    close(listenFd);
+    // Accept failed.
+    return 1;
+#endif
+}
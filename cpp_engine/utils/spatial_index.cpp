@@ -0,0 +1,271 @@
+#include "../include/spatial_index.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Side of the grid the Hilbert curve is laid over.
+    const uint32_t HILBERT_SIDE = 1u << 16;
+
+    // Position of grid cell (x, y) along the Hilbert curve over the HILBERT_SIDE x HILBERT_SIDE grid.
+    uint32_t hilbertIndex(uint32_t x, uint32_t y) {
+        // Index accumulated quadrant by quadrant, from the coarsest.
+        uint32_t index = 0;
+        for (uint32_t s = HILBERT_SIDE / 2; s > 0; s /= 2) {
+            // Quadrant of the cell at this scale.
+            uint32_t rx = (x & s) ? 1 : 0;
+            uint32_t ry = (y & s) ? 1 : 0;
+            index += s * s * ((3 * rx) ^ ry);
+            // Rotate the lower quadrants so the curve stays continuous.
+            if (ry == 0) {
+                if (rx == 1) { x = HILBERT_SIDE - 1 - x; y = HILBERT_SIDE - 1 - y; }
+                std::swap(x, y);
+            }
+        }
+        return index;
+    }
+
+    // Sorts (key, item) pairs by key with three stable 11-bit counting passes (LSD radix sort).
+    void radixSort(std::vector<std::pair<uint32_t, int>>& keys) {
+        // Scratch for each pass's output.
+        std::vector<std::pair<uint32_t, int>> sorted(keys.size());
+        for (int shift = 0; shift < 32; shift += 11) {
+            // Start of each digit's run in the output.
+            std::vector<size_t> start((1 << 11) + 1, 0);
+            for (const auto& key : keys) ++start[((key.first >> shift) & 2047) + 1];
+            for (size_t d = 1; d < start.size(); ++d) start[d] += start[d - 1];
+            // Scatter in input order, which keeps earlier passes' order within a digit.
+            for (const auto& key : keys) sorted[start[(key.first >> shift) & 2047]++] = key;
+            keys.swap(sorted);
+        }
+    }
+
+    // Packs an unordered pair of node IDs, smaller one first.
+    uint64_t pairKey(int a, int b) {
+        // High half the smaller ID, low half the larger.
+        if (b < a) std::swap(a, b);
+        return (static_cast<uint64_t>(static_cast<uint32_t>(a)) << 32) | static_cast<uint32_t>(b);
+    }
+
+    // Squared distance from (x, y) to the segment (ax, ay)-(bx, by); the closest point's position
+    // along it (0 at a, 1 at b) is stored in fraction.
+    double segmentDistance2(double ax, double ay, double bx, double by, double x, double y, double& fraction) {
+        // Direction of the segment.
+        double dx = bx - ax, dy = by - ay;
+        double length2 = dx * dx + dy * dy;
+        // Projection onto the line, clamped to the segment (degenerate segments are their first end).
+        double t = length2 > 0.0 ? ((x - ax) * dx + (y - ay) * dy) / length2 : 0.0;
+        fraction = t <= 0.0 ? 0.0 : std::min(t, 1.0);
+        // Offset to the closest point.
+        double px = ax + fraction * dx - x, py = ay + fraction * dy - y;
+        return px * px + py * py;
+    }
+}
+
+// Sorts the items along the Hilbert curve and packs the levels bottom-up.
+std::vector<int> PackedHilbertRTree::build(const std::vector<Box>& items) {
+    // Start over.
+    boxes.clear();
+    levelStart.clear();
+    std::vector<int> order(items.size());
+    if (items.empty()) return order;
+    // Bounds of the item centers, which the curve's grid is stretched over.
+    double minX = INF, minY = INF, maxX = -INF, maxY = -INF;
+    for (const Box& box : items) {
+        minX = std::min(minX, (box.minX + box.maxX) * 0.5);
+        minY = std::min(minY, (box.minY + box.maxY) * 0.5);
+        maxX = std::max(maxX, (box.minX + box.maxX) * 0.5);
+        maxY = std::max(maxY, (box.minY + box.maxY) * 0.5);
+    }
+    // Grid cells per unit along each axis (any scale works when all centers coincide).
+    double scaleX = maxX > minX ? (HILBERT_SIDE - 1) / (maxX - minX) : 0.0;
+    double scaleY = maxY > minY ? (HILBERT_SIDE - 1) / (maxY - minY) : 0.0;
+    // Curve position of every item.
+    std::vector<std::pair<uint32_t, int>> keys(items.size());
+    for (size_t i = 0; i < items.size(); ++i) {
+        // Grid cell of the center.
+        uint32_t x = static_cast<uint32_t>(((items[i].minX + items[i].maxX) * 0.5 - minX) * scaleX);
+        uint32_t y = static_cast<uint32_t>(((items[i].minY + items[i].maxY) * 0.5 - minY) * scaleY);
+        keys[i] = {hilbertIndex(x, y), static_cast<int>(i)};
+    }
+    // Items in curve order are the leaves.
+    radixSort(keys);
+    boxes.reserve(items.size() + items.size() / (FANOUT - 1) + 2);
+    for (size_t slot = 0; slot < keys.size(); ++slot) {
+        order[slot] = keys[slot].second;
+        boxes.push_back(items[keys[slot].second]);
+    }
+    // Pack each level into the next until a single root remains (always at least one level above the leaves).
+    levelStart.push_back(0);
+    size_t below = 0;
+    do {
+        // The level below ends where this one starts.
+        size_t end = boxes.size();
+        levelStart.push_back(end);
+        // One node per FANOUT consecutive boxes, bounding them all.
+        for (size_t first = below; first < end; first += FANOUT) {
+            Box box = boxes[first];
+            for (size_t i = first + 1; i < std::min(first + FANOUT, end); ++i) {
+                box.minX = std::min(box.minX, boxes[i].minX);
+                box.minY = std::min(box.minY, boxes[i].minY);
+                box.maxX = std::max(box.maxX, boxes[i].maxX);
+                box.maxY = std::max(box.maxY, boxes[i].maxY);
+            }
+            boxes.push_back(box);
+        }
+        // Continue one level up.
+        below = end;
+    } while (boxes.size() - below > 1);
+    // Close the last level.
+    levelStart.push_back(boxes.size());
+    return order;
+}
+
+// Indexes every node and edge of a frozen graph.
+void SpatialIndex::build(const CsrGraph& graph) {
+    // Nodes as point boxes.
+    std::vector<Point> points(graph.numNodes());
+    std::vector<PackedHilbertRTree::Box> boxes(graph.numNodes());
+    for (int u = 0; u < graph.numNodes(); ++u) {
+        points[u] = {graph.externalId(u), graph.x(u), graph.y(u)};
+        boxes[u] = {graph.x(u), graph.y(u), graph.x(u), graph.y(u)};
+    }
+    // Store them in tree order.
+    std::vector<int> order = nodeTree.build(boxes);
+    nodes.resize(points.size());
+    for (size_t slot = 0; slot < order.size(); ++slot) nodes[slot] = points[order[slot]];
+    // One segment per pair of joined nodes, found from the pair's smaller node (internal indices
+    // follow the external IDs), so the pairs come out sorted; loops have no extent and are skipped.
+    std::vector<Segment> found;
+    std::vector<int> partners;
+    for (int u = 0; u < graph.numNodes(); ++u) {
+        // Larger neighbours over outgoing and incoming edges.
+        partners.clear();
+        for (int e = graph.beginEdge(u); e < graph.endEdge(u); ++e) if (graph.edgeHead(e) > u) partners.push_back(graph.edgeHead(e));
+        for (int e = graph.beginInEdge(u); e < graph.endInEdge(u); ++e) if (graph.inEdgeTail(e) > u) partners.push_back(graph.inEdgeTail(e));
+        std::sort(partners.begin(), partners.end());
+        partners.erase(std::unique(partners.begin(), partners.end()), partners.end());
+        // One segment each, oriented from u unless only the edge towards u exists.
+        for (int v : partners) {
+            int a = graph.findEdge(u, v) >= 0 ? u : v, b = a == u ? v : u;
+            found.push_back({graph.externalId(a), graph.externalId(b), graph.x(a), graph.y(a), graph.x(b), graph.y(b), false});
+        }
+    }
+    // Segments by their bounding boxes.
+    boxes.resize(found.size());
+    for (size_t i = 0; i < found.size(); ++i) {
+        const Segment& s = found[i];
+        boxes[i] = {std::min(s.ax, s.bx), std::min(s.ay, s.by), std::max(s.ax, s.bx), std::max(s.ay, s.by)};
+    }
+    // Store them in tree order; the pairs keep their sorted order for lookups.
+    order = segmentTree.build(boxes);
+    segments.resize(found.size());
+    treeSegments.resize(found.size());
+    for (size_t slot = 0; slot < order.size(); ++slot) {
+        segments[slot] = found[order[slot]];
+        treeSegments[order[slot]] = {pairKey(segments[slot].from, segments[slot].to), static_cast<int>(slot)};
+    }
+    bufferedSegments.clear();
+    // Nothing removed yet.
+    removedSegments = 0;
+}
+
+// Buffers a new node.
+void SpatialIndex::addNode(int id, double x, double y) {
+    // Queries scan the buffer after the tree.
+    nodes.push_back({id, x, y});
+}
+
+// Slot of the segment between a pair of nodes.
+int SpatialIndex::findSegment(uint64_t key) const {
+    // Segments of the tree, by binary search.
+    auto it = std::lower_bound(treeSegments.begin(), treeSegments.end(), std::make_pair(key, -1));
+    if (it != treeSegments.end() && it->first == key && !segments[it->second].removed) return it->second;
+    // Buffered segments.
+    auto buffered = bufferedSegments.find(key);
+    return buffered == bufferedSegments.end() ? -1 : buffered->second;
+}
+
+// Buffers the segment of a new edge.
+void SpatialIndex::addEdge(int from, double fromX, double fromY, int to, double toX, double toY) {
+    // Loops have no extent; parallel and opposite edges share the segment.
+    uint64_t key = pairKey(from, to);
+    if (from == to || findSegment(key) >= 0) return;
+    // Queries scan the buffer after the tree.
+    bufferedSegments[key] = static_cast<int>(segments.size());
+    segments.push_back({from, to, fromX, fromY, toX, toY, false});
+}
+
+// Flags the segment between two nodes as removed.
+void SpatialIndex::removeEdge(int from, int to) {
+    // Segment of the pair, if indexed.
+    uint64_t key = pairKey(from, to);
+    int slot = findSegment(key);
+    if (slot < 0) return;
+    // Skipped by queries from now on; a later edge between the pair gets a fresh segment.
+    segments[slot].removed = true;
+    ++removedSegments;
+    bufferedSegments.erase(key);
+}
+
+// Whether the buffers or removals grew large enough to rebuild.
+bool SpatialIndex::needsRebuild() const {
+    // Buffers are scanned linearly by every query.
+    if (nodes.size() - nodeTree.size() > BUFFER_LIMIT || segments.size() - segmentTree.size() > BUFFER_LIMIT) return true;
+    // Removed segments still take up room in the tree.
+    return removedSegments > std::max(BUFFER_LIMIT, segments.size() / 4);
+}
+
+// Closest nodes: the tree's k best merged with the buffer.
+std::vector<SpatialIndex::NodeMatch> SpatialIndex::nearestNodes(double x, double y, size_t k) const {
+    // Squared distance of the node in a slot.
+    auto distance2 = [&](int slot) {
+        double dx = nodes[slot].x - x, dy = nodes[slot].y - y;
+        return dx * dx + dy * dy;
+    };
+    // Best k of the tree.
+    std::vector<std::pair<double, int>> candidates;
+    nodeTree.nearest(x, y, k, distance2, candidates);
+    // Every buffered node competes.
+    for (size_t slot = nodeTree.size(); slot < nodes.size(); ++slot) candidates.push_back({distance2(static_cast<int>(slot)), static_cast<int>(slot)});
+    // Keep the k closest, ties by slot for a stable answer.
+    size_t count = std::min(k, candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end());
+    // Report them.
+    std::vector<NodeMatch> matches;
+    matches.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        const Point& point = nodes[candidates[i].second];
+        matches.push_back({point.id, point.x, point.y, std::sqrt(candidates[i].first)});
+    }
+    return matches;
+}
+
+// Closest segments: the tree's k best merged with the buffer.
+std::vector<SpatialIndex::EdgeMatch> SpatialIndex::nearestEdges(double x, double y, size_t k) const {
+    // Squared distance of the segment in a slot (INF once removed).
+    auto distance2 = [&](int slot) {
+        const Segment& s = segments[slot];
+        double fraction = 0.0;
+        return s.removed ? INF : segmentDistance2(s.ax, s.ay, s.bx, s.by, x, y, fraction);
+    };
+    // Best k of the tree.
+    std::vector<std::pair<double, int>> candidates;
+    segmentTree.nearest(x, y, k, distance2, candidates);
+    // Every buffered segment still in place competes.
+    for (size_t slot = segmentTree.size(); slot < segments.size(); ++slot) {
+        if (!segments[slot].removed) candidates.push_back({distance2(static_cast<int>(slot)), static_cast<int>(slot)});
+    }
+    // Keep the k closest, ties by slot for a stable answer.
+    size_t count = std::min(k, candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end());
+    // Report them with their closest points.
+    std::vector<EdgeMatch> matches;
+    matches.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        const Segment& s = segments[candidates[i].second];
+        double fraction = 0.0;
+        segmentDistance2(s.ax, s.ay, s.bx, s.by, x, y, fraction);
+        matches.push_back({s.from, s.to, s.ax + fraction * (s.bx - s.ax), s.ay + fraction * (s.by - s.ay), fraction, std::sqrt(candidates[i].first)});
+    }
+    return matches;
+}
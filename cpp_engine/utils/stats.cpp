@@ -0,0 +1,180 @@
+#include "../include/stats.h"
+#include <algorithm>
+#include <mutex>
+
+namespace {
+    // Linear sub-buckets per power of two, and half of them.
+    const int SUB_BUCKETS = 128;
+    const int HALF_BUCKETS = SUB_BUCKETS / 2;
+    // Buckets for the whole 64-bit range: the first SUB_BUCKETS exact values, then HALF_BUCKETS per
+    // power of two above them.
+    const int BUCKET_COUNT = SUB_BUCKETS + (64 - 7) * HALF_BUCKETS;
+
+    // Every live thread's counters, plus the counts of exited threads.
+    struct Registry {
+        // Guards the fields (not the counters themselves).
+        std::mutex mutex;
+        // Blocks of live threads.
+        std::vector<Stats::ThreadCounters*> threads;
+        // Counts of exited threads.
+        Stats::Totals retired;
+        // Totals at the last reset.
+        Stats::Totals baseline;
+    };
+
+    // The process-wide registry.
+    Registry& registry() {
+        // Created on first use.
+        static Registry instance;
+        return instance;
+    }
+
+    // Sum of every thread's counters; the registry lock must be held.
+    Stats::Totals sumLocked(const Registry& reg) {
+        // Start from the exited threads.
+        Stats::Totals sum = reg.retired;
+        // Add the live ones.
+        for (const Stats::ThreadCounters* counters : reg.threads) {
+            for (int c = 0; c < Stats::CounterCount; ++c) sum.values[c] += counters->values[c].load(std::memory_order_relaxed);
+        }
+        return sum;
+    }
+}
+
+// Snake-case name of a counter.
+const char* Stats::counterName(int counter) {
+    // Same order as the enum.
+    static const char* const names[CounterCount] = {"nodes_settled", "edges_relaxed", "heap_pushes", "heap_pops", "stale_pops", "cache_hits", "cache_misses"};
+    return names[counter];
+}
+
+// Whether counters are compiled in.
+bool Stats::enabled() {
+#ifdef ROUTE_ENGINE_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Difference to an earlier reading.
+Stats::Totals Stats::Totals::operator-(const Totals& earlier) const {
+    // Counter by counter.
+    Totals difference;
+    for (int c = 0; c < CounterCount; ++c) difference.values[c] = values[c] - earlier.values[c];
+    return difference;
+}
+
+// Registers a thread's counters.
+Stats::ThreadCounters::ThreadCounters() {
+    // Start at zero.
+    for (std::atomic<uint64_t>& value : values) value.store(0, std::memory_order_relaxed);
+    // Make them visible to readers.
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.threads.push_back(this);
+}
+
+// Folds an exiting thread's counts into the retired totals.
+Stats::ThreadCounters::~ThreadCounters() {
+    // Keep the counts, drop the block.
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    for (int c = 0; c < CounterCount; ++c) reg.retired.values[c] += values[c].load(std::memory_order_relaxed);
+    for (size_t i = 0; i < reg.threads.size(); ++i) {
+        // Swap-remove this block.
+        if (reg.threads[i] == this) { reg.threads[i] = reg.threads.back(); reg.threads.pop_back(); break; }
+    }
+}
+
+// Counters of the calling thread.
+Stats::ThreadCounters& Stats::threadCounters() {
+    // Registered on the thread's first count.
+    thread_local ThreadCounters counters;
+    return counters;
+}
+
+// Sum over all threads since the last reset.
+Stats::Totals Stats::totals() {
+    // Read under the registry lock so that no thread exits halfway.
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    return sumLocked(reg) - reg.baseline;
+}
+
+// Starts counting from zero again.
+void Stats::reset() {
+    // The writers keep counting; later readings subtract the current sum.
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.baseline = sumLocked(reg);
+}
+
+// Creates an empty histogram.
+LatencyHistogram::LatencyHistogram() : counts(BUCKET_COUNT, 0) {}
+
+// Bucket of a value.
+int LatencyHistogram::bucketOf(uint64_t value) {
+    // Small values are exact.
+    if (value < static_cast<uint64_t>(SUB_BUCKETS)) return static_cast<int>(value);
+    // Shift that brings the value into [HALF_BUCKETS, SUB_BUCKETS).
+    int shift = (63 - __builtin_clzll(value)) - 6;
+    return SUB_BUCKETS + (shift - 1) * HALF_BUCKETS + static_cast<int>((value >> shift) - HALF_BUCKETS);
+}
+
+// Smallest value of a bucket.
+uint64_t LatencyHistogram::lowerBound(int bucket) {
+    // Exact buckets.
+    if (bucket < SUB_BUCKETS) return static_cast<uint64_t>(bucket);
+    // Sub-bucket within its power of two.
+    int shift = (bucket - SUB_BUCKETS) / HALF_BUCKETS + 1;
+    return static_cast<uint64_t>((bucket - SUB_BUCKETS) % HALF_BUCKETS + HALF_BUCKETS) << shift;
+}
+
+// Width of a bucket.
+uint64_t LatencyHistogram::width(int bucket) {
+    // Exact buckets hold one value, the others 2^shift.
+    return bucket < SUB_BUCKETS ? 1 : uint64_t(1) << ((bucket - SUB_BUCKETS) / HALF_BUCKETS + 1);
+}
+
+// Records one value.
+void LatencyHistogram::record(uint64_t nanoseconds) {
+    // Bucket count.
+    ++counts[bucketOf(nanoseconds)];
+    // Exact summary.
+    ++total;
+    sum += nanoseconds;
+    if (nanoseconds < smallest) smallest = nanoseconds;
+    if (nanoseconds > largest) largest = nanoseconds;
+}
+
+// Value at or below which the given fraction of the values lie.
+uint64_t LatencyHistogram::percentile(double fraction) const {
+    // Nothing recorded.
+    if (total == 0) return 0;
+    // Rank of the value (nearest rank, at least the first).
+    uint64_t rank = static_cast<uint64_t>(fraction * total + 0.5);
+    if (rank < 1) rank = 1;
+    if (rank >= total) return largest;
+    // Walk the buckets up to the rank.
+    uint64_t seen = 0;
+    for (int bucket = 0; bucket < BUCKET_COUNT; ++bucket) {
+        seen += counts[bucket];
+        // Middle of the bucket, clamped to the exact extremes.
+        if (seen >= rank) {
+            uint64_t value = lowerBound(bucket) + width(bucket) / 2;
+            return value < smallest ? smallest : value > largest ? largest : value;
+        }
+    }
+    return largest;
+}
+
+// Forgets every value.
+void LatencyHistogram::clear() {
+    // Reset the buckets and the summary.
+    std::fill(counts.begin(), counts.end(), 0);
+    total = 0;
+    sum = 0;
+    smallest = UINT64_MAX;
+    largest = 0;
+}
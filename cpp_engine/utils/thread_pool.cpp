@@ -0,0 +1,131 @@
+#include "../include/thread_pool.h"
+#include <algorithm> // For std::max
+
+// Worker index of the parallelFor body the current thread is executing, or -1 outside bodies.
+static thread_local int currentWorker = -1;
+
+// Starts a pool with the given number of workers (0 = one per hardware thread).
+ThreadPool::ThreadPool(unsigned count) {
+    // Default to the hardware concurrency (which may be reported as 0).
+    if (count == 0) count = std::max(1u, std::thread::hardware_concurrency());
+    // The calling thread is worker 0, so start count-1 background threads.
+    for (unsigned worker = 1; worker < count; ++worker) threads.emplace_back(&ThreadPool::workerLoop, this, worker);
+}
+
+// Stops and joins the workers.
+ThreadPool::~ThreadPool() {
+    {
+        // Announce shutdown.
+        std::lock_guard<std::mutex> lock(mutex);
+        // Workers exit their loop.
+        stopping = true;
+    }
+    // Wake everyone.
+    wake.notify_all();
+    // Wait for all workers.
+    for (std::thread& thread : threads) thread.join();
+}
+
+// Process-wide pool sized to the hardware.
+ThreadPool& ThreadPool::shared() {
+    // Created on first use.
+    static ThreadPool pool;
+    // Return the pool.
+    return pool;
+}
+
+// Claims and runs items of the current job until none are left.
+void ThreadPool::drain(unsigned worker) {
+    // Mark nested calls.
+    currentWorker = static_cast<int>(worker);
+    // Claim items one at a time; bodies are expected to be coarse enough for this to be cheap.
+    for (size_t i = nextItem.fetch_add(1); i < jobSize; i = nextItem.fetch_add(1)) {
+        try {
+            // Run the item.
+            (*job)(i, worker);
+        } catch (...) {
+            // Remember the first failure.
+            std::lock_guard<std::mutex> lock(mutex);
+            // Later failures are dropped.
+            if (!failure) failure = std::current_exception();
+            // Skip the remaining items.
+            nextItem.store(jobSize);
+        }
+    }
+    // Back outside any body.
+    currentWorker = -1;
+}
+
+// Loop of background worker `worker`.
+void ThreadPool::workerLoop(unsigned worker) {
+    // Last job this worker took part in.
+    unsigned long long seen = 0;
+    // Serve jobs until shutdown.
+    while (true) {
+        {
+            // Wait for a new job or shutdown.
+            std::unique_lock<std::mutex> lock(mutex);
+            // Sleep until something changes.
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            // Leave on shutdown.
+            if (stopping) return;
+            // Join the new job.
+            seen = generation;
+        }
+        // Work on it.
+        drain(worker);
+        {
+            // Report completion.
+            std::lock_guard<std::mutex> lock(mutex);
+            // The last worker out wakes the caller.
+            if (--active == 0) finished.notify_one();
+        }
+    }
+}
+
+// Runs body(i, worker) for every i in [0, count).
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t, unsigned)>& body) {
+    // Nested calls and single-item or single-worker jobs run on the calling thread.
+    if (currentWorker >= 0 || threads.empty() || count <= 1) {
+        // Plain loop under the calling worker's index (0 outside any body).
+        for (size_t i = 0; i < count; ++i) body(i, static_cast<unsigned>(std::max(currentWorker, 0)));
+        // Done.
+        return;
+    }
+    // One job at a time.
+    std::lock_guard<std::mutex> call(callMutex);
+    {
+        // Publish the job.
+        std::lock_guard<std::mutex> lock(mutex);
+        // Body to run.
+        job = &body;
+        // Item count.
+        jobSize = count;
+        // Start handing out items at 0.
+        nextItem.store(0);
+        // No failure yet.
+        failure = nullptr;
+        // All background workers take part.
+        active = static_cast<unsigned>(threads.size());
+        // New job.
+        ++generation;
+    }
+    // Wake the workers.
+    wake.notify_all();
+    // The caller works as worker 0.
+    drain(0);
+    // Failure of this job, if any.
+    std::exception_ptr error;
+    {
+        // Wait for the background workers.
+        std::unique_lock<std::mutex> lock(mutex);
+        // Sleep until the last one leaves.
+        finished.wait(lock, [&] { return active == 0; });
+        // Detach the body.
+        job = nullptr;
+        // Take the failure.
+        error = failure;
+    }
+    // Propagate the first failure.
+    if (error) std::rethrow_exception(error);
+}
@@ -0,0 +1,79 @@
+#include "../include/travel_time.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+// Sorts and checks the breakpoints of a function.
+bool TravelTime::normalize(std::vector<Breakpoint>& points, const char*& error) {
+    // A function needs at least one breakpoint.
+    if (points.empty()) { error = "travel-time function without breakpoints"; return false; }
+    // Times and values must be usable.
+    for (const Breakpoint& point : points) {
+        // Departure times within one period.
+        if (!(point.time >= 0.0 && point.time < PERIOD)) { error = "travel-time breakpoint outside [0, 1440)"; return false; }
+        // Finite, non-negative travel times.
+        if (!(point.value >= 0.0) || std::isinf(point.value)) { error = "negative or infinite travel time"; return false; }
+    }
+    // Departure order.
+    std::sort(points.begin(), points.end(), [](const Breakpoint& a, const Breakpoint& b) { return a.time < b.time; });
+    // Every slope, the wrap-around to the next period included, must be at least -1.
+    for (size_t i = 0; i < points.size(); ++i) {
+        // Next breakpoint (the first one of the next period after the last).
+        const Breakpoint& a = points[i];
+        const Breakpoint& b = points[(i + 1) % points.size()];
+        double gap = i + 1 < points.size() ? b.time - a.time : b.time + PERIOD - a.time;
+        // Two breakpoints at one time.
+        if (gap <= 0.0) { error = "duplicate travel-time breakpoint"; return false; }
+        // Arriving earlier by leaving later.
+        if (b.value - a.value < -gap) { error = "travel-time function is not FIFO (slope below -1)"; return false; }
+    }
+    // Valid.
+    return true;
+}
+
+// Travel time when departing at t.
+double TravelTime::evaluate(const Breakpoint* points, int count, double t) {
+    // Constant function.
+    if (count == 1) return points[0].value;
+    // Position within the period.
+    double x = std::fmod(t, PERIOD);
+    if (x < 0.0) x += PERIOD;
+    // First breakpoint after x.
+    const Breakpoint* next = std::upper_bound(points, points + count, x, [](double time, const Breakpoint& point) { return time < point.time; });
+    // Neighbours, wrapping around the period at both ends.
+    double t0, v0, t1, v1;
+    if (next == points) { t0 = points[count - 1].time - PERIOD; v0 = points[count - 1].value; t1 = points[0].time; v1 = points[0].value; }
+    else if (next == points + count) { t0 = points[count - 1].time; v0 = points[count - 1].value; t1 = points[0].time + PERIOD; v1 = points[0].value; }
+    else { t0 = next[-1].time; v0 = next[-1].value; t1 = next->time; v1 = next->value; }
+    // Linear in between.
+    return v0 + (v1 - v0) * (x - t0) / (t1 - t0);
+}
+
+// Smallest travel time of a function.
+double TravelTime::minimum(const Breakpoint* points, int count) {
+    // Linear pieces take their minimum at a breakpoint.
+    double best = points[0].value;
+    for (int i = 1; i < count; ++i) best = std::min(best, points[i].value);
+    return best;
+}
+
+// Parses "HH:MM" or plain minutes.
+bool TravelTime::parseTime(const std::string& text, double& minutes) {
+    // Hours and minutes.
+    size_t colon = text.find(':');
+    try {
+        // Plain minutes.
+        if (colon == std::string::npos) {
+            minutes = std::stod(text);
+        } else {
+            // Both parts must be present.
+            if (colon == 0 || colon + 1 == text.size()) return false;
+            minutes = std::stoi(text.substr(0, colon)) * 60.0 + std::stod(text.substr(colon + 1));
+        }
+    } catch (const std::exception&) {
+        // Not a number.
+        return false;
+    }
+    // Finite and not before midnight of day 0.
+    return minutes >= 0.0 && !std::isinf(minutes);
+}
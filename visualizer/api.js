@@ -1,12 +1,15 @@
 // Base URL for the backend API.
 const API_BASE_URL = 'http://127.0.0.1:8000/api/v1';
 
-// Asynchronously fetches graph data from the backend.
-async function fetchGraphData() {
+// Asynchronously fetches graph data from the backend; with `since` (an earlier response's version)
+// only the nodes and edges changed after it are returned, unless the response has `full` set.
+async function fetchGraphData(since = null) {
     // Try to fetch data from the /graph endpoint.
     try {
+        // Ask for a delta when there is a version to start from.
+        const query = since === null ? '' : `?since=${since}`;
         // Await the response from the API.
-        const response = await fetch(`${API_BASE_URL}/graph`);
+        const response = await fetch(`${API_BASE_URL}/graph${query}`);
         // If the response is not ok (e.g., 404, 500), throw an error.
         if (!response.ok) {
             // Throw error with status text.
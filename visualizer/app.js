@@ -10,6 +10,11 @@ let graphNodes = [];
 // Array to store graph links (edges).
 let graphLinks = [];
 
+// Graph version of the last response; refreshes only ask for what changed after it.
+let graphVersion = null;
+// Interval between background refreshes, in milliseconds.
+const GRAPH_POLL_INTERVAL_MS = 5000;
+
 // Variables to store selected nodes for edge creation.
 let selectedNode1 = null;
 // Second selected node for creating an edge.
@@ -92,8 +97,19 @@ function handleSvgClick(event) {
 
 // Fetches graph data from the API and updates the D3 visualization.
 async function loadAndDrawGraph() {
-    // Fetch graph data.
-    const data = await fetchGraphData();
+    // Fetch and draw the whole graph.
+    drawGraph(await fetchGraphData());
+}
+
+// Identity of a link: its end node IDs and its position among parallel edges (source and target
+// become node objects once the simulation runs).
+function linkKey(l) {
+    // Source, target and parallel position.
+    return `${l.source.id ?? l.source}-${l.target.id ?? l.target}-${l.parallel ?? 0}`;
+}
+
+// Replaces the drawing with a full graph response (or clears it if data is missing).
+function drawGraph(data) {
     // If data is successfully fetched.
     if (data && data.nodes && data.edges) {
         // Clear existing shortest path highlights.
@@ -120,9 +136,13 @@ async function loadAndDrawGraph() {
             // Target node ID.
             target: e.to_node,
             // Edge weight.
-            weight: e.weight
+            weight: e.weight,
+            // Position among parallel edges between the same nodes.
+            parallel: e.parallel ?? 0
         }));
 
+        // Remember the version for later deltas.
+        graphVersion = data.version ?? null;
         // Update the D3 simulation with new data.
         updateSimulation();
         // Update message area.
@@ -134,11 +154,52 @@ async function loadAndDrawGraph() {
         graphNodes = [];
         // Reset graph links.
         graphLinks = [];
+        // The next refresh starts from scratch.
+        graphVersion = null;
         // Update simulation with empty data to clear visuals.
         updateSimulation();
     }
 }
 
+// Fetches only what changed since the last response and merges it into the current drawing.
+async function refreshGraph() {
+    // Without a version there is nothing to patch; load everything.
+    if (graphVersion === null) return loadAndDrawGraph();
+    // Fetch the changes.
+    const data = await fetchGraphData(graphVersion);
+    // Keep the current drawing if the request failed.
+    if (!data || !data.nodes || !data.edges) return;
+    // The engine sends everything when it cannot produce a delta (e.g. after a reload).
+    if (data.full) return drawGraph(data);
+    // Nothing changed.
+    if (data.nodes.length === 0 && data.edges.length === 0) { graphVersion = data.version; return; }
+    // Current nodes by ID.
+    const nodesById = new Map(graphNodes.map(n => [n.id, n]));
+    // New nodes join the simulation; existing ones keep their simulated position.
+    for (const n of data.nodes) {
+        // Skip nodes already drawn.
+        if (nodesById.has(n.id)) continue;
+        // Add the node.
+        graphNodes.push({ id: n.id, x: n.x || Math.random() * width, y: n.y || Math.random() * height, fx: null, fy: null });
+    }
+    // Current links by identity.
+    const linksByKey = new Map(graphLinks.map(l => [linkKey(l), l]));
+    // Changed edges get their new weight, new ones (including new parallel edges) are added.
+    for (const e of data.edges) {
+        // The delta's edge as a link.
+        const update = { source: e.from_node, target: e.to_node, weight: e.weight, parallel: e.parallel ?? 0 };
+        // Existing link with the same identity.
+        const link = linksByKey.get(linkKey(update));
+        // Update or add.
+        if (link) link.weight = e.weight;
+        else graphLinks.push(update);
+    }
+    // Continue from the new version.
+    graphVersion = data.version;
+    // Redraw.
+    updateSimulation();
+}
+
 
 // Updates D3 elements based on current graphNodes and graphLinks.
 function updateSimulation() {
@@ -173,7 +234,7 @@ function updateSimulation() {
         .merge(nodeLabels);
 
     // Update link data join.
-    linkElements = linkElements.data(graphLinks, d => `${d.source.id || d.source}-${d.target.id || d.target}`); // Use IDs if source/target are objects
+    linkElements = linkElements.data(graphLinks, linkKey);
     // Remove old links.
     linkElements.exit().remove();
     // Add new links.
@@ -183,15 +244,15 @@ function updateSimulation() {
         .merge(linkElements);
 
     // Update edge weight label data join.
-    edgeWeightLabels = edgeWeightLabels.data(graphLinks, d => `${d.source.id || d.source}-${d.target.id || d.target}`);
+    edgeWeightLabels = edgeWeightLabels.data(graphLinks, linkKey);
     // Remove old weight labels.
     edgeWeightLabels.exit().remove();
     // Add new weight labels.
     edgeWeightLabels = edgeWeightLabels.enter().append("text")
         .attr("class", "edge-weight")
-        .text(d => d.weight.toFixed(1))
         .attr("dy", -5) // Position above the link
-        .merge(edgeWeightLabels);
+        .merge(edgeWeightLabels)
+        .text(d => d.weight.toFixed(1)); // Existing labels too, as weights change
 
     // Restart the simulation with new nodes and links.
     simulation.nodes(graphNodes);
@@ -327,6 +388,8 @@ function clearShortestPath() {
 document.addEventListener('DOMContentLoaded', () => {
     // Initialize graph visualization on page load.
     initializeGraph();
+    // Pick up changes made by other clients; each poll only transfers the delta.
+    setInterval(refreshGraph, GRAPH_POLL_INTERVAL_MS);
 
     // Listener for "Load/Refresh Graph" button.
     document.getElementById('loadGraphBtn').addEventListener('click', loadAndDrawGraph);
@@ -408,8 +471,8 @@ document.addEventListener('DOMContentLoaded', () => {
         const result = await addNode(nodeId, isNaN(nodeX) ? null : nodeX, isNaN(nodeY) ? null : nodeY);
         // If node added successfully.
         if (result && !result.detail) { // Assuming error responses have a 'detail' field
-            // Reload and draw the graph to reflect changes.
-            loadAndDrawGraph();
+            // Fetch and draw the change.
+            refreshGraph();
         }
     });
 
@@ -432,8 +495,8 @@ document.addEventListener('DOMContentLoaded', () => {
         const result = await addEdge(fromNode, toNode, weight);
         // If edge added successfully.
         if (result && !result.detail) {
-            // Reload and draw graph.
-            loadAndDrawGraph();
+            // Fetch and draw the change.
+            refreshGraph();
             // Clear selection and input fields.
             selectedNode1 = null; selectedNode2 = null;
             // Reset 'from' input.
@@ -464,8 +527,8 @@ document.addEventListener('DOMContentLoaded', () => {
         const result = await updateEdgeWeight(fromNode, toNode, newWeight);
         // If update successful.
         if (result && !result.detail) {
-            // Reload and draw graph.
-            loadAndDrawGraph();
+            // Fetch and draw the change.
+            refreshGraph();
         }
     });
     
@@ -505,7 +568,7 @@ document.addEventListener('DOMContentLoaded', () => {
         if (result && !result.detail) {
             // Optionally, you might want to visually represent zones/sets if your graph nodes have set info.
             // For now, just a message update.
-            loadAndDrawGraph(); // Reload graph if zones affect visual representation or for consistency
+            refreshGraph(); // Fetch any changes if zones affect visual representation or for consistency
         }
     });
 });
\ No newline at end of file